@@ -96,13 +96,60 @@ QuicAckTrackerAddPacketNumber(
         !RangeUpdated;
 }
 
+//
+// Returns TRUE if, with the given reordering threshold, the currently tracked
+// packet numbers indicate a gap the peer should hear about immediately. Only
+// packets missing above the largest packet number already reported in an ACK
+// frame are considered, since the older ones have already been signaled.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicAckTrackerDidHitReorderingThreshold(
+    _In_ QUIC_ACK_TRACKER* Tracker,
+    _In_ uint8_t ReorderingThreshold
+    )
+{
+    if (ReorderingThreshold == 0) {
+        return FALSE; // Peer asked for reordering to be ignored.
+    }
+
+    const uint32_t RangeCount = QuicRangeSize(&Tracker->PacketNumbersToAck);
+    if (RangeCount < 2) {
+        return FALSE; // No gaps.
+    }
+
+    const uint64_t LargestUnacked = QuicRangeGetMax(&Tracker->PacketNumbersToAck);
+
+    //
+    // Find the smallest missing packet number that hasn't been reported yet.
+    // It has the largest distance to the largest received packet number, so
+    // it's the only one that needs checking.
+    //
+    for (uint32_t i = 1; i < RangeCount; ++i) {
+        const uint64_t GapEnd =
+            QuicRangeGet(&Tracker->PacketNumbersToAck, i)->Low - 1;
+        if (GapEnd <= Tracker->LargestPacketNumberAcknowledged) {
+            continue;
+        }
+        uint64_t SmallestMissing =
+            QuicRangeGetHigh(QuicRangeGet(&Tracker->PacketNumbersToAck, i - 1)) + 1;
+        if (SmallestMissing <= Tracker->LargestPacketNumberAcknowledged) {
+            SmallestMissing = Tracker->LargestPacketNumberAcknowledged + 1;
+        }
+        return LargestUnacked - SmallestMissing >= ReorderingThreshold;
+    }
+
+    return FALSE;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicAckTrackerAckPacket(
     _Inout_ QUIC_ACK_TRACKER* Tracker,
     _In_ uint64_t PacketNumber,
     _In_ QUIC_ECN_TYPE ECN,
-    _In_ BOOLEAN AckElicitingPayload
+    _In_ BOOLEAN AckElicitingPayload,
+    _In_ BOOLEAN ImmediateAck
     )
 {
     QUIC_CONNECTION* Connection = QuicAckTrackerGetPacketSpace(Tracker)->Connection;
@@ -178,26 +225,49 @@ QuicAckTrackerAckPacket(
     //
     // There are several conditions where we decide to send an ACK immediately:
     //
-    //   1. We have received QUIC_MIN_ACK_SEND_NUMBER ACK eliciting packets.
-    //   2. We received an ACK eliciting packet that doesn't directly follow the
-    //      previously received packet number. So we assume there might have
-    //      been loss and should indicate this info to the peer.
-    //   3. The delayed ACK timer fires after the configured time.
+    //   1. The peer explicitly asked for one (IMMEDIATE_ACK frame).
+    //   2. We have received more than the ACK eliciting threshold of ACK
+    //      eliciting packets.
+    //   3. We received an ACK eliciting packet that indicates a gap in the
+    //      packet numbers, per the reordering threshold. So we assume there
+    //      might have been loss and should indicate this info to the peer.
+    //   4. The delayed ACK timer fires after the configured time.
+    //
+    // The thresholds default to QUIC_MIN_ACK_SEND_NUMBER - 1 and 1 (a gap
+    // right before the newest packet number), but the peer may change them
+    // for the 1-RTT packet number space via ACK_FREQUENCY frames.
     //
     // If we don't queue an immediate ACK and this is the first ACK eliciting
     // packet received, we make sure the ACK delay timer is started.
     //
 
-    if (Tracker->AckElicitingPacketsToAcknowledge >= QUIC_MIN_ACK_SEND_NUMBER ||
-        (NewLargestPacketNumber &&
-         QuicRangeSize(&Tracker->PacketNumbersToAck) > 1 && // There are more than two ranges, i.e. a gap somewhere.
+    uint16_t AckElicitingThreshold = QUIC_MIN_ACK_SEND_NUMBER - 1;
+    uint8_t ReorderingThreshold = 1;
+    if (QuicAckTrackerGetPacketSpace(Tracker)->EncryptLevel == QUIC_ENCRYPT_LEVEL_1_RTT) {
+        AckElicitingThreshold = Connection->AckFrequency.AckElicitingThreshold;
+        ReorderingThreshold = Connection->AckFrequency.ReorderingThreshold;
+    }
+
+    BOOLEAN Reordered;
+    if (ReorderingThreshold == 1) {
+        Reordered =
+            NewLargestPacketNumber &&
+            QuicRangeSize(&Tracker->PacketNumbersToAck) > 1 && // There are more than two ranges, i.e. a gap somewhere.
             QuicRangeGet(
-            &Tracker->PacketNumbersToAck,
-         QuicRangeSize(&Tracker->PacketNumbersToAck) - 1)->Count == 1)) { // The gap is right before the last packet number.
+                &Tracker->PacketNumbersToAck,
+                QuicRangeSize(&Tracker->PacketNumbersToAck) - 1)->Count == 1; // The gap is right before the last packet number.
+    } else {
+        Reordered =
+            QuicAckTrackerDidHitReorderingThreshold(Tracker, ReorderingThreshold);
+    }
+
+    if (ImmediateAck ||
+        Tracker->AckElicitingPacketsToAcknowledge > AckElicitingThreshold ||
+        Reordered) {
         //
-        // Always send an ACK immediately if we have received enough ACK
-        // eliciting packets OR the latest one indicate a gap in the packet
-        // numbers, which likely means there was loss.
+        // Always send an ACK immediately if asked to, if we have received
+        // enough ACK eliciting packets OR the latest one indicate a gap in the
+        // packet numbers, which likely means there was loss.
         //
         QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_ACK);
 
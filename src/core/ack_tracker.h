@@ -93,6 +93,8 @@ QuicAckTrackerAddPacketNumber(
 
 //
 // Adds the packet number to the list of packets that should be acknowledged.
+// ImmediateAck is set when the peer explicitly asked (IMMEDIATE_ACK) for an
+// acknowledgement without delay.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
@@ -100,7 +102,8 @@ QuicAckTrackerAckPacket(
     _Inout_ QUIC_ACK_TRACKER* Tracker,
     _In_ uint64_t PacketNumber,
     _In_ QUIC_ECN_TYPE ECN,
-    _In_ BOOLEAN AckElicitingPayload
+    _In_ BOOLEAN AckElicitingPayload,
+    _In_ BOOLEAN ImmediateAck
     );
 
 //
@@ -142,7 +142,7 @@ MsQuicConnectionClose(
         QuicTraceEvent(
             ApiWaitOperation,
             "[ api] Waiting on operation");
-        QuicEventWaitForever(CompletionEvent);
+        QuicWorkerWaitForOperation(Connection->Worker, &CompletionEvent);
         QuicEventUninitialize(CompletionEvent);
     }
 
@@ -740,7 +740,7 @@ MsQuicStreamClose(
         QuicTraceEvent(
             ApiWaitOperation,
             "[ api] Waiting on operation");
-        QuicEventWaitForever(CompletionEvent);
+        QuicWorkerWaitForOperation(Connection->Worker, &CompletionEvent);
         QuicEventUninitialize(CompletionEvent);
     }
 
@@ -852,7 +852,7 @@ MsQuicStreamStart(
         QuicTraceEvent(
             ApiWaitOperation,
             "[ api] Waiting on operation");
-        QuicEventWaitForever(CompletionEvent);
+        QuicWorkerWaitForOperation(Connection->Worker, &CompletionEvent);
         QuicEventUninitialize(CompletionEvent);
     }
 
@@ -930,6 +930,26 @@ MsQuicStreamShutdown(
         (Connection->WorkerThreadID == QuicCurThreadID()) ||
         !Connection->State.HandleClosed);
 
+    if (QuicConnIsOnWorkerThread(Connection) &&
+        Stream->InlineShutdownFlags == 0) {
+        //
+        // Called from a callback on the worker thread, so have the shutdown
+        // processed as soon as the current operation completes instead of
+        // queuing a new operation. A graceful shutdown behind sends that
+        // haven't been flushed yet is instead queued as a FIN on the last of
+        // them, to keep it in order. The ref is released after the shutdown.
+        //
+        if (Flags != QUIC_STREAM_SHUTDOWN_FLAG_GRACEFUL ||
+            !QuicStreamSendQueueApiFin(Stream)) {
+            QuicStreamAddRef(Stream, QUIC_STREAM_REF_OPERATION);
+            Stream->InlineShutdownFlags = Flags;
+            Stream->InlineShutdownErrorCode = ErrorCode;
+            QuicConnQueueInlineApiShutdown(Connection, Stream);
+        }
+        Status = QUIC_STATUS_PENDING;
+        goto Error;
+    }
+
     Oper = QuicOperationAlloc(Connection->Worker, QUIC_OPER_TYPE_API_CALL);
     if (Oper == NULL) {
         Status = QUIC_STATUS_OUT_OF_MEMORY;
@@ -985,7 +1005,7 @@ MsQuicStreamSend(
     QUIC_CONNECTION* Connection;
     uint64_t TotalLength;
     QUIC_SEND_REQUEST* SendRequest;
-    BOOLEAN QueueOper = TRUE;
+    BOOLEAN QueueOper;
     QUIC_OPERATION* Oper;
 
     QuicTraceEvent(
@@ -1053,26 +1073,23 @@ MsQuicStreamSend(
     SendRequest->TotalLength = TotalLength;
     SendRequest->ClientContext = ClientSendContext;
 
-    QuicDispatchLockAcquire(&Stream->ApiSendRequestLock);
-    if (!Stream->Flags.SendEnabled) {
-        Status = QUIC_STATUS_INVALID_STATE;
-    } else {
-        QUIC_SEND_REQUEST** ApiSendRequestsTail = &Stream->ApiSendRequests;
-        while (*ApiSendRequestsTail != NULL) {
-            ApiSendRequestsTail = &((*ApiSendRequestsTail)->Next);
-            QueueOper = FALSE; // Not necessary if the previous send hasn't been flushed yet.
-        }
-        *ApiSendRequestsTail = SendRequest;
-        Status = QUIC_STATUS_SUCCESS;
-    }
-    QuicDispatchLockRelease(&Stream->ApiSendRequestLock);
-
+    Status = QuicStreamSendQueueApiRequest(Stream, SendRequest, &QueueOper);
     if (QUIC_FAILED(Status)) {
         QuicPoolFree(&Connection->Worker->SendRequestPool, SendRequest);
         goto Exit;
     }
 
-    if (QueueOper) {
+    if (QueueOper && QuicConnIsOnWorkerThread(Connection)) {
+        //
+        // Called from a callback on the worker thread, so have the stream
+        // flushed as soon as the current operation completes instead of
+        // queuing a new operation. The ref is released after the flush.
+        //
+        QuicStreamAddRef(Stream, QUIC_STREAM_REF_OPERATION);
+        Stream->ApiSendBatchNext = NULL;
+        QuicConnQueueInlineApiSends(Connection, Stream, &Stream->ApiSendBatchNext);
+
+    } else if (QueueOper) {
         Oper = QuicOperationAlloc(Connection->Worker, QUIC_OPER_TYPE_API_CALL);
         if (Oper == NULL) {
             Status = QUIC_STATUS_OUT_OF_MEMORY;
@@ -1111,6 +1128,227 @@ Exit:
     return Status;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicApiStreamSendBatchEntry(
+    _In_ QUIC_CONNECTION* Connection,
+    _Inout_ QUIC_STREAM_SEND_BATCH_ENTRY* Entry,
+    _Out_ QUIC_STREAM** FlushStream
+    )
+{
+    QUIC_STATUS Status;
+    QUIC_STREAM* Stream;
+    uint64_t TotalLength;
+    QUIC_SEND_REQUEST* SendRequest;
+    BOOLEAN NeedsFlush;
+
+    *FlushStream = NULL;
+
+    if (Entry->Buffers == NULL ||
+        Entry->BufferCount == 0) {
+        return QUIC_STATUS_INVALID_PARAMETER;
+    }
+
+    TotalLength = 0;
+    for (uint32_t i = 0; i < Entry->BufferCount; ++i) {
+        TotalLength += Entry->Buffers[i].Length;
+    }
+
+    if (TotalLength > UINT32_MAX ||
+        (TotalLength == 0 && !(Entry->Flags & QUIC_SEND_FLAG_FIN))) {
+        return QUIC_STATUS_INVALID_PARAMETER;
+    }
+
+    if (Entry->Stream == NULL) {
+        if (Entry->Handler == NULL) {
+            return QUIC_STATUS_INVALID_PARAMETER;
+        }
+
+        if (QuicConnIsClosed(Connection)) {
+            return QUIC_STATUS_INVALID_STATE;
+        }
+
+        Stream = NULL;
+
+    } else if (IS_STREAM_HANDLE(Entry->Stream)) {
+#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
+        Stream = (QUIC_STREAM*)Entry->Stream;
+
+        QUIC_TEL_ASSERT(!Stream->Flags.HandleClosed);
+        QUIC_TEL_ASSERT(!Stream->Flags.Freed);
+
+        if (Stream->Connection != Connection) {
+            return QUIC_STATUS_INVALID_PARAMETER;
+        }
+
+    } else {
+        return QUIC_STATUS_INVALID_PARAMETER;
+    }
+
+#pragma prefast(suppress: __WARNING_6014, "Memory is correctly freed (QuicStreamCompleteSendRequest).")
+    SendRequest = QuicPoolAlloc(&Connection->Worker->SendRequestPool);
+    if (SendRequest == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "Stream Send request",
+            0);
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    if (Stream == NULL) {
+        //
+        // Only open the stream once nothing else can fail, so that the app
+        // never gets a handle back for a failed entry. Sends are always
+        // enabled on a new stream, so queuing the request can't fail either.
+        //
+        Status =
+            QuicStreamInitialize(
+                Connection,
+                FALSE,
+                !!(Entry->OpenFlags & QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL),
+                !!(Entry->OpenFlags & QUIC_STREAM_OPEN_FLAG_0_RTT),
+                &Stream);
+        if (QUIC_FAILED(Status)) {
+            QuicPoolFree(&Connection->Worker->SendRequestPool, SendRequest);
+            return Status;
+        }
+
+        Stream->ClientCallbackHandler = Entry->Handler;
+        Stream->ClientContext = Entry->Context;
+        Entry->Stream = (HQUIC)Stream;
+    }
+
+    SendRequest->Next = NULL;
+    SendRequest->Buffers = Entry->Buffers;
+    SendRequest->BufferCount = Entry->BufferCount;
+    SendRequest->Flags = Entry->Flags & ~QUIC_SEND_FLAGS_INTERNAL;
+    SendRequest->TotalLength = TotalLength;
+    SendRequest->ClientContext = Entry->ClientSendContext;
+
+    Status = QuicStreamSendQueueApiRequest(Stream, SendRequest, &NeedsFlush);
+    if (QUIC_FAILED(Status)) {
+        QuicPoolFree(&Connection->Worker->SendRequestPool, SendRequest);
+        return Status;
+    }
+
+    if (NeedsFlush) {
+        //
+        // The flush holds a ref on each stream in the batch, released after
+        // the stream is flushed.
+        //
+        QuicStreamAddRef(Stream, QUIC_STREAM_REF_OPERATION);
+        *FlushStream = Stream;
+    }
+
+    return QUIC_STATUS_PENDING;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QUIC_API
+MsQuicStreamSendBatch(
+    _In_ _Pre_defensive_ HQUIC Handle,
+    _Inout_updates_(EntryCount) _Pre_defensive_
+        QUIC_STREAM_SEND_BATCH_ENTRY* Entries,
+    _In_ uint32_t EntryCount
+    )
+{
+    QUIC_STATUS Status;
+    QUIC_CONNECTION* Connection;
+    QUIC_OPERATION* Oper = NULL;
+    QUIC_STREAM* FlushStreams = NULL;
+    QUIC_STREAM** FlushTail = &FlushStreams;
+    BOOLEAN Inline;
+    uint32_t QueuedCount = 0;
+
+    QuicTraceEvent(
+        ApiEnter,
+        "[ api] Enter %u (%p).",
+        QUIC_TRACE_API_STREAM_SEND_BATCH,
+        Handle);
+
+    if (!IS_CONN_HANDLE(Handle) ||
+        Entries == NULL ||
+        EntryCount == 0) {
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
+    Connection = (QUIC_CONNECTION*)Handle;
+
+    QUIC_CONN_VERIFY(Connection, !Connection->State.Freed);
+    QUIC_CONN_VERIFY(Connection,
+        (Connection->WorkerThreadID == QuicCurThreadID()) ||
+        !Connection->State.HandleClosed);
+
+    //
+    // When called from a callback on the worker thread, the streams are
+    // flushed as soon as the current operation completes. Otherwise, a single
+    // operation flushes every stream in the batch. It is allocated up front so
+    // that no send request is ever queued without one.
+    //
+    Inline = QuicConnIsOnWorkerThread(Connection);
+    if (!Inline) {
+        Oper = QuicOperationAlloc(Connection->Worker, QUIC_OPER_TYPE_API_CALL);
+        if (Oper == NULL) {
+            Status = QUIC_STATUS_OUT_OF_MEMORY;
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "STRM_SEND_BATCH operation",
+                0);
+            goto Exit;
+        }
+        Oper->API_CALL.Context->Type = QUIC_API_TYPE_STRM_SEND_BATCH;
+        Oper->API_CALL.Context->STRM_SEND_BATCH.Streams = NULL;
+    }
+
+    for (uint32_t i = 0; i < EntryCount; ++i) {
+        QUIC_STREAM* FlushStream;
+        Entries[i].Status =
+            QuicApiStreamSendBatchEntry(Connection, &Entries[i], &FlushStream);
+        if (Entries[i].Status == QUIC_STATUS_PENDING) {
+            QueuedCount++;
+        }
+        if (FlushStream != NULL) {
+            FlushStream->ApiSendBatchNext = NULL;
+            *FlushTail = FlushStream;
+            FlushTail = &FlushStream->ApiSendBatchNext;
+        }
+    }
+
+    if (Inline) {
+        if (FlushStreams != NULL) {
+            QuicConnQueueInlineApiSends(Connection, FlushStreams, FlushTail);
+        }
+    } else if (FlushStreams != NULL) {
+        //
+        // Queue the operation but don't wait for the completion.
+        //
+        Oper->API_CALL.Context->STRM_SEND_BATCH.Streams = FlushStreams;
+        QuicConnQueueOper(Connection, Oper);
+    } else {
+        //
+        // Every queued send is already covered by a pending flush, so there
+        // are no stream refs to release here.
+        //
+        QuicOperationFree(Connection->Worker, Oper);
+    }
+
+    Status = QueuedCount != 0 ? QUIC_STATUS_PENDING : Entries[0].Status;
+
+Exit:
+
+    QuicTraceEvent(
+        ApiExitStatus,
+        "[ api] Exit %u",
+        Status);
+
+    return Status;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 QUIC_API
@@ -1227,6 +1465,22 @@ MsQuicStreamReceiveComplete(
         goto Exit;
     }
 
+    if (QuicConnIsOnWorkerThread(Connection) &&
+        Stream->Flags.ReceiveCallActive) {
+        //
+        // Called from the stream's own receive callback. Just record the
+        // completion, which is processed when the callback returns. Only the
+        // first one counts; any others would find the receive already
+        // completed.
+        //
+        if (!Stream->Flags.ReceiveCompleteInline) {
+            Stream->RecvInlineCompleteLength = BufferLength;
+            Stream->Flags.ReceiveCompleteInline = TRUE;
+        }
+        Status = QUIC_STATUS_SUCCESS;
+        goto Exit;
+    }
+
     Oper = QuicOperationAlloc(Connection->Worker, QUIC_OPER_TYPE_API_CALL);
     if (Oper == NULL) {
         Status = QUIC_STATUS_OUT_OF_MEMORY;
@@ -1362,7 +1616,7 @@ MsQuicSetParam(
     QuicTraceEvent(
         ApiWaitOperation,
         "[ api] Waiting on operation");
-    QuicEventWaitForever(CompletionEvent);
+    QuicWorkerWaitForOperation(Connection->Worker, &CompletionEvent);
     QuicEventUninitialize(CompletionEvent);
 
 Error:
@@ -1473,7 +1727,7 @@ MsQuicGetParam(
     QuicTraceEvent(
         ApiWaitOperation,
         "[ api] Waiting on operation");
-    QuicEventWaitForever(CompletionEvent);
+    QuicWorkerWaitForOperation(Connection->Worker, &CompletionEvent);
     QuicEventUninitialize(CompletionEvent);
 
 Error:
@@ -0,0 +1,689 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    A BBR (Bottleneck Bandwidth and Round-trip propagation time) style, model
+    based congestion control algorithm.
+
+    Instead of reacting to every loss, the sender continuously estimates the
+    bottleneck bandwidth (windowed max of the delivery rate) and the round
+    trip propagation time (windowed min of the RTT). Sends are paced at a gain
+    of the estimated bandwidth and the congestion window is limited to a gain
+    of the estimated bandwidth-delay product (BDP). The state machine is:
+
+        STARTUP:   Exponential growth until the bandwidth estimate plateaus.
+        DRAIN:     Drains the queue built during STARTUP.
+        PROBE_BW:  Cycles the pacing gain to probe for more bandwidth and then
+                   drain any queue the probe created.
+        PROBE_RTT: Periodically reduces the data in flight to refresh the min
+                   RTT estimate.
+
+    As in BBRv2, loss and ECN are used as signals too, but only once a round
+    trip sees more than a small fraction of loss (or any CE marks); those
+    rounds bound the data in flight (InflightHi) multiplicatively. Random loss
+    below that threshold does not reduce the sending rate.
+
+Future work:
+
+    -Idle restart handling.
+    -Ack aggregation (extra ACKed) estimation.
+
+--*/
+
+#include "precomp.h"
+#ifdef QUIC_CLOG
+#include "bbr.c.clog.h"
+#endif
+
+//
+// Gains are fixed point fractions of BBR_UNIT.
+//
+#define BBR_UNIT 256
+
+//
+// 2/ln(2): the minimum gain that allows the sending rate to double each round.
+//
+#define QUIC_BBR_STARTUP_PACING_GAIN        (BBR_UNIT * 2885 / 1000 + 1)
+#define QUIC_BBR_STARTUP_CWND_GAIN          (BBR_UNIT * 2)
+#define QUIC_BBR_DRAIN_PACING_GAIN          (BBR_UNIT * 1000 / 2885)
+#define QUIC_BBR_CWND_GAIN                  (BBR_UNIT * 2)
+
+//
+// The multiplicative reduction of InflightHi after a round with too much loss.
+//
+#define QUIC_BBR_BETA                       (BBR_UNIT * 7 / 10)
+
+#define QUIC_BBR_PROBE_BW_CYCLE_LENGTH      8
+
+//
+// The number of round trips the max bandwidth filter covers.
+//
+#define QUIC_BBR_BANDWIDTH_FILTER_ROUNDS    10
+
+//
+// STARTUP ends after this many rounds without 25% bandwidth growth.
+//
+#define QUIC_BBR_STARTUP_FULL_BW_ROUNDS     3
+
+#define QUIC_BBR_MIN_RTT_EXPIRATION         S_TO_US(10) // microsec
+#define QUIC_BBR_PROBE_RTT_DURATION         MS_TO_US(200) // microsec
+
+#define QUIC_BBR_MIN_CWND_PACKETS           4
+
+//
+// Extra packets allowed in the congestion window to absorb ACK aggregation.
+//
+#define QUIC_BBR_ACK_AGGREGATION_PACKETS    3
+
+//
+// A round trip is considered lossy if more than this percentage of its bytes
+// (and at least QUIC_BBR_LOSS_MIN_PACKETS worth) were lost.
+//
+#define QUIC_BBR_LOSS_THRESHOLD_PERCENT     2
+#define QUIC_BBR_LOSS_MIN_PACKETS           2
+
+static const uint32_t QuicBbrPacingGainCycle[QUIC_BBR_PROBE_BW_CYCLE_LENGTH] = {
+    BBR_UNIT * 5 / 4,
+    BBR_UNIT * 3 / 4,
+    BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT
+};
+
+void
+QuicConnLogBbr(
+    _In_ const QUIC_CONNECTION* const Connection
+    )
+{
+    QuicTraceLogConnVerbose(
+        BbrState,
+        Connection,
+        "BBR: State=%hhu BtlBw=%llu MinRtt=%u InflightHi=%u Cwnd=%u",
+        Connection->CongestionControl.Bbr.State,
+        Connection->CongestionControl.Bbr.MaxBandwidthFilter[0].Bandwidth,
+        Connection->CongestionControl.Bbr.MinRtt,
+        Connection->CongestionControl.Bbr.InflightHi,
+        Connection->CongestionControl.CongestionWindow);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicBbrGetBandwidth(
+    _In_ const QUIC_CONGESTION_CONTROL_BBR* Bbr
+    )
+{
+    return Bbr->MaxBandwidthFilter[0].Bandwidth;
+}
+
+//
+// Windowed max filter (Kathleen Nichols' algorithm) which tracks the best,
+// second best and third best bandwidth samples in the filter window, so that
+// the max can be aged out without keeping every sample.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrUpdateBandwidthFilter(
+    _In_ QUIC_CONGESTION_CONTROL_BBR* Bbr,
+    _In_ uint64_t Bandwidth
+    )
+{
+    QUIC_BBR_BANDWIDTH_SAMPLE* Samples = Bbr->MaxBandwidthFilter;
+    const QUIC_BBR_BANDWIDTH_SAMPLE New = { Bandwidth, Bbr->RoundTripCount };
+    const uint64_t Window = QUIC_BBR_BANDWIDTH_FILTER_ROUNDS;
+
+    if (New.Bandwidth >= Samples[0].Bandwidth ||
+        New.Round - Samples[2].Round > Window) {
+        //
+        // New max, or nothing left in the window: forget earlier samples.
+        //
+        Samples[0] = Samples[1] = Samples[2] = New;
+        return;
+    }
+
+    if (New.Bandwidth >= Samples[1].Bandwidth) {
+        Samples[2] = Samples[1] = New;
+    } else if (New.Bandwidth >= Samples[2].Bandwidth) {
+        Samples[2] = New;
+    }
+
+    const uint64_t Age = New.Round - Samples[0].Round;
+    if (Age > Window) {
+        //
+        // The best sample aged out; promote the others.
+        //
+        Samples[0] = Samples[1];
+        Samples[1] = Samples[2];
+        Samples[2] = New;
+        if (New.Round - Samples[0].Round > Window) {
+            Samples[0] = Samples[1];
+            Samples[1] = Samples[2];
+            Samples[2] = New;
+        }
+    } else if (Samples[1].Round == Samples[0].Round && Age > Window / 4) {
+        //
+        // A quarter of the window passed without a second best sample.
+        //
+        Samples[2] = Samples[1] = New;
+    } else if (Samples[2].Round == Samples[1].Round && Age > Window / 2) {
+        //
+        // Half the window passed without a third best sample.
+        //
+        Samples[2] = New;
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicBbrGetMinCongestionWindow(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    return
+        QUIC_BBR_MIN_CWND_PACKETS *
+        QuicCongestionControlGetConnection(Cc)->Paths[0].Mtu;
+}
+
+//
+// Returns the estimated bandwidth-delay product, scaled by Gain.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicBbrGetBdp(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint32_t Gain
+    )
+{
+    const QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+    const uint64_t Bandwidth = QuicBbrGetBandwidth(Bbr);
+
+    if (Bandwidth == 0 || !Bbr->MinRttValid) {
+        //
+        // No model yet, so fall back to the initial window.
+        //
+        return
+            (uint64_t)QuicCongestionControlGetConnection(Cc)->Paths[0].Mtu *
+            Cc->InitialWindowPackets * Gain / BBR_UNIT;
+    }
+
+    return Bandwidth * Bbr->MinRtt / S_TO_US(1) * Gain / BBR_UNIT;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicBbrGetTargetCongestionWindow(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint32_t Gain
+    )
+{
+    uint64_t Target =
+        QuicBbrGetBdp(Cc, Gain) +
+        QUIC_BBR_ACK_AGGREGATION_PACKETS *
+            QuicCongestionControlGetConnection(Cc)->Paths[0].Mtu;
+    if (Target > UINT32_MAX) {
+        Target = UINT32_MAX;
+    }
+    return max((uint32_t)Target, QuicBbrGetMinCongestionWindow(Cc));
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicBbrGetProbeRttCongestionWindow(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    uint64_t Window = QuicBbrGetBdp(Cc, BBR_UNIT / 2);
+    if (Window > UINT32_MAX) {
+        Window = UINT32_MAX;
+    }
+    return max((uint32_t)Window, QuicBbrGetMinCongestionWindow(Cc));
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrSetState(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ QUIC_BBR_STATE State,
+    _In_ uint32_t PacingGain,
+    _In_ uint32_t CwndGain
+    )
+{
+    Cc->Bbr.State = (uint8_t)State;
+    Cc->Bbr.PacingGain = PacingGain;
+    Cc->Bbr.CwndGain = CwndGain;
+    QuicConnLogBbr(QuicCongestionControlGetConnection(Cc));
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrEnterProbeBw(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint32_t TimeNow // microsec
+    )
+{
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    //
+    // Start at a random phase of the cycle, other than the draining one, so
+    // flows sharing a bottleneck don't probe in lock step.
+    //
+    uint8_t Index;
+    QuicRandom(sizeof(Index), &Index);
+    Index %= QUIC_BBR_PROBE_BW_CYCLE_LENGTH - 1;
+    if (Index >= 1) {
+        Index++;
+    }
+
+    Bbr->PacingCycleIndex = Index;
+    Bbr->CycleStart = TimeNow;
+    QuicBbrSetState(
+        Cc,
+        QUIC_BBR_STATE_PROBE_BW,
+        QuicBbrPacingGainCycle[Index],
+        QUIC_BBR_CWND_GAIN);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrEnterStartup(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QuicBbrSetState(
+        Cc,
+        QUIC_BBR_STATE_STARTUP,
+        QUIC_BBR_STARTUP_PACING_GAIN,
+        QUIC_BBR_STARTUP_CWND_GAIN);
+}
+
+//
+// Returns TRUE if the current PROBE_BW phase is done.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicBbrIsNextCyclePhase(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ const QUIC_ACK_EVENT* AckEvent,
+    _In_ BOOLEAN HighLoss
+    )
+{
+    const QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+    const BOOLEAN IsFullLength =
+        QuicTimeDiff32(Bbr->CycleStart, AckEvent->TimeNow) > Bbr->MinRtt;
+    const uint64_t PriorInFlight =
+        (uint64_t)Cc->BytesInFlight + AckEvent->NumRetransmittableBytes;
+
+    if (Bbr->PacingGain == BBR_UNIT) {
+        return IsFullLength;
+    }
+
+    if (Bbr->PacingGain > BBR_UNIT) {
+        //
+        // Keep probing until the extra data actually made it into the
+        // network (or we can't put more in flight), unless it caused loss.
+        //
+        uint64_t Target = QuicBbrGetBdp(Cc, Bbr->PacingGain);
+        if (Target > Bbr->InflightHi) {
+            Target = Bbr->InflightHi;
+        }
+        return IsFullLength && (HighLoss || PriorInFlight >= Target);
+    }
+
+    //
+    // Stop draining early once the queue from the probe is gone.
+    //
+    return IsFullLength || PriorInFlight <= QuicBbrGetBdp(Cc, BBR_UNIT);
+}
+
+//
+// Multiplicatively reduces the bound on the data in flight after congestion.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrReduceInflightHi(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    uint64_t InflightHi = min(Cc->CongestionWindow, Bbr->InflightHi);
+    InflightHi = InflightHi * QUIC_BBR_BETA / BBR_UNIT;
+    Bbr->InflightHi = max((uint32_t)InflightHi, QuicBbrGetMinCongestionWindow(Cc));
+
+    if (!Bbr->BtlBwFound) {
+        //
+        // The pipe is full if it is already dropping packets.
+        //
+        Bbr->BtlBwFound = TRUE;
+    }
+}
+
+//
+// Called at the end of a round trip which saw too much loss or CE marks.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrOnHighLoss(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    QuicTraceEvent(
+        ConnCongestion,
+        "[conn][%p] Congestion event",
+        Connection);
+    Connection->Stats.Send.CongestionCount++;
+    if (Bbr->EcnCeInRound) {
+        Connection->Stats.Send.EcnCongestionCount++;
+    }
+
+    QuicBbrReduceInflightHi(Cc);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrInitialize(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QuicZeroMemory(&Cc->Bbr, sizeof(Cc->Bbr));
+    Cc->SlowStartThreshold = UINT32_MAX;
+    Cc->CongestionWindow = Connection->Paths[0].Mtu * Cc->InitialWindowPackets;
+    Cc->BytesInFlightMax = Cc->CongestionWindow / 2;
+    Cc->Bbr.InflightHi = UINT32_MAX;
+    QuicConnLogOutFlowStats(Connection);
+    QuicBbrEnterStartup(Cc);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicBbrGetSendAllowance(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t TimeSinceLastSend, // microsec
+    _In_ BOOLEAN TimeSinceLastSendValid
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    const QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    if (Cc->BytesInFlight >= Cc->CongestionWindow) {
+        //
+        // We are CC blocked, so we can't send anything.
+        //
+        return 0;
+    }
+
+    if (!Connection->Settings.PacingEnabled || !Connection->Paths[0].GotFirstRttSample) {
+        //
+        // Pacing is disabled or we don't have an RTT sample yet, so just send
+        // everything we can.
+        //
+        return Cc->CongestionWindow - Cc->BytesInFlight;
+    }
+
+    //
+    // Pace at PacingGain times the estimated bandwidth, expressed as the
+    // number of bytes that rate delivers over one smoothed RTT. Until there
+    // is a bandwidth estimate, pace the window at the same gain.
+    //
+    const uint64_t Bandwidth = QuicBbrGetBandwidth(Bbr);
+    uint64_t EstimatedWnd;
+    if (Bandwidth == 0) {
+        EstimatedWnd = (uint64_t)Cc->CongestionWindow * Bbr->PacingGain / BBR_UNIT;
+    } else {
+        EstimatedWnd =
+            Bandwidth * Bbr->PacingGain / BBR_UNIT *
+            Connection->Paths[0].SmoothedRtt / S_TO_US(1);
+    }
+
+    return
+        QuicCongestionControlGetPacedAllowance(
+            Cc, EstimatedWnd, TimeSinceLastSend, TimeSinceLastSendValid);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrOnDataAcknowledged(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ const QUIC_ACK_EVENT* AckEvent
+    )
+{
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+    const uint32_t TimeNow = AckEvent->TimeNow;
+    BOOLEAN RoundStart = FALSE;
+    BOOLEAN HighLoss = FALSE;
+
+    Bbr->RoundDeliveredBytes += AckEvent->NumRetransmittableBytes;
+
+    //
+    // Round trip accounting and the loss/ECN signal of the finished round.
+    //
+    if (AckEvent->LargestAck > Bbr->EndOfRoundTrip) {
+        RoundStart = TRUE;
+        Bbr->RoundTripCount++;
+        Bbr->EndOfRoundTrip = AckEvent->LargestSentPacketNumber;
+
+        const uint64_t RoundBytes =
+            (uint64_t)Bbr->RoundLostBytes + Bbr->RoundDeliveredBytes;
+        HighLoss =
+            Bbr->EcnCeInRound ||
+            (Bbr->RoundLostBytes >=
+                QUIC_BBR_LOSS_MIN_PACKETS * QuicCongestionControlGetConnection(Cc)->Paths[0].Mtu &&
+             (uint64_t)Bbr->RoundLostBytes * 100 > RoundBytes * QUIC_BBR_LOSS_THRESHOLD_PERCENT);
+        if (HighLoss) {
+            QuicBbrOnHighLoss(Cc);
+        }
+        Bbr->RoundLostBytes = 0;
+        Bbr->RoundDeliveredBytes = 0;
+        Bbr->EcnCeInRound = FALSE;
+    }
+
+    //
+    // Update the model: the windowed max bandwidth and windowed min RTT. App
+    // limited samples only count if they increase the estimate.
+    //
+    if (AckEvent->DeliveryRate != 0 &&
+        (!AckEvent->IsAppLimited ||
+         AckEvent->DeliveryRate >= QuicBbrGetBandwidth(Bbr))) {
+        QuicBbrUpdateBandwidthFilter(Bbr, AckEvent->DeliveryRate);
+    }
+
+    const BOOLEAN MinRttExpired =
+        Bbr->MinRttValid &&
+        QuicTimeDiff32(Bbr->MinRttTimestamp, TimeNow) > QUIC_BBR_MIN_RTT_EXPIRATION;
+    if (AckEvent->MinRttValid &&
+        (!Bbr->MinRttValid || AckEvent->MinRtt <= Bbr->MinRtt || MinRttExpired)) {
+        Bbr->MinRtt = AckEvent->MinRtt;
+        Bbr->MinRttTimestamp = TimeNow;
+        Bbr->MinRttValid = TRUE;
+    }
+
+    //
+    // STARTUP is done once the bandwidth stops growing by at least 25% a
+    // round for a few rounds.
+    //
+    if (!Bbr->BtlBwFound && RoundStart && !AckEvent->IsAppLimited) {
+        const uint64_t Bandwidth = QuicBbrGetBandwidth(Bbr);
+        if (Bandwidth >= Bbr->FullBandwidth * 5 / 4) {
+            Bbr->FullBandwidth = Bandwidth;
+            Bbr->FullBandwidthCount = 0;
+        } else if (++Bbr->FullBandwidthCount >= QUIC_BBR_STARTUP_FULL_BW_ROUNDS) {
+            Bbr->BtlBwFound = TRUE;
+        }
+    }
+
+    //
+    // State machine.
+    //
+    if (Bbr->State == QUIC_BBR_STATE_STARTUP && Bbr->BtlBwFound) {
+        QuicBbrSetState(
+            Cc,
+            QUIC_BBR_STATE_DRAIN,
+            QUIC_BBR_DRAIN_PACING_GAIN,
+            QUIC_BBR_STARTUP_CWND_GAIN);
+    }
+
+    if (Bbr->State == QUIC_BBR_STATE_DRAIN &&
+        Cc->BytesInFlight <= QuicBbrGetBdp(Cc, BBR_UNIT)) {
+        QuicBbrEnterProbeBw(Cc, TimeNow);
+
+    } else if (Bbr->State == QUIC_BBR_STATE_PROBE_BW &&
+        QuicBbrIsNextCyclePhase(Cc, AckEvent, HighLoss)) {
+        Bbr->PacingCycleIndex =
+            (Bbr->PacingCycleIndex + 1) % QUIC_BBR_PROBE_BW_CYCLE_LENGTH;
+        Bbr->PacingGain = QuicBbrPacingGainCycle[Bbr->PacingCycleIndex];
+        Bbr->CycleStart = TimeNow;
+    }
+
+    if (Bbr->State != QUIC_BBR_STATE_PROBE_RTT && MinRttExpired) {
+        Bbr->PriorCongestionWindow = Cc->CongestionWindow;
+        Bbr->ProbeRttDoneTimeValid = FALSE;
+        QuicBbrSetState(Cc, QUIC_BBR_STATE_PROBE_RTT, BBR_UNIT, BBR_UNIT);
+    }
+
+    if (Bbr->State == QUIC_BBR_STATE_PROBE_RTT) {
+        if (!Bbr->ProbeRttDoneTimeValid) {
+            //
+            // Wait for the data in flight to drop to the probe window before
+            // starting the clock.
+            //
+            if (Cc->BytesInFlight <= QuicBbrGetProbeRttCongestionWindow(Cc)) {
+                Bbr->ProbeRttDoneTime = TimeNow + QUIC_BBR_PROBE_RTT_DURATION;
+                Bbr->ProbeRttDoneTimeValid = TRUE;
+                Bbr->ProbeRttRoundDone = FALSE;
+                Bbr->ProbeRttRoundEnd = AckEvent->LargestSentPacketNumber;
+            }
+        } else {
+            if (AckEvent->LargestAck > Bbr->ProbeRttRoundEnd) {
+                Bbr->ProbeRttRoundDone = TRUE;
+            }
+            if (Bbr->ProbeRttRoundDone &&
+                QuicTimeAtOrBefore32(Bbr->ProbeRttDoneTime, TimeNow)) {
+                Bbr->MinRttTimestamp = TimeNow;
+                Cc->CongestionWindow =
+                    max(Cc->CongestionWindow, Bbr->PriorCongestionWindow);
+                if (Bbr->BtlBwFound) {
+                    QuicBbrEnterProbeBw(Cc, TimeNow);
+                } else {
+                    QuicBbrEnterStartup(Cc);
+                }
+            }
+        }
+    }
+
+    //
+    // Update the congestion window towards CwndGain times the BDP. While the
+    // pipe isn't known to be full, keep growing with every ACK.
+    //
+    const uint32_t TargetWindow = QuicBbrGetTargetCongestionWindow(Cc, Bbr->CwndGain);
+    const uint32_t MinWindow = QuicBbrGetMinCongestionWindow(Cc);
+    if (Bbr->BtlBwFound) {
+        Cc->CongestionWindow =
+            min(Cc->CongestionWindow + AckEvent->NumRetransmittableBytes, TargetWindow);
+    } else if (Cc->CongestionWindow < TargetWindow) {
+        Cc->CongestionWindow += AckEvent->NumRetransmittableBytes;
+    }
+
+    if (Bbr->InflightHi != UINT32_MAX) {
+        if (Bbr->PacingGain > BBR_UNIT && !HighLoss &&
+            Cc->BytesInFlight + AckEvent->NumRetransmittableBytes >= Bbr->InflightHi) {
+            //
+            // Probing up and limited by the bound without excessive loss, so
+            // grow the bound as in slow start.
+            //
+            Bbr->InflightHi += AckEvent->NumRetransmittableBytes;
+        }
+        if (Cc->CongestionWindow > Bbr->InflightHi) {
+            Cc->CongestionWindow = Bbr->InflightHi;
+        }
+    }
+
+    if (Bbr->State == QUIC_BBR_STATE_PROBE_RTT) {
+        Cc->CongestionWindow =
+            min(Cc->CongestionWindow, QuicBbrGetProbeRttCongestionWindow(Cc));
+    }
+
+    //
+    // Limit the growth of the window based on the number of bytes we
+    // actually manage to put on the wire, as CUBIC does.
+    //
+    if (Cc->CongestionWindow > 2 * Cc->BytesInFlightMax) {
+        Cc->CongestionWindow = 2 * Cc->BytesInFlightMax;
+    }
+
+    if (Cc->CongestionWindow < MinWindow) {
+        Cc->CongestionWindow = MinWindow;
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrOnDataLost(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t LargestPacketNumberLost,
+    _In_ uint64_t LargestPacketNumberSent,
+    _In_ uint32_t NumRetransmittableBytes,
+    _In_ BOOLEAN PersistentCongestion
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    UNREFERENCED_PARAMETER(LargestPacketNumberLost);
+    UNREFERENCED_PARAMETER(LargestPacketNumberSent);
+
+    //
+    // Loss only feeds the per round loss rate; the reaction (if any) happens
+    // at the end of the round.
+    //
+    Cc->Bbr.RoundLostBytes += NumRetransmittableBytes;
+
+    if (PersistentCongestion) {
+        QuicTraceEvent(
+            ConnPersistentCongestion,
+            "[conn][%p] Persistent congestion event",
+            Connection);
+        Connection->Stats.Send.PersistentCongestionCount++;
+
+        //
+        // As CUBIC does, bound the window to a fraction of what it was and
+        // restart from a minimal window. The window then grows back by the
+        // bytes acknowledged, but never past the new bound, and leaving
+        // PROBE_RTT doesn't restore the previous window either.
+        //
+        QuicBbrReduceInflightHi(Cc);
+        Cc->CongestionWindow =
+            Connection->Paths[0].Mtu * QUIC_PERSISTENT_CONGESTION_WINDOW_PACKETS;
+        Cc->Bbr.PriorCongestionWindow = Cc->CongestionWindow;
+    }
+
+    QuicConnLogBbr(Connection);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrOnEcn(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t LargestPacketNumberAcked,
+    _In_ uint64_t LargestPacketNumberSent
+    )
+{
+    UNREFERENCED_PARAMETER(LargestPacketNumberAcked);
+    UNREFERENCED_PARAMETER(LargestPacketNumberSent);
+
+    //
+    // Like loss, CE marks are handled at the end of the round.
+    //
+    Cc->Bbr.EcnCeInRound = TRUE;
+}
+
+const QUIC_CONGESTION_CONTROL_DISPATCH QuicCongestionControlBbrDispatch = {
+    "BBR",
+    QuicBbrInitialize,
+    QuicBbrInitialize,
+    QuicBbrGetSendAllowance,
+    QuicBbrOnDataAcknowledged,
+    QuicBbrOnDataLost,
+    QuicBbrOnEcn
+};
@@ -0,0 +1,112 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+--*/
+
+typedef enum QUIC_BBR_STATE {
+    QUIC_BBR_STATE_STARTUP,
+    QUIC_BBR_STATE_DRAIN,
+    QUIC_BBR_STATE_PROBE_BW,
+    QUIC_BBR_STATE_PROBE_RTT
+} QUIC_BBR_STATE;
+
+//
+// A bandwidth sample and the round trip it was taken in.
+//
+typedef struct QUIC_BBR_BANDWIDTH_SAMPLE {
+
+    uint64_t Bandwidth; // bytes per second
+    uint64_t Round;
+
+} QUIC_BBR_BANDWIDTH_SAMPLE;
+
+typedef struct QUIC_CONGESTION_CONTROL_BBR {
+
+    //
+    // TRUE once the bandwidth estimate stopped growing during STARTUP (or
+    // STARTUP saw too much loss), i.e. the pipe is considered full.
+    //
+    BOOLEAN BtlBwFound : 1;
+
+    //
+    // TRUE if MinRtt holds a measurement.
+    //
+    BOOLEAN MinRttValid : 1;
+
+    //
+    // TRUE while waiting for the PROBE_RTT minimum duration to elapse.
+    //
+    BOOLEAN ProbeRttDoneTimeValid : 1;
+
+    //
+    // TRUE once a full round trip has passed in PROBE_RTT.
+    //
+    BOOLEAN ProbeRttRoundDone : 1;
+
+    //
+    // TRUE if the peer reported CE marks during the current round trip.
+    //
+    BOOLEAN EcnCeInRound : 1;
+
+    uint8_t State; // QUIC_BBR_STATE
+
+    //
+    // Current position in the PROBE_BW pacing gain cycle.
+    //
+    uint8_t PacingCycleIndex;
+
+    //
+    // Number of consecutive rounds without significant bandwidth growth.
+    //
+    uint8_t FullBandwidthCount;
+
+    //
+    // Gains applied to the bandwidth estimate and BDP, in BBR_UNIT fractions.
+    //
+    uint32_t PacingGain;
+    uint32_t CwndGain;
+
+    //
+    // Round trip counting: a round ends when a packet sent after the start of
+    // the round is acknowledged.
+    //
+    uint64_t RoundTripCount;
+    uint64_t EndOfRoundTrip; // packet number
+
+    //
+    // Windowed max filter of the delivery rate over the last few round trips.
+    //
+    QUIC_BBR_BANDWIDTH_SAMPLE MaxBandwidthFilter[3];
+
+    //
+    // The bandwidth at the last significant growth seen during STARTUP.
+    //
+    uint64_t FullBandwidth; // bytes per second
+
+    uint32_t MinRtt; // microsec
+    uint32_t MinRttTimestamp; // microsec
+
+    uint32_t CycleStart; // microsec
+    uint32_t ProbeRttDoneTime; // microsec
+    uint64_t ProbeRttRoundEnd;
+
+    //
+    // Upper bound on the data in flight, learned from rounds which saw
+    // excessive loss or ECN marks. UINT32_MAX if not yet bounded.
+    //
+    uint32_t InflightHi; // bytes
+
+    //
+    // The congestion window saved when entering PROBE_RTT.
+    //
+    uint32_t PriorCongestionWindow; // bytes
+
+    //
+    // Bytes acknowledged and lost in the current round trip.
+    //
+    uint32_t RoundDeliveredBytes;
+    uint32_t RoundLostBytes;
+
+} QUIC_CONGESTION_CONTROL_BBR;
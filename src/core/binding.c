@@ -927,11 +927,12 @@ QuicBindingProcessStatelessOperation(
             QuicCopyMemory(Iv, NewDestCid, MsQuicLib.CidTotalLength);
         }
 
-        QuicDispatchLockAcquire(&MsQuicLib.StatelessRetryKeysLock);
+        QUIC_LIBRARY_PP* PerProc = QuicLibraryGetPerProc();
+        QuicDispatchLockAcquire(&PerProc->StatelessRetryKeysLock);
 
-        QUIC_KEY* StatelessRetryKey = QuicLibraryGetCurrentStatelessRetryKey();
+        QUIC_KEY* StatelessRetryKey = QuicLibraryGetCurrentStatelessRetryKey(PerProc);
         if (StatelessRetryKey == NULL) {
-            QuicDispatchLockRelease(&MsQuicLib.StatelessRetryKeysLock);
+            QuicDispatchLockRelease(&PerProc->StatelessRetryKeysLock);
             goto Exit;
         }
 
@@ -942,7 +943,7 @@ QuicBindingProcessStatelessOperation(
                 sizeof(Token.Authenticated), (uint8_t*) &Token.Authenticated,
                 sizeof(Token.Encrypted) + sizeof(Token.EncryptionTag), (uint8_t*)&(Token.Encrypted));
 
-        QuicDispatchLockRelease(&MsQuicLib.StatelessRetryKeysLock);
+        QuicDispatchLockRelease(&PerProc->StatelessRetryKeysLock);
         if (QUIC_FAILED(Status)) {
             goto Exit;
         }
@@ -144,6 +144,30 @@ typedef struct QUIC_RECV_PACKET {
     //
     BOOLEAN HasNonProbingFrame : 1;
 
+    //
+    // Flag indicating stream data in the datagram was lent to a stream (see
+    // QUIC_PARAM_CONN_RECV_BUFFER_LENDING). The datagram isn't returned to the
+    // datapath until the stream is done with it.
+    //
+    BOOLEAN LentToStream : 1;
+
+    //
+    // Flag indicating the connection was done with the datagram while it was
+    // still lent to a stream, so the stream must return it.
+    //
+    BOOLEAN ReleasedWhileLent : 1;
+
+    //
+    // The stream data lent to the stream, not yet consumed by the app.
+    //
+    uint16_t LentLength;
+    const uint8_t* LentBuffer;
+
+    //
+    // The next datagram lent to the same stream.
+    //
+    struct QUIC_RECV_DATAGRAM* LentNext;
+
 } QUIC_RECV_PACKET;
 
 typedef enum QUIC_BINDING_LOOKUP_TYPE {
@@ -343,7 +367,8 @@ QuicBindingAddSourceConnectionID(
     );
 
 //
-// Removes a single source CID from the binding's lookup table.
+// Removes a single source CID from the binding's lookup table and the
+// connection's list. The binding takes ownership of (and frees) the CID.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
@@ -463,13 +488,15 @@ QuicRetryTokenDecrypt(
         QuicCopyMemory(Iv, Packet->DestCid, MsQuicLib.CidTotalLength);
     }
 
-    QuicDispatchLockAcquire(&MsQuicLib.StatelessRetryKeysLock);
+    QUIC_LIBRARY_PP* PerProc = QuicLibraryGetPerProc();
+    QuicDispatchLockAcquire(&PerProc->StatelessRetryKeysLock);
 
     QUIC_KEY* StatelessRetryKey =
         QuicLibraryGetStatelessRetryKeyForTimestamp(
+            PerProc,
             Token->Authenticated.Timestamp);
     if (StatelessRetryKey == NULL) {
-        QuicDispatchLockRelease(&MsQuicLib.StatelessRetryKeysLock);
+        QuicDispatchLockRelease(&PerProc->StatelessRetryKeysLock);
         return FALSE;
     }
 
@@ -482,6 +509,6 @@ QuicRetryTokenDecrypt(
             sizeof(Token->Encrypted) + sizeof(Token->EncryptionTag),
             (uint8_t*)&Token->Encrypted);
 
-    QuicDispatchLockRelease(&MsQuicLib.StatelessRetryKeysLock);
+    QuicDispatchLockRelease(&PerProc->StatelessRetryKeysLock);
     return QUIC_SUCCEEDED(Status);
 }
@@ -142,9 +142,21 @@ typedef struct QUIC_CID_QUIC_LIST_ENTRY {
 
 } QUIC_CID_QUIC_LIST_ENTRY;
 
+//
+// An entry in a binding's lookup tables. Readers walk the tables without any
+// locks, so an entry has two links: one used by the table readers currently
+// see, and a spare one used to build a replacement table when it is resized.
+//
+typedef struct QUIC_LOOKUP_ENTRY {
+
+    struct QUIC_LOOKUP_ENTRY* Next[2];
+    uint32_t Hash;
+
+} QUIC_LOOKUP_ENTRY;
+
 typedef struct QUIC_CID_HASH_ENTRY {
 
-    QUIC_HASHTABLE_ENTRY Entry;
+    QUIC_LOOKUP_ENTRY Entry;
     QUIC_SINGLE_LIST_ENTRY Link;
     QUIC_CONNECTION* Connection;
     QUIC_CID CID;
@@ -10,7 +10,11 @@
 //
 typedef struct QUIC_CONFIGURATION {
 
+#ifdef QUIC_CORE_UNIT_TEST
+    struct QUIC_HANDLE _;
+#else
     struct QUIC_HANDLE;
+#endif
 
     //
     // Parent registration.
@@ -3,32 +3,112 @@
     Copyright (c) Microsoft Corporation.
     Licensed under the MIT License.
 
+Abstract:
+
+    The congestion control interface. The generic layer tracks bytes in flight
+    and the blocked state, while the algorithm selected via
+    QUIC_SETTINGS.CongestionControlAlgorithm adjusts the congestion window and
+    paces sends through the function table in QUIC_CONGESTION_CONTROL_DISPATCH.
+
 --*/
 
-typedef struct QUIC_CONGESTION_CONTROL {
+typedef struct QUIC_CONGESTION_CONTROL QUIC_CONGESTION_CONTROL;
+
+//
+// Information about a set of packets acknowledged by a single ACK frame.
+//
+typedef struct QUIC_ACK_EVENT {
+
+    uint32_t TimeNow; // microsec
+
+    uint64_t LargestAck;
+    uint64_t LargestSentPacketNumber;
+
+    //
+    // Number of retransmittable bytes newly acknowledged.
+    //
+    uint32_t NumRetransmittableBytes;
+
+    uint32_t SmoothedRtt; // microsec
+
+    //
+    // The smallest RTT sample taken from this ACK. Only valid if MinRttValid.
+    //
+    uint32_t MinRtt; // microsec
+    BOOLEAN MinRttValid : 1;
+
+    //
+    // TRUE if the delivery rate sample was taken while the sender did not
+    // have enough data to fill the congestion window, in which case it is
+    // only a lower bound on the available bandwidth.
+    //
+    BOOLEAN IsAppLimited : 1;
 
     //
-    // TRUE if we have had at least one congestion event.
-    // If TRUE, RecoverySentPacketNumber is valid.
+    // The delivery rate measured over the flight of the most recently sent
+    // packet acknowledged. Zero if no sample could be taken.
     //
-    BOOLEAN HasHadCongestionEvent : 1;
+    uint64_t DeliveryRate; // bytes per second
+
+} QUIC_ACK_EVENT;
+
+//
+// Algorithm specific functions.
+//
+typedef struct QUIC_CONGESTION_CONTROL_DISPATCH {
+
+    const char* Name;
+
+    void (*Initialize)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc
+        );
+
+    void (*Reset)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc
+        );
+
+    uint32_t (*GetSendAllowance)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc,
+        _In_ uint64_t TimeSinceLastSend, // microsec
+        _In_ BOOLEAN TimeSinceLastSendValid
+        );
 
     //
-    // This flag indicates a congestion event occurred and CC is attempting
-    // to recover from it.
+    // Called after BytesInFlight has been reduced by the acknowledged bytes.
     //
-    BOOLEAN IsInRecovery : 1;
+    void (*OnDataAcknowledged)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc,
+        _In_ const QUIC_ACK_EVENT* AckEvent
+        );
 
     //
-    // This flag indicates a persistent congestion event occurred and CC is
-    // attempting to recover from it.
+    // Called before BytesInFlight is reduced by the lost bytes.
     //
-    BOOLEAN IsInPersistentCongestion : 1;
+    void (*OnDataLost)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc,
+        _In_ uint64_t LargestPacketNumberLost,
+        _In_ uint64_t LargestPacketNumberSent,
+        _In_ uint32_t NumRetransmittableBytes,
+        _In_ BOOLEAN PersistentCongestion
+        );
+
+    void (*OnEcn)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc,
+        _In_ uint64_t LargestPacketNumberAcked,
+        _In_ uint64_t LargestPacketNumberSent
+        );
+
+} QUIC_CONGESTION_CONTROL_DISPATCH;
+
+extern const QUIC_CONGESTION_CONTROL_DISPATCH QuicCongestionControlCubicDispatch;
+extern const QUIC_CONGESTION_CONTROL_DISPATCH QuicCongestionControlBbrDispatch;
+
+typedef struct QUIC_CONGESTION_CONTROL {
 
     //
-    // TRUE if there has been at least one ACK.
+    // The functions of the algorithm in use.
     //
-    BOOLEAN TimeOfLastAckValid : 1;
+    const QUIC_CONGESTION_CONTROL_DISPATCH* Dispatch;
 
     //
     // The size of the initial congestion window, in packets.
@@ -41,6 +121,10 @@ typedef struct QUIC_CONGESTION_CONTROL {
     uint32_t SendIdleTimeoutMs;
 
     uint32_t CongestionWindow; // bytes
+
+    //
+    // Only maintained by loss based algorithms; UINT32_MAX otherwise.
+    //
     uint32_t SlowStartThreshold; // bytes
 
     //
@@ -62,18 +146,25 @@ typedef struct QUIC_CONGESTION_CONTROL {
     //
     uint8_t Exemptions;
 
-    uint64_t TimeOfLastAck; // millisec
-    uint64_t TimeOfCongAvoidStart; // millisec
-    uint32_t KCubic; // millisec
-    uint32_t WindowMax; // bytes
-    uint32_t WindowLastMax; // bytes
+    //
+    // When the current send allowance is paced with departure times (see
+    // TxTimePacingEnabled), the number of bytes to spread evenly over one
+    // smoothed RTT. Zero otherwise.
+    //
+    uint64_t PacingWindow;
+
+    //
+    // The departure time (QuicTimeUs64) of the next paced datagram.
+    //
+    uint64_t NextDepartureTime;
 
     //
-    // This variable tracks the largest packet that was outstanding at the time
-    // the last congestion event occurred. An ACK for any packet number greater
-    // than this indicates recovery is over.
+    // Algorithm specific state.
     //
-    uint64_t RecoverySentPacketNumber;
+    union {
+        QUIC_CONGESTION_CONTROL_CUBIC Cubic;
+        QUIC_CONGESTION_CONTROL_BBR Bbr;
+    };
 
 } QUIC_CONGESTION_CONTROL;
 
@@ -153,10 +244,7 @@ _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicCongestionControlOnDataAcknowledged(
     _In_ QUIC_CONGESTION_CONTROL* Cc,
-    _In_ uint64_t TimeNow, // millisec
-    _In_ uint64_t LargestPacketNumberAcked,
-    _In_ uint32_t NumRetransmittableBytes,
-    _In_ uint32_t SmoothedRtt
+    _In_ const QUIC_ACK_EVENT* AckEvent
     );
 
 //
@@ -170,4 +258,42 @@ QuicCongestionControlOnDataLost(
     _In_ uint64_t LargestPacketNumberSent,
     _In_ uint32_t NumRetransmittableBytes,
     _In_ BOOLEAN PersistentCongestion
+    );
+
+//
+// Called when the peer reports an increase in CE marked packets.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCongestionControlOnEcn(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t LargestPacketNumberAcked,
+    _In_ uint64_t LargestPacketNumberSent
+    );
+
+//
+// Returns the size of the next pacing chunk: the part of EstimatedWnd (the
+// number of bytes the algorithm expects to send over the next RTT) that
+// corresponds to the time since the last send. When pacing with departure
+// times, it is instead the part that departs within the next pacing interval.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicCongestionControlGetPacedAllowance(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t EstimatedWnd,
+    _In_ uint64_t TimeSinceLastSend, // microsec
+    _In_ BOOLEAN TimeSinceLastSendValid
+    );
+
+//
+// Returns the departure time (QuicTimeUs64) for the next datagram of the
+// current paced allowance, and advances the pacing schedule by its length.
+// Only valid if PacingWindow is nonzero.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicCongestionControlGetDepartureTime(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint16_t DatagramLength
     );
\ No newline at end of file
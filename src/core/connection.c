@@ -118,7 +118,13 @@ QuicConnAlloc(
     Connection->SourceCidLimit = QUIC_ACTIVE_CONNECTION_ID_LIMIT;
     Connection->AckDelayExponent = QUIC_ACK_DELAY_EXPONENT;
     Connection->PeerTransportParams.AckDelayExponent = QUIC_TP_ACK_DELAY_EXPONENT_DEFAULT;
+    Connection->AckFrequency.AckElicitingThreshold = QUIC_MIN_ACK_SEND_NUMBER - 1;
+    Connection->AckFrequency.ReorderingThreshold = 1;
+    Connection->AckFrequency.PeerAckElicitingThreshold = QUIC_MIN_ACK_SEND_NUMBER - 1;
+    Connection->AckFrequency.PeerReorderingThreshold = 1;
     Connection->ReceiveQueueTail = &Connection->ReceiveQueue;
+    Connection->InlineApiSendStreamsTail = &Connection->InlineApiSendStreams;
+    Connection->InlineApiShutdownStreamsTail = &Connection->InlineApiShutdownStreams;
     Connection->Settings = MsQuicLib.Settings;
     Connection->Settings.IsSetFlags = 0; // Just grab the global values, not IsSet flags.
     QuicDispatchLockInitialize(&Connection->ReceiveQueueLock);
@@ -297,6 +303,8 @@ QuicConnFree(
     }
     QUIC_TEL_ASSERT(Connection->SourceCids.Next == NULL);
     QUIC_TEL_ASSERT(QuicListIsEmpty(&Connection->Streams.ClosedStreams));
+    QUIC_TEL_ASSERT(Connection->InlineApiSendStreams == NULL);
+    QUIC_TEL_ASSERT(Connection->InlineApiShutdownStreams == NULL);
     QuicLossDetectionUninitialize(&Connection->LossDetection);
     QuicSendUninitialize(&Connection->Send);
     //
@@ -670,6 +678,10 @@ QuicConnIndicateEvent(
     )
 {
     QUIC_STATUS Status;
+    //
+    // Events are never indicated from the TLS pool.
+    //
+    QUIC_DBG_ASSERT(Connection->Crypto.TlsOffloadState != QUIC_TLS_OFFLOAD_RUNNING);
     if (!Connection->State.HandleClosed) {
         QUIC_CONN_VERIFY(Connection, Connection->State.HandleShutdown || Connection->ClientCallbackHandler != NULL || !Connection->State.ExternalOwner);
         if (Connection->ClientCallbackHandler == NULL) {
@@ -733,6 +745,67 @@ QuicConnQueueHighestPriorityOper(
     }
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnQueueInlineApiSends(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_STREAM* Streams,
+    _In_ QUIC_STREAM** StreamsTail
+    )
+{
+    QUIC_DBG_ASSERT(QuicConnIsOnWorkerThread(Connection));
+    *Connection->InlineApiSendStreamsTail = Streams;
+    Connection->InlineApiSendStreamsTail = StreamsTail;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnQueueInlineApiShutdown(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    QUIC_DBG_ASSERT(QuicConnIsOnWorkerThread(Connection));
+    QUIC_DBG_ASSERT(Stream->InlineShutdownFlags != 0);
+    Stream->InlineShutdownNext = NULL;
+    *Connection->InlineApiShutdownStreamsTail = Stream;
+    Connection->InlineApiShutdownStreamsTail = &Stream->InlineShutdownNext;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnFlushInlineApiCalls(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    //
+    // Processing may indicate events to the app, which may queue more calls.
+    // Shutdowns go first: a send queued before a shutdown on the same stream
+    // either carries the FIN itself or is aborted either way, while one queued
+    // after it must not go out.
+    //
+    while (Connection->InlineApiShutdownStreams != NULL ||
+           Connection->InlineApiSendStreams != NULL) {
+
+        QUIC_STREAM* Streams = Connection->InlineApiShutdownStreams;
+        Connection->InlineApiShutdownStreams = NULL;
+        Connection->InlineApiShutdownStreamsTail = &Connection->InlineApiShutdownStreams;
+        while (Streams != NULL) {
+            QUIC_STREAM* Stream = Streams;
+            Streams = Stream->InlineShutdownNext;
+            QUIC_STREAM_SHUTDOWN_FLAGS Flags = Stream->InlineShutdownFlags;
+            Stream->InlineShutdownFlags = 0;
+            QuicStreamShutdown(Stream, Flags, Stream->InlineShutdownErrorCode);
+            QuicStreamRelease(Stream, QUIC_STREAM_REF_OPERATION);
+        }
+
+        Streams = Connection->InlineApiSendStreams;
+        Connection->InlineApiSendStreams = NULL;
+        Connection->InlineApiSendStreamsTail = &Connection->InlineApiSendStreams;
+        QuicStreamSendFlushBatch(Streams);
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicConnUpdateRtt(
@@ -788,6 +861,89 @@ QuicConnUpdateRtt(
     }
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnUpdatePeerAckFrequency(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    if (!Connection->Settings.AckFrequencyEnabled ||
+        !(Connection->PeerTransportParams.Flags & QUIC_TP_FLAG_MIN_ACK_DELAY) ||
+        !Connection->State.Connected ||
+        Connection->State.ClosedLocally ||
+        Connection->State.ClosedRemotely) {
+        return;
+    }
+
+    const QUIC_PATH* Path = &Connection->Paths[0];
+    if (!Path->GotFirstRttSample) {
+        return;
+    }
+
+    //
+    // Ask for an ACK a few times per congestion window, instead of for every
+    // other packet. This cuts down on the ACK processing (on both sides) for
+    // high throughput connections, while still giving congestion control
+    // regular feedback. The peer's default is used for small windows.
+    //
+    const uint32_t PacketsPerAck =
+        (Connection->CongestionControl.CongestionWindow / Path->Mtu) /
+        QUIC_ACK_FREQUENCY_ACKS_PER_WINDOW;
+    uint16_t AckElicitingThreshold = QUIC_MIN_ACK_SEND_NUMBER - 1;
+    if (PacketsPerAck > QUIC_MAX_ACK_ELICITING_THRESHOLD) {
+        AckElicitingThreshold = QUIC_MAX_ACK_ELICITING_THRESHOLD;
+    } else if (PacketsPerAck > QUIC_MIN_ACK_SEND_NUMBER) {
+        AckElicitingThreshold = (uint16_t)(PacketsPerAck - 1);
+    }
+
+    //
+    // Don't let the peer sit on the ACKs for more than a fraction of the RTT,
+    // bounded by what the peer can do and what it advertised (which our PTO
+    // calculation already accounts for).
+    //
+    uint64_t MaxAckDelayUs = Path->SmoothedRtt / 4;
+    if (MaxAckDelayUs < Connection->PeerTransportParams.MinAckDelay) {
+        MaxAckDelayUs = Connection->PeerTransportParams.MinAckDelay;
+    }
+    if (MaxAckDelayUs > MS_TO_US(Connection->PeerTransportParams.MaxAckDelay)) {
+        MaxAckDelayUs = MS_TO_US(Connection->PeerTransportParams.MaxAckDelay);
+    }
+
+    //
+    // Only need to hear about reordering as soon as it would be considered
+    // loss.
+    //
+    const uint8_t ReorderingThreshold = QUIC_PACKET_REORDER_THRESHOLD;
+
+    //
+    // RTT jitter shouldn't cause a stream of updates, so ignore small changes
+    // to the delay.
+    //
+    const uint32_t PrevMaxAckDelayUs = Connection->AckFrequency.PeerMaxAckDelayUs;
+    if (AckElicitingThreshold == Connection->AckFrequency.PeerAckElicitingThreshold &&
+        ReorderingThreshold == Connection->AckFrequency.PeerReorderingThreshold &&
+        MaxAckDelayUs + PrevMaxAckDelayUs / 4 >= PrevMaxAckDelayUs &&
+        MaxAckDelayUs <= PrevMaxAckDelayUs + PrevMaxAckDelayUs / 4) {
+        return;
+    }
+
+    Connection->AckFrequency.SendSeqNum++;
+    Connection->AckFrequency.PeerAckElicitingThreshold = AckElicitingThreshold;
+    Connection->AckFrequency.PeerMaxAckDelayUs = (uint32_t)MaxAckDelayUs;
+    Connection->AckFrequency.PeerReorderingThreshold = ReorderingThreshold;
+
+    QuicTraceLogConnVerbose(
+        AckFrequencyRequested,
+        Connection,
+        "Requesting ACK frequency, seq=%llu threshold=%hu, max ack delay=%u us, reorder threshold=%hhu",
+        Connection->AckFrequency.SendSeqNum,
+        AckElicitingThreshold,
+        (uint32_t)MaxAckDelayUs,
+        ReorderingThreshold);
+
+    QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_ACK_FREQUENCY);
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_CID_HASH_ENTRY*
 QuicConnGenerateNewSourceCid(
@@ -1139,9 +1295,10 @@ QuicConnTimerSet(
         NewIndex = CurIndex;
     }
 
-    if (NewIndex == 0) {
+    if (NewIndex == 0 && !QuicCryptoIsOffloadPending(&Connection->Crypto)) {
         //
         // The first timer was updated, so make sure the timer wheel is updated.
+        // While TLS is offloaded, this happens once the offload completes.
         //
         QuicTimerWheelUpdateConnection(&Connection->Worker->TimerWheel, Connection);
     }
@@ -1198,7 +1355,7 @@ QuicConnTimerCancel(
                     Connection->Timers[j - 1].ExpirationTime = UINT64_MAX;
                 }
 
-                if (i == 0) {
+                if (i == 0 && !QuicCryptoIsOffloadPending(&Connection->Crypto)) {
                     //
                     // The first timer was removed, so make sure the timer wheel is updated.
                     //
@@ -2111,8 +2268,10 @@ QuicConnCleanupServerResumptionState(
         if (Crypto->Initialized) {
             QuicRecvBufferUninitialize(&Crypto->RecvBuffer);
             QuicRangeUninitialize(&Crypto->SparseAckRanges);
-            QUIC_FREE(Crypto->TlsState.Buffer, QUIC_POOL_TLS_BUFFER);
-            Crypto->TlsState.Buffer = NULL;
+            if (Crypto->TlsState.Buffer != NULL) {
+                QUIC_FREE(Crypto->TlsState.Buffer, QUIC_POOL_TLS_BUFFER);
+                Crypto->TlsState.Buffer = NULL;
+            }
             Crypto->Initialized = FALSE;
         }
     }
@@ -2182,6 +2341,15 @@ QuicConnGenerateLocalTransportParameters(
         LocalTP->Flags |= QUIC_TP_FLAG_DISABLE_1RTT_ENCRYPTION;
     }
 
+    if (Connection->Settings.AckFrequencyEnabled) {
+        //
+        // The smallest ACK delay we can honor is bounded by the timer
+        // resolution.
+        //
+        LocalTP->Flags |= QUIC_TP_FLAG_MIN_ACK_DELAY;
+        LocalTP->MinAckDelay = MS_TO_US(MsQuicLib.TimerResolutionMs);
+    }
+
     if (QuicConnIsServer(Connection)) {
 
         if (Connection->Streams.Types[STREAM_ID_FLAG_IS_CLIENT | STREAM_ID_FLAG_IS_BI_DIR].MaxTotalStreamCount) {
@@ -3694,6 +3862,7 @@ QuicConnRecvFrames(
     )
 {
     BOOLEAN AckPacketImmediately = FALSE; // Allows skipping delayed ACK timer.
+    BOOLEAN ImmediateAckRequested = FALSE;
     BOOLEAN UpdatedFlowControl = FALSE;
     QUIC_ENCRYPT_LEVEL EncryptLevel = QuicKeyTypeToEncryptLevel(Packet->KeyType);
     BOOLEAN Closed = Connection->State.ClosedLocally || Connection->State.ClosedRemotely;
@@ -3704,10 +3873,13 @@ QuicConnRecvFrames(
     while (Offset < PayloadLength) {
 
         //
-        // Read the frame type.
+        // Read the frame type. It's encoded as a variable length integer, but
+        // only the extension frames need more than one byte.
         //
-        QUIC_FRAME_TYPE FrameType = Payload[Offset];
-        if (!QUIC_FRAME_IS_KNOWN(FrameType)) {
+        QUIC_VAR_INT FrameTypeValue = 0;
+        uint16_t FrameOffset = Offset;
+        if (!QuicVarIntDecode(PayloadLength, Payload, &FrameOffset, &FrameTypeValue) ||
+            !QUIC_FRAME_IS_KNOWN(FrameTypeValue)) {
             QuicTraceEvent(
                 ConnError,
                 "[conn][%p] ERROR, %s.",
@@ -3716,6 +3888,7 @@ QuicConnRecvFrames(
             QuicConnTransportError(Connection, QUIC_ERROR_FRAME_ENCODING_ERROR);
             return FALSE;
         }
+        QUIC_FRAME_TYPE FrameType = (QUIC_FRAME_TYPE)FrameTypeValue;
 
         //
         // Validate allowable frames based on the packet type.
@@ -3769,7 +3942,7 @@ QuicConnRecvFrames(
             }
         }
 
-        Offset += sizeof(uint8_t);
+        Offset = FrameOffset;
 
         //
         // Process the frame based on the frame type.
@@ -3966,7 +4139,7 @@ QuicConnRecvFrames(
                 QUIC_STATUS Status =
                     QuicStreamRecv(
                         Stream,
-                        Packet->EncryptedWith0Rtt,
+                        Packet,
                         FrameType,
                         PayloadLength,
                         Payload,
@@ -4250,11 +4423,15 @@ QuicConnRecvFrames(
                 QuicConnGetSourceCidFromSeq(
                     Connection,
                     Frame.Sequence,
-                    TRUE,
+                    FALSE,
                     &IsLastCid);
             if (SourceCid != NULL) {
                 BOOLEAN CidAlreadyRetired = SourceCid->CID.Retired;
-                QUIC_FREE(SourceCid, QUIC_POOL_CIDHASH);
+                (void)QuicConnGetSourceCidFromSeq(
+                    Connection,
+                    Frame.Sequence,
+                    TRUE,
+                    &IsLastCid);
                 if (IsLastCid) {
                     QuicTraceEvent(
                         ConnError,
@@ -4397,6 +4574,89 @@ QuicConnRecvFrames(
             break;
         }
 
+        case QUIC_FRAME_IMMEDIATE_ACK: {
+            if (!Connection->Settings.AckFrequencyEnabled) {
+                QuicTraceEvent(
+                    ConnError,
+                    "[conn][%p] ERROR, %s.",
+                    Connection,
+                    "Received IMMEDIATE_ACK frame when not negotiated");
+                QuicConnTransportError(Connection, QUIC_ERROR_PROTOCOL_VIOLATION);
+                return FALSE;
+            }
+
+            AckPacketImmediately = TRUE;
+            ImmediateAckRequested = TRUE;
+            Packet->HasNonProbingFrame = TRUE;
+            break;
+        }
+
+        case QUIC_FRAME_ACK_FREQUENCY: {
+            QUIC_ACK_FREQUENCY_EX Frame;
+            if (!QuicAckFrequencyFrameDecode(PayloadLength, Payload, &Offset, &Frame)) {
+                QuicTraceEvent(
+                    ConnError,
+                    "[conn][%p] ERROR, %s.",
+                    Connection,
+                    "Decoding ACK_FREQUENCY frame");
+                QuicConnTransportError(Connection, QUIC_ERROR_FRAME_ENCODING_ERROR);
+                return FALSE;
+            }
+
+            if (!Connection->Settings.AckFrequencyEnabled) {
+                QuicTraceEvent(
+                    ConnError,
+                    "[conn][%p] ERROR, %s.",
+                    Connection,
+                    "Received ACK_FREQUENCY frame when not negotiated");
+                QuicConnTransportError(Connection, QUIC_ERROR_PROTOCOL_VIOLATION);
+                return FALSE;
+            }
+
+            if (Frame.RequestedMaxAckDelay < MS_TO_US(MsQuicLib.TimerResolutionMs)) {
+                QuicTraceEvent(
+                    ConnError,
+                    "[conn][%p] ERROR, %s.",
+                    Connection,
+                    "ACK_FREQUENCY delay less than min_ack_delay");
+                QuicConnTransportError(Connection, QUIC_ERROR_PROTOCOL_VIOLATION);
+                return FALSE;
+            }
+
+            AckPacketImmediately = TRUE;
+            Packet->HasNonProbingFrame = TRUE;
+
+            if (Frame.SequenceNumber < Connection->AckFrequency.NextRecvSeqNum) {
+                break; // Stale (reordered) frame; already have newer values.
+            }
+
+            Connection->AckFrequency.NextRecvSeqNum = Frame.SequenceNumber + 1;
+            Connection->AckFrequency.AckElicitingThreshold =
+                Frame.AckElicitingThreshold < UINT16_MAX ?
+                    (uint16_t)Frame.AckElicitingThreshold : UINT16_MAX - 1;
+            Connection->AckFrequency.ReorderingThreshold =
+                Frame.ReorderingThreshold < UINT8_MAX ?
+                    (uint8_t)Frame.ReorderingThreshold : UINT8_MAX;
+
+            //
+            // The delayed ACK timer has millisecond granularity, so round down
+            // to make sure the requested delay is never exceeded. The check
+            // against min_ack_delay above guarantees at least 1 ms.
+            //
+            const uint64_t MaxAckDelayMs = US_TO_MS(Frame.RequestedMaxAckDelay);
+            Connection->AckFrequency.MaxAckDelayMs =
+                MaxAckDelayMs < UINT32_MAX ? (uint32_t)MaxAckDelayMs : UINT32_MAX;
+
+            QuicTraceLogConnVerbose(
+                AckFrequencyUpdated,
+                Connection,
+                "ACK frequency updated, threshold=%hu, max ack delay=%u ms, reorder threshold=%hhu",
+                Connection->AckFrequency.AckElicitingThreshold,
+                Connection->AckFrequency.MaxAckDelayMs,
+                Connection->AckFrequency.ReorderingThreshold);
+            break;
+        }
+
         case QUIC_FRAME_DATAGRAM:
         case QUIC_FRAME_DATAGRAM_1: {
             if (!Connection->Datagram.ReceiveEnabled) {
@@ -4465,7 +4725,8 @@ Done:
             &Connection->Packets[EncryptLevel]->AckTracker,
             Packet->PacketNumber,
             ECN,
-            AckPacketImmediately);
+            AckPacketImmediately,
+            ImmediateAckRequested);
     }
 
     Packet->CompletelyValid = TRUE;
@@ -4687,6 +4948,39 @@ QuicConnRecvDatagramBatch(
     }
 }
 
+//
+// Returns the processed datagrams to the datapath, except for the ones still
+// lent to a stream, which are returned by the stream once it's done with them.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnReleaseRecvDatagrams(
+    _In_ QUIC_RECV_DATAGRAM* DatagramChain
+    )
+{
+    QUIC_RECV_DATAGRAM* ReleaseChain = NULL;
+    QUIC_RECV_DATAGRAM** ReleaseChainTail = &ReleaseChain;
+
+    QUIC_RECV_DATAGRAM* Datagram;
+    while ((Datagram = DatagramChain) != NULL) {
+        DatagramChain = Datagram->Next;
+        Datagram->Next = NULL;
+
+        QUIC_RECV_PACKET* Packet =
+            QuicDataPathRecvDatagramToRecvPacket(Datagram);
+        if (Packet->LentToStream) {
+            Packet->ReleasedWhileLent = TRUE;
+        } else {
+            *ReleaseChainTail = Datagram;
+            ReleaseChainTail = &Datagram->Next;
+        }
+    }
+
+    if (ReleaseChain != NULL) {
+        QuicDataPathBindingReturnRecvDatagrams(ReleaseChain);
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicConnRecvDatagrams(
@@ -4893,7 +5187,7 @@ QuicConnRecvDatagrams(
                         &RecvState);
                     BatchCount = 0;
                 }
-                QuicDataPathBindingReturnRecvDatagrams(ReleaseChain);
+                QuicConnReleaseRecvDatagrams(ReleaseChain);
                 ReleaseChain = NULL;
                 ReleaseChainTail = &ReleaseChain;
                 ReleaseChainCount = 0;
@@ -4917,7 +5211,7 @@ QuicConnRecvDatagrams(
     }
 
     if (ReleaseChain != NULL) {
-        QuicDataPathBindingReturnRecvDatagrams(ReleaseChain);
+        QuicConnReleaseRecvDatagrams(ReleaseChain);
     }
 
     if (QuicConnIsServer(Connection) &&
@@ -5544,6 +5838,24 @@ QuicConnParamSet(
         break;
     }
 
+    case QUIC_PARAM_CONN_RECV_BUFFER_LENDING:
+
+        if (BufferLength != sizeof(BOOLEAN)) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        Connection->State.RecvBufferLending = *(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+
+        QuicTraceLogConnVerbose(
+            RecvBufferLendingUpdated,
+            Connection,
+            "Updated receive buffer lending to %hhu",
+            Connection->State.RecvBufferLending);
+
+        break;
+
     //
     // Private
     //
@@ -6014,6 +6326,69 @@ QuicConnParamGet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_CONN_RECV_BUFFER_LENDING:
+
+        if (*BufferLength < sizeof(BOOLEAN)) {
+            *BufferLength = sizeof(BOOLEAN);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(BOOLEAN);
+        *(BOOLEAN*)Buffer = Connection->State.RecvBufferLending;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
+    case QUIC_PARAM_CONN_MEMORY_USAGE: {
+
+        if (*BufferLength < sizeof(uint64_t)) {
+            *BufferLength = sizeof(uint64_t);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        //
+        // An estimate of the connection's own allocations. Stream receive
+        // buffers and queued app send data aren't included.
+        //
+        uint64_t MemoryUsage = sizeof(QUIC_CONNECTION);
+        for (uint32_t i = 0; i < ARRAYSIZE(Connection->Packets); ++i) {
+            if (Connection->Packets[i] != NULL) {
+                MemoryUsage += sizeof(QUIC_PACKET_SPACE);
+            }
+        }
+        if (Connection->Crypto.Initialized) {
+            MemoryUsage +=
+                Connection->Crypto.TlsState.BufferAllocLength +
+                Connection->Crypto.RecvBuffer.AllocBufferLength;
+        }
+        if (Connection->HandshakeTP != NULL) {
+            MemoryUsage += sizeof(QUIC_TRANSPORT_PARAMETERS);
+        }
+        for (uint32_t i = 0; i < ARRAYSIZE(Connection->Streams.Types); ++i) {
+            MemoryUsage +=
+                (uint64_t)Connection->Streams.Types[i].CurrentStreamCount *
+                sizeof(QUIC_STREAM);
+        }
+
+        *BufferLength = sizeof(uint64_t);
+        *(uint64_t*)Buffer = MemoryUsage;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
     default:
         Status = QUIC_STATUS_INVALID_PARAMETER;
         break;
@@ -6050,6 +6425,9 @@ QuicConnApplyNewSettings(
 
         Connection->Paths[0].SmoothedRtt = MS_TO_US(Connection->Settings.InitialRttMs);
         Connection->Paths[0].RttVariance = Connection->Paths[0].SmoothedRtt / 2;
+        Connection->Paths[0].EcnValidationState =
+            Connection->Settings.EcnEnabled ?
+                QUIC_ECN_VALIDATION_TESTING : QUIC_ECN_VALIDATION_FAILED;
         Connection->Datagram.ReceiveEnabled = Connection->Settings.DatagramReceiveEnabled;
 
         if (Connection->Settings.ServerResumptionLevel > QUIC_SERVER_NO_RESUME &&
@@ -6184,6 +6562,12 @@ QuicConnProcessApiOperation(
             ApiCtx->STRM_SEND.Stream);
         break;
 
+    case QUIC_API_TYPE_STRM_SEND_BATCH:
+        QuicStreamSendFlushBatch(
+            ApiCtx->STRM_SEND_BATCH.Streams);
+        ApiCtx->STRM_SEND_BATCH.Streams = NULL;
+        break;
+
     case QUIC_API_TYPE_STRM_RECV_COMPLETE:
         QuicStreamReceiveCompletePending(
             ApiCtx->STRM_RECV_COMPLETE.Stream,
@@ -6303,6 +6687,16 @@ QuicConnDrainOperations(
            !Connection->State.UpdateWorker &&
            OperationCount++ < MaxOperationCount) {
 
+        if (QuicCryptoIsOffloadPending(&Connection->Crypto)) {
+            //
+            // TLS processing has been offloaded to the TLS pool. Leave the rest
+            // of the operations queued until the pool completes and requeues
+            // the connection.
+            //
+            HasMoreWorkToDo = FALSE;
+            break;
+        }
+
         Oper = QuicOperationDequeue(&Connection->OperQ);
         if (Oper == NULL) {
             HasMoreWorkToDo = FALSE;
@@ -6369,6 +6763,7 @@ QuicConnDrainOperations(
             break;
         }
 
+        QuicConnFlushInlineApiCalls(Connection);
         QuicConnValidate(Connection);
 
         if (FreeOper) {
@@ -6407,6 +6802,11 @@ QuicConnDrainOperations(
         }
     }
 
+    //
+    // Catch any API calls deferred by callbacks outside of an operation.
+    //
+    QuicConnFlushInlineApiCalls(Connection);
+
     if (Connection->State.HandleClosed) {
         if (!Connection->State.Uninitialized) {
             QuicConnUninitialize(Connection);
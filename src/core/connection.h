@@ -140,6 +140,13 @@ typedef union QUIC_CONNECTION_STATE {
         //
         BOOLEAN UseRoundRobinStreamScheduling : 1;
 
+        //
+        // Indicates in-order stream data is indicated to the app directly from
+        // the received datagrams, instead of being copied to the streams'
+        // receive buffers.
+        //
+        BOOLEAN RecvBufferLending : 1;
+
         //
         // Indicates that this connection has resumption enabled and needs to
         // keep the TLS state and transport parameters until it is done sending
@@ -171,6 +178,7 @@ typedef enum QUIC_CONNECTION_REF {
     QUIC_CONN_REF_LOOKUP_TABLE,         // Per registered CID.
     QUIC_CONN_REF_LOOKUP_RESULT,        // For connections returned from lookups.
     QUIC_CONN_REF_WORKER,               // Worker is (queued for) processing.
+    QUIC_CONN_REF_TLS_POOL,             // TLS processing is offloaded.
 
     QUIC_CONN_REF_COUNT
 
@@ -204,6 +212,7 @@ typedef struct QUIC_CONN_STATS {
     uint32_t StatelessRetry         : 1;
     uint32_t ResumptionAttempted    : 1;
     uint32_t ResumptionSucceeded    : 1;
+    uint32_t EcnFailed              : 1;
 
     //
     // QUIC protocol version used. Network byte order.
@@ -223,6 +232,10 @@ typedef struct QUIC_CONN_STATS {
         uint32_t LastQueueTime;         // Time the connection last entered the work queue.
         uint64_t DrainCount;            // Sum of drain calls
         uint64_t OperationCount;        // Sum of operations processed
+        uint64_t ProcessingTime;        // Sum of time spent draining operations
+        uint32_t LoadIntervalId;        // Worker load interval of IntervalProcessingTime
+        uint32_t IntervalProcessingTime;// Time spent draining in that interval
+        uint32_t LastIntervalProcessingTime; // Time spent draining in the interval before
     } Schedule;
 
     struct {
@@ -242,6 +255,7 @@ typedef struct QUIC_CONN_STATS {
 
         uint32_t CongestionCount;
         uint32_t PersistentCongestionCount;
+        uint32_t EcnCongestionCount;    // Congestion events triggered by CE marks.
     } Send;
 
     struct {
@@ -270,7 +284,11 @@ typedef struct QUIC_CONN_STATS {
 //
 typedef struct QUIC_CONNECTION {
 
+#ifdef QUIC_CORE_UNIT_TEST
+    struct QUIC_HANDLE _;
+#else
     struct QUIC_HANDLE;
+#endif
 
     //
     // Link into the registrations's list of connections.
@@ -316,9 +334,10 @@ typedef struct QUIC_CONNECTION {
 
 #if DEBUG
     //
-    // Detailed ref counts
+    // Detailed ref counts. Not 16-bit, as every CID in (or retired from) the
+    // lookup tables holds its own QUIC_CONN_REF_LOOKUP_TABLE ref.
     //
-    short RefTypeCount[QUIC_CONN_REF_COUNT];
+    long RefTypeCount[QUIC_CONN_REF_COUNT];
 #endif
 
     //
@@ -331,6 +350,22 @@ typedef struct QUIC_CONNECTION {
     //
     QUIC_THREAD_ID WorkerThreadID;
 
+    //
+    // Streams with API sends queued from the worker thread while processing
+    // the connection. Instead of each queuing an operation, they are flushed
+    // as soon as the current operation completes. Linked via
+    // QUIC_STREAM::ApiSendBatchNext.
+    //
+    QUIC_STREAM* InlineApiSendStreams;
+    QUIC_STREAM** InlineApiSendStreamsTail;
+
+    //
+    // Streams with an API shutdown deferred the same way. Linked via
+    // QUIC_STREAM::InlineShutdownNext.
+    //
+    QUIC_STREAM* InlineApiShutdownStreams;
+    QUIC_STREAM** InlineApiShutdownStreamsTail;
+
     //
     // The server ID for the connection ID.
     //
@@ -474,6 +509,46 @@ typedef struct QUIC_CONNECTION {
     //
     QUIC_RANGE DecodedAckRanges;
 
+    //
+    // ACK_FREQUENCY extension state.
+    //
+    struct {
+
+        //
+        // The next sequence number expected in a received ACK_FREQUENCY
+        // frame. Anything older is stale and ignored.
+        //
+        QUIC_VAR_INT NextRecvSeqNum;
+
+        //
+        // The number of ACK eliciting 1-RTT packets that may be received
+        // before an ACK is sent immediately, as requested by the peer.
+        //
+        uint16_t AckElicitingThreshold;
+
+        //
+        // The packet reordering distance that triggers an immediate ACK, as
+        // requested by the peer. Zero means reordering is ignored.
+        //
+        uint8_t ReorderingThreshold;
+
+        //
+        // The maximum time to delay acknowledging 1-RTT packets, as requested
+        // by the peer. Zero means the MaxAckDelayMs setting is used.
+        //
+        uint32_t MaxAckDelayMs;
+
+        //
+        // The values most recently requested of the peer, sent in the
+        // ACK_FREQUENCY frame with sequence number SendSeqNum.
+        //
+        uint8_t PeerReorderingThreshold;
+        uint16_t PeerAckElicitingThreshold;
+        uint32_t PeerMaxAckDelayUs;
+        QUIC_VAR_INT SendSeqNum;
+
+    } AckFrequency;
+
     //
     // All the information and management logic for streams.
     //
@@ -596,6 +671,23 @@ QuicConnIsClosed(
     return Connection->State.ClosedLocally || Connection->State.ClosedRemotely;
 }
 
+//
+// Helper for checking if the caller is the connection's own worker thread, in
+// the middle of processing the connection (i.e. in a callback). API calls made
+// from there don't need to queue an operation.
+//
+inline
+BOOLEAN
+QuicConnIsOnWorkerThread(
+    _In_ const QUIC_CONNECTION * const Connection
+    )
+{
+    const QUIC_THREAD_ID ThreadID = QuicCurThreadID();
+    return
+        Connection->WorkerThreadID == ThreadID &&
+        Connection->Worker->ThreadID == ThreadID;
+}
+
 //
 // Returns the earliest expiration time across all timers for the connection.
 //
@@ -686,6 +778,19 @@ QuicDatagramGetConnection(
     return QUIC_CONTAINING_RECORD(Datagram, QUIC_CONNECTION, Datagram);
 }
 
+//
+// Helper to get the owning QUIC_CONNECTION for the send buffer.
+//
+inline
+_Ret_notnull_
+QUIC_CONNECTION*
+QuicSendBufferGetConnection(
+    _In_ QUIC_SEND_BUFFER* SendBuffer
+    )
+{
+    return QUIC_CONTAINING_RECORD(SendBuffer, QUIC_CONNECTION, SendBuffer);
+}
+
 inline
 void
 QuicConnLogOutFlowStats(
@@ -879,7 +984,7 @@ QuicConnAddRef(
     QuicConnValidate(Connection);
 
 #if DEBUG
-    InterlockedIncrement16((volatile short*)&Connection->RefTypeCount[Ref]);
+    InterlockedIncrement((volatile long*)&Connection->RefTypeCount[Ref]);
 #else
     UNREFERENCED_PARAMETER(Ref);
 #endif
@@ -905,8 +1010,8 @@ QuicConnRelease(
 
 #if DEBUG
     QUIC_TEL_ASSERT(Connection->RefTypeCount[Ref] > 0);
-    uint16_t result = (uint16_t)InterlockedDecrement16((volatile short*)&Connection->RefTypeCount[Ref]);
-    QUIC_TEL_ASSERT(result != 0xFFFF);
+    long result = InterlockedDecrement((volatile long*)&Connection->RefTypeCount[Ref]);
+    QUIC_TEL_ASSERT(result >= 0);
 #else
     UNREFERENCED_PARAMETER(Ref);
 #endif
@@ -991,6 +1096,41 @@ QuicConnQueueHighestPriorityOper(
     _In_ QUIC_OPERATION* Oper
     );
 
+//
+// Queues a list of streams, linked via ApiSendBatchNext, to have their API
+// sends flushed after the current operation. Must be called on the worker
+// thread currently processing the connection.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnQueueInlineApiSends(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_STREAM* Streams,
+    _In_ QUIC_STREAM** StreamsTail
+    );
+
+//
+// Queues a stream to have its deferred API shutdown (InlineShutdownFlags)
+// processed after the current operation. Must be called on the worker thread
+// currently processing the connection.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnQueueInlineApiShutdown(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_STREAM* Stream
+    );
+
+//
+// Processes the API shutdowns and sends queued by
+// QuicConnQueueInlineApiShutdown and QuicConnQueueInlineApiSends.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnFlushInlineApiCalls(
+    _In_ QUIC_CONNECTION* Connection
+    );
+
 //
 // Generates a new source connection ID.
 //
@@ -1022,7 +1162,9 @@ QuicConnRetireCurrentDestCid(
     );
 
 //
-// Look up a source CID by sequence number.
+// Look up a source CID by sequence number. If RemoveFromList is TRUE, the CID
+// is also removed and freed by the binding, so only the returned pointer's
+// value (not the CID it pointed to) may be used.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Success_(return != NULL)
@@ -1045,16 +1187,16 @@ QuicConnGetSourceCidFromSeq(
                 Link);
         if (SourceCid->CID.SequenceNumber == SequenceNumber) {
             if (RemoveFromList) {
-                QuicBindingRemoveSourceConnectionID(
-                    Connection->Paths[0].Binding,
-                    SourceCid,
-                    Entry);
                 QuicTraceEvent(
                     ConnSourceCidRemoved,
                     "[conn][%p] (SeqNum=%llu) Removed Source CID: %!CID!",
                     Connection,
                     SourceCid->CID.SequenceNumber,
                     CLOG_BYTEARRAY(SourceCid->CID.Length, SourceCid->CID.Data));
+                QuicBindingRemoveSourceConnectionID(
+                    Connection->Paths[0].Binding,
+                    SourceCid,
+                    Entry);
             }
             *IsLastCid = Connection->SourceCids.Next == NULL;
             return SourceCid;
@@ -1093,7 +1235,9 @@ QuicConnGetSourceCidFromBuf(
 }
 
 //
-// Look up a source CID by sequence number.
+// Look up a source CID by sequence number. If RemoveFromList is TRUE, the CID
+// is also removed and freed by the binding, so only the returned pointer's
+// value (not the CID it pointed to) may be used.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 inline
@@ -1133,6 +1277,17 @@ QuicConnUpdateRtt(
     _In_ uint32_t LatestRtt
     );
 
+//
+// Recomputes how often the peer should acknowledge packets, given the current
+// congestion window and RTT, and queues an ACK_FREQUENCY frame if it changed.
+// Only has an effect if the extension was negotiated.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnUpdatePeerAckFrequency(
+    _In_ QUIC_CONNECTION* Connection
+    );
+
 //
 // Sets a new timer delay in milliseconds.
 //
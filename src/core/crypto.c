@@ -225,6 +225,16 @@ QuicCryptoUninitialize(
     _In_ QUIC_CRYPTO* Crypto
     )
 {
+    if (Crypto->TlsOffloadState == QUIC_TLS_OFFLOAD_PREPARED) {
+        //
+        // The connection was shut down before the prepared TLS processing was
+        // handed off to the TLS pool, so just abandon it.
+        //
+        Crypto->TlsOffloadState = QUIC_TLS_OFFLOAD_NONE;
+        QuicOperationFree(QuicCryptoGetConnection(Crypto)->Worker, Crypto->TlsOffloadOper);
+        Crypto->TlsOffloadOper = NULL;
+        QuicConnRelease(QuicCryptoGetConnection(Crypto), QUIC_CONN_REF_TLS_POOL);
+    }
     for (uint8_t i = 0; i < QUIC_PACKET_KEY_COUNT; ++i) {
         QuicPacketKeyFree(Crypto->TlsState.ReadKeys[i]);
         Crypto->TlsState.ReadKeys[i] = NULL;
@@ -247,8 +257,10 @@ QuicCryptoUninitialize(
     if (Crypto->Initialized) {
         QuicRecvBufferUninitialize(&Crypto->RecvBuffer);
         QuicRangeUninitialize(&Crypto->SparseAckRanges);
-        QUIC_FREE(Crypto->TlsState.Buffer, QUIC_POOL_TLS_BUFFER);
-        Crypto->TlsState.Buffer = NULL;
+        if (Crypto->TlsState.Buffer != NULL) {
+            QUIC_FREE(Crypto->TlsState.Buffer, QUIC_POOL_TLS_BUFFER);
+            Crypto->TlsState.Buffer = NULL;
+        }
         Crypto->Initialized = FALSE;
     }
 }
@@ -362,6 +374,63 @@ QuicCryptoReset(
     QuicCryptoValidate(Crypto);
 }
 
+//
+// Once the handshake is confirmed, the send and receive buffers are only used
+// occasionally (resumption tickets), so they are freed whenever they are empty
+// and allocated again on demand.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoFreeIdleBuffers(
+    _In_ QUIC_CRYPTO* Crypto
+    )
+{
+    if (!Crypto->Initialized ||
+        !QuicCryptoGetConnection(Crypto)->State.HandshakeConfirmed ||
+        Crypto->TlsCallPending ||
+        Crypto->TlsOffloadState != QUIC_TLS_OFFLOAD_NONE) {
+        return;
+    }
+
+    if (Crypto->TlsState.Buffer != NULL && Crypto->TlsState.BufferLength == 0) {
+        QUIC_FREE(Crypto->TlsState.Buffer, QUIC_POOL_TLS_BUFFER);
+        Crypto->TlsState.Buffer = NULL;
+        Crypto->TlsState.BufferAllocLength = 0;
+    }
+
+    QuicRecvBufferTrim(&Crypto->RecvBuffer);
+}
+
+//
+// Makes sure the send buffer is allocated before calling into TLS, which
+// writes any output directly into it.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicCryptoEnsureSendBuffer(
+    _In_ QUIC_CRYPTO* Crypto
+    )
+{
+    if (Crypto->TlsState.Buffer != NULL) {
+        return TRUE;
+    }
+
+    uint16_t SendBufferLength =
+        QuicConnIsServer(QuicCryptoGetConnection(Crypto)) ?
+            QUIC_MAX_TLS_SERVER_SEND_BUFFER : QUIC_MAX_TLS_CLIENT_SEND_BUFFER;
+    Crypto->TlsState.Buffer = QUIC_ALLOC_NONPAGED(SendBufferLength, QUIC_POOL_TLS_BUFFER);
+    if (Crypto->TlsState.Buffer == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "crypto send buffer",
+            SendBufferLength);
+        return FALSE;
+    }
+    Crypto->TlsState.BufferAllocLength = SendBufferLength;
+    return TRUE;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicCryptoHandshakeConfirmed(
@@ -376,6 +445,7 @@ QuicCryptoHandshakeConfirmed(
     QuicBindingOnConnectionHandshakeConfirmed(Path->Binding, Connection);
 
     QuicCryptoDiscardKeys(Crypto, QUIC_PACKET_KEY_HANDSHAKE);
+    QuicCryptoFreeIdleBuffers(Crypto);
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -959,6 +1029,7 @@ QuicCryptoOnAck(
                     Crypto->TlsState.BufferLength);
             } else {
                 Crypto->TlsState.BufferLength = 0;
+                QuicCryptoFreeIdleBuffers(Crypto);
             }
 
             if (Crypto->NextSendOffset < Crypto->UnAckedOffset) {
@@ -1444,7 +1515,7 @@ QuicCryptoProcessTlsCompletion(
         }
         Connection->Stats.ResumptionSucceeded = Crypto->TlsState.SessionResumed;
 
-        QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_PMTUD);
+        QuicMtuDiscoveryNewSearch(Connection, &Connection->Paths[0]);
 
         if (QuicConnIsServer(Connection) &&
             Crypto->TlsState.BufferOffset1Rtt != 0 &&
@@ -1485,6 +1556,8 @@ QuicCryptoProcessDataComplete(
     if (Crypto->TlsDataPending && !Crypto->TlsCallPending) {
         QuicCryptoProcessData(Crypto, FALSE);
     }
+
+    QuicCryptoFreeIdleBuffers(Crypto);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -1511,12 +1584,140 @@ QuicCryptoProcessCompleteOperation(
     _In_ QUIC_CRYPTO* Crypto
     )
 {
+    if (Crypto->TlsOffloadState == QUIC_TLS_OFFLOAD_COMPLETE) {
+        QUIC_CONNECTION* Connection = QuicCryptoGetConnection(Crypto);
+        Crypto->TlsOffloadState = QUIC_TLS_OFFLOAD_NONE;
+
+        //
+        // The worker skipped the connection's timers while TLS was offloaded,
+        // so make sure they are back in the timer wheel.
+        //
+        QuicTimerWheelUpdateConnection(&Connection->Worker->TimerWheel, Connection);
+
+        if (Crypto->TlsOffloadResultFlags != QUIC_TLS_RESULT_PENDING) {
+            QuicCryptoProcessDataComplete(
+                Crypto,
+                Crypto->TlsOffloadResultFlags,
+                Crypto->TlsOffloadBufferLength);
+        }
+        return;
+    }
+
     uint32_t BufferConsumed = 0;
     QUIC_TLS_RESULT_FLAGS ResultFlags =
         QuicTlsProcessDataComplete(Crypto->TLS, &BufferConsumed);
     QuicCryptoProcessDataComplete(Crypto, ResultFlags, BufferConsumed);
 }
 
+//
+// Stages the TLS data to be processed on the TLS pool, if the connection is
+// configured for it. Returns FALSE if TLS should be called inline instead.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicCryptoPrepareOffload(
+    _In_ QUIC_CRYPTO* Crypto,
+    _In_reads_(BufferLength)
+        const uint8_t* Buffer,
+    _In_ uint32_t BufferLength
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCryptoGetConnection(Crypto);
+    if (!QuicConnIsServer(Connection) ||
+        !Connection->Settings.AsyncHandshakeEnabled ||
+        QuicLibraryGetTlsPool() == NULL) {
+        return FALSE;
+    }
+
+    if (Connection->Settings.ServerResumptionLevel > QUIC_SERVER_NO_RESUME &&
+        Crypto->TlsState.ReadKey == QUIC_PACKET_KEY_INITIAL) {
+        //
+        // Processing the ClientHello may indicate QUIC_CONNECTION_EVENT_RESUMED
+        // to the app, which must only ever happen on the worker.
+        //
+        return FALSE;
+    }
+
+    QUIC_OPERATION* Oper =
+        QuicOperationAlloc(Connection->Worker, QUIC_OPER_TYPE_TLS_COMPLETE);
+    if (Oper == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "TLS offload operation",
+            0);
+        return FALSE;
+    }
+
+    QuicTraceLogConnVerbose(
+        CryptoOffloadPrepared,
+        Connection,
+        "Offloading %u crypto bytes to the TLS pool",
+        BufferLength);
+
+    Crypto->TlsOffloadOper = Oper;
+    Crypto->TlsOffloadBuffer = Buffer;
+    Crypto->TlsOffloadBufferLength = BufferLength;
+    QuicConnAddRef(Connection, QUIC_CONN_REF_TLS_POOL);
+    Crypto->TlsOffloadState = QUIC_TLS_OFFLOAD_PREPARED;
+
+    return TRUE;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoQueueOffload(
+    _In_ QUIC_CRYPTO* Crypto
+    )
+{
+    QUIC_DBG_ASSERT(Crypto->TlsOffloadState == QUIC_TLS_OFFLOAD_PREPARED);
+    QUIC_DBG_ASSERT(MsQuicLib.TlsPool != NULL);
+    WriteRelease(&Crypto->TlsOffloadState, QUIC_TLS_OFFLOAD_RUNNING);
+    QuicTlsPoolQueue(MsQuicLib.TlsPool, Crypto);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoProcessOffloadedData(
+    _In_ QUIC_CRYPTO* Crypto
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCryptoGetConnection(Crypto);
+    QUIC_DBG_ASSERT(Crypto->TlsOffloadState == QUIC_TLS_OFFLOAD_RUNNING);
+
+    //
+    // N.B. The connection's WorkerThreadID is deliberately left unset. Nothing
+    // indicated from here may reach the app (see QuicCryptoPrepareOffload), so
+    // there are no reentrant API calls to execute inline.
+    //
+    QuicConfigurationAttachSilo(Connection->Configuration);
+
+    uint32_t BufferLength = Crypto->TlsOffloadBufferLength;
+    Crypto->TlsOffloadResultFlags =
+        QuicTlsProcessData(
+            Crypto->TLS,
+            QUIC_TLS_CRYPTO_DATA,
+            Crypto->TlsOffloadBuffer,
+            &BufferLength,
+            &Crypto->TlsState);
+    Crypto->TlsOffloadBufferLength = BufferLength;
+    Crypto->TlsOffloadBuffer = NULL;
+
+    QuicConfigurationDetachSilo();
+
+    QUIC_OPERATION* Oper = Crypto->TlsOffloadOper;
+    Crypto->TlsOffloadOper = NULL;
+    WriteRelease(&Crypto->TlsOffloadState, QUIC_TLS_OFFLOAD_COMPLETE);
+
+    //
+    // The connection's operations were left queued behind the offload, so put
+    // the completion at the front and reschedule the connection.
+    //
+    (void)QuicOperationEnqueueFront(&Connection->OperQ, Oper);
+    QuicWorkerQueueConnection(Connection->Worker, Connection);
+    QuicConnRelease(Connection, QUIC_CONN_REF_TLS_POOL);
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicCryptoProcessData(
@@ -1621,11 +1822,24 @@ QuicCryptoProcessData(
         goto Error;
     }
 
+    if (!QuicCryptoEnsureSendBuffer(Crypto)) {
+        QuicConnFatalError(
+            QuicCryptoGetConnection(Crypto),
+            QUIC_STATUS_OUT_OF_MEMORY,
+            "Out of memory");
+        goto Error;
+    }
+
     Crypto->TlsDataPending = FALSE;
     Crypto->TlsCallPending = TRUE;
 
     QuicCryptoValidate(Crypto);
 
+    if (!IsClientInitial &&
+        QuicCryptoPrepareOffload(Crypto, Buffer.Buffer, Buffer.Length)) {
+        return;
+    }
+
     QUIC_TLS_RESULT_FLAGS ResultFlags =
         QuicTlsProcessData(
             Crypto->TLS,
@@ -1663,6 +1877,11 @@ QuicCryptoProcessAppData(
         goto Error;
     }
 
+    if (!QuicCryptoEnsureSendBuffer(Crypto)) {
+        Status = QUIC_STATUS_OUT_OF_MEMORY;
+        goto Error;
+    }
+
     QUIC_TLS_RESULT_FLAGS ResultFlags =
         QuicTlsProcessData(Crypto->TLS, QUIC_TLS_TICKET_DATA, AppData, &DataLength, &Crypto->TlsState);
     if (ResultFlags & QUIC_TLS_RESULT_ERROR) {
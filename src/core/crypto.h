@@ -10,6 +10,16 @@ Abstract:
 
 --*/
 
+//
+// The states of TLS processing offloaded to the TLS pool.
+//
+typedef enum QUIC_TLS_OFFLOAD_STATE {
+    QUIC_TLS_OFFLOAD_NONE,      // Not offloaded; TLS runs inline on the worker.
+    QUIC_TLS_OFFLOAD_PREPARED,  // Data staged; handed off once the worker is done.
+    QUIC_TLS_OFFLOAD_RUNNING,   // Owned by a TLS pool thread.
+    QUIC_TLS_OFFLOAD_COMPLETE   // Results staged; waiting on the TLS complete operation.
+} QUIC_TLS_OFFLOAD_STATE;
+
 //
 // Stream of TLS data.
 //
@@ -99,8 +109,40 @@ typedef struct QUIC_CRYPTO {
     uint8_t* ResumptionTicket;
     uint32_t ResumptionTicketLength;
 
+    //
+    // State for TLS processing offloaded to the TLS pool. The offload state
+    // is a QUIC_TLS_OFFLOAD_STATE, and is the only field shared between the
+    // worker and the pool thread without any other synchronization.
+    //
+    long TlsOffloadState;
+    QUIC_TLS_RESULT_FLAGS TlsOffloadResultFlags;
+    const uint8_t* TlsOffloadBuffer;
+    uint32_t TlsOffloadBufferLength; // Consumed length, once complete.
+    QUIC_LIST_ENTRY TlsPoolLink;
+
+    //
+    // Preallocated so that completing offloaded TLS processing can't fail.
+    //
+    QUIC_OPERATION* TlsOffloadOper;
+
 } QUIC_CRYPTO;
 
+//
+// Returns TRUE while offloaded TLS processing is outstanding, during which the
+// connection must not be drained or have its timers processed.
+//
+inline
+BOOLEAN
+QuicCryptoIsOffloadPending(
+    _In_ const QUIC_CRYPTO* Crypto
+    )
+{
+    const long State = ReadAcquire(&Crypto->TlsOffloadState);
+    return
+        State == QUIC_TLS_OFFLOAD_PREPARED ||
+        State == QUIC_TLS_OFFLOAD_RUNNING;
+}
+
 inline
 BOOLEAN
 QuicCryptoHasPendingCryptoFrame(
@@ -238,6 +280,25 @@ QuicCryptoProcessCompleteOperation(
     _In_ QUIC_CRYPTO* Crypto
     );
 
+//
+// Hands prepared TLS processing off to the TLS pool. Called by the worker once
+// it's done with the connection.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoQueueOffload(
+    _In_ QUIC_CRYPTO* Crypto
+    );
+
+//
+// Runs offloaded TLS processing. Called on a TLS pool thread.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoProcessOffloadedData(
+    _In_ QUIC_CRYPTO* Crypto
+    );
+
 //
 // Processes app-provided data for TLS (i.e. resumption ticket data).
 //
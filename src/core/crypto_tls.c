@@ -63,6 +63,7 @@ typedef enum eSniNameType {
 //
 #define QUIC_TP_ID_MAX_DATAGRAM_FRAME_SIZE                  32  // varint
 #define QUIC_TP_ID_DISABLE_1RTT_ENCRYPTION                  0xBAAD  // N/A
+#define QUIC_TP_ID_MIN_ACK_DELAY                            0xFF04DE1B  // varint
 
 BOOLEAN
 QuicTpIdIsReserved(
@@ -112,7 +113,7 @@ TlsReadUint24(
 static
 uint8_t*
 TlsWriteTransportParam(
-    _In_ uint16_t Id,
+    _In_ QUIC_VAR_INT Id,
     _In_ uint16_t Length,
     _In_reads_bytes_opt_(Length) const uint8_t* Param,
     _Out_writes_bytes_(_Inexpressible_("Too Dynamic"))
@@ -132,7 +133,7 @@ TlsWriteTransportParam(
 static
 uint8_t*
 TlsWriteTransportParamVarInt(
-    _In_ uint16_t Id,
+    _In_ QUIC_VAR_INT Id,
     _In_ QUIC_VAR_INT Value,
     _Out_writes_bytes_(_Inexpressible_("Too Dynamic"))
         uint8_t* Buffer
@@ -796,6 +797,12 @@ QuicCryptoTlsEncodeTransportParameters(
                 QUIC_TP_ID_DISABLE_1RTT_ENCRYPTION,
                 0);
     }
+    if (TransportParams->Flags & QUIC_TP_FLAG_MIN_ACK_DELAY) {
+        RequiredTPLen +=
+            TlsTransportParamLength(
+                QUIC_TP_ID_MIN_ACK_DELAY,
+                QuicVarIntSize(TransportParams->MinAckDelay));
+    }
     if (TestParam != NULL) {
         RequiredTPLen +=
             TlsTransportParamLength(
@@ -1059,6 +1066,17 @@ QuicCryptoTlsEncodeTransportParameters(
             Connection,
             "TP: Disable 1-RTT Encryption");
     }
+    if (TransportParams->Flags & QUIC_TP_FLAG_MIN_ACK_DELAY) {
+        TPBuf =
+            TlsWriteTransportParamVarInt(
+                QUIC_TP_ID_MIN_ACK_DELAY,
+                TransportParams->MinAckDelay, TPBuf);
+        QuicTraceLogConnVerbose(
+            EncodeTPMinAckDelay,
+            Connection,
+            "TP: Min ACK Delay (%llu us)",
+            TransportParams->MinAckDelay);
+    }
     if (TestParam != NULL) {
         TPBuf =
             TlsWriteTransportParam(
@@ -1627,6 +1645,24 @@ QuicCryptoTlsDecodeTransportParameters(
                 "TP: Disable 1-RTT Encryption");
             break;
 
+        case QUIC_TP_ID_MIN_ACK_DELAY:
+            if (!TRY_READ_VAR_INT(TransportParams->MinAckDelay)) {
+                QuicTraceEvent(
+                    ConnErrorStatus,
+                    "[conn][%p] ERROR, %u, %s.",
+                    Connection,
+                    Length,
+                    "Invalid length of QUIC_TP_ID_MIN_ACK_DELAY");
+                goto Exit;
+            }
+            TransportParams->Flags |= QUIC_TP_FLAG_MIN_ACK_DELAY;
+            QuicTraceLogConnVerbose(
+                DecodeTPMinAckDelay,
+                Connection,
+                "TP: Min ACK Delay (%llu us)",
+                TransportParams->MinAckDelay);
+            break;
+
         default:
             if (QuicTpIdIsReserved(Id)) {
                 QuicTraceLogConnWarning(
@@ -1649,6 +1685,16 @@ QuicCryptoTlsDecodeTransportParameters(
         Offset += Length;
     }
 
+    if ((TransportParams->Flags & QUIC_TP_FLAG_MIN_ACK_DELAY) &&
+        TransportParams->MinAckDelay > MS_TO_US(TransportParams->MaxAckDelay)) {
+        QuicTraceEvent(
+            ConnError,
+            "[conn][%p] ERROR, %s.",
+            Connection,
+            "TP min_ack_delay larger than max_ack_delay");
+        goto Exit;
+    }
+
     Result = TRUE;
 
 Exit:
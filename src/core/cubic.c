@@ -0,0 +1,482 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    The CUBIC (RFC8312) congestion control algorithm.
+
+Future work:
+
+    -Early slowstart exit via HyStart or similar.
+
+--*/
+
+#include "precomp.h"
+#ifdef QUIC_CLOG
+#include "cubic.c.clog.h"
+#endif
+
+//
+// BETA and C from RFC8312. 10x multiples for integer arithmetic.
+//
+#define TEN_TIMES_BETA_CUBIC 7
+#define TEN_TIMES_C_CUBIC 4
+
+//
+// Shifting nth root algorithm.
+//
+// This works sort of like long division: we look at the radicand in aligned
+// chunks of 3 bits to compute each bit of the root. This is somewhat
+// intuitive, since 2^3 = 8, i.e. one bit is needed to encode the cube root
+// of a 3-bit number.
+//
+// At each step, we have a root value computed "so far" (i.e. the most
+// significant bits of the root) and we need to find the correct value of
+// the LSB of the (shifted) root so that it satisfies the two conditions:
+// y^3 <= x
+// (y+1)^3 > x
+// ...where y represents the shifted value of the root "computed so far"
+// and x represents the bits of the radicand "shifted in so far."
+//
+// The initial shift of 30 bits gives us 3-bit-aligned chunks.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+CubeRoot(
+    uint32_t Radicand
+    )
+{
+    int i;
+    uint32_t x = 0;
+    uint32_t y = 0;
+
+    for (i = 30; i >= 0; i -= 3) {
+        x = x * 8 + ((Radicand >> i) & 7);
+        if ((y * 2 + 1) * (y * 2 + 1) * (y * 2 + 1) <= x) {
+            y = y * 2 + 1;
+        } else {
+            y = y * 2;
+        }
+    }
+    return y;
+}
+
+void
+QuicConnLogCubic(
+    _In_ const QUIC_CONNECTION* const Connection
+    )
+{
+    UNREFERENCED_PARAMETER(Connection);
+    QuicTraceEvent(
+        ConnCubic,
+        "[conn][%p] CUBIC: SlowStartThreshold=%u K=%u WindowMax=%u WindowLastMax=%u",
+        Connection,
+        Connection->CongestionControl.SlowStartThreshold,
+        Connection->CongestionControl.Cubic.KCubic,
+        Connection->CongestionControl.Cubic.WindowMax,
+        Connection->CongestionControl.Cubic.WindowLastMax);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCubicInitialize(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QuicZeroMemory(&Cc->Cubic, sizeof(Cc->Cubic));
+    Cc->SlowStartThreshold = UINT32_MAX;
+    Cc->CongestionWindow = Connection->Paths[0].Mtu * Cc->InitialWindowPackets;
+    Cc->BytesInFlightMax = Cc->CongestionWindow / 2;
+    QuicConnLogOutFlowStats(Connection);
+    QuicConnLogCubic(Connection);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCubicReset(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    Cc->SlowStartThreshold = UINT32_MAX;
+    Cc->Cubic.IsInRecovery = FALSE;
+    Cc->Cubic.HasHadCongestionEvent = FALSE;
+    Cc->CongestionWindow = Connection->Paths[0].Mtu * Cc->InitialWindowPackets;
+    Cc->BytesInFlightMax = Cc->CongestionWindow / 2;
+    QuicConnLogOutFlowStats(Connection);
+    QuicConnLogCubic(Connection);
+}
+
+//
+// Attempts to predict what the congestion window will be one RTT from now.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicCubicPredictNextWindow(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    //
+    // TODO - Replace NewReno prediction logic.
+    //
+    uint32_t Wnd;
+    if (Cc->CongestionWindow < Cc->SlowStartThreshold) {
+        Wnd = Cc->CongestionWindow << 1;
+        if (Wnd > Cc->SlowStartThreshold) {
+            Wnd = Cc->SlowStartThreshold;
+        }
+    } else {
+        Wnd =
+            Cc->CongestionWindow +
+            QuicCongestionControlGetConnection(Cc)->Paths[0].Mtu;
+    }
+    return Wnd;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicCubicGetSendAllowance(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t TimeSinceLastSend, // microsec
+    _In_ BOOLEAN TimeSinceLastSendValid
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    if (Cc->BytesInFlight >= Cc->CongestionWindow) {
+        //
+        // We are CC blocked, so we can't send anything.
+        //
+        return 0;
+    }
+
+    if (!Connection->Settings.PacingEnabled || !Connection->Paths[0].GotFirstRttSample) {
+        //
+        // Pacing is disabled or we don't have an RTT sample yet, so just send
+        // everything we can.
+        //
+        return Cc->CongestionWindow - Cc->BytesInFlight;
+    }
+
+    //
+    // Since the window grows via ACK feedback and since we defer packets
+    // when pacing, using the current window to calculate the pacing interval
+    // is not quite as aggressive as we'd like. Instead, use the predicted
+    // window of the next RTT.
+    //
+    return
+        QuicCongestionControlGetPacedAllowance(
+            Cc,
+            QuicCubicPredictNextWindow(Cc),
+            TimeSinceLastSend,
+            TimeSinceLastSendValid);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCubicOnCongestionEvent(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QUIC_CONGESTION_CONTROL_CUBIC* Cubic = &Cc->Cubic;
+    QuicTraceEvent(
+        ConnCongestion,
+        "[conn][%p] Congestion event",
+        Connection);
+    Connection->Stats.Send.CongestionCount++;
+
+    Cubic->IsInRecovery = TRUE;
+    Cubic->HasHadCongestionEvent = TRUE;
+
+    Cubic->WindowMax = Cc->CongestionWindow;
+    if (Cubic->WindowLastMax > Cubic->WindowMax) {
+        //
+        // Fast convergence.
+        //
+        Cubic->WindowLastMax = Cubic->WindowMax;
+        Cubic->WindowMax = Cubic->WindowMax * (10 + TEN_TIMES_BETA_CUBIC) / 20;
+    } else {
+        Cubic->WindowLastMax = Cubic->WindowMax;
+    }
+
+    //
+    // K = (WindowMax * (1 - BETA) / C) ^ (1/3)
+    // BETA := multiplicative window decrease factor.
+    //
+    // Here we reduce rounding error by left-shifting the CubeRoot argument
+    // by 9 before the division and then right-shifting the result by 3
+    // (since 2^9 = 2^3^3).
+    //
+    Cubic->KCubic =
+        CubeRoot(
+            (Cubic->WindowMax / Connection->Paths[0].Mtu * (10 - TEN_TIMES_BETA_CUBIC) << 9) /
+            TEN_TIMES_C_CUBIC);
+    Cubic->KCubic = S_TO_MS(Cubic->KCubic);
+    Cubic->KCubic >>= 3;
+
+    Cc->SlowStartThreshold =
+    Cc->CongestionWindow =
+        max(
+            (uint32_t)Connection->Paths[0].Mtu * Cc->InitialWindowPackets,
+            Cc->CongestionWindow * TEN_TIMES_BETA_CUBIC / 10);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCubicOnPersistentCongestionEvent(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QUIC_CONGESTION_CONTROL_CUBIC* Cubic = &Cc->Cubic;
+    QuicTraceEvent(
+        ConnPersistentCongestion,
+        "[conn][%p] Persistent congestion event",
+        Connection);
+    Connection->Stats.Send.PersistentCongestionCount++;
+
+    Cubic->IsInPersistentCongestion = TRUE;
+    Cubic->WindowMax =
+        Cubic->WindowLastMax =
+        Cc->SlowStartThreshold =
+            Cc->CongestionWindow * TEN_TIMES_BETA_CUBIC / 10;
+    Cc->CongestionWindow =
+        Connection->Paths[0].Mtu * QUIC_PERSISTENT_CONGESTION_WINDOW_PACKETS;
+    Cubic->KCubic = 0;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCubicOnDataAcknowledged(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ const QUIC_ACK_EVENT* AckEvent
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QUIC_CONGESTION_CONTROL_CUBIC* Cubic = &Cc->Cubic;
+    const uint64_t TimeNow = US_TO_MS(AckEvent->TimeNow);
+
+    if (Cubic->IsInRecovery) {
+        if (AckEvent->LargestAck > Cubic->RecoverySentPacketNumber) {
+            //
+            // Done recovering. Note that completion of recovery is defined a
+            // bit differently here than in TCP: we simply require an ACK for a
+            // packet sent after recovery started.
+            //
+            QuicTraceEvent(
+                ConnRecoveryExit,
+                "[conn][%p] Recovery complete",
+                Connection);
+            Cubic->IsInRecovery = FALSE;
+            Cubic->IsInPersistentCongestion = FALSE;
+            Cubic->TimeOfCongAvoidStart = QuicTimeMs64();
+        }
+        goto Exit;
+    } else if (AckEvent->NumRetransmittableBytes == 0) {
+        goto Exit;
+    }
+
+    if (Cc->CongestionWindow < Cc->SlowStartThreshold) {
+
+        //
+        // Slow Start
+        //
+
+        Cc->CongestionWindow += AckEvent->NumRetransmittableBytes;
+        if (Cc->CongestionWindow >= Cc->SlowStartThreshold) {
+            Cubic->TimeOfCongAvoidStart = QuicTimeMs64();
+        }
+
+    } else {
+
+        //
+        // Congestion Avoidance
+        //
+
+        //
+        // We require steady ACK feedback to justify window growth. If there is
+        // a long time gap between ACKs, add the gap to TimeOfCongAvoidStart to
+        // reduce the value of TimeInCongAvoid, which effectively freezes window
+        // growth during the gap.
+        //
+        if (Cubic->TimeOfLastAckValid) {
+            uint64_t TimeSinceLastAck = QuicTimeDiff64(Cubic->TimeOfLastAck, TimeNow);
+            if (TimeSinceLastAck > Cc->SendIdleTimeoutMs &&
+                TimeSinceLastAck > US_TO_MS(Connection->Paths[0].SmoothedRtt + 4 * Connection->Paths[0].RttVariance)) {
+                Cubic->TimeOfCongAvoidStart += TimeSinceLastAck;
+                if (QuicTimeAtOrBefore64(TimeNow, Cubic->TimeOfCongAvoidStart)) {
+                    Cubic->TimeOfCongAvoidStart = TimeNow;
+                }
+            }
+        }
+
+        uint64_t TimeInCongAvoid =
+            QuicTimeDiff64(Cubic->TimeOfCongAvoidStart, QuicTimeMs64());
+        if (TimeInCongAvoid > UINT32_MAX) {
+            TimeInCongAvoid = UINT32_MAX;
+        }
+
+        //
+        // Compute the cubic window:
+        // W_cubic(t) = C*(t-K)^3 + WindowMax.
+        // (t in seconds; window sizes in MSS)
+        //
+        // NB: The RFC uses W_cubic(t+RTT) rather than W_cubic(t), so we
+        // add RTT to DeltaT.
+        //
+        // Here we have 30 bits' worth of right shift. This is to convert
+        // millisec^3 to sec^3. Each ten bit's worth of shift approximates
+        // a division by 1000. The order of operations is chosen to strike
+        // a balance between rounding error and overflow protection.
+        // With C = 0.4 and MTU=0xffff, we are safe from overflow for
+        // DeltaT < ~2.5M (about 30min).
+        //
+
+        int64_t DeltaT = TimeInCongAvoid - Cubic->KCubic + US_TO_MS(AckEvent->SmoothedRtt);
+
+        int64_t CubicWindow =
+            ((((DeltaT * DeltaT) >> 10) * DeltaT *
+              (int64_t)(Connection->Paths[0].Mtu * TEN_TIMES_C_CUBIC / 10)) >> 20) +
+            (int64_t)Cubic->WindowMax;
+
+        if (CubicWindow < 0) {
+            //
+            // The window came out so large it overflowed. We want to limit the
+            // huge window below anyway, so just set it to the limiting value.
+            //
+            CubicWindow = 2 * Cc->BytesInFlightMax;
+        }
+
+        //
+        // Compute the AIMD window (called W_est in the RFC):
+        // W_est(t) = WindowMax*BETA + [3*(1-BETA)/(1+BETA)] * (t/RTT).
+        // (again, window sizes in MSS)
+        //
+        // This is a window with linear growth which is designed
+        // to have the same average window size as an AIMD window
+        // with BETA=0.5 and a slope of 1MSS/RTT. Since our
+        // BETA is 0.7, we need a smaller slope than 1MSS/RTT to
+        // have this property.
+        //
+        // Also, for our value of BETA we have [3*(1-BETA)/(1+BETA)] ~= 0.5,
+        // so we simplify the calculation as:
+        // W_est(t) ~= WindowMax*BETA + (t/(2*RTT)).
+        //
+        // Using max(RTT, 1) prevents division by zero.
+        //
+
+        QUIC_STATIC_ASSERT(TEN_TIMES_BETA_CUBIC == 7, "TEN_TIMES_BETA_CUBIC must be 7 for simplified calculation.");
+
+        int64_t AimdWindow =
+            Cubic->WindowMax * TEN_TIMES_BETA_CUBIC / 10 +
+            TimeInCongAvoid * Connection->Paths[0].Mtu / (2 * max(1, US_TO_MS(AckEvent->SmoothedRtt)));
+
+        //
+        // Use the cubic or AIMD window, whichever is larger.
+        //
+        if (AimdWindow > CubicWindow) {
+            Cc->CongestionWindow = (uint32_t)max(AimdWindow, Cc->CongestionWindow + 1);
+        } else {
+            //
+            // Here we increment by a fraction of the difference, per the spec,
+            // rather than setting the window equal to CubicWindow. This helps
+            // prevent a burst when transitioning into congestion avoidance, since
+            // the cubic window may be significantly different from SlowStartThreshold.
+            //
+            Cc->CongestionWindow +=
+                (uint32_t)max(
+                    ((CubicWindow - Cc->CongestionWindow) * Connection->Paths[0].Mtu) / Cc->CongestionWindow,
+                    1);
+        }
+    }
+
+    //
+    // Limit the growth of the window based on the number of bytes we
+    // actually manage to put on the wire, which may be limited by flow
+    // control or by the app posting a limited number of bytes. This must
+    // be done to prevent the window from growing without loss feedback from
+    // the network.
+    //
+    // Using 2 * BytesInFlightMax for the limit allows for exponential growth
+    // in the window when not otherwise limited.
+    //
+    if (Cc->CongestionWindow > 2 * Cc->BytesInFlightMax) {
+        Cc->CongestionWindow = 2 * Cc->BytesInFlightMax;
+    }
+
+Exit:
+
+    Cubic->TimeOfLastAck = TimeNow;
+    Cubic->TimeOfLastAckValid = TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCubicOnDataLost(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t LargestPacketNumberLost,
+    _In_ uint64_t LargestPacketNumberSent,
+    _In_ uint32_t NumRetransmittableBytes,
+    _In_ BOOLEAN PersistentCongestion
+    )
+{
+    QUIC_CONGESTION_CONTROL_CUBIC* Cubic = &Cc->Cubic;
+    UNREFERENCED_PARAMETER(NumRetransmittableBytes);
+
+    //
+    // If data is lost after the most recent congestion event (or if there
+    // hasn't been a congestion event yet) then treat this loss as a new
+    // congestion event.
+    //
+    if (!Cubic->HasHadCongestionEvent ||
+        LargestPacketNumberLost > Cubic->RecoverySentPacketNumber) {
+
+        Cubic->RecoverySentPacketNumber = LargestPacketNumberSent;
+        QuicCubicOnCongestionEvent(Cc);
+
+        if (PersistentCongestion && !Cubic->IsInPersistentCongestion) {
+            QuicCubicOnPersistentCongestionEvent(Cc);
+        }
+    }
+
+    QuicConnLogCubic(QuicCongestionControlGetConnection(Cc));
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCubicOnEcn(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t LargestPacketNumberAcked,
+    _In_ uint64_t LargestPacketNumberSent
+    )
+{
+    QUIC_CONGESTION_CONTROL_CUBIC* Cubic = &Cc->Cubic;
+
+    //
+    // A CE mark is treated like a loss: only the first one reported after the
+    // most recent congestion event starts a new congestion event. Unlike loss,
+    // nothing left the network, so bytes in flight is unchanged.
+    //
+    if (!Cubic->HasHadCongestionEvent ||
+        LargestPacketNumberAcked > Cubic->RecoverySentPacketNumber) {
+
+        Cubic->RecoverySentPacketNumber = LargestPacketNumberSent;
+        QuicCongestionControlGetConnection(Cc)->Stats.Send.EcnCongestionCount++;
+        QuicCubicOnCongestionEvent(Cc);
+    }
+
+    QuicConnLogCubic(QuicCongestionControlGetConnection(Cc));
+}
+
+const QUIC_CONGESTION_CONTROL_DISPATCH QuicCongestionControlCubicDispatch = {
+    "CUBIC",
+    QuicCubicInitialize,
+    QuicCubicReset,
+    QuicCubicGetSendAllowance,
+    QuicCubicOnDataAcknowledged,
+    QuicCubicOnDataLost,
+    QuicCubicOnEcn
+};
@@ -1163,6 +1163,56 @@ QuicDatagramFrameDecode(
     return TRUE;
 }
 
+_Success_(return != FALSE)
+BOOLEAN
+QuicAckFrequencyFrameEncode(
+    _In_ const QUIC_ACK_FREQUENCY_EX * const Frame,
+    _Inout_ uint16_t* Offset,
+    _In_ uint16_t BufferLength,
+    _Out_writes_to_(BufferLength, *Offset) uint8_t* Buffer
+    )
+{
+    uint16_t RequiredLength =
+        QuicVarIntSize(QUIC_FRAME_ACK_FREQUENCY) +     // Type
+        QuicVarIntSize(Frame->SequenceNumber) +
+        QuicVarIntSize(Frame->AckElicitingThreshold) +
+        QuicVarIntSize(Frame->RequestedMaxAckDelay) +
+        QuicVarIntSize(Frame->ReorderingThreshold);
+
+    if (BufferLength < *Offset + RequiredLength) {
+        return FALSE;
+    }
+
+    Buffer = Buffer + *Offset;
+    Buffer = QuicVarIntEncode(QUIC_FRAME_ACK_FREQUENCY, Buffer);
+    Buffer = QuicVarIntEncode(Frame->SequenceNumber, Buffer);
+    Buffer = QuicVarIntEncode(Frame->AckElicitingThreshold, Buffer);
+    Buffer = QuicVarIntEncode(Frame->RequestedMaxAckDelay, Buffer);
+    Buffer = QuicVarIntEncode(Frame->ReorderingThreshold, Buffer);
+    *Offset += RequiredLength;
+
+    return TRUE;
+}
+
+_Success_(return != FALSE)
+BOOLEAN
+QuicAckFrequencyFrameDecode(
+    _In_ uint16_t BufferLength,
+    _In_reads_bytes_(BufferLength)
+        const uint8_t * const Buffer,
+    _Inout_ uint16_t* Offset,
+    _Out_ QUIC_ACK_FREQUENCY_EX* Frame
+    )
+{
+    if (!QuicVarIntDecode(BufferLength, Buffer, Offset, &Frame->SequenceNumber) ||
+        !QuicVarIntDecode(BufferLength, Buffer, Offset, &Frame->AckElicitingThreshold) ||
+        !QuicVarIntDecode(BufferLength, Buffer, Offset, &Frame->RequestedMaxAckDelay) ||
+        !QuicVarIntDecode(BufferLength, Buffer, Offset, &Frame->ReorderingThreshold)) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicFrameLog(
@@ -1175,19 +1225,26 @@ QuicFrameLog(
     _Inout_ uint16_t* Offset
     )
 {
-    QUIC_FRAME_TYPE FrameType = Packet[*Offset];
-    if (!QUIC_FRAME_IS_KNOWN(FrameType)) {
+    //
+    // Frame types are encoded as variable length integers. All but the
+    // extension frames fit in a single byte.
+    //
+    QUIC_VAR_INT FrameTypeValue = 0;
+    uint16_t TypeOffset = *Offset;
+    if (!QuicVarIntDecode(PacketLength, Packet, &TypeOffset, &FrameTypeValue) ||
+        !QUIC_FRAME_IS_KNOWN(FrameTypeValue)) {
         QuicTraceLogVerbose(
             FrameLogUnknownType,
             "[%c][%cX][%llu]   unknown frame (%hu)",
             PtkConnPre(Connection),
             PktRxPre(Rx),
             PacketNumber,
-            FrameType);
+            (uint16_t)FrameTypeValue);
         return FALSE;
     }
 
-    *Offset += 1;
+    QUIC_FRAME_TYPE FrameType = (QUIC_FRAME_TYPE)FrameTypeValue;
+    *Offset = TypeOffset;
 
     switch (FrameType) {
 
@@ -1733,6 +1790,40 @@ QuicFrameLog(
         break;
     }
 
+    case QUIC_FRAME_IMMEDIATE_ACK: {
+        QuicTraceLogVerbose(
+            FrameLogImmediateAck,
+            "[%c][%cX][%llu]   IMMEDIATE_ACK",
+            PtkConnPre(Connection),
+            PktRxPre(Rx),
+            PacketNumber);
+        break;
+    }
+
+    case QUIC_FRAME_ACK_FREQUENCY: {
+        QUIC_ACK_FREQUENCY_EX Frame;
+        if (!QuicAckFrequencyFrameDecode(PacketLength, Packet, Offset, &Frame)) {
+            QuicTraceLogVerbose(
+                FrameLogAckFrequencyInvalid,
+                "[%c][%cX][%llu]   ACK_FREQUENCY [Invalid]",
+                PtkConnPre(Connection),
+                PktRxPre(Rx),
+                PacketNumber);
+            return FALSE;
+        }
+        QuicTraceLogVerbose(
+            FrameLogAckFrequency,
+            "[%c][%cX][%llu]   ACK_FREQUENCY SeqNum:%llu Threshold:%llu MaxDelay:%llu Reorder:%llu",
+            PtkConnPre(Connection),
+            PktRxPre(Rx),
+            PacketNumber,
+            Frame.SequenceNumber,
+            Frame.AckElicitingThreshold,
+            Frame.RequestedMaxAckDelay,
+            Frame.ReorderingThreshold);
+        break;
+    }
+
     case QUIC_FRAME_DATAGRAM:
     case QUIC_FRAME_DATAGRAM_1: {
         QUIC_DATAGRAM_EX Frame;
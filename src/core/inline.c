@@ -95,6 +95,11 @@ QuicConnIsServer(
     _In_ const QUIC_CONNECTION * const Connection
     );
 
+BOOLEAN
+QuicConnIsOnWorkerThread(
+    _In_ const QUIC_CONNECTION * const Connection
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicConnTransportError(
@@ -140,6 +145,12 @@ QuicLibraryGetCurrentPartition(
     void
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LIBRARY_PP*
+QuicLibraryGetPerProc(
+    void
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 uint16_t
 QuicPartitionIdCreate(
@@ -220,6 +231,11 @@ QuicCryptoHasPendingCryptoFrame(
     _In_ QUIC_CRYPTO* Crypto
     );
 
+BOOLEAN
+QuicCryptoIsOffloadPending(
+    _In_ const QUIC_CRYPTO* Crypto
+    );
+
 void
 QuicCryptoCombineIvAndPacketNumber(
     _In_reads_bytes_(QUIC_IV_LENGTH)
@@ -297,6 +313,11 @@ QuicDatagramGetConnection(
     _In_ const QUIC_DATAGRAM* const Datagram
     );
 
+QUIC_CONNECTION*
+QuicSendBufferGetConnection(
+    _In_ QUIC_SEND_BUFFER* SendBuffer
+    );
+
 uint8_t
 QuicEncryptLevelToPacketType(
     QUIC_ENCRYPT_LEVEL Level
@@ -483,6 +504,11 @@ QuicPathDecrementAllowance(
     _In_ uint32_t Amount
     );
 
+BOOLEAN
+QuicPathOnEcnPacketLost(
+    _In_ QUIC_PATH* Path
+    );
+
 void
 QuicPktNumDecode(
     _In_ uint8_t PacketNumberLength,
@@ -648,6 +674,16 @@ QuicPacketTraceType(
     _In_ const QUIC_SENT_PACKET_METADATA* Metadata
     );
 
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetFirst(
+    _In_ const QUIC_SENT_PACKET_RING* Ring
+    );
+
+uint64_t
+QuicSentPacketRingGetEnd(
+    _In_ const QUIC_SENT_PACKET_RING* Ring
+    );
+
 int64_t
 QuicTimeEpochMs64(
     void
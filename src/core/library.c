@@ -221,8 +221,12 @@ MsQuicLibraryInitialize(
 
     MsQuicLibraryReadSettings(NULL); // NULL means don't update registrations.
 
+    QuicDispatchLockInitialize(&MsQuicLib.LookupEpochLock);
+    MsQuicLib.LookupEpoch = 0;
+    QuicZeroMemory(&MsQuicLib.LookupRetired, sizeof(MsQuicLib.LookupRetired));
+    QuicZeroMemory(&MsQuicLib.LookupPending, sizeof(MsQuicLib.LookupPending));
     QuicDispatchLockInitialize(&MsQuicLib.StatelessRetryKeysLock);
-    QuicZeroMemory(&MsQuicLib.StatelessRetryKeys, sizeof(MsQuicLib.StatelessRetryKeys));
+    QuicZeroMemory(&MsQuicLib.StatelessRetrySecrets, sizeof(MsQuicLib.StatelessRetrySecrets));
     QuicZeroMemory(&MsQuicLib.StatelessRetryKeysExpiration, sizeof(MsQuicLib.StatelessRetryKeysExpiration));
 
     //
@@ -278,6 +282,16 @@ MsQuicLibraryInitialize(
         QuicZeroMemory(
             &MsQuicLib.PerProc[i].PerfCounters,
             sizeof(MsQuicLib.PerProc[i].PerfCounters));
+        QuicZeroMemory(
+            &MsQuicLib.PerProc[i].LookupReaders,
+            sizeof(MsQuicLib.PerProc[i].LookupReaders));
+        QuicDispatchLockInitialize(&MsQuicLib.PerProc[i].StatelessRetryKeysLock);
+        QuicZeroMemory(
+            &MsQuicLib.PerProc[i].StatelessRetryKeys,
+            sizeof(MsQuicLib.PerProc[i].StatelessRetryKeys));
+        QuicZeroMemory(
+            &MsQuicLib.PerProc[i].StatelessRetryKeysExpiration,
+            sizeof(MsQuicLib.PerProc[i].StatelessRetryKeysExpiration));
     }
 
     Status =
@@ -325,6 +339,7 @@ Error:
                 QuicPoolUninitialize(&MsQuicLib.PerProc[i].ConnectionPool);
                 QuicPoolUninitialize(&MsQuicLib.PerProc[i].TransportParamPool);
                 QuicPoolUninitialize(&MsQuicLib.PerProc[i].PacketSpacePool);
+                QuicDispatchLockUninitialize(&MsQuicLib.PerProc[i].StatelessRetryKeysLock);
             }
             QUIC_FREE(MsQuicLib.PerProc, QUIC_POOL_PERPROC);
             MsQuicLib.PerProc = NULL;
@@ -409,19 +424,33 @@ MsQuicLibraryUninitialize(
     //
     QUIC_TEL_ASSERT(QuicListIsEmpty(&MsQuicLib.Bindings));
 
+    //
+    // Free any replaced lookup tables still waiting on a grace period.
+    //
+    QuicLookupSynchronize();
+
+    if (MsQuicLib.TlsPool != NULL) {
+        QuicTlsPoolUninitialize(MsQuicLib.TlsPool);
+        MsQuicLib.TlsPool = NULL;
+    }
+
     for (uint16_t i = 0; i < MsQuicLib.ProcessorCount; ++i) {
         QuicPoolUninitialize(&MsQuicLib.PerProc[i].ConnectionPool);
         QuicPoolUninitialize(&MsQuicLib.PerProc[i].TransportParamPool);
         QuicPoolUninitialize(&MsQuicLib.PerProc[i].PacketSpacePool);
+        for (uint8_t j = 0; j < ARRAYSIZE(MsQuicLib.PerProc[i].StatelessRetryKeys); ++j) {
+            QuicKeyFree(MsQuicLib.PerProc[i].StatelessRetryKeys[j]);
+        }
+        QuicDispatchLockUninitialize(&MsQuicLib.PerProc[i].StatelessRetryKeysLock);
     }
     QUIC_FREE(MsQuicLib.PerProc, QUIC_POOL_PERPROC);
     MsQuicLib.PerProc = NULL;
 
-    for (uint8_t i = 0; i < ARRAYSIZE(MsQuicLib.StatelessRetryKeys); ++i) {
-        QuicKeyFree(MsQuicLib.StatelessRetryKeys[i]);
-        MsQuicLib.StatelessRetryKeys[i] = NULL;
-    }
+    QuicSecureZeroMemory(
+        &MsQuicLib.StatelessRetrySecrets,
+        sizeof(MsQuicLib.StatelessRetrySecrets));
     QuicDispatchLockUninitialize(&MsQuicLib.StatelessRetryKeysLock);
+    QuicDispatchLockUninitialize(&MsQuicLib.LookupEpochLock);
 
     QuicTraceEvent(
         LibraryUninitialized,
@@ -655,6 +684,37 @@ QuicLibrarySetGlobalParam(
         break;
     }
 
+    case QUIC_PARAM_GLOBAL_EXECUTION_MODE: {
+
+        if (BufferLength != sizeof(uint16_t)) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (*(uint16_t*)Buffer > QUIC_EXECUTION_MODE_DATAPATH_INLINE) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.InUse &&
+            MsQuicLib.ExecutionMode != (QUIC_EXECUTION_MODE)*(uint16_t*)Buffer) {
+            QuicTraceLogError(
+                LibraryExecutionModeSetAfterInUse,
+                "[ lib] Tried to change execution mode after library in use!");
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        MsQuicLib.ExecutionMode = (QUIC_EXECUTION_MODE)*(uint16_t*)Buffer;
+        QuicTraceLogInfo(
+            LibraryExecutionModeSet,
+            "[ lib] Updated execution mode = %hu",
+            *(uint16_t*)Buffer);
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
     case QUIC_PARAM_GLOBAL_SETTINGS:
 
         if (BufferLength != sizeof(QUIC_SETTINGS)) {
@@ -778,6 +838,25 @@ QuicLibraryGetGlobalParam(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_GLOBAL_EXECUTION_MODE:
+
+        if (*BufferLength < sizeof(uint16_t)) {
+            *BufferLength = sizeof(uint16_t);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(uint16_t);
+        *(uint16_t*)Buffer = (uint16_t)MsQuicLib.ExecutionMode;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
     case QUIC_PARAM_GLOBAL_PERF_COUNTERS: {
 
         if (*BufferLength < sizeof(int64_t)) {
@@ -1168,6 +1247,8 @@ MsQuicOpen(
 
     Api->DatagramSend = MsQuicDatagramSend;
 
+    Api->StreamSendBatch = MsQuicStreamSendBatch;
+
     *QuicApi = Api;
 
 Error:
@@ -1502,6 +1583,30 @@ QuicLibraryGetWorker(
             Datagram->PartitionIndex % MsQuicLib.PartitionCount];
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Ret_maybenull_
+QUIC_TLS_POOL*
+QuicLibraryGetTlsPool(
+    void
+    )
+{
+    QUIC_TLS_POOL* TlsPool =
+        (QUIC_TLS_POOL*)ReadPointerAcquire((void**)&MsQuicLib.TlsPool);
+    if (TlsPool != NULL) {
+        return TlsPool;
+    }
+
+    QuicLockAcquire(&MsQuicLib.Lock);
+    if (MsQuicLib.TlsPool == NULL &&
+        QUIC_SUCCEEDED(QuicTlsPoolInitialize(MsQuicLib.PartitionCount, &TlsPool))) {
+        WritePointerRelease((void**)&MsQuicLib.TlsPool, TlsPool);
+    }
+    TlsPool = MsQuicLib.TlsPool;
+    QuicLockRelease(&MsQuicLib.Lock);
+
+    return TlsPool;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicTraceRundown(
@@ -1557,66 +1662,84 @@ QuicTraceRundown(
     QuicLockRelease(&MsQuicLib.Lock);
 }
 
+//
+// Copies out the library's stateless retry secret for the key interval,
+// generating it first if requested and it's newer than the one currently in
+// its slot. Returns FALSE if there is no secret for the interval.
+//
+// N.B. Each processor only needs to do this once per key interval, so the
+// lock isn't taken for every retry token.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
-_Ret_maybenull_
-QUIC_KEY*
-QuicLibraryGetStatelessRetryKeyForTimestamp(
-    _In_ int64_t Timestamp
+BOOLEAN
+QuicLibraryGetStatelessRetrySecret(
+    _In_ int64_t Interval,
+    _In_ BOOLEAN Generate,
+    _Out_writes_all_(QUIC_AEAD_AES_256_GCM_SIZE)
+        uint8_t* Secret
     )
 {
-    if (Timestamp < MsQuicLib.StatelessRetryKeysExpiration[!MsQuicLib.CurrentStatelessRetryKey] - QUIC_STATELESS_RETRY_KEY_LIFETIME_MS) {
-        //
-        // Timestamp is before the begining of the previous key's validity window.
-        //
-        return NULL;
-    } else if (Timestamp < MsQuicLib.StatelessRetryKeysExpiration[!MsQuicLib.CurrentStatelessRetryKey]) {
-        if (MsQuicLib.StatelessRetryKeys[!MsQuicLib.CurrentStatelessRetryKey] == NULL) {
-            return NULL;
-        }
-        return MsQuicLib.StatelessRetryKeys[!MsQuicLib.CurrentStatelessRetryKey];
-    } else if (Timestamp < MsQuicLib.StatelessRetryKeysExpiration[MsQuicLib.CurrentStatelessRetryKey]) {
-        if (MsQuicLib.StatelessRetryKeys[MsQuicLib.CurrentStatelessRetryKey] == NULL) {
-            return NULL;
-        }
-        return MsQuicLib.StatelessRetryKeys[MsQuicLib.CurrentStatelessRetryKey];
-    } else {
-        //
-        // Timestamp is after the end of the latest key's validity window.
-        //
-        return NULL;
+    const int64_t ExpirationTime =
+        (Interval + 1) * QUIC_STATELESS_RETRY_KEY_LIFETIME_MS;
+    const uint8_t Slot = (uint8_t)(Interval & 1);
+    BOOLEAN Found = FALSE;
+
+    QuicDispatchLockAcquire(&MsQuicLib.StatelessRetryKeysLock);
+
+    if (Generate &&
+        ExpirationTime > MsQuicLib.StatelessRetryKeysExpiration[Slot]) {
+        QuicRandom(
+            sizeof(MsQuicLib.StatelessRetrySecrets[Slot]),
+            MsQuicLib.StatelessRetrySecrets[Slot]);
+        MsQuicLib.StatelessRetryKeysExpiration[Slot] = ExpirationTime;
+    }
+
+    if (MsQuicLib.StatelessRetryKeysExpiration[Slot] == ExpirationTime) {
+        QuicCopyMemory(
+            Secret,
+            MsQuicLib.StatelessRetrySecrets[Slot],
+            QUIC_AEAD_AES_256_GCM_SIZE);
+        Found = TRUE;
     }
+
+    QuicDispatchLockRelease(&MsQuicLib.StatelessRetryKeysLock);
+
+    return Found;
 }
 
+//
+// Returns the processor's copy of the stateless retry key for the key
+// interval, creating it from the library's secret if necessary.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Ret_maybenull_
 QUIC_KEY*
-QuicLibraryGetCurrentStatelessRetryKey(
-    void
+QuicLibraryGetStatelessRetryKeyForInterval(
+    _In_ QUIC_LIBRARY_PP* PerProc,
+    _In_ int64_t Interval,
+    _In_ BOOLEAN Generate
     )
 {
-    int64_t Now = QuicTimeEpochMs64();
-    int64_t StartTime = (Now / QUIC_STATELESS_RETRY_KEY_LIFETIME_MS) * QUIC_STATELESS_RETRY_KEY_LIFETIME_MS;
+    const int64_t ExpirationTime =
+        (Interval + 1) * QUIC_STATELESS_RETRY_KEY_LIFETIME_MS;
+    const uint8_t Slot = (uint8_t)(Interval & 1);
 
-    if (StartTime < MsQuicLib.StatelessRetryKeysExpiration[MsQuicLib.CurrentStatelessRetryKey]) {
-        return MsQuicLib.StatelessRetryKeys[MsQuicLib.CurrentStatelessRetryKey];
+    if (PerProc->StatelessRetryKeysExpiration[Slot] == ExpirationTime) {
+        return PerProc->StatelessRetryKeys[Slot];
     }
 
-    //
-    // If the start time for the current key interval is greater-than-or-equal
-    // to the expiration time of the latest stateless retry key, generate a new
-    // key, and rotate the old.
-    //
-
-    int64_t ExpirationTime = StartTime + QUIC_STATELESS_RETRY_KEY_LIFETIME_MS;
+    uint8_t Secret[QUIC_AEAD_AES_256_GCM_SIZE];
+    if (!QuicLibraryGetStatelessRetrySecret(Interval, Generate, Secret)) {
+        return NULL;
+    }
 
     QUIC_KEY* NewKey;
-    uint8_t RawKey[QUIC_AEAD_AES_256_GCM_SIZE];
-    QuicRandom(sizeof(RawKey), RawKey);
     QUIC_STATUS Status =
         QuicKeyCreate(
             QUIC_AEAD_AES_256_GCM,
-            RawKey,
+            Secret,
             &NewKey);
+    QuicSecureZeroMemory(Secret, sizeof(Secret));
     if (QUIC_FAILED(Status)) {
         QuicTraceEvent(
             LibraryErrorStatus,
@@ -1626,14 +1749,54 @@ QuicLibraryGetCurrentStatelessRetryKey(
         return NULL;
     }
 
-    MsQuicLib.StatelessRetryKeysExpiration[!MsQuicLib.CurrentStatelessRetryKey] = ExpirationTime;
-    QuicKeyFree(MsQuicLib.StatelessRetryKeys[!MsQuicLib.CurrentStatelessRetryKey]);
-    MsQuicLib.StatelessRetryKeys[!MsQuicLib.CurrentStatelessRetryKey] = NewKey;
-    MsQuicLib.CurrentStatelessRetryKey = !MsQuicLib.CurrentStatelessRetryKey;
+    QuicKeyFree(PerProc->StatelessRetryKeys[Slot]);
+    PerProc->StatelessRetryKeys[Slot] = NewKey;
+    PerProc->StatelessRetryKeysExpiration[Slot] = ExpirationTime;
 
     return NewKey;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Ret_maybenull_
+QUIC_KEY*
+QuicLibraryGetStatelessRetryKeyForTimestamp(
+    _In_ QUIC_LIBRARY_PP* PerProc,
+    _In_ int64_t Timestamp
+    )
+{
+    const int64_t Interval = Timestamp / QUIC_STATELESS_RETRY_KEY_LIFETIME_MS;
+    const int64_t CurrentInterval =
+        QuicTimeEpochMs64() / QUIC_STATELESS_RETRY_KEY_LIFETIME_MS;
+
+    if (Timestamp < 0 || Interval > CurrentInterval || Interval + 1 < CurrentInterval) {
+        //
+        // Timestamp is outside the validity windows of the current and previous
+        // keys.
+        //
+        return NULL;
+    }
+
+    return QuicLibraryGetStatelessRetryKeyForInterval(PerProc, Interval, FALSE);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Ret_maybenull_
+QUIC_KEY*
+QuicLibraryGetCurrentStatelessRetryKey(
+    _In_ QUIC_LIBRARY_PP* PerProc
+    )
+{
+    //
+    // If the current key interval has no key yet, a new one is generated,
+    // replacing the one from two intervals ago.
+    //
+    return
+        QuicLibraryGetStatelessRetryKeyForInterval(
+            PerProc,
+            QuicTimeEpochMs64() / QUIC_STATELESS_RETRY_KEY_LIFETIME_MS,
+            TRUE);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicLibraryOnHandshakeConnectionAdded(
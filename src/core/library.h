@@ -61,6 +61,28 @@ typedef struct QUIC_CACHEALIGN QUIC_LIBRARY_PP {
     //
     int64_t PerfCounters[QUIC_PERF_COUNTER_MAX];
 
+    //
+    // Number of lookup readers currently running on this processor, indexed
+    // by the parity of the lookup epoch they entered in.
+    //
+    long LookupReaders[2];
+
+    //
+    // Serializes use of this processor's copies of the stateless retry keys.
+    //
+    QUIC_DISPATCH_LOCK StatelessRetryKeysLock;
+
+    //
+    // This processor's copies of the keys used for encryption of stateless
+    // retry tokens, indexed by the parity of their key interval.
+    //
+    QUIC_KEY* StatelessRetryKeys[2];
+
+    //
+    // Timestamp when each of this processor's stateless retry keys expires.
+    //
+    int64_t StatelessRetryKeysExpiration[2];
+
 } QUIC_LIBRARY_PP;
 
 //
@@ -88,14 +110,14 @@ typedef struct QUIC_LIBRARY {
     BOOLEAN InUse;
 
     //
-    // Indicates if the stateless retry feature is currently enabled.
+    // How the workers of (low latency) registrations are run.
     //
-    BOOLEAN SendRetryEnabled;
+    QUIC_EXECUTION_MODE ExecutionMode;
 
     //
-    // Index for the current stateless retry token key.
+    // Indicates if the stateless retry feature is currently enabled.
     //
-    BOOLEAN CurrentStatelessRetryKey;
+    BOOLEAN SendRetryEnabled;
 
     //
     // Configurable (app & registry) settings.
@@ -196,6 +218,12 @@ typedef struct QUIC_LIBRARY {
     //
     QUIC_REGISTRATION* StatelessRegistration;
 
+    //
+    // Threads for offloaded TLS handshake processing. Lazily created the first
+    // time a connection offloads.
+    //
+    QUIC_TLS_POOL* TlsPool;
+
     //
     // Per-processor storage. Count of `PartitionCount`.
     //
@@ -203,17 +231,42 @@ typedef struct QUIC_LIBRARY {
     QUIC_LIBRARY_PP* PerProc;
 
     //
-    // Controls access to the stateless retry keys when rotated.
+    // Serializes lookup grace periods (see QuicLookupSynchronize).
+    //
+    QUIC_DISPATCH_LOCK LookupEpochLock;
+
+    //
+    // The current lookup epoch. Incremented at the start of each grace period.
+    //
+    long LookupEpoch;
+
+    //
+    // Lookup entries removed since the last grace period started. Protected
+    // by LookupEpochLock.
+    //
+    QUIC_LOOKUP_RETIRED LookupRetired;
+
+    //
+    // Lookup entries waiting for the grace period that started when the epoch
+    // was incremented from LookupPendingEpoch to complete. Protected by
+    // LookupEpochLock.
+    //
+    QUIC_LOOKUP_RETIRED LookupPending;
+    long LookupPendingEpoch;
+
+    //
+    // Controls access to the stateless retry secrets when rotated.
     //
     QUIC_DISPATCH_LOCK StatelessRetryKeysLock;
 
     //
-    // Keys used for encryption of stateless retry tokens.
+    // Secrets the (per-processor) stateless retry keys are created from,
+    // indexed by the parity of their key interval.
     //
-    QUIC_KEY* StatelessRetryKeys[2];
+    uint8_t StatelessRetrySecrets[2][QUIC_AEAD_AES_256_GCM_SIZE];
 
     //
-    // Timestamp when the current stateless retry key expires.
+    // Timestamp when each stateless retry secret expires.
     //
     int64_t StatelessRetryKeysExpiration[2];
 
@@ -480,22 +533,49 @@ QuicLibraryGetWorker(
     );
 
 //
-// Returns the current stateless retry key.
+// Returns the TLS pool, creating it if necessary. Returns NULL if the pool
+// couldn't be created.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Ret_maybenull_
+QUIC_TLS_POOL*
+QuicLibraryGetTlsPool(
+    void
+    );
+
+//
+// Returns the per-processor library state for the current processor.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+inline
+QUIC_LIBRARY_PP*
+QuicLibraryGetPerProc(
+    void
+    )
+{
+    return &MsQuicLib.PerProc[QuicProcCurrentNumber() % MsQuicLib.ProcessorCount];
+}
+
+//
+// Returns the processor's copy of the current stateless retry key. Must be
+// called with the processor's StatelessRetryKeysLock held.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Ret_maybenull_
 QUIC_KEY*
 QuicLibraryGetCurrentStatelessRetryKey(
-    void
+    _In_ QUIC_LIBRARY_PP* PerProc
     );
 
 //
-// Returns the stateless retry key for that timestamp.
+// Returns the processor's copy of the stateless retry key for that timestamp.
+// Must be called with the processor's StatelessRetryKeysLock held.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Ret_maybenull_
 QUIC_KEY*
 QuicLibraryGetStatelessRetryKeyForTimestamp(
+    _In_ QUIC_LIBRARY_PP* PerProc,
     _In_ int64_t Timestamp
     );
 
@@ -14,13 +14,49 @@ Abstract:
 #include "lookup.c.clog.h"
 #endif
 
+//
+// The bucket array of a QUIC_LOOKUP_TABLE. Replaced as a whole (and freed
+// after a grace period) when the table is resized.
+//
+typedef struct QUIC_LOOKUP_BUCKETS {
+
+    QUIC_SINGLE_LIST_ENTRY RetireLink;
+
+    //
+    // Which of the entries' links (QUIC_LOOKUP_ENTRY.Next) this array uses.
+    //
+    uint8_t Link;
+
+    //
+    // Number of buckets minus one. The number of buckets is a power of 2.
+    //
+    uint32_t Mask;
+
+    QUIC_LOOKUP_ENTRY* Heads[0];
+
+} QUIC_LOOKUP_BUCKETS;
+
 typedef struct QUIC_CACHEALIGN QUIC_PARTITIONED_HASHTABLE {
 
-    QUIC_DISPATCH_RW_LOCK RwLock;
-    QUIC_HASHTABLE Table;
+    QUIC_LOOKUP_TABLE Table;
 
 } QUIC_PARTITIONED_HASHTABLE;
 
+//
+// The set of partitioned hash tables. Published as a whole so that readers
+// always see a table array consistent with its count.
+//
+typedef struct QUIC_LOOKUP_PARTITIONS {
+
+    QUIC_SINGLE_LIST_ENTRY RetireLink;
+
+    uint16_t Count;
+
+    _Field_size_(Count)
+    QUIC_PARTITIONED_HASHTABLE Tables[0];
+
+} QUIC_LOOKUP_PARTITIONS;
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicLookupInsertLocalCid(
@@ -30,88 +66,544 @@ QuicLookupInsertLocalCid(
     _In_ BOOLEAN UpdateRefCount
     );
 
+//
+// Lookup read sections are tracked with per-processor reader counts, split by
+// the parity of the global lookup epoch. A reader increments the count of the
+// processor it starts on and decrements that same count when done. Where the
+// IRQL can't be raised (user mode), it may have moved to another processor in
+// between, so the counts are shared and only updated with interlocked
+// operations. A grace period flips the epoch parity and then waits for the
+// counts of the previous parity to drain on all processors.
+//
+// Writers usually don't wait on grace periods themselves. Removed entries are
+// retired to a library-wide set instead, which the workers free in batches,
+// once the grace period started after their removal has completed
+// (QuicLookupReclaim). Only if that set grows too large, because readers keep
+// holding up grace periods, does the writer wait (QuicLookupLimitRetired).
+//
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+long*
+QuicLookupReadBegin(
+    _Out_ QUIC_IRQL* PrevIrql
+    )
+{
+    QuicIrqlRaiseToDispatch(PrevIrql);
+
+    QUIC_LIBRARY_PP* PerProc =
+        &MsQuicLib.PerProc[QuicProcCurrentNumber() % MsQuicLib.ProcessorCount];
+
+    while (TRUE) {
+        long Epoch = ReadAcquire(&MsQuicLib.LookupEpoch);
+        long* Readers = &PerProc->LookupReaders[Epoch & 1];
+        InterlockedIncrement(Readers);
+        if (ReadAcquire(&MsQuicLib.LookupEpoch) == Epoch) {
+            return Readers;
+        }
+        //
+        // A grace period started in the meantime and may have already checked
+        // this count. Retry with the new epoch.
+        //
+        InterlockedDecrement(Readers);
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
-QuicLookupInitialize(
-    _Inout_ QUIC_LOOKUP* Lookup
+QuicLookupReadEnd(
+    _In_ long* Readers,
+    _In_ QUIC_IRQL PrevIrql
     )
 {
-    QuicZeroMemory(Lookup, sizeof(QUIC_LOOKUP));
-    QuicDispatchRwLockInitialize(&Lookup->RwLock);
+    InterlockedDecrement(Readers);
+    QuicIrqlLower(PrevIrql);
 }
 
+//
+// Returns TRUE if all read sections entered with the parity of the given epoch
+// have completed.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLookupReadersDrained(
+    _In_ long Epoch
+    )
+{
+    for (uint16_t i = 0; i < MsQuicLib.ProcessorCount; ++i) {
+        if (ReadAcquire(&MsQuicLib.PerProc[i].LookupReaders[Epoch & 1]) != 0) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+//
+// Adds an entry, already removed from its table, to the retired set.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
-QuicLookupUninitialize(
-    _In_ QUIC_LOOKUP* Lookup
+QuicLookupRetire(
+    _Inout_ QUIC_SINGLE_LIST_ENTRY* RetiredList,
+    _In_ QUIC_SINGLE_LIST_ENTRY* Link
     )
 {
-    QUIC_DBG_ASSERT(Lookup->CidCount == 0);
+    QuicDispatchLockAcquire(&MsQuicLib.LookupEpochLock);
+    QuicListPushEntry(RetiredList, Link);
+    MsQuicLib.LookupRetired.Count++;
+    QuicDispatchLockRelease(&MsQuicLib.LookupEpochLock);
+}
 
-    if (Lookup->PartitionCount == 0) {
-        QUIC_DBG_ASSERT(Lookup->SINGLE.Connection == NULL);
+//
+// Bounds the retired set, by waiting for a grace period if it has grown past
+// QUIC_LOOKUP_RETIRED_MAX. Must be called outside of any lookup lock.
+//
+// N.B. The counts are read without the lock, only as a hint.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupLimitRetired(
+    void
+    )
+{
+    if (MsQuicLib.LookupRetired.Count + MsQuicLib.LookupPending.Count >=
+        QUIC_LOOKUP_RETIRED_MAX) {
+        QuicLookupSynchronize();
+    }
+}
+
+//
+// Releases the lookup table reference a retired entry held on its connection.
+// The reclaiming worker may be running on a datapath thread, so the final
+// release is left to the connection's own worker (see QuicConnRelease).
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupReleaseConnection(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    if (Connection->Worker != NULL) {
+        QuicConnAddRef(Connection, QUIC_CONN_REF_LOOKUP_RESULT);
+        QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
+        QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_RESULT);
     } else {
-        QUIC_DBG_ASSERT(Lookup->HASH.Tables != NULL);
-        for (uint16_t i = 0; i < Lookup->PartitionCount; i++) {
-            QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[i];
-            QUIC_DBG_ASSERT(Table->Table.NumEntries == 0);
-#pragma warning(push)
-#pragma warning(disable:6001)
-            QuicHashtableUninitialize(&Table->Table);
-#pragma warning(pop)
-            QuicDispatchRwLockUninitialize(&Table->RwLock);
+        QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupPartitionsFree(
+    _In_ QUIC_LOOKUP_PARTITIONS* Partitions
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupFreeRetired(
+    _Inout_ QUIC_LOOKUP_RETIRED* Retired
+    )
+{
+    while (Retired->Cids.Next != NULL) {
+        QUIC_CID_HASH_ENTRY* CID =
+            QUIC_CONTAINING_RECORD(
+                QuicListPopEntry(&Retired->Cids),
+                QUIC_CID_HASH_ENTRY,
+                Link);
+        QUIC_CONNECTION* Connection = CID->Connection;
+        QUIC_FREE(CID, QUIC_POOL_CIDHASH);
+        QuicLookupReleaseConnection(Connection);
+    }
+
+    while (Retired->RemoteHashes.Next != NULL) {
+        QUIC_REMOTE_HASH_ENTRY* Entry =
+            QUIC_CONTAINING_RECORD(
+                QuicListPopEntry(&Retired->RemoteHashes),
+                QUIC_REMOTE_HASH_ENTRY,
+                Link);
+        QUIC_CONNECTION* Connection = Entry->Connection;
+        QUIC_FREE(Entry, QUIC_POOL_REMOTE_HASH);
+        QuicLookupReleaseConnection(Connection);
+    }
+
+    while (Retired->Buckets.Next != NULL) {
+        QUIC_FREE(
+            QUIC_CONTAINING_RECORD(
+                QuicListPopEntry(&Retired->Buckets),
+                QUIC_LOOKUP_BUCKETS,
+                RetireLink),
+            QUIC_POOL_LOOKUP_HASHTABLE);
+    }
+
+    while (Retired->Partitions.Next != NULL) {
+        QuicLookupPartitionsFree(
+            QUIC_CONTAINING_RECORD(
+                QuicListPopEntry(&Retired->Partitions),
+                QUIC_LOOKUP_PARTITIONS,
+                RetireLink));
+    }
+
+    Retired->Count = 0;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupSynchronize(
+    void
+    )
+{
+    QUIC_LOOKUP_RETIRED Pending;
+    QUIC_LOOKUP_RETIRED Retired;
+
+    QuicDispatchLockAcquire(&MsQuicLib.LookupEpochLock);
+
+    //
+    // Complete the grace period already in progress (if any) first, so that
+    // the parity flipped to next has no readers left from before.
+    //
+    if (MsQuicLib.LookupPending.Count != 0) {
+        while (!QuicLookupReadersDrained(MsQuicLib.LookupPendingEpoch)) {
+            YieldProcessor();
         }
-        QUIC_FREE(Lookup->HASH.Tables, QUIC_POOL_LOOKUP_HASHTABLE);
     }
+    Pending = MsQuicLib.LookupPending;
+    QuicZeroMemory(&MsQuicLib.LookupPending, sizeof(MsQuicLib.LookupPending));
 
-    if (Lookup->MaximizePartitioning) {
-        QUIC_DBG_ASSERT(Lookup->RemoteHashTable.NumEntries == 0);
-        QuicHashtableUninitialize(&Lookup->RemoteHashTable);
+    long Epoch = InterlockedIncrement(&MsQuicLib.LookupEpoch) - 1;
+    while (!QuicLookupReadersDrained(Epoch)) {
+        YieldProcessor();
     }
+    Retired = MsQuicLib.LookupRetired;
+    QuicZeroMemory(&MsQuicLib.LookupRetired, sizeof(MsQuicLib.LookupRetired));
 
-    QuicDispatchRwLockUninitialize(&Lookup->RwLock);
+    QuicDispatchLockRelease(&MsQuicLib.LookupEpochLock);
+
+    QuicLookupFreeRetired(&Pending);
+    QuicLookupFreeRetired(&Retired);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLookupReclaim(
+    void
+    )
+{
+    QUIC_LOOKUP_RETIRED Completed;
+    QuicZeroMemory(&Completed, sizeof(Completed));
+
+    QuicDispatchLockAcquire(&MsQuicLib.LookupEpochLock);
+
+    if (MsQuicLib.LookupPending.Count != 0 &&
+        QuicLookupReadersDrained(MsQuicLib.LookupPendingEpoch)) {
+        Completed = MsQuicLib.LookupPending;
+        QuicZeroMemory(&MsQuicLib.LookupPending, sizeof(MsQuicLib.LookupPending));
+    }
+
+    if (MsQuicLib.LookupPending.Count == 0 && MsQuicLib.LookupRetired.Count != 0) {
+        //
+        // Start a grace period for everything retired so far. Only one is
+        // tracked at a time, so the previous one must have completed.
+        //
+        MsQuicLib.LookupPendingEpoch = InterlockedIncrement(&MsQuicLib.LookupEpoch) - 1;
+        MsQuicLib.LookupPending = MsQuicLib.LookupRetired;
+        QuicZeroMemory(&MsQuicLib.LookupRetired, sizeof(MsQuicLib.LookupRetired));
+    }
+
+    BOOLEAN MoreToReclaim = MsQuicLib.LookupPending.Count != 0;
+
+    QuicDispatchLockRelease(&MsQuicLib.LookupEpochLock);
+
+    QuicLookupFreeRetired(&Completed);
+
+    return MoreToReclaim;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_BUCKETS*
+QuicLookupBucketsAlloc(
+    _In_ uint32_t BucketCount,
+    _In_ uint8_t Link
+    )
+{
+    QUIC_DBG_ASSERT((BucketCount & (BucketCount - 1)) == 0);
+    QUIC_LOOKUP_BUCKETS* Buckets =
+        QUIC_ALLOC_NONPAGED(
+            sizeof(QUIC_LOOKUP_BUCKETS) + BucketCount * sizeof(QUIC_LOOKUP_ENTRY*),
+            QUIC_POOL_LOOKUP_HASHTABLE);
+    if (Buckets != NULL) {
+        Buckets->Link = Link;
+        Buckets->Mask = BucketCount - 1;
+        QuicZeroMemory(Buckets->Heads, BucketCount * sizeof(QUIC_LOOKUP_ENTRY*));
+    }
+    return Buckets;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLookupTableInitialize(
+    _Out_ QUIC_LOOKUP_TABLE* Table,
+    _In_ uint8_t Link
+    )
+{
+    QUIC_LOOKUP_BUCKETS* Buckets = QuicLookupBucketsAlloc(QUIC_HASH_MIN_SIZE, Link);
+    Table->NumEntries = 0;
+    WritePointerRelease((void**)&Table->Buckets, Buckets);
+    return Buckets != NULL;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupTableUninitialize(
+    _Inout_ QUIC_LOOKUP_TABLE* Table
+    )
+{
+    if (Table->Buckets != NULL) {
+        QUIC_FREE(Table->Buckets, QUIC_POOL_LOOKUP_HASHTABLE);
+        Table->Buckets = NULL;
+    }
+}
+
+//
+// Returns the first entry in the table with the given hash, or NULL. Requires
+// a read section or the writer's lock.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_ENTRY*
+QuicLookupTableLookup(
+    _In_ QUIC_LOOKUP_TABLE* Table,
+    _In_ uint32_t Hash,
+    _Out_ uint8_t* Link
+    )
+{
+    QUIC_LOOKUP_BUCKETS* Buckets =
+        (QUIC_LOOKUP_BUCKETS*)ReadPointerAcquire((void**)&Table->Buckets);
+    if (Buckets == NULL) {
+        *Link = 0;
+        return NULL;
+    }
+
+    *Link = Buckets->Link;
+    QUIC_LOOKUP_ENTRY* Entry =
+        (QUIC_LOOKUP_ENTRY*)ReadPointerAcquire((void**)&Buckets->Heads[Hash & Buckets->Mask]);
+    while (Entry != NULL && Entry->Hash != Hash) {
+        Entry = (QUIC_LOOKUP_ENTRY*)ReadPointerAcquire((void**)&Entry->Next[*Link]);
+    }
+    return Entry;
+}
+
+//
+// Returns the next entry after Entry with the given hash, or NULL.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_ENTRY*
+QuicLookupTableLookupNext(
+    _In_ QUIC_LOOKUP_ENTRY* Entry,
+    _In_ uint32_t Hash,
+    _In_ uint8_t Link
+    )
+{
+    do {
+        Entry = (QUIC_LOOKUP_ENTRY*)ReadPointerAcquire((void**)&Entry->Next[Link]);
+    } while (Entry != NULL && Entry->Hash != Hash);
+    return Entry;
 }
 
 //
-// Allocates and initializes a new partitioned hash table.
+// Links the entry into the table without ever resizing it.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupTableLink(
+    _Inout_ QUIC_LOOKUP_TABLE* Table,
+    _Inout_ QUIC_LOOKUP_ENTRY* Entry,
+    _In_ uint32_t Hash
+    )
+{
+    QUIC_LOOKUP_BUCKETS* Buckets = Table->Buckets;
+    QUIC_LOOKUP_ENTRY** Head = &Buckets->Heads[Hash & Buckets->Mask];
+    Entry->Hash = Hash;
+    Entry->Next[Buckets->Link] = *Head;
+    WritePointerRelease((void**)Head, Entry);
+    Table->NumEntries++;
+}
+
+//
+// Moves all entries to a new bucket array, linked through the other link so
+// that concurrent readers can keep walking the old one. The old array is
+// freed after a grace period.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
-QuicLookupCreateHashTable(
-    _In_ QUIC_LOOKUP* Lookup,
-    _In_range_(>, 0) uint16_t PartitionCount
+QuicLookupTableResize(
+    _Inout_ QUIC_LOOKUP_TABLE* Table,
+    _In_ uint32_t BucketCount
+    )
+{
+    QUIC_LOOKUP_BUCKETS* OldBuckets = Table->Buckets;
+    QUIC_LOOKUP_BUCKETS* NewBuckets =
+        QuicLookupBucketsAlloc(BucketCount, !OldBuckets->Link);
+    if (NewBuckets == NULL) {
+        return FALSE;
+    }
+
+    for (uint32_t i = 0; i <= OldBuckets->Mask; ++i) {
+        for (QUIC_LOOKUP_ENTRY* Entry = OldBuckets->Heads[i];
+            Entry != NULL;
+            Entry = Entry->Next[OldBuckets->Link]) {
+            QUIC_LOOKUP_ENTRY** Head = &NewBuckets->Heads[Entry->Hash & NewBuckets->Mask];
+            Entry->Next[NewBuckets->Link] = *Head;
+            *Head = Entry;
+        }
+    }
+
+    WritePointerRelease((void**)&Table->Buckets, NewBuckets);
+    QuicLookupRetire(&MsQuicLib.LookupRetired.Buckets, &OldBuckets->RetireLink);
+
+    return TRUE;
+}
+
+//
+// Inserts the entry into the table, growing it if it has gotten too full.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupTableInsert(
+    _Inout_ QUIC_LOOKUP_TABLE* Table,
+    _Inout_ QUIC_LOOKUP_ENTRY* Entry,
+    _In_ uint32_t Hash
+    )
+{
+    QuicLookupTableLink(Table, Entry, Hash);
+
+    uint32_t BucketCount = Table->Buckets->Mask + 1;
+    if (Table->NumEntries > BucketCount && BucketCount < 0x80000000u) {
+        //
+        // Failing to grow isn't fatal; the chains just get longer.
+        //
+        (void)QuicLookupTableResize(Table, BucketCount * 2);
+    }
+}
+
+//
+// Unlinks the entry from the table. The entry's own links are left intact for
+// concurrent readers, so it must not be freed or reinserted until after a
+// grace period.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupTableRemove(
+    _Inout_ QUIC_LOOKUP_TABLE* Table,
+    _In_ QUIC_LOOKUP_ENTRY* Entry
+    )
+{
+    QUIC_LOOKUP_BUCKETS* Buckets = Table->Buckets;
+    QUIC_LOOKUP_ENTRY** Prev = &Buckets->Heads[Entry->Hash & Buckets->Mask];
+    while (*Prev != Entry) {
+        QUIC_DBG_ASSERT(*Prev != NULL);
+        Prev = &(*Prev)->Next[Buckets->Link];
+    }
+    WritePointerRelease((void**)Prev, Entry->Next[Buckets->Link]);
+    QUIC_DBG_ASSERT(Table->NumEntries != 0);
+    Table->NumEntries--;
+}
+
+//
+// Allocates a new set of partitioned hash tables.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_PARTITIONS*
+QuicLookupPartitionsAlloc(
+    _In_range_(>, 0) uint16_t PartitionCount,
+    _In_ uint8_t Link
     )
 {
-    QUIC_DBG_ASSERT(Lookup->LookupTable == NULL);
     QUIC_FRE_ASSERT(PartitionCount > 0);
 
-    Lookup->HASH.Tables =
+    QUIC_LOOKUP_PARTITIONS* Partitions =
         QUIC_ALLOC_NONPAGED(
-            sizeof(QUIC_PARTITIONED_HASHTABLE) * PartitionCount,
+            sizeof(QUIC_LOOKUP_PARTITIONS) +
+                sizeof(QUIC_PARTITIONED_HASHTABLE) * PartitionCount,
             QUIC_POOL_LOOKUP_HASHTABLE);
 
-    if (Lookup->HASH.Tables != NULL) {
-
-        uint16_t Cleanup = 0;
+    if (Partitions != NULL) {
+        Partitions->Count = PartitionCount;
         for (uint16_t i = 0; i < PartitionCount; i++) {
-            if (!QuicHashtableInitializeEx(&Lookup->HASH.Tables[i].Table, QUIC_HASH_MIN_SIZE)) {
-                Cleanup = i;
+            if (!QuicLookupTableInitialize(&Partitions->Tables[i].Table, Link)) {
+                for (uint16_t j = 0; j < i; j++) {
+                    QuicLookupTableUninitialize(&Partitions->Tables[j].Table);
+                }
+                QUIC_FREE(Partitions, QUIC_POOL_LOOKUP_HASHTABLE);
+                Partitions = NULL;
                 break;
             }
-            QuicDispatchRwLockInitialize(&Lookup->HASH.Tables[i].RwLock);
         }
-        if (Cleanup != 0) {
-            for (uint16_t i = 0; i < Cleanup; i++) {
-                QuicHashtableUninitialize(&Lookup->HASH.Tables[i].Table);
-            }
-            QUIC_FREE(Lookup->HASH.Tables, QUIC_POOL_LOOKUP_HASHTABLE);
-            Lookup->HASH.Tables = NULL;
-        } else {
-            Lookup->PartitionCount = PartitionCount;
+    }
+
+    return Partitions;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupPartitionsFree(
+    _In_ QUIC_LOOKUP_PARTITIONS* Partitions
+    )
+{
+    for (uint16_t i = 0; i < Partitions->Count; i++) {
+        QuicLookupTableUninitialize(&Partitions->Tables[i].Table);
+    }
+    QUIC_FREE(Partitions, QUIC_POOL_LOOKUP_HASHTABLE);
+}
+
+//
+// Uses the partition ID in the connection ID to find its hash table.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_TABLE*
+QuicLookupGetPartition(
+    _In_ QUIC_LOOKUP_PARTITIONS* Partitions,
+    _In_reads_(MsQuicLib.CidServerIdLength + MSQUIC_CID_PID_LENGTH)
+        const uint8_t* const CID
+    )
+{
+    QUIC_STATIC_ASSERT(MSQUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
+    uint16_t PartitionIndex;
+    QuicCopyMemory(&PartitionIndex, CID + MsQuicLib.CidServerIdLength, 2);
+    PartitionIndex &= MsQuicLib.PartitionMask;
+    PartitionIndex %= Partitions->Count;
+    return &Partitions->Tables[PartitionIndex].Table;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupInitialize(
+    _Inout_ QUIC_LOOKUP* Lookup
+    )
+{
+    QuicZeroMemory(Lookup, sizeof(QUIC_LOOKUP));
+    QuicDispatchRwLockInitialize(&Lookup->RwLock);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupUninitialize(
+    _In_ QUIC_LOOKUP* Lookup
+    )
+{
+    QUIC_DBG_ASSERT(Lookup->CidCount == 0);
+
+    if (Lookup->PartitionCount == 0) {
+        QUIC_DBG_ASSERT(Lookup->SINGLE.Connection == NULL);
+    } else {
+        QUIC_DBG_ASSERT(Lookup->HASH.Partitions != NULL);
+        for (uint16_t i = 0; i < Lookup->HASH.Partitions->Count; i++) {
+            QUIC_DBG_ASSERT(Lookup->HASH.Partitions->Tables[i].Table.NumEntries == 0);
         }
+        QuicLookupPartitionsFree(Lookup->HASH.Partitions);
     }
 
-    return Lookup->HASH.Tables != NULL;
+    QUIC_DBG_ASSERT(Lookup->RemoteHashTable.NumEntries == 0);
+    QuicLookupTableUninitialize(&Lookup->RemoteHashTable);
+
+    QuicDispatchRwLockUninitialize(&Lookup->RwLock);
 }
 
 //
@@ -152,14 +644,23 @@ QuicLookupRebalance(
 
     if (PartitionCount > Lookup->PartitionCount) {
 
-        uint16_t PreviousPartitionCount = Lookup->PartitionCount;
-        void* PreviousLookup = Lookup->LookupTable;
-        Lookup->LookupTable = NULL;
+        QUIC_LOOKUP_PARTITIONS* PreviousPartitions = Lookup->HASH.Partitions;
 
         QUIC_DBG_ASSERT(PartitionCount != 0);
 
-        if (!QuicLookupCreateHashTable(Lookup, PartitionCount)) {
-            Lookup->LookupTable = PreviousLookup;
+        //
+        // Partitioning only ever goes from none, to a single table, to the
+        // maximum; so there is at most one previous table. The new tables use
+        // its other link, leaving it intact for concurrent readers.
+        //
+        QUIC_DBG_ASSERT(PreviousPartitions == NULL || PreviousPartitions->Count == 1);
+        uint8_t Link =
+            PreviousPartitions == NULL ?
+                0 : !PreviousPartitions->Tables[0].Table.Buckets->Link;
+
+        QUIC_LOOKUP_PARTITIONS* Partitions =
+            QuicLookupPartitionsAlloc(PartitionCount, Link);
+        if (Partitions == NULL) {
             return FALSE;
         }
 
@@ -167,16 +668,16 @@ QuicLookupRebalance(
         // Move the CIDs to the new table.
         //
 
-        if (PreviousPartitionCount == 0) {
+        if (PreviousPartitions == NULL) {
 
             //
             // Only a single connection before. Enumerate all CIDs on the
-            // connection and reinsert them into the new table(s).
+            // connection and insert them into the new table(s).
             //
 
-            if (PreviousLookup != NULL) {
+            if (Lookup->SINGLE.Connection != NULL) {
                 QUIC_SINGLE_LIST_ENTRY* Entry =
-                    ((QUIC_CONNECTION*)PreviousLookup)->SourceCids.Next;
+                    Lookup->SINGLE.Connection->SourceCids.Next;
 
                 while (Entry != NULL) {
                     QUIC_CID_HASH_ENTRY *CID =
@@ -184,11 +685,10 @@ QuicLookupRebalance(
                             Entry,
                             QUIC_CID_HASH_ENTRY,
                             Link);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        QuicHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
+                    QuicLookupTableLink(
+                        QuicLookupGetPartition(Partitions, CID->CID.Data),
+                        &CID->Entry,
+                        QuicHashSimple(CID->CID.Length, CID->CID.Data));
                     Entry = Entry->Next;
                 }
             }
@@ -196,43 +696,38 @@ QuicLookupRebalance(
         } else {
 
             //
-            // Changes the number of partitioned tables. Remove all the CIDs
-            // from the old tables and insert them into the new tables.
+            // Changes the number of partitioned tables. Link all the CIDs from
+            // the old tables into the new tables.
             //
 
-            QUIC_PARTITIONED_HASHTABLE* PreviousTable = PreviousLookup;
-            for (uint16_t i = 0; i < PreviousPartitionCount; i++) {
-                QUIC_HASHTABLE_ENTRY* Entry;
-                QUIC_HASHTABLE_ENUMERATOR Enumerator;
-#pragma warning(push)
-#pragma warning(disable:6001)
-                QuicHashtableEnumerateBegin(&PreviousTable[i].Table, &Enumerator);
-#pragma warning(pop)
-                while (TRUE) {
-                    Entry = QuicHashtableEnumerateNext(&PreviousTable[i].Table, &Enumerator);
-                    if (Entry == NULL) {
-                        QuicHashtableEnumerateEnd(&PreviousTable[i].Table, &Enumerator);
-                        break;
-                    }
-                    QuicHashtableRemove(&PreviousTable[i].Table, Entry, NULL);
-
-                    QUIC_CID_HASH_ENTRY *CID =
-                        QUIC_CONTAINING_RECORD(
+            for (uint16_t i = 0; i < PreviousPartitions->Count; i++) {
+                QUIC_LOOKUP_BUCKETS* Buckets = PreviousPartitions->Tables[i].Table.Buckets;
+                for (uint32_t j = 0; j <= Buckets->Mask; j++) {
+                    for (QUIC_LOOKUP_ENTRY* Entry = Buckets->Heads[j];
+                        Entry != NULL;
+                        Entry = Entry->Next[Buckets->Link]) {
+                        QUIC_CID_HASH_ENTRY *CID =
+                            QUIC_CONTAINING_RECORD(
+                                Entry,
+                                QUIC_CID_HASH_ENTRY,
+                                Entry);
+                        QuicLookupTableLink(
+                            QuicLookupGetPartition(Partitions, CID->CID.Data),
                             Entry,
-                            QUIC_CID_HASH_ENTRY,
-                            Entry);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        QuicHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
+                            Entry->Hash);
+                    }
                 }
-#pragma warning(push)
-#pragma warning(disable:6001)
-                QuicHashtableUninitialize(&PreviousTable[i].Table);
-#pragma warning(pop)
             }
-            QUIC_FREE(PreviousTable, QUIC_POOL_LOOKUP_HASHTABLE);
+        }
+
+        WritePointerRelease((void**)&Lookup->HASH.Partitions, Partitions);
+        Lookup->PartitionCount = PartitionCount;
+        Lookup->SINGLE.Connection = NULL;
+
+        if (PreviousPartitions != NULL) {
+            QuicLookupRetire(
+                &MsQuicLib.LookupRetired.Partitions,
+                &PreviousPartitions->RetireLink);
         }
     }
 
@@ -250,16 +745,17 @@ QuicLookupMaximizePartitioning(
     QuicDispatchRwLockAcquireExclusive(&Lookup->RwLock);
 
     if (!Lookup->MaximizePartitioning) {
-        Result =
-            QuicHashtableInitializeEx(
-                &Lookup->RemoteHashTable, QUIC_HASH_MIN_SIZE);
+        Lookup->MaximizePartitioning = TRUE;
+        Result = QuicLookupRebalance(Lookup, NULL);
         if (Result) {
-            Lookup->MaximizePartitioning = TRUE;
-            Result = QuicLookupRebalance(Lookup, NULL);
-            if (!Result) {
-                    QuicHashtableUninitialize(&Lookup->RemoteHashTable);
-                Lookup->MaximizePartitioning = FALSE;
-            }
+            Result = QuicLookupTableInitialize(&Lookup->RemoteHashTable, 0);
+        }
+        if (!Result) {
+            //
+            // Already rebalanced tables are left as they are; partitioning
+            // never decreases.
+            //
+            Lookup->MaximizePartitioning = FALSE;
         }
     }
 
@@ -305,16 +801,16 @@ QuicCidMatchConnection(
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
 QuicHashLookupConnection(
-    _In_ QUIC_HASHTABLE* Table,
+    _In_ QUIC_LOOKUP_TABLE* Table,
     _In_reads_(Length)
         const uint8_t* const DestCid,
     _In_ uint8_t Length,
     _In_ uint32_t Hash
     )
 {
-    QUIC_HASHTABLE_LOOKUP_CONTEXT Context;
-    QUIC_HASHTABLE_ENTRY* TableEntry =
-        QuicHashtableLookup(Table, Hash, &Context);
+    uint8_t Link;
+    QUIC_LOOKUP_ENTRY* TableEntry =
+        QuicLookupTableLookup(Table, Hash, &Link);
 
     while (TableEntry != NULL) {
         QUIC_CID_HASH_ENTRY* CIDEntry =
@@ -325,12 +821,16 @@ QuicHashLookupConnection(
             return CIDEntry->Connection;
         }
 
-        TableEntry = QuicHashtableLookupNext(Table, &Context);
+        TableEntry = QuicLookupTableLookupNext(TableEntry, Hash, Link);
     }
 
     return NULL;
 }
 
+//
+// Requires Lookup->RwLock to be held, or, once the partitioned hash tables have
+// been published, a read section.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
 QuicLookupFindConnectionByLocalCidInternal(
@@ -342,8 +842,10 @@ QuicLookupFindConnectionByLocalCidInternal(
     )
 {
     QUIC_CONNECTION* Connection = NULL;
+    QUIC_LOOKUP_PARTITIONS* Partitions =
+        (QUIC_LOOKUP_PARTITIONS*)ReadPointerAcquire((void**)&Lookup->HASH.Partitions);
 
-    if (Lookup->PartitionCount == 0) {
+    if (Partitions == NULL) {
         //
         // Only a single connection is on this binding. Validate that the
         // destination connection ID matches that connection.
@@ -358,25 +860,15 @@ QuicLookupFindConnectionByLocalCidInternal(
         QUIC_DBG_ASSERT(CID != NULL);
 
         //
-        // Use the destination connection ID to get the index into the
-        // partitioned hash table array, and look up the connection in that
-        // hash table.
+        // Use the destination connection ID to find the partitioned hash
+        // table, and look up the connection in that hash table.
         //
-        QUIC_STATIC_ASSERT(MSQUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
-        uint16_t PartitionIndex;
-        QuicCopyMemory(&PartitionIndex, CID + MsQuicLib.CidServerIdLength, 2);
-        PartitionIndex &= MsQuicLib.PartitionMask;
-        PartitionIndex %= Lookup->PartitionCount;
-        QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
-
-        QuicDispatchRwLockAcquireShared(&Table->RwLock);
         Connection =
             QuicHashLookupConnection(
-                &Table->Table,
+                QuicLookupGetPartition(Partitions, CID),
                 CID,
                 CIDLen,
                 Hash);
-        QuicDispatchRwLockReleaseShared(&Table->RwLock);
     }
 
 #if QUIC_DEBUG_HASHTABLE_LOOKUP
@@ -400,8 +892,7 @@ QuicLookupFindConnectionByLocalCidInternal(
 }
 
 //
-// Requires Lookup->RwLock to be held (shared).
-
+// Requires a read section or Lookup->RwLock to be held.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
@@ -414,9 +905,9 @@ QuicLookupFindConnectionByRemoteHashInternal(
     _In_ uint32_t Hash
     )
 {
-    QUIC_HASHTABLE_LOOKUP_CONTEXT Context;
-    QUIC_HASHTABLE_ENTRY* TableEntry =
-        QuicHashtableLookup(&Lookup->RemoteHashTable, Hash, &Context);
+    uint8_t Link;
+    QUIC_LOOKUP_ENTRY* TableEntry =
+        QuicLookupTableLookup(&Lookup->RemoteHashTable, Hash, &Link);
 
     while (TableEntry != NULL) {
         QUIC_REMOTE_HASH_ENTRY* Entry =
@@ -436,7 +927,7 @@ QuicLookupFindConnectionByRemoteHashInternal(
             return Entry->Connection;
         }
 
-        TableEntry = QuicHashtableLookupNext(&Lookup->RemoteHashTable, &Context);
+        TableEntry = QuicLookupTableLookupNext(TableEntry, Hash, Link);
     }
 
 #if QUIC_DEBUG_HASHTABLE_LOOKUP
@@ -481,20 +972,10 @@ QuicLookupInsertLocalCid(
         //
         // Insert the source connection ID into the hash table.
         //
-        QUIC_STATIC_ASSERT(MSQUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
-        uint16_t PartitionIndex;
-        QuicCopyMemory(&PartitionIndex, SourceCid->CID.Data + MsQuicLib.CidServerIdLength, 2);
-        PartitionIndex &= MsQuicLib.PartitionMask;
-        PartitionIndex %= Lookup->PartitionCount;
-        QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
-
-        QuicDispatchRwLockAcquireExclusive(&Table->RwLock);
-        QuicHashtableInsert(
-            &Table->Table,
+        QuicLookupTableInsert(
+            QuicLookupGetPartition(Lookup->HASH.Partitions, SourceCid->CID.Data),
             &SourceCid->Entry,
-            Hash,
-            NULL);
-        QuicDispatchRwLockReleaseExclusive(&Table->RwLock);
+            Hash);
     }
 
     if (UpdateRefCount) {
@@ -548,11 +1029,10 @@ QuicLookupInsertRemoteHash(
         RemoteCid,
         RemoteCidLength);
 
-    QuicHashtableInsert(
+    QuicLookupTableInsert(
         &Lookup->RemoteHashTable,
         &Entry->Entry,
-        Hash,
-        NULL);
+        Hash);
 
     Connection->RemoteHashEntry = Entry;
 
@@ -610,17 +1090,12 @@ QuicLookupRemoveLocalCidInt(
         QUIC_DBG_ASSERT(SourceCid->CID.Length >= MsQuicLib.CidServerIdLength + MSQUIC_CID_PID_LENGTH);
 
         //
-        // Remove the source connection ID from the multi-hash table.
+        // Remove the source connection ID from the multi-hash table. Readers
+        // may still be looking at it until the next grace period completes.
         //
-        QUIC_STATIC_ASSERT(MSQUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
-        uint16_t PartitionIndex;
-        QuicCopyMemory(&PartitionIndex, SourceCid->CID.Data + MsQuicLib.CidServerIdLength, 2);
-        PartitionIndex &= MsQuicLib.PartitionMask;
-        PartitionIndex %= Lookup->PartitionCount;
-        QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
-        QuicDispatchRwLockAcquireExclusive(&Table->RwLock);
-        QuicHashtableRemove(&Table->Table, &SourceCid->Entry, NULL);
-        QuicDispatchRwLockReleaseExclusive(&Table->RwLock);
+        QuicLookupTableRemove(
+            QuicLookupGetPartition(Lookup->HASH.Partitions, SourceCid->CID.Data),
+            &SourceCid->Entry);
     }
 }
 
@@ -634,21 +1109,45 @@ QuicLookupFindConnectionByLocalCid(
     )
 {
     uint32_t Hash = QuicHashSimple(CIDLen, CID);
+    QUIC_CONNECTION* ExistingConnection;
 
-    QuicDispatchRwLockAcquireShared(&Lookup->RwLock);
+    if (ReadPointerAcquire((void**)&Lookup->HASH.Partitions) != NULL) {
+        //
+        // Once published, the partitioned hash tables stay for the lifetime
+        // of the lookup, so the lookup only needs a read section.
+        //
+        QUIC_IRQL PrevIrql;
+        long* Readers = QuicLookupReadBegin(&PrevIrql);
 
-    QUIC_CONNECTION* ExistingConnection =
-        QuicLookupFindConnectionByLocalCidInternal(
-            Lookup,
-            CID,
-            CIDLen,
-            Hash);
+        ExistingConnection =
+            QuicLookupFindConnectionByLocalCidInternal(
+                Lookup,
+                CID,
+                CIDLen,
+                Hash);
 
-    if (ExistingConnection != NULL) {
-        QuicConnAddRef(ExistingConnection, QUIC_CONN_REF_LOOKUP_RESULT);
-    }
+        if (ExistingConnection != NULL) {
+            QuicConnAddRef(ExistingConnection, QUIC_CONN_REF_LOOKUP_RESULT);
+        }
 
-    QuicDispatchRwLockReleaseShared(&Lookup->RwLock);
+        QuicLookupReadEnd(Readers, PrevIrql);
+
+    } else {
+        QuicDispatchRwLockAcquireShared(&Lookup->RwLock);
+
+        ExistingConnection =
+            QuicLookupFindConnectionByLocalCidInternal(
+                Lookup,
+                CID,
+                CIDLen,
+                Hash);
+
+        if (ExistingConnection != NULL) {
+            QuicConnAddRef(ExistingConnection, QUIC_CONN_REF_LOOKUP_RESULT);
+        }
+
+        QuicDispatchRwLockReleaseShared(&Lookup->RwLock);
+    }
 
     return ExistingConnection;
 }
@@ -665,27 +1164,26 @@ QuicLookupFindConnectionByRemoteHash(
 {
     uint32_t Hash = QuicPacketHash(RemoteAddress, RemoteCidLength, RemoteCid);
 
-    QuicDispatchRwLockAcquireShared(&Lookup->RwLock);
-
-    QUIC_CONNECTION* ExistingConnection;
-    if (Lookup->MaximizePartitioning) {
-        ExistingConnection =
-            QuicLookupFindConnectionByRemoteHashInternal(
-                Lookup,
-                RemoteAddress,
-                RemoteCidLength,
-                RemoteCid,
-                Hash);
+    //
+    // The remote hash table has no buckets (so nothing is found) until
+    // partitioning is maximized.
+    //
+    QUIC_IRQL PrevIrql;
+    long* Readers = QuicLookupReadBegin(&PrevIrql);
 
-        if (ExistingConnection != NULL) {
-            QuicConnAddRef(ExistingConnection, QUIC_CONN_REF_LOOKUP_RESULT);
-        }
+    QUIC_CONNECTION* ExistingConnection =
+        QuicLookupFindConnectionByRemoteHashInternal(
+            Lookup,
+            RemoteAddress,
+            RemoteCidLength,
+            RemoteCid,
+            Hash);
 
-    } else {
-        ExistingConnection = NULL;
+    if (ExistingConnection != NULL) {
+        QuicConnAddRef(ExistingConnection, QUIC_CONN_REF_LOOKUP_RESULT);
     }
 
-    QuicDispatchRwLockReleaseShared(&Lookup->RwLock);
+    QuicLookupReadEnd(Readers, PrevIrql);
 
     return ExistingConnection;
 }
@@ -831,8 +1329,21 @@ QuicLookupRemoveLocalCid(
     QuicLookupRemoveLocalCidInt(Lookup, SourceCid);
     SourceCid->CID.IsInLookupTable = FALSE;
     *Entry = (*Entry)->Next;
+    BOOLEAN WasHashed = Lookup->PartitionCount != 0;
     QuicDispatchRwLockReleaseExclusive(&Lookup->RwLock);
-    QuicConnRelease(SourceCid->Connection, QUIC_CONN_REF_LOOKUP_TABLE);
+
+    if (WasHashed) {
+        //
+        // Readers may still be walking through the CID, so it (and its
+        // connection reference) is only freed after a grace period.
+        //
+        QuicLookupRetire(&MsQuicLib.LookupRetired.Cids, &SourceCid->Link);
+        QuicLookupLimitRetired();
+    } else {
+        QUIC_CONNECTION* Connection = SourceCid->Connection;
+        QUIC_FREE(SourceCid, QUIC_POOL_CIDHASH);
+        QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
+    }
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -849,15 +1360,14 @@ QuicLookupRemoveRemoteHash(
 
     QuicDispatchRwLockAcquireExclusive(&Lookup->RwLock);
     QUIC_DBG_ASSERT(Connection->RemoteHashEntry != NULL);
-    QuicHashtableRemove(
+    QuicLookupTableRemove(
         &Lookup->RemoteHashTable,
-        &RemoteHashEntry->Entry,
-        NULL);
+        &RemoteHashEntry->Entry);
     Connection->RemoteHashEntry = NULL;
     QuicDispatchRwLockReleaseExclusive(&Lookup->RwLock);
 
-    QUIC_FREE(RemoteHashEntry, QUIC_POOL_REMOTE_HASH);
-    QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
+    QuicLookupRetire(&MsQuicLib.LookupRetired.RemoteHashes, &RemoteHashEntry->Link);
+    QuicLookupLimitRetired();
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -868,32 +1378,66 @@ QuicLookupRemoveLocalCids(
     )
 {
     uint8_t ReleaseRefCount = 0;
+    QUIC_SINGLE_LIST_ENTRY FreeCids = { NULL };
+    QUIC_SINGLE_LIST_ENTRY RetiredCids = { NULL };
 
     QuicDispatchRwLockAcquireExclusive(&Lookup->RwLock);
+    BOOLEAN IsHashed = Lookup->PartitionCount != 0;
     while (Connection->SourceCids.Next != NULL) {
         QUIC_CID_HASH_ENTRY *CID =
             QUIC_CONTAINING_RECORD(
                 QuicListPopEntry(&Connection->SourceCids),
                 QUIC_CID_HASH_ENTRY,
                 Link);
-        if (CID->CID.IsInLookupTable) {
+        if (!CID->CID.IsInLookupTable) {
+            QuicListPushEntry(&FreeCids, &CID->Link);
+        } else {
             QuicLookupRemoveLocalCidInt(Lookup, CID);
             CID->CID.IsInLookupTable = FALSE;
-            ReleaseRefCount++;
+            if (IsHashed) {
+                QuicListPushEntry(&RetiredCids, &CID->Link);
+            } else {
+                QuicListPushEntry(&FreeCids, &CID->Link);
+                ReleaseRefCount++;
+            }
         }
-        QUIC_FREE(CID, QUIC_POOL_CIDHASH);
     }
     QuicDispatchRwLockReleaseExclusive(&Lookup->RwLock);
 
+    //
+    // CIDs readers might still be walking through are only freed (and release
+    // their connection reference) after a grace period.
+    //
+    while (RetiredCids.Next != NULL) {
+        QuicLookupRetire(
+            &MsQuicLib.LookupRetired.Cids,
+            QuicListPopEntry(&RetiredCids));
+    }
+    QuicLookupLimitRetired();
+
+    while (FreeCids.Next != NULL) {
+        QUIC_CID_HASH_ENTRY *CID =
+            QUIC_CONTAINING_RECORD(
+                QuicListPopEntry(&FreeCids),
+                QUIC_CID_HASH_ENTRY,
+                Link);
+        QUIC_FREE(CID, QUIC_POOL_CIDHASH);
+    }
+
     for (uint8_t i = 0; i < ReleaseRefCount; i++) {
 #pragma prefast(suppress:6001, "SAL doesn't understand ref counts")
         QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
     }
 }
 
+//
+// Moves the CIDs by relinking them into the destination lookup. Readers of the
+// source lookup may still be walking through them, so this has to wait for a
+// grace period in between.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
-QuicLookupMoveLocalConnectionIDs(
+QuicLookupMoveLocalConnectionIDsSync(
     _In_ QUIC_LOOKUP* LookupSrc,
     _In_ QUIC_LOOKUP* LookupDest,
     _In_ QUIC_CONNECTION* Connection
@@ -916,6 +1460,8 @@ QuicLookupMoveLocalConnectionIDs(
     }
     QuicDispatchRwLockReleaseExclusive(&LookupSrc->RwLock);
 
+    QuicLookupSynchronize();
+
     QuicDispatchRwLockAcquireExclusive(&LookupDest->RwLock);
 #pragma prefast(suppress:6001, "SAL doesn't understand ref counts")
     Entry = Connection->SourceCids.Next;
@@ -939,3 +1485,109 @@ QuicLookupMoveLocalConnectionIDs(
     }
     QuicDispatchRwLockReleaseExclusive(&LookupDest->RwLock);
 }
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupMoveLocalConnectionIDs(
+    _In_ QUIC_LOOKUP* LookupSrc,
+    _In_ QUIC_LOOKUP* LookupDest,
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    //
+    // Readers of the source lookup may still be walking through the CIDs, so
+    // instead of relinking them, they are replaced by copies inserted into the
+    // destination lookup, and retired.
+    //
+    QUIC_SINGLE_LIST_ENTRY Copies = { NULL };
+    QUIC_SINGLE_LIST_ENTRY* CopiesTail = &Copies;
+    QUIC_SINGLE_LIST_ENTRY* Entry;
+
+    for (Entry = Connection->SourceCids.Next; Entry != NULL; Entry = Entry->Next) {
+        QUIC_CID_HASH_ENTRY *CID =
+            QUIC_CONTAINING_RECORD(
+                Entry,
+                QUIC_CID_HASH_ENTRY,
+                Link);
+        if (CID->CID.IsInLookupTable) {
+            QUIC_CID_HASH_ENTRY* Copy =
+                QuicCidNewSource(Connection, CID->CID.Length, CID->CID.Data);
+            if (Copy == NULL) {
+                break;
+            }
+            QuicCopyMemory(&Copy->CID, &CID->CID, sizeof(CID->CID));
+            Copy->Link.Next = NULL;
+            CopiesTail->Next = &Copy->Link;
+            CopiesTail = &Copy->Link;
+        }
+    }
+
+    if (Entry != NULL) {
+        //
+        // Out of memory. Fall back to relinking the CIDs themselves.
+        //
+        while (Copies.Next != NULL) {
+            QUIC_FREE(
+                QUIC_CONTAINING_RECORD(
+                    QuicListPopEntry(&Copies),
+                    QUIC_CID_HASH_ENTRY,
+                    Link),
+                QUIC_POOL_CIDHASH);
+        }
+        QuicLookupMoveLocalConnectionIDsSync(LookupSrc, LookupDest, Connection);
+        return;
+    }
+
+    QuicDispatchRwLockAcquireExclusive(&LookupSrc->RwLock);
+    for (Entry = Connection->SourceCids.Next; Entry != NULL; Entry = Entry->Next) {
+        QUIC_CID_HASH_ENTRY *CID =
+            QUIC_CONTAINING_RECORD(
+                Entry,
+                QUIC_CID_HASH_ENTRY,
+                Link);
+        if (CID->CID.IsInLookupTable) {
+            QuicLookupRemoveLocalCidInt(LookupSrc, CID);
+        }
+    }
+    QuicDispatchRwLockReleaseExclusive(&LookupSrc->RwLock);
+
+    QUIC_SINGLE_LIST_ENTRY RetiredCids = { NULL };
+
+    QuicDispatchRwLockAcquireExclusive(&LookupDest->RwLock);
+    for (QUIC_SINGLE_LIST_ENTRY** Prev = &Connection->SourceCids.Next;
+        *Prev != NULL;
+        Prev = &(*Prev)->Next) {
+        QUIC_CID_HASH_ENTRY *CID =
+            QUIC_CONTAINING_RECORD(
+                *Prev,
+                QUIC_CID_HASH_ENTRY,
+                Link);
+        if (CID->CID.IsInLookupTable) {
+            QUIC_CID_HASH_ENTRY* Copy =
+                QUIC_CONTAINING_RECORD(
+                    QuicListPopEntry(&Copies),
+                    QUIC_CID_HASH_ENTRY,
+                    Link);
+            Copy->Link.Next = CID->Link.Next;
+            *Prev = &Copy->Link;
+            QuicListPushEntry(&RetiredCids, &CID->Link);
+
+            BOOLEAN Result =
+                QuicLookupInsertLocalCid(
+                    LookupDest,
+                    QuicHashSimple(Copy->CID.Length, Copy->CID.Data),
+                    Copy,
+                    TRUE);
+            QUIC_DBG_ASSERT(Result);
+            UNREFERENCED_PARAMETER(Result);
+        }
+    }
+    QuicDispatchRwLockReleaseExclusive(&LookupDest->RwLock);
+
+    while (RetiredCids.Next != NULL) {
+        QuicLookupRetire(
+            &MsQuicLib.LookupRetired.Cids,
+            QuicListPopEntry(&RetiredCids));
+    }
+    QuicLookupLimitRetired();
+}
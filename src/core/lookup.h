@@ -5,11 +5,32 @@
 
 --*/
 
-typedef struct QUIC_PARTITIONED_HASHTABLE QUIC_PARTITIONED_HASHTABLE;
+typedef struct QUIC_LOOKUP_BUCKETS QUIC_LOOKUP_BUCKETS;
+typedef struct QUIC_LOOKUP_PARTITIONS QUIC_LOOKUP_PARTITIONS;
+
+//
+// A hash table of QUIC_LOOKUP_ENTRYs that supports lookups concurrently with
+// a single (externally serialized) writer. Readers must be in a lookup read
+// section (see QuicLookupReadBegin).
+//
+typedef struct QUIC_LOOKUP_TABLE {
+
+    //
+    // The current bucket array. NULL if the table isn't initialized.
+    //
+    QUIC_LOOKUP_BUCKETS* Buckets;
+
+    //
+    // Number of entries in the table.
+    //
+    uint32_t NumEntries;
+
+} QUIC_LOOKUP_TABLE;
 
 typedef struct QUIC_REMOTE_HASH_ENTRY {
 
-    QUIC_HASHTABLE_ENTRY Entry;
+    QUIC_LOOKUP_ENTRY Entry;
+    QUIC_SINGLE_LIST_ENTRY Link; // Used once removed, while awaiting its free.
     QUIC_CONNECTION* Connection;
     QUIC_ADDR RemoteAddress;
     uint8_t RemoteCidLength;
@@ -17,6 +38,25 @@ typedef struct QUIC_REMOTE_HASH_ENTRY {
 
 } QUIC_REMOTE_HASH_ENTRY;
 
+//
+// A set of entries removed from lookup tables, waiting for a grace period to
+// complete before they can be freed. Removed CIDs and remote hash entries keep
+// their connection's lookup table reference until then.
+//
+typedef struct QUIC_LOOKUP_RETIRED {
+
+    QUIC_SINGLE_LIST_ENTRY Cids;            // QUIC_CID_HASH_ENTRY
+    QUIC_SINGLE_LIST_ENTRY RemoteHashes;    // QUIC_REMOTE_HASH_ENTRY
+    QUIC_SINGLE_LIST_ENTRY Buckets;         // QUIC_LOOKUP_BUCKETS
+    QUIC_SINGLE_LIST_ENTRY Partitions;      // QUIC_LOOKUP_PARTITIONS
+
+    //
+    // The total number of entries in the lists.
+    //
+    uint32_t Count;
+
+} QUIC_LOOKUP_RETIRED;
+
 //
 // Lookup table for connections.
 //
@@ -34,7 +74,9 @@ typedef struct QUIC_LOOKUP {
     uint32_t CidCount;
 
     //
-    // Lock for accessing the lookup data.
+    // Lock for modifying the lookup data. Lookups in the partitioned hash
+    // tables and the remote hash table don't acquire it; they only need to
+    // be in a read section. Removed entries are freed after a grace period.
     //
     QUIC_DISPATCH_RW_LOCK RwLock;
 
@@ -47,30 +89,69 @@ typedef struct QUIC_LOOKUP {
     //
     // Local CID lookup.
     //
-    union {
-        void* LookupTable;
-        struct {
-            //
-            // Single client connection is bound.
-            //
-            QUIC_CONNECTION* Connection;
-        } SINGLE;
-        struct {
-            //
-            // Set of partitioned hash tables.
-            //
-            _Field_size_bytes_(PartitionCount * sizeof(QUIC_PARTITIONED_HASHTABLE))
-            QUIC_PARTITIONED_HASHTABLE* Tables;
-        } HASH;
-    };
+    struct {
+        //
+        // Single client connection is bound. Only accessed with RwLock held.
+        //
+        QUIC_CONNECTION* Connection;
+    } SINGLE;
+    struct {
+        //
+        // Set of partitioned hash tables. NULL until PartitionCount is
+        // non-zero and, once published, never goes back to NULL.
+        //
+        QUIC_LOOKUP_PARTITIONS* Partitions;
+    } HASH;
 
     //
     // Remote Hash lookup.
     //
-    QUIC_HASHTABLE RemoteHashTable;
+    QUIC_LOOKUP_TABLE RemoteHashTable;
 
 } QUIC_LOOKUP;
 
+//
+// Enters a lookup read section, during which entries in the lookup tables
+// won't be freed. Returns the reader count to pass to QuicLookupReadEnd.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+long*
+QuicLookupReadBegin(
+    _Out_ QUIC_IRQL* PrevIrql
+    );
+
+//
+// Leaves a lookup read section.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupReadEnd(
+    _In_ long* Readers,
+    _In_ QUIC_IRQL PrevIrql
+    );
+
+//
+// Waits for all read sections that might still reference previously removed
+// entries to complete, and frees all retired entries. Must not be called from
+// within a read section.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupSynchronize(
+    void
+    );
+
+//
+// Frees the retired entries whose grace period has completed, and starts a new
+// grace period for the rest, without waiting on readers. Returns TRUE if there
+// are still retired entries to be freed by a later call.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLookupReclaim(
+    void
+    );
+
 //
 // Initializes a new lookup.
 //
@@ -160,7 +241,8 @@ QuicLookupAddRemoteHash(
     );
 
 //
-// Removes a local CID from the lookup.
+// Removes a local CID from the lookup and the connection's list. The lookup
+// takes ownership of the CID, which may be freed at any point after this.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
@@ -71,6 +71,10 @@ QuicLossDetectionInitializeInternalState(
 {
     LossDetection->PacketsInFlight = 0;
     LossDetection->ProbeCount = 0;
+    LossDetection->TotalBytesDelivered = 0;
+    LossDetection->TimeOfLastDelivery = 0;
+    LossDetection->DeliveryIntervalStart = 0;
+    LossDetection->AppLimitedUntil = 0;
 }
 
 #if DEBUG
@@ -81,23 +85,32 @@ QuicLossValidate(
     )
 {
     uint32_t AckElicitingPackets = 0;
-    QUIC_SENT_PACKET_METADATA** Tail = &LossDetection->SentPackets;
-    while (*Tail) {
-        QUIC_DBG_ASSERT(!(*Tail)->Flags.Freed);
-        if ((*Tail)->Flags.IsAckEliciting) {
+    uint32_t Count = 0;
+    QUIC_SENT_PACKET_METADATA* Packet =
+        QuicSentPacketRingGetFirst(&LossDetection->SentPackets);
+    while (Packet != NULL) {
+        QUIC_DBG_ASSERT(!Packet->Flags.Freed);
+        if (Packet->Flags.IsAckEliciting) {
             AckElicitingPackets++;
         }
-        Tail = &((*Tail)->Next);
+        Count++;
+        Packet =
+            QuicSentPacketRingGetNext(
+                &LossDetection->SentPackets, Packet->PacketNumber + 1);
     }
-    QUIC_DBG_ASSERT(Tail == LossDetection->SentPacketsTail);
+    QUIC_DBG_ASSERT(Count == LossDetection->SentPackets.Count);
     QUIC_DBG_ASSERT(LossDetection->PacketsInFlight == AckElicitingPackets);
 
-    Tail = &LossDetection->LostPackets;
-    while (*Tail) {
-        QUIC_DBG_ASSERT(!(*Tail)->Flags.Freed);
-        Tail = &((*Tail)->Next);
+    Count = 0;
+    Packet = QuicSentPacketRingGetFirst(&LossDetection->LostPackets);
+    while (Packet != NULL) {
+        QUIC_DBG_ASSERT(!Packet->Flags.Freed);
+        Count++;
+        Packet =
+            QuicSentPacketRingGetNext(
+                &LossDetection->LostPackets, Packet->PacketNumber + 1);
     }
-    QUIC_DBG_ASSERT(Tail == LossDetection->LostPacketsTail);
+    QUIC_DBG_ASSERT(Count == LossDetection->LostPackets.Count);
 }
 #else
 #define QuicLossValidate(LossDetection)
@@ -109,10 +122,8 @@ QuicLossDetectionInitialize(
     _Inout_ QUIC_LOSS_DETECTION* LossDetection
     )
 {
-    LossDetection->SentPackets = NULL;
-    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-    LossDetection->LostPackets = NULL;
-    LossDetection->LostPacketsTail = &LossDetection->LostPackets;
+    QuicSentPacketRingInitialize(&LossDetection->SentPackets);
+    QuicSentPacketRingInitialize(&LossDetection->LostPackets);
     QuicLossDetectionInitializeInternalState(LossDetection);
 }
 
@@ -123,10 +134,10 @@ QuicLossDetectionUninitialize(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+    QUIC_SENT_PACKET_METADATA* Packet;
 
-    while (LossDetection->SentPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-        LossDetection->SentPackets = LossDetection->SentPackets->Next;
+    while ((Packet = QuicSentPacketRingGetFirst(&LossDetection->SentPackets)) != NULL) {
+        QuicSentPacketRingRemove(&LossDetection->SentPackets, Packet->PacketNumber);
 
         if (Packet->Flags.IsAckEliciting) {
             QuicTraceLogVerbose(
@@ -139,9 +150,8 @@ QuicLossDetectionUninitialize(
 
         QuicLossDetectionOnPacketDiscarded(LossDetection, Packet);
     }
-    while (LossDetection->LostPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->LostPackets;
-        LossDetection->LostPackets = LossDetection->LostPackets->Next;
+    while ((Packet = QuicSentPacketRingGetFirst(&LossDetection->LostPackets)) != NULL) {
+        QuicSentPacketRingRemove(&LossDetection->LostPackets, Packet->PacketNumber);
 
         QuicTraceLogVerbose(
             PacketTxLostDiscarded,
@@ -151,6 +161,9 @@ QuicLossDetectionUninitialize(
 
         QuicLossDetectionOnPacketDiscarded(LossDetection, Packet);
     }
+
+    QuicSentPacketRingUninitialize(&LossDetection->SentPackets);
+    QuicSentPacketRingUninitialize(&LossDetection->LostPackets);
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -172,19 +185,17 @@ QuicLossDetectionReset(
     // Throw away any outstanding packets.
     //
 
-    while (LossDetection->SentPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-        LossDetection->SentPackets = LossDetection->SentPackets->Next;
+    QUIC_SENT_PACKET_METADATA* Packet;
+
+    while ((Packet = QuicSentPacketRingGetFirst(&LossDetection->SentPackets)) != NULL) {
+        QuicSentPacketRingRemove(&LossDetection->SentPackets, Packet->PacketNumber);
         QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
     }
-    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
 
-    while (LossDetection->LostPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->LostPackets;
-        LossDetection->LostPackets = LossDetection->LostPackets->Next;
+    while ((Packet = QuicSentPacketRingGetFirst(&LossDetection->LostPackets)) != NULL) {
+        QuicSentPacketRingRemove(&LossDetection->LostPackets, Packet->PacketNumber);
         QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
     }
-    LossDetection->LostPacketsTail = &LossDetection->LostPackets;
 
     QuicLossValidate(LossDetection);
 }
@@ -200,9 +211,12 @@ QuicLossDetectionOldestOutstandingPacket(
     _In_ QUIC_LOSS_DETECTION* LossDetection
     )
 {
-    QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
+    QUIC_SENT_PACKET_METADATA* Packet =
+        QuicSentPacketRingGetFirst(&LossDetection->SentPackets);
     while (Packet != NULL && !Packet->Flags.IsAckEliciting) {
-        Packet = Packet->Next;
+        Packet =
+            QuicSentPacketRingGetNext(
+                &LossDetection->SentPackets, Packet->PacketNumber + 1);
     }
     return Packet;
 }
@@ -387,7 +401,7 @@ QUIC_STATUS
 QuicLossDetectionOnPacketSent(
     _In_ QUIC_LOSS_DETECTION* LossDetection,
     _In_ QUIC_PATH* Path,
-    _In_ QUIC_SENT_PACKET_METADATA* TempSentPacket
+    _Inout_ QUIC_SENT_PACKET_METADATA* TempSentPacket
     )
 {
     QUIC_SENT_PACKET_METADATA* SentPacket;
@@ -410,14 +424,22 @@ QuicLossDetectionOnPacketSent(
         sizeof(QUIC_SENT_PACKET_METADATA) +
         sizeof(QUIC_SENT_FRAME_METADATA) * TempSentPacket->FrameCount);
 
-    LossDetection->LargestSentPacketNumber = TempSentPacket->PacketNumber;
-
     //
-    // Add to the outstanding-packet queue.
+    // Add to the outstanding-packet ring.
     //
-    SentPacket->Next = NULL;
-    *LossDetection->SentPacketsTail = SentPacket;
-    LossDetection->SentPacketsTail = &SentPacket->Next;
+    if (QUIC_FAILED(
+            QuicSentPacketRingInsert(&LossDetection->SentPackets, SentPacket))) {
+        //
+        // The copy now owns the frames' references, so they are released
+        // with it instead of by the caller.
+        //
+        QuicSentPacketPoolReturnPacketMetadata(
+            &Connection->Worker->SentPacketPool, SentPacket);
+        TempSentPacket->FrameCount = 0;
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    LossDetection->LargestSentPacketNumber = TempSentPacket->PacketNumber;
 
     QUIC_DBG_ASSERT(
         SentPacket->Flags.KeyType != QUIC_PACKET_KEY_0_RTT ||
@@ -431,6 +453,8 @@ QuicLossDetectionOnPacketSent(
             QuicConnResetIdleTimeout(Connection);
         }
 
+        QuicLossDetectionSaveDeliveryState(LossDetection, SentPacket);
+
         Connection->Stats.Send.RetransmittablePackets++;
         LossDetection->PacketsInFlight++;
         LossDetection->TimeOfLastPacketSent = SentPacket->SentTime;
@@ -449,6 +473,97 @@ QuicLossDetectionOnPacketSent(
     return QUIC_STATUS_SUCCESS;
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionSaveDeliveryState(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _Inout_ QUIC_SENT_PACKET_METADATA* SentPacket
+    )
+{
+    if (LossDetection->PacketsInFlight == 0) {
+        //
+        // Nothing is in flight, so the delivery rate interval starts now.
+        //
+        LossDetection->TimeOfLastDelivery = SentPacket->SentTime;
+        LossDetection->DeliveryIntervalStart = SentPacket->SentTime;
+    }
+
+    SentPacket->TotalBytesDelivered = LossDetection->TotalBytesDelivered;
+    SentPacket->DeliveredTime = LossDetection->TimeOfLastDelivery;
+    SentPacket->DeliveryIntervalStart = LossDetection->DeliveryIntervalStart;
+    SentPacket->Flags.IsAppLimited = LossDetection->AppLimitedUntil != 0;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnPacketDelivered(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _Inout_ QUIC_RATE_SAMPLE* RateSample,
+    _In_ const QUIC_SENT_PACKET_METADATA* Packet,
+    _In_ uint32_t TimeNow
+    )
+{
+    LossDetection->TotalBytesDelivered += Packet->PacketLength;
+    LossDetection->TimeOfLastDelivery = TimeNow;
+    if (!RateSample->Valid ||
+        Packet->TotalBytesDelivered >= RateSample->PriorDelivered) {
+        RateSample->Valid = TRUE;
+        RateSample->IsAppLimited = Packet->Flags.IsAppLimited;
+        RateSample->PriorDelivered = Packet->TotalBytesDelivered;
+        RateSample->PriorDeliveredTime = Packet->DeliveredTime;
+        RateSample->SendElapsed =
+            QuicTimeDiff32(Packet->DeliveryIntervalStart, Packet->SentTime);
+        LossDetection->DeliveryIntervalStart = Packet->SentTime;
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+uint64_t
+QuicLossDetectionGetDeliveryRate(
+    _In_ const QUIC_LOSS_DETECTION* LossDetection,
+    _In_ const QUIC_RATE_SAMPLE* RateSample,
+    _In_ const QUIC_PATH* Path,
+    _In_ uint32_t TimeNow
+    )
+{
+    if (!RateSample->Valid) {
+        return 0;
+    }
+
+    //
+    // The delivery rate is the data delivered over the longer of the send and
+    // ACK intervals of the sampled packet's flight, which guards against both
+    // ACK compression and send bursts. Intervals shorter than the min RTT are
+    // unreliable and are ignored.
+    //
+    const uint64_t Delivered =
+        LossDetection->TotalBytesDelivered - RateSample->PriorDelivered;
+    uint32_t Interval = QuicTimeDiff32(RateSample->PriorDeliveredTime, TimeNow);
+    if (Interval < RateSample->SendElapsed) {
+        Interval = RateSample->SendElapsed;
+    }
+    if (Interval == 0 || !Path->GotFirstRttSample || Interval < Path->MinRtt) {
+        return 0;
+    }
+
+    return Delivered * S_TO_US(1) / Interval;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnAppLimited(
+    _In_ QUIC_LOSS_DETECTION* LossDetection
+    )
+{
+    QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+    LossDetection->AppLimitedUntil =
+        LossDetection->TotalBytesDelivered +
+        Connection->CongestionControl.BytesInFlight;
+    if (LossDetection->AppLimitedUntil == 0) {
+        LossDetection->AppLimitedUntil = 1;
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicLossDetectionOnPacketAcknowledged(
@@ -576,11 +691,6 @@ QuicLossDetectionOnPacketAcknowledged(
     }
 
     if (Path != NULL) {
-        uint16_t PacketMtu =
-            PacketSizeFromUdpPayloadSize(
-                QuicAddrGetFamily(&Path->RemoteAddress),
-                Packet->PacketLength);
-
         if (!Path->IsMinMtuValidated &&
             Packet->PacketLength >= QUIC_INITIAL_PACKET_LENGTH) {
             Path->IsMinMtuValidated = TRUE;
@@ -591,16 +701,12 @@ QuicLossDetectionOnPacketAcknowledged(
                 Path->ID);
         }
 
-        if (PacketMtu > Path->Mtu) {
-            Path->Mtu = PacketMtu;
-            QuicTraceLogConnInfo(
-                PathMtuUpdated,
-                Connection,
-                "Path[%hhu] MTU updated to %hu bytes",
-                Path->ID,
-                Path->Mtu);
-            QuicDatagramOnSendStateChanged(&Connection->Datagram);
-        }
+        QuicMtuDiscoveryOnPacketAcknowledged(
+            Connection,
+            Path,
+            Packet->PacketNumber,
+            Packet->PacketLength,
+            Packet->Flags.IsPMTUD);
     }
 
     QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
@@ -775,6 +881,19 @@ QuicLossDetectionRetransmitFrames(
                     QUIC_CONN_SEND_FLAG_HANDSHAKE_DONE);
             break;
 
+        case QUIC_FRAME_ACK_FREQUENCY:
+            //
+            // Only resend if nothing newer has been requested since.
+            //
+            if (Packet->Frames[i].ACK_FREQUENCY.Sequence ==
+                Connection->AckFrequency.SendSeqNum) {
+                NewDataQueued |=
+                    QuicSendSetSendFlag(
+                        &Connection->Send,
+                        QUIC_CONN_SEND_FLAG_ACK_FREQUENCY);
+            }
+            break;
+
         case QUIC_FRAME_DATAGRAM:
         case QUIC_FRAME_DATAGRAM_1:
             if (!Packet->Flags.SuspectedLost) {
@@ -833,11 +952,12 @@ QuicLossDetectionDetectAndHandleLostPackets(
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
     uint32_t LostRetransmittableBytes = 0;
+    uint32_t LostProbeBytes = 0;
     QUIC_SENT_PACKET_METADATA* Packet;
 
-    if (LossDetection->LostPackets != NULL) {
+    if (LossDetection->LostPackets.Count != 0) {
         //
-        // Clean out any packets in the LostPackets list that we are pretty
+        // Clean out any packets in the LostPackets ring that we are pretty
         // confident will never be acknowledged.
         //
         uint32_t TwoPto =
@@ -845,7 +965,7 @@ QuicLossDetectionDetectAndHandleLostPackets(
                 LossDetection,
                 &Connection->Paths[0], // TODO - Is this right?
                 2);
-        while ((Packet = LossDetection->LostPackets) != NULL &&
+        while ((Packet = QuicSentPacketRingGetFirst(&LossDetection->LostPackets)) != NULL &&
                 Packet->PacketNumber < LossDetection->LargestAck &&
                 QuicTimeDiff32(Packet->SentTime, TimeNow) > TwoPto) {
             QuicTraceLogVerbose(
@@ -853,17 +973,14 @@ QuicLossDetectionDetectAndHandleLostPackets(
                 "[%c][TX][%llu] Forgetting",
                 PtkConnPre(Connection),
                 Packet->PacketNumber);
-            LossDetection->LostPackets = Packet->Next;
+            QuicSentPacketRingRemove(&LossDetection->LostPackets, Packet->PacketNumber);
             QuicLossDetectionOnPacketDiscarded(LossDetection, Packet);
         }
-        if (LossDetection->LostPackets == NULL) {
-            LossDetection->LostPacketsTail = &LossDetection->LostPackets;
-        }
 
         QuicLossValidate(LossDetection);
     }
 
-    if (LossDetection->SentPackets != NULL) {
+    if (LossDetection->SentPackets.Count != 0) {
         //
         // Remove "suspect" packets inferred lost from out-of-order ACKs.
         // The spec has:
@@ -876,8 +993,7 @@ QuicLossDetectionDetectAndHandleLostPackets(
         uint32_t Rtt = max(Path->SmoothedRtt, Path->LatestRttSample);
         uint32_t TimeReorderThreshold = QUIC_TIME_REORDER_THRESHOLD(Rtt);
         uint64_t LargestLostPacketNumber = 0;
-        QUIC_SENT_PACKET_METADATA* PrevPacket = NULL;
-        Packet = LossDetection->SentPackets;
+        Packet = QuicSentPacketRingGetFirst(&LossDetection->SentPackets);
         while (Packet != NULL) {
 
             BOOLEAN NonretransmittableHandshakePacket =
@@ -887,8 +1003,9 @@ QuicLossDetectionDetectAndHandleLostPackets(
                 QuicKeyTypeToEncryptLevel(Packet->Flags.KeyType);
 
             if (EncryptLevel > LossDetection->LargestAckEncryptLevel) {
-                PrevPacket = Packet;
-                Packet = Packet->Next;
+                Packet =
+                    QuicSentPacketRingGetNext(
+                        &LossDetection->SentPackets, Packet->PacketNumber + 1);
                 continue;
             } else if (Packet->PacketNumber + QUIC_PACKET_REORDER_THRESHOLD < LossDetection->LargestAck) {
                 if (!NonretransmittableHandshakePacket) {
@@ -931,31 +1048,70 @@ QuicLossDetectionDetectAndHandleLostPackets(
             QuicPerfCounterIncrement(QUIC_PERF_COUNTER_PKTS_SUSPECTED_LOST);
             if (Packet->Flags.IsAckEliciting) {
                 LossDetection->PacketsInFlight--;
-                LostRetransmittableBytes += Packet->PacketLength;
+                if (Packet->Flags.IsPMTUD) {
+                    //
+                    // Lost MTU probes are expected and not a sign of
+                    // congestion.
+                    //
+                    LostProbeBytes += Packet->PacketLength;
+                } else {
+                    LostRetransmittableBytes += Packet->PacketLength;
+                }
                 QuicLossDetectionRetransmitFrames(LossDetection, Packet, FALSE);
             }
 
-            LargestLostPacketNumber = Packet->PacketNumber;
-            if (PrevPacket == NULL) {
-                LossDetection->SentPackets = Packet->Next;
-                if (Packet->Next == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            } else {
-                PrevPacket->Next = Packet->Next;
-                if (Packet->Next == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
+            if (Packet->Flags.IsAckEliciting || Packet->Flags.EcnEctSet) {
+                uint8_t PathIndex;
+                QUIC_PATH* LostPath =
+                    QuicConnGetPathByID(Connection, Packet->PathId, &PathIndex);
+                if (LostPath != NULL) {
+                    if (Packet->Flags.IsAckEliciting) {
+                        QuicMtuDiscoveryOnPacketLost(
+                            Connection,
+                            LostPath,
+                            Packet->PacketNumber,
+                            Packet->PacketLength,
+                            Packet->Flags.IsPMTUD);
+                    }
+                    if (Packet->Flags.EcnEctSet &&
+                        QuicPathOnEcnPacketLost(LostPath)) {
+                        QuicTraceLogConnInfo(
+                            EcnTestPacketsLost,
+                            Connection,
+                            "Path[%hhu] ECN validation failed, all test packets lost",
+                            LostPath->ID);
+                        Connection->Stats.EcnFailed = TRUE;
+                    }
                 }
             }
 
-            *LossDetection->LostPacketsTail = Packet;
-            LossDetection->LostPacketsTail = &Packet->Next;
-            Packet = Packet->Next;
-            *LossDetection->LostPacketsTail = NULL;
+            LargestLostPacketNumber = Packet->PacketNumber;
+            QuicSentPacketRingRemove(&LossDetection->SentPackets, Packet->PacketNumber);
+            if (QUIC_FAILED(
+                    QuicSentPacketRingInsert(&LossDetection->LostPackets, Packet))) {
+                //
+                // Without room to remember the packet, a late ACK for it just
+                // won't be detected as a spurious loss.
+                //
+                QuicLossDetectionOnPacketDiscarded(LossDetection, Packet);
+            }
+            Packet =
+                QuicSentPacketRingGetNext(
+                    &LossDetection->SentPackets, LargestLostPacketNumber + 1);
         }
 
         QuicLossValidate(LossDetection);
 
+        if (LostProbeBytes > 0 &&
+            QuicCongestionControlOnDataInvalidated(
+                &Connection->CongestionControl,
+                LostProbeBytes)) {
+            //
+            // We were previously blocked and are now unblocked.
+            //
+            QuicSendQueueFlush(&Connection->Send, REASON_CONGESTION_CONTROL);
+        }
+
         if (LostRetransmittableBytes > 0) {
             QuicCongestionControlOnDataLost(
                 &Connection->CongestionControl,
@@ -984,7 +1140,6 @@ QuicLossDetectionDiscardPackets(
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
     QUIC_ENCRYPT_LEVEL EncryptLevel = QuicKeyTypeToEncryptLevel(KeyType);
-    QUIC_SENT_PACKET_METADATA* PrevPacket;
     QUIC_SENT_PACKET_METADATA* Packet;
     uint32_t AckedRetransmittableBytes = 0;
     uint32_t TimeNow = QuicTimeUs32();
@@ -995,23 +1150,12 @@ QuicLossDetectionDiscardPackets(
     // Implicitly ACK all outstanding packets.
     //
 
-    PrevPacket = NULL;
-    Packet = LossDetection->LostPackets;
+    Packet = QuicSentPacketRingGetFirst(&LossDetection->LostPackets);
     while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
+        const uint64_t PacketNumber = Packet->PacketNumber;
 
         if (Packet->Flags.KeyType == KeyType) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->LostPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->LostPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->LostPacketsTail = &LossDetection->LostPackets;
-                }
-            }
+            QuicSentPacketRingRemove(&LossDetection->LostPackets, PacketNumber);
 
             QuicTraceLogVerbose(
                 PacketTxAckedImplicit,
@@ -1025,34 +1169,21 @@ QuicLossDetectionDiscardPackets(
                 Packet->PacketNumber,
                 QuicPacketTraceType(Packet));
             QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet);
-
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
         }
+
+        Packet =
+            QuicSentPacketRingGetNext(
+                &LossDetection->LostPackets, PacketNumber + 1);
     }
 
     QuicLossValidate(LossDetection);
 
-    PrevPacket = NULL;
-    Packet = LossDetection->SentPackets;
+    Packet = QuicSentPacketRingGetFirst(&LossDetection->SentPackets);
     while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
+        const uint64_t PacketNumber = Packet->PacketNumber;
 
         if (Packet->Flags.KeyType == KeyType) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
+            QuicSentPacketRingRemove(&LossDetection->SentPackets, PacketNumber);
 
             QuicTraceLogVerbose(
                 PacketTxAckedImplicit,
@@ -1072,25 +1203,26 @@ QuicLossDetectionDiscardPackets(
             }
 
             QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet);
-
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
         }
+
+        Packet =
+            QuicSentPacketRingGetNext(
+                &LossDetection->SentPackets, PacketNumber + 1);
     }
 
     QuicLossValidate(LossDetection);
 
     if (AckedRetransmittableBytes > 0) {
         const QUIC_PATH* Path = &Connection->Paths[0]; // TODO - Correct?
+        QUIC_ACK_EVENT AckEvent;
+        QuicZeroMemory(&AckEvent, sizeof(AckEvent));
+        AckEvent.TimeNow = TimeNow;
+        AckEvent.LargestAck = LossDetection->LargestAck;
+        AckEvent.LargestSentPacketNumber = LossDetection->LargestSentPacketNumber;
+        AckEvent.NumRetransmittableBytes = AckedRetransmittableBytes;
+        AckEvent.SmoothedRtt = Path->SmoothedRtt;
         if (QuicCongestionControlOnDataAcknowledged(
-                &Connection->CongestionControl,
-                US_TO_MS(TimeNow),
-                LossDetection->LargestAck,
-                AckedRetransmittableBytes,
-                Path->SmoothedRtt)) {
+                &Connection->CongestionControl, &AckEvent)) {
             //
             // We were previously blocked and are now unblocked.
             //
@@ -1106,7 +1238,6 @@ QuicLossDetectionOnZeroRttRejected(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
-    QUIC_SENT_PACKET_METADATA* PrevPacket;
     QUIC_SENT_PACKET_METADATA* Packet;
     uint32_t CountRetransmittableBytes = 0;
 
@@ -1114,23 +1245,12 @@ QuicLossDetectionOnZeroRttRejected(
     // Marks all the packets as lost so they can be retransmitted immediately.
     //
 
-    PrevPacket = NULL;
-    Packet = LossDetection->SentPackets;
+    Packet = QuicSentPacketRingGetFirst(&LossDetection->SentPackets);
     while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
+        const uint64_t PacketNumber = Packet->PacketNumber;
 
         if (Packet->Flags.KeyType == QUIC_PACKET_KEY_0_RTT) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
+            QuicSentPacketRingRemove(&LossDetection->SentPackets, PacketNumber);
 
             QuicTraceLogVerbose(
                 PacketTx0RttRejected,
@@ -1144,13 +1264,11 @@ QuicLossDetectionOnZeroRttRejected(
             CountRetransmittableBytes += Packet->PacketLength;
 
             QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
-
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
         }
+
+        Packet =
+            QuicSentPacketRingGetNext(
+                &LossDetection->SentPackets, PacketNumber + 1);
     }
 
     QuicLossValidate(LossDetection);
@@ -1167,6 +1285,92 @@ QuicLossDetectionOnZeroRttRejected(
     }
 }
 
+//
+// Validates the peer's ECN counts (RFC 9000, Section 13.4.2) and signals a
+// congestion event if the CE count increased. Only called when the ACK frame
+// increased the largest acknowledged packet number.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionProcessEcn(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ QUIC_PATH* Path,
+    _In_ QUIC_ENCRYPT_LEVEL EncryptLevel,
+    _In_opt_ const QUIC_ACK_ECN_EX* Ecn,
+    _In_ uint32_t AckedEctPackets
+    )
+{
+    QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+    QUIC_PACKET_SPACE* Packets = Connection->Packets[EncryptLevel];
+    BOOLEAN EcnValid = TRUE;
+    uint64_t EctCeIncrease = 0;
+
+    if (Ecn == NULL) {
+        //
+        // Newly acknowledged ECT packets must be reflected in ECN counts.
+        //
+        EcnValid = AckedEctPackets == 0;
+
+    } else if (Ecn->ECT_0_Count < Packets->EcnEctCounter ||
+               Ecn->CE_Count < Packets->EcnCeCounter) {
+        //
+        // The peer reduced its counts.
+        //
+        EcnValid = FALSE;
+
+    } else {
+        EctCeIncrease =
+            (Ecn->ECT_0_Count - Packets->EcnEctCounter) +
+            (Ecn->CE_Count - Packets->EcnCeCounter);
+        if (EctCeIncrease < AckedEctPackets ||
+            Ecn->ECT_1_Count != 0 ||
+            Ecn->ECT_0_Count + Ecn->CE_Count > Connection->Send.NumPacketsSentWithEct) {
+            //
+            // The counts don't match what we marked: either some marks were
+            // cleared on the path, or the peer reports marks we never sent.
+            //
+            EcnValid = FALSE;
+
+        } else if (Ecn->CE_Count > Packets->EcnCeCounter) {
+            QuicTraceLogConnInfo(
+                EcnCongestion,
+                Connection,
+                "ECN CE count increased to %llu",
+                Ecn->CE_Count);
+            QuicCongestionControlOnEcn(
+                &Connection->CongestionControl,
+                LossDetection->LargestAck,
+                LossDetection->LargestSentPacketNumber);
+        }
+    }
+
+    if (!EcnValid) {
+        QuicTraceLogConnInfo(
+            EcnValidationFailed,
+            Connection,
+            "Path[%hhu] ECN validation failed",
+            Path->ID);
+        Connection->Stats.EcnFailed = TRUE;
+        Path->EcnValidationState = QUIC_ECN_VALIDATION_FAILED;
+        return;
+    }
+
+    if (Ecn != NULL) {
+        Packets->EcnEctCounter = Ecn->ECT_0_Count;
+        Packets->EcnCeCounter = Ecn->CE_Count;
+    }
+
+    if (EctCeIncrease > 0 &&
+        Path->EcnValidationState != QUIC_ECN_VALIDATION_CAPABLE) {
+        QuicTraceLogConnInfo(
+            EcnValidated,
+            Connection,
+            "Path[%hhu] ECN validated",
+            Path->ID);
+        Path->EcnValidationState = QUIC_ECN_VALIDATION_CAPABLE;
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicLossDetectionProcessAckBlocks(
@@ -1174,6 +1378,7 @@ QuicLossDetectionProcessAckBlocks(
     _In_ QUIC_PATH* Path,
     _In_ QUIC_ENCRYPT_LEVEL EncryptLevel,
     _In_ uint64_t AckDelay,
+    _In_opt_ const QUIC_ACK_ECN_EX* Ecn,
     _In_ QUIC_RANGE* AckBlocks,
     _Out_ BOOLEAN* InvalidAckBlock
     )
@@ -1182,6 +1387,7 @@ QuicLossDetectionProcessAckBlocks(
     QUIC_SENT_PACKET_METADATA** AckedPacketsTail = &AckedPackets;
 
     uint32_t AckedRetransmittableBytes = 0;
+    uint32_t AckedEctPackets = 0;
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
     uint32_t TimeNow = QuicTimeUs32();
     uint32_t SmallestRtt = (uint32_t)(-1);
@@ -1189,10 +1395,11 @@ QuicLossDetectionProcessAckBlocks(
     BOOLEAN NewLargestAckRetransmittable = FALSE;
     BOOLEAN NewLargestAckDifferentPath = FALSE;
 
+    QUIC_RATE_SAMPLE RateSample;
+    QuicZeroMemory(&RateSample, sizeof(RateSample));
+
     *InvalidAckBlock = FALSE;
 
-    QUIC_SENT_PACKET_METADATA** LostPacketsStart = &LossDetection->LostPackets;
-    QUIC_SENT_PACKET_METADATA** SentPacketsStart = &LossDetection->SentPackets;
     QUIC_SENT_PACKET_METADATA* LargestAckedPacket = NULL;
 
     uint32_t i = 0;
@@ -1200,21 +1407,29 @@ QuicLossDetectionProcessAckBlocks(
     while ((AckBlock = QuicRangeGetSafe(AckBlocks, i++)) != NULL) {
 
         //
-        // Check to see if any packets in the LostPackets list are acknowledged,
+        // Check to see if any packets in the LostPackets ring are acknowledged,
         // which would mean we mistakenly classified those packets as lost.
+        // Only the part of the block that overlaps the ring is looked at,
+        // since ACK frames keep repeating previously acknowledged ranges.
         //
-        if (*LostPacketsStart != NULL) {
-            while (*LostPacketsStart && (*LostPacketsStart)->PacketNumber < AckBlock->Low) {
-                LostPacketsStart = &((*LostPacketsStart)->Next);
-            }
+        if (LossDetection->LostPackets.Count != 0) {
+            uint64_t PacketNumber =
+                max(AckBlock->Low, LossDetection->LostPackets.BasePacketNumber);
+            const uint64_t End =
+                min(QuicRangeGetHigh(AckBlock) + 1,
+                    QuicSentPacketRingGetEnd(&LossDetection->LostPackets));
+            for (; PacketNumber < End; ++PacketNumber) {
+                QUIC_SENT_PACKET_METADATA* Packet =
+                    QuicSentPacketRingRemove(&LossDetection->LostPackets, PacketNumber);
+                if (Packet == NULL) {
+                    continue;
+                }
 
-            QUIC_SENT_PACKET_METADATA** End = LostPacketsStart;
-            while (*End && (*End)->PacketNumber <= QuicRangeGetHigh(AckBlock)) {
                 QuicTraceLogVerbose(
                     PacketTxSpuriousLoss,
                     "[%c][TX][%llu] Spurious loss detected",
                     PtkConnPre(Connection),
-                    (*End)->PacketNumber);
+                    Packet->PacketNumber);
                 Connection->Stats.Send.SpuriousLostPackets++;
                 QuicPerfCounterDecrement(QUIC_PERF_COUNTER_PKTS_SUSPECTED_LOST);
                 //
@@ -1222,55 +1437,41 @@ QuicLossDetectionProcessAckBlocks(
                 // because we already told the congestion control module that
                 // this packet left the network.
                 //
-                End = &((*End)->Next);
+                *AckedPacketsTail = Packet;
+                AckedPacketsTail = &Packet->Next;
             }
+            *AckedPacketsTail = NULL;
 
-            if (LostPacketsStart != End) {
-                *AckedPacketsTail = *LostPacketsStart;
-                AckedPacketsTail = End;
-                *LostPacketsStart = *End;
-                *End = NULL;
-                if (End == LossDetection->LostPacketsTail) {
-                    LossDetection->LostPacketsTail = LostPacketsStart;
-                }
-
-                QuicLossValidate(LossDetection);
-            }
+            QuicLossValidate(LossDetection);
         }
 
         //
-        // Now find all the acknowledged packets in the SentPackets list.
+        // Now find all the acknowledged packets in the SentPackets ring.
         //
-        if (*SentPacketsStart != NULL) {
-            while (*SentPacketsStart && (*SentPacketsStart)->PacketNumber < AckBlock->Low) {
-                SentPacketsStart = &((*SentPacketsStart)->Next);
-            }
-
-            QUIC_SENT_PACKET_METADATA** End = SentPacketsStart;
-            while (*End && (*End)->PacketNumber <= QuicRangeGetHigh(AckBlock)) {
+        if (LossDetection->SentPackets.Count != 0) {
+            uint64_t PacketNumber =
+                max(AckBlock->Low, LossDetection->SentPackets.BasePacketNumber);
+            const uint64_t End =
+                min(QuicRangeGetHigh(AckBlock) + 1,
+                    QuicSentPacketRingGetEnd(&LossDetection->SentPackets));
+            for (; PacketNumber < End; ++PacketNumber) {
+                QUIC_SENT_PACKET_METADATA* Packet =
+                    QuicSentPacketRingRemove(&LossDetection->SentPackets, PacketNumber);
+                if (Packet == NULL) {
+                    continue;
+                }
 
-                if ((*End)->Flags.IsAckEliciting) {
+                if (Packet->Flags.IsAckEliciting) {
                     LossDetection->PacketsInFlight--;
-                    AckedRetransmittableBytes += (*End)->PacketLength;
+                    AckedRetransmittableBytes += Packet->PacketLength;
                 }
-                LargestAckedPacket = *End;
-                End = &((*End)->Next);
+                LargestAckedPacket = Packet;
+                *AckedPacketsTail = Packet;
+                AckedPacketsTail = &Packet->Next;
             }
+            *AckedPacketsTail = NULL;
 
-            if (SentPacketsStart != End) {
-                //
-                // Remove the ACKed packets from the outstanding packet list.
-                //
-                *AckedPacketsTail = *SentPacketsStart;
-                AckedPacketsTail = End;
-                *SentPacketsStart = *End;
-                *End = NULL;
-                if (End == LossDetection->SentPacketsTail) {
-                    LossDetection->SentPacketsTail = SentPacketsStart;
-                }
-
-                QuicLossValidate(LossDetection);
-            }
+            QuicLossValidate(LossDetection);
         }
 
         if (LargestAckedPacket != NULL &&
@@ -1327,9 +1528,23 @@ QuicLossDetectionProcessAckBlocks(
 
         SmallestRtt = min(SmallestRtt, PacketRtt);
 
+        if (Packet->Flags.EcnEctSet) {
+            AckedEctPackets++;
+        }
+
+        if (Packet->Flags.IsAckEliciting) {
+            QuicLossDetectionOnPacketDelivered(
+                LossDetection, &RateSample, Packet, TimeNow);
+        }
+
         QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet);
     }
 
+    if (LossDetection->AppLimitedUntil != 0 &&
+        LossDetection->TotalBytesDelivered > LossDetection->AppLimitedUntil) {
+        LossDetection->AppLimitedUntil = 0;
+    }
+
     QuicLossValidate(LossDetection);
 
     if (NewLargestAckRetransmittable && !NewLargestAckDifferentPath) {
@@ -1347,6 +1562,10 @@ QuicLossDetectionProcessAckBlocks(
         QuicConnUpdateRtt(Connection, Path, SmallestRtt);
     }
 
+    if (NewLargestAck && Path->EcnValidationState != QUIC_ECN_VALIDATION_FAILED) {
+        QuicLossDetectionProcessEcn(LossDetection, Path, EncryptLevel, Ecn, AckedEctPackets);
+    }
+
     if (NewLargestAck) {
         //
         // Handle packet loss (and any possible congestion events) before
@@ -1357,21 +1576,43 @@ QuicLossDetectionProcessAckBlocks(
     }
 
     if (NewLargestAck || AckedRetransmittableBytes > 0) {
+        QUIC_ACK_EVENT AckEvent;
+        QuicZeroMemory(&AckEvent, sizeof(AckEvent));
+        AckEvent.TimeNow = TimeNow;
+        AckEvent.LargestAck = LossDetection->LargestAck;
+        AckEvent.LargestSentPacketNumber = LossDetection->LargestSentPacketNumber;
+        AckEvent.NumRetransmittableBytes = AckedRetransmittableBytes;
+        AckEvent.SmoothedRtt = Connection->Paths[0].SmoothedRtt;
+        if (NewLargestAckRetransmittable && !NewLargestAckDifferentPath) {
+            AckEvent.MinRtt = SmallestRtt;
+            AckEvent.MinRttValid = TRUE;
+        }
+
+        AckEvent.DeliveryRate =
+            QuicLossDetectionGetDeliveryRate(
+                LossDetection, &RateSample, Path, TimeNow);
+        if (AckEvent.DeliveryRate != 0) {
+            AckEvent.IsAppLimited = RateSample.IsAppLimited;
+        }
+
         if (QuicCongestionControlOnDataAcknowledged(
-                &Connection->CongestionControl,
-                US_TO_MS(TimeNow),
-                LossDetection->LargestAck,
-                AckedRetransmittableBytes,
-                Connection->Paths[0].SmoothedRtt)) {
+                &Connection->CongestionControl, &AckEvent)) {
             //
             // We were previously blocked and are now unblocked.
             //
             QuicSendQueueFlush(&Connection->Send, REASON_CONGESTION_CONTROL);
         }
+
+        QuicConnUpdatePeerAckFrequency(Connection);
     }
 
     LossDetection->ProbeCount = 0;
 
+    QuicMtuDiscoveryCheckSearchCompleteTimeout(
+        Connection,
+        &Connection->Paths[0],
+        TimeNow);
+
     //
     // At least one packet was ACKed. If all packets were ACKed then we'll
     // cancel the timer; otherwise we'll reset the timer.
@@ -1429,7 +1670,6 @@ QuicLossDetectionProcessAckFrame(
 
         } else {
 
-            // TODO - Use ECN information.
             AckDelay <<= Connection->PeerTransportParams.AckDelayExponent;
 
             QuicLossDetectionProcessAckBlocks(
@@ -1437,6 +1677,7 @@ QuicLossDetectionProcessAckFrame(
                 Path,
                 EncryptLevel,
                 AckDelay,
+                FrameType == QUIC_FRAME_ACK_1 ? &Ecn : NULL,
                 &Connection->DecodedAckRanges,
                 InvalidFrame);
         }
@@ -1484,6 +1725,14 @@ QuicLossDetectionScheduleProbe(
     QuicSendQueueFlush(&Connection->Send, REASON_PROBE);
     Connection->Send.TailLossProbeNeeded = TRUE;
 
+    if (Connection->AckFrequency.SendSeqNum != 0) {
+        //
+        // The peer has been asked to delay its ACKs beyond the default, so
+        // make sure the probes get acknowledged right away.
+        //
+        QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_IMMEDIATE_ACK);
+    }
+
     if (Connection->Crypto.TlsState.WriteKey == QUIC_PACKET_KEY_1_RTT) {
         //
         // Check to see if any streams have fresh data to send out.
@@ -1506,7 +1755,8 @@ QuicLossDetectionScheduleProbe(
     // Not enough new stream data exists to fill the probing packets. Schedule
     // retransmits if possible.
     //
-    QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
+    QUIC_SENT_PACKET_METADATA* Packet =
+        QuicSentPacketRingGetFirst(&LossDetection->SentPackets);
     while (Packet != NULL) {
         if (Packet->Flags.IsAckEliciting) {
             QuicTraceLogVerbose(
@@ -1526,7 +1776,9 @@ QuicLossDetectionScheduleProbe(
                 return;
             }
         }
-        Packet = Packet->Next;
+        Packet =
+            QuicSentPacketRingGetNext(
+                &LossDetection->SentPackets, Packet->PacketNumber + 1);
     }
 
     //
@@ -1576,7 +1828,7 @@ QuicLossDetectionProcessTimerOperation(
         QuicTimeDiff32(OldestPacket->SentTime, TimeNow) >=
             MS_TO_US(Connection->Settings.DisconnectTimeoutMs)) {
         //
-        // OldestPacket has been in the SentPackets list for at least
+        // OldestPacket has been in the SentPackets ring for at least
         // DisconnectTimeoutUs without an ACK for either OldestPacket or for any
         // packets sent more than the reordering threshold after it. Assume the
         // path is dead and close the connection.
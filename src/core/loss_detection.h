@@ -23,11 +23,12 @@ typedef struct QUIC_LOSS_DETECTION {
     QUIC_ENCRYPT_LEVEL LargestAckEncryptLevel;
 
     //
-    // N.B.: SentPackets and LostPackets are generally kept in ascending packet
-    // number order, and packets in the LostPackets list generally have smaller
-    // numbers than those in the SentPackets list. The only case this is not
-    // true is during the handshake. Since multiple encryption levels are used
-    // in parallel, higher numbered packets in lower encryption levels can be
+    // N.B.: SentPackets and LostPackets are indexed by packet number, which is
+    // shared by all encryption levels, so both are always walked in ascending
+    // packet number order. Packets in LostPackets generally have smaller
+    // numbers than those in SentPackets. The only case this is not true is
+    // during the handshake. Since multiple encryption levels are used in
+    // parallel, higher numbered packets in lower encryption levels can be
     // "lost" sooner than the higher encryption levels.
     //
 
@@ -35,25 +36,39 @@ typedef struct QUIC_LOSS_DETECTION {
     // Outstanding packets.
     //
     uint64_t LargestSentPacketNumber;
-    QUIC_SENT_PACKET_METADATA* SentPackets;
-    QUIC_SENT_PACKET_METADATA** SentPacketsTail;
+    QUIC_SENT_PACKET_RING SentPackets;
 
     uint32_t TimeOfLastPacketSent;
 
     //
-    // Lost packets. The purpose of this list is to remember packets a little
+    // Lost packets. The purpose of this ring is to remember packets a little
     // while after we decide they are lost, in case we were wrong and the ACK
     // comes in later than expected. For accounting purposes we don't consider
     // these packets to be in the network.
     //
-    QUIC_SENT_PACKET_METADATA* LostPackets;
-    QUIC_SENT_PACKET_METADATA** LostPacketsTail;
+    QUIC_SENT_PACKET_RING LostPackets;
 
     //
     // Number of probes sent.
     //
     uint16_t ProbeCount;
 
+    //
+    // Delivery rate estimation state. TotalBytesDelivered counts the
+    // retransmittable bytes acknowledged so far and TimeOfLastDelivery is when
+    // the last of them was. DeliveryIntervalStart is the send time of the most
+    // recently sent packet that was acknowledged.
+    //
+    uint64_t TotalBytesDelivered;
+    uint32_t TimeOfLastDelivery;
+    uint32_t DeliveryIntervalStart;
+
+    //
+    // When non-zero, the sender is application limited until
+    // TotalBytesDelivered exceeds this value.
+    //
+    uint64_t AppLimitedUntil;
+
 } QUIC_LOSS_DETECTION;
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -122,7 +137,70 @@ QUIC_STATUS
 QuicLossDetectionOnPacketSent(
     _In_ QUIC_LOSS_DETECTION* LossDetection,
     _In_ QUIC_PATH* Path,
-    _In_ QUIC_SENT_PACKET_METADATA* SentPacket
+    _Inout_ QUIC_SENT_PACKET_METADATA* SentPacket
+    );
+
+//
+// The delivery state snapshot of the most recently sent packet acknowledged
+// by an ACK frame, from which the delivery rate sample is computed.
+//
+typedef struct QUIC_RATE_SAMPLE {
+
+    BOOLEAN Valid : 1;
+    BOOLEAN IsAppLimited : 1;
+
+    uint64_t PriorDelivered; // bytes
+    uint32_t PriorDeliveredTime; // microsec
+    uint32_t SendElapsed; // microsec
+
+} QUIC_RATE_SAMPLE;
+
+//
+// Saves the connection's delivery state in a retransmittable packet about to
+// be sent, for computing a delivery rate sample once it is acknowledged.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionSaveDeliveryState(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _Inout_ QUIC_SENT_PACKET_METADATA* SentPacket
+    );
+
+//
+// Called for each retransmittable packet newly acknowledged by an ACK frame.
+// Updates the delivered byte count and RateSample.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnPacketDelivered(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _Inout_ QUIC_RATE_SAMPLE* RateSample,
+    _In_ const QUIC_SENT_PACKET_METADATA* Packet,
+    _In_ uint32_t TimeNow
+    );
+
+//
+// Returns the delivery rate (bytes per second) measured by RateSample, or
+// zero if no reliable sample could be taken.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+uint64_t
+QuicLossDetectionGetDeliveryRate(
+    _In_ const QUIC_LOSS_DETECTION* LossDetection,
+    _In_ const QUIC_RATE_SAMPLE* RateSample,
+    _In_ const QUIC_PATH* Path,
+    _In_ uint32_t TimeNow
+    );
+
+//
+// Called when the sender runs out of data to send while the congestion
+// window still has room. Delivery rate samples taken until the data now in
+// flight is acknowledged only give a lower bound of the available bandwidth.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnAppLimited(
+    _In_ QUIC_LOSS_DETECTION* LossDetection
     );
 
 //
@@ -0,0 +1,293 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Datagram Packetization Layer Path MTU Discovery (DPLPMTUD, RFC 8899).
+
+    Each path starts at QUIC_DEFAULT_PATH_MTU (the base MTU). Once the path is
+    validated, padded PING-only probe packets are sent to search for a larger
+    MTU, up to the smallest of the local interface MTU, the MaximumMtu setting
+    and the peer's max_udp_payload_size:
+
+    - The largest possible size is probed first, since most paths support
+      the full interface MTU. After that, the search continues as a binary
+      search between the current MTU and the largest size not yet found to
+      be unsupported.
+
+    - Only one probe is outstanding at a time. The normal loss detection
+      timers act as the probe timer: a probe declared lost is resent up to
+      QUIC_DPLPMTUD_MAX_PROBES times before its size is considered too large.
+      Lost probes are not considered congestion.
+
+    - The search completes when the remaining range is smaller than
+      QUIC_DPLPMTUD_MIN_SEARCH_STEP and is restarted after
+      QUIC_DPLPMTUD_RAISE_TIMER, in case the path MTU grew.
+
+    - If QUIC_DPLPMTUD_BLACK_HOLE_THRESHOLD consecutive packets larger than
+      the base MTU are lost, without any later large packet being
+      acknowledged, the path MTU most likely shrunk. The MTU falls back to the
+      base MTU and a new search is started.
+
+--*/
+
+#include "precomp.h"
+#ifdef QUIC_CLOG
+#include "mtu_discovery.c.clog.h"
+#endif
+
+//
+// Returns the largest MTU the search may try on the path.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+uint16_t
+QuicMtuDiscoveryGetMaxMtu(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path
+    )
+{
+    QUIC_ADDRESS_FAMILY Family = QuicAddrGetFamily(&Path->RemoteAddress);
+    uint16_t MaxMtu =
+        QuicDataPathBindingGetLocalMtu(Path->Binding->DatapathBinding);
+    if (MaxMtu > Connection->Settings.MaximumMtu) {
+        MaxMtu = Connection->Settings.MaximumMtu;
+    }
+    if ((Connection->PeerTransportParams.Flags & QUIC_TP_FLAG_MAX_UDP_PAYLOAD_SIZE) &&
+        Connection->PeerTransportParams.MaxUdpPayloadSize <
+            MaxUdpPayloadSizeForFamily(Family, MaxMtu)) {
+        MaxMtu =
+            PacketSizeFromUdpPayloadSize(
+                Family,
+                (uint16_t)Connection->PeerTransportParams.MaxUdpPayloadSize);
+    }
+    if (MaxMtu < Path->Mtu) {
+        MaxMtu = Path->Mtu;
+    }
+    return MaxMtu;
+}
+
+//
+// Picks the next size to probe and queues the probe, or completes the search if
+// the remaining range is too small to bother.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoverySendNextProbe(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path
+    )
+{
+    QUIC_MTU_DISCOVERY* MtuDiscovery = &Path->MtuDiscovery;
+
+    if (MtuDiscovery->MaxMtu <= Path->Mtu ||
+        (MtuDiscovery->HasProbedMaxMtu &&
+         MtuDiscovery->MaxMtu - Path->Mtu < QUIC_DPLPMTUD_MIN_SEARCH_STEP)) {
+        MtuDiscovery->IsSearching = FALSE;
+        MtuDiscovery->SearchCompleteTime = QuicTimeUs32();
+        QuicTraceLogConnInfo(
+            MtuSearchComplete,
+            Connection,
+            "Path[%hhu] Mtu search complete at %hu bytes",
+            Path->ID,
+            Path->Mtu);
+        return;
+    }
+
+    if (!MtuDiscovery->HasProbedMaxMtu) {
+        MtuDiscovery->HasProbedMaxMtu = TRUE;
+        MtuDiscovery->ProbeSize = MtuDiscovery->MaxMtu;
+    } else {
+        MtuDiscovery->ProbeSize =
+            Path->Mtu + (MtuDiscovery->MaxMtu - Path->Mtu) / 2;
+    }
+    MtuDiscovery->ProbeCount = 0;
+
+    QuicTraceLogConnVerbose(
+        MtuProbeQueued,
+        Connection,
+        "Path[%hhu] Probing Mtu of %hu bytes (max %hu)",
+        Path->ID,
+        MtuDiscovery->ProbeSize,
+        MtuDiscovery->MaxMtu);
+
+    QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_PMTUD);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryNewSearch(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path
+    )
+{
+    QUIC_DBG_ASSERT(Path == &Connection->Paths[0]);
+
+    QUIC_MTU_DISCOVERY* MtuDiscovery = &Path->MtuDiscovery;
+    if (MtuDiscovery->IsSearching) {
+        return; // Already a probe outstanding.
+    }
+
+    MtuDiscovery->IsSearching = TRUE;
+    MtuDiscovery->HasProbedMaxMtu = FALSE;
+    MtuDiscovery->MaxMtu = QuicMtuDiscoveryGetMaxMtu(Connection, Path);
+
+    QuicTraceLogConnInfo(
+        MtuSearchStarted,
+        Connection,
+        "Path[%hhu] Mtu search started (%hu to %hu bytes)",
+        Path->ID,
+        Path->Mtu,
+        MtuDiscovery->MaxMtu);
+
+    QuicMtuDiscoverySendNextProbe(Connection, Path);
+}
+
+//
+// Updates the path MTU and lets the dependent modules know.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoverySetMtu(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ uint16_t Mtu
+    )
+{
+    Path->Mtu = Mtu;
+    QuicTraceLogConnInfo(
+        PathMtuUpdated,
+        Connection,
+        "Path[%hhu] MTU updated to %hu bytes",
+        Path->ID,
+        Path->Mtu);
+    QuicDatagramOnSendStateChanged(&Connection->Datagram);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryOnPacketAcknowledged(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ uint64_t PacketNumber,
+    _In_ uint16_t PacketLength,
+    _In_ BOOLEAN IsProbe
+    )
+{
+    QUIC_MTU_DISCOVERY* MtuDiscovery = &Path->MtuDiscovery;
+    uint16_t PacketMtu =
+        PacketSizeFromUdpPayloadSize(
+            QuicAddrGetFamily(&Path->RemoteAddress),
+            PacketLength);
+
+    if (PacketMtu > QUIC_DEFAULT_PATH_MTU) {
+        MtuDiscovery->BlackHoleCount = 0;
+        if (PacketNumber > MtuDiscovery->LargestAckedLargePacket) {
+            MtuDiscovery->LargestAckedLargePacket = PacketNumber;
+        }
+    }
+
+    if (PacketMtu <= Path->Mtu) {
+        return;
+    }
+
+    QuicMtuDiscoverySetMtu(Connection, Path, PacketMtu);
+    if (MtuDiscovery->MaxMtu < Path->Mtu) {
+        MtuDiscovery->MaxMtu = Path->Mtu;
+    }
+
+    if (IsProbe && MtuDiscovery->IsSearching && Path->IsActive &&
+        PacketMtu >= MtuDiscovery->ProbeSize) {
+        QuicMtuDiscoverySendNextProbe(Connection, Path);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryOnPacketLost(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ uint64_t PacketNumber,
+    _In_ uint16_t PacketLength,
+    _In_ BOOLEAN IsProbe
+    )
+{
+    QUIC_MTU_DISCOVERY* MtuDiscovery = &Path->MtuDiscovery;
+    uint16_t PacketMtu =
+        PacketSizeFromUdpPayloadSize(
+            QuicAddrGetFamily(&Path->RemoteAddress),
+            PacketLength);
+
+    if (IsProbe) {
+        if (!MtuDiscovery->IsSearching ||
+            !Path->IsActive ||
+            PacketMtu < MtuDiscovery->ProbeSize) {
+            return; // Stale probe.
+        }
+
+        if (++MtuDiscovery->ProbeCount < QUIC_DPLPMTUD_MAX_PROBES) {
+            //
+            // Try the same size again.
+            //
+            QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_PMTUD);
+            return;
+        }
+
+        QuicTraceLogConnVerbose(
+            MtuProbeFailed,
+            Connection,
+            "Path[%hhu] Mtu of %hu bytes not supported",
+            Path->ID,
+            MtuDiscovery->ProbeSize);
+        MtuDiscovery->MaxMtu = MtuDiscovery->ProbeSize - 1;
+        QuicMtuDiscoverySendNextProbe(Connection, Path);
+        return;
+    }
+
+    //
+    // Only large packets sent after the last large packet which made it count
+    // towards black hole detection.
+    //
+    if (Path->Mtu <= QUIC_DEFAULT_PATH_MTU ||
+        PacketMtu <= QUIC_DEFAULT_PATH_MTU ||
+        PacketNumber < MtuDiscovery->LargestAckedLargePacket) {
+        return;
+    }
+
+    if (++MtuDiscovery->BlackHoleCount < QUIC_DPLPMTUD_BLACK_HOLE_THRESHOLD) {
+        return;
+    }
+
+    QuicTraceLogConnWarning(
+        MtuBlackHoleDetected,
+        Connection,
+        "Path[%hhu] Mtu black hole detected at %hu bytes",
+        Path->ID,
+        Path->Mtu);
+
+    MtuDiscovery->BlackHoleCount = 0;
+    MtuDiscovery->IsSearching = FALSE;
+    QuicMtuDiscoverySetMtu(Connection, Path, QUIC_DEFAULT_PATH_MTU);
+    if (Path->IsActive) {
+        QuicMtuDiscoveryNewSearch(Connection, Path);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryCheckSearchCompleteTimeout(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ uint32_t TimeNow
+    )
+{
+    QUIC_MTU_DISCOVERY* MtuDiscovery = &Path->MtuDiscovery;
+    if (!MtuDiscovery->IsSearching &&
+        MtuDiscovery->SearchCompleteTime != 0 &&
+        QuicTimeAtOrBefore32(
+            MtuDiscovery->SearchCompleteTime + MS_TO_US(QUIC_DPLPMTUD_RAISE_TIMER),
+            TimeNow)) {
+        QuicMtuDiscoveryNewSearch(Connection, Path);
+    }
+}
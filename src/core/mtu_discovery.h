@@ -0,0 +1,110 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Datagram Packetization Layer Path MTU Discovery (DPLPMTUD, RFC 8899).
+
+--*/
+
+//
+// Per path state of the MTU search.
+//
+typedef struct QUIC_MTU_DISCOVERY {
+
+    //
+    // TRUE while probes are being sent to find a larger MTU.
+    //
+    BOOLEAN IsSearching : 1;
+
+    //
+    // TRUE once the largest possible size (MaxMtu at the start of the search)
+    // has been probed. After that, the search continues as a binary search.
+    //
+    BOOLEAN HasProbedMaxMtu : 1;
+
+    //
+    // The number of times the current probe size has been lost.
+    //
+    uint8_t ProbeCount;
+
+    //
+    // The number of consecutive losses of packets larger than the base MTU
+    // without any later one being acknowledged. Used for black hole detection.
+    //
+    uint8_t BlackHoleCount;
+
+    //
+    // The MTU currently being probed.
+    //
+    uint16_t ProbeSize;
+
+    //
+    // The upper bound of the search. Initialized with the smallest of the local
+    // interface MTU, the MaximumMtu setting and the peer's max_udp_payload_size,
+    // then lowered as probe sizes are found not to be supported.
+    //
+    uint16_t MaxMtu;
+
+    //
+    // The time the last search completed. Used to periodically restart the
+    // search, in case the path MTU grew.
+    //
+    uint32_t SearchCompleteTime; // microsec
+
+    //
+    // The largest packet number, larger than the base MTU, acknowledged.
+    //
+    uint64_t LargestAckedLargePacket;
+
+} QUIC_MTU_DISCOVERY;
+
+//
+// Starts a new search on the path, from its current MTU.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryNewSearch(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path
+    );
+
+//
+// Called when a packet sent on the path is acknowledged.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryOnPacketAcknowledged(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ uint64_t PacketNumber,
+    _In_ uint16_t PacketLength, // UDP payload bytes
+    _In_ BOOLEAN IsProbe
+    );
+
+//
+// Called when a packet sent on the path is declared lost. Lost probes are not
+// a sign of congestion and must not be reported to congestion control.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryOnPacketLost(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ uint64_t PacketNumber,
+    _In_ uint16_t PacketLength, // UDP payload bytes
+    _In_ BOOLEAN IsProbe
+    );
+
+//
+// Restarts the search if the last one completed long enough ago.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicMtuDiscoveryCheckSearchCompleteTimeout(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ uint32_t TimeNow // microsec
+    );
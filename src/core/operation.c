@@ -111,6 +111,13 @@ QuicOperationFree(
             QuicStreamRelease(ApiCtx->STRM_SHUTDOWN.Stream, QUIC_STREAM_REF_OPERATION);
         } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_SEND) {
             QuicStreamRelease(ApiCtx->STRM_SEND.Stream, QUIC_STREAM_REF_OPERATION);
+        } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_SEND_BATCH) {
+            while (ApiCtx->STRM_SEND_BATCH.Streams != NULL) {
+                QUIC_STREAM* Stream = ApiCtx->STRM_SEND_BATCH.Streams;
+                ApiCtx->STRM_SEND_BATCH.Streams = Stream->ApiSendBatchNext;
+                Stream->ApiSendBatchNext = NULL;
+                QuicStreamRelease(Stream, QUIC_STREAM_REF_OPERATION);
+            }
         } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_RECV_COMPLETE) {
             QuicStreamRelease(ApiCtx->STRM_RECV_COMPLETE.Stream, QUIC_STREAM_REF_OPERATION);
         } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_RECV_SET_ENABLED) {
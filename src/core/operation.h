@@ -61,6 +61,8 @@ typedef enum QUIC_API_TYPE {
 
     QUIC_API_TYPE_DATAGRAM_SEND,
 
+    QUIC_API_TYPE_STRM_SEND_BATCH,
+
 } QUIC_API_TYPE;
 
 //
@@ -133,6 +135,9 @@ typedef struct QUIC_API_CONTEXT {
         struct {
             QUIC_STREAM* Stream;
         } STRM_SEND;
+        struct {
+            QUIC_STREAM* Streams; // Linked via ApiSendBatchNext.
+        } STRM_SEND_BATCH;
         struct {
             QUIC_STREAM* Stream;
             uint64_t BufferLength;
@@ -182,10 +182,13 @@ QuicPacketBuilderPrepare(
         //
 
         if (Builder->SendContext == NULL) {
+            Builder->EcnEctSet =
+                Builder->Path->EcnValidationState == QUIC_ECN_VALIDATION_TESTING ||
+                Builder->Path->EcnValidationState == QUIC_ECN_VALIDATION_CAPABLE;
             Builder->SendContext =
                 QuicDataPathBindingAllocSendContext(
                     Builder->Path->Binding->DatapathBinding,
-                    QUIC_ECN_NON_ECT,
+                    Builder->EcnEctSet ? QUIC_ECN_ECT_0 : QUIC_ECN_NON_ECT,
                     IsPathMtuDiscovery ?
                         0 :
                         MaxUdpPayloadSizeForFamily(
@@ -204,7 +207,8 @@ QuicPacketBuilderPrepare(
         uint16_t NewDatagramLength =
             MaxUdpPayloadSizeForFamily(
                 QuicAddrGetFamily(&Builder->Path->RemoteAddress),
-                IsPathMtuDiscovery ? QUIC_MAX_MTU : DatagramSize);
+                IsPathMtuDiscovery ?
+                    Builder->Path->MtuDiscovery.ProbeSize : DatagramSize);
         if ((Connection->PeerTransportParams.Flags & QUIC_TP_FLAG_MAX_UDP_PAYLOAD_SIZE) &&
             NewDatagramLength > Connection->PeerTransportParams.MaxUdpPayloadSize) {
             NewDatagramLength = (uint16_t)Connection->PeerTransportParams.MaxUdpPayloadSize;
@@ -223,6 +227,22 @@ QuicPacketBuilderPrepare(
             goto Error;
         }
 
+        if (Connection->CongestionControl.PacingWindow != 0 &&
+            Builder->SendAllowance > 0) {
+            //
+            // Schedule the datagram's departure so the paced allowance is
+            // spread out over time rather than sent as a burst. Datagrams
+            // that don't count against the allowance (e.g. ACKs while
+            // congestion blocked) still go out immediately.
+            //
+            QuicDataPathBindingSetSendDepartureTime(
+                Builder->SendContext,
+                Builder->Datagram,
+                QuicCongestionControlGetDepartureTime(
+                    &Connection->CongestionControl,
+                    NewDatagramLength));
+        }
+
         Builder->DatagramLength = 0;
         Builder->MinimumDatagramLength = 0;
 
@@ -289,6 +309,8 @@ QuicPacketBuilderPrepare(
         Builder->Metadata->Flags.IsAckEliciting = FALSE;
         Builder->Metadata->Flags.IsPMTUD = IsPathMtuDiscovery;
         Builder->Metadata->Flags.SuspectedLost = FALSE;
+        Builder->Metadata->Flags.EcnEctSet = Builder->EcnEctSet;
+        Builder->Metadata->Flags.IsAppLimited = FALSE;
 #if DEBUG
         Builder->Metadata->Flags.Freed = FALSE;
 #endif
@@ -834,6 +856,19 @@ QuicPacketBuilderFinalize(
         Builder->Metadata->PacketNumber,
         QuicPacketTraceType(Builder->Metadata),
         Builder->Metadata->PacketLength);
+
+    if (Builder->Metadata->Flags.EcnEctSet) {
+        Connection->Send.NumPacketsSentWithEct++;
+        if (Builder->Path->EcnValidationState == QUIC_ECN_VALIDATION_TESTING &&
+            ++Builder->Path->EcnTestingPacketCount >= QUIC_ECN_TESTING_PACKET_COUNT) {
+            //
+            // Stop marking until the test packets are acknowledged and the
+            // peer's ECN counts can be validated.
+            //
+            Builder->Path->EcnValidationState = QUIC_ECN_VALIDATION_UNKNOWN;
+        }
+    }
+
     if (QUIC_FAILED(
         QuicLossDetectionOnPacketSent(
             &Connection->LossDetection,
@@ -73,6 +73,11 @@ typedef struct QUIC_PACKET_BUILDER {
     //
     uint8_t BatchCount : 4;
 
+    //
+    // Indicates the current send context marks its datagrams ECT(0).
+    //
+    uint8_t EcnEctSet : 1;
+
     //
     // The total number of datagrams that have been created.
     //
@@ -94,6 +94,12 @@ typedef struct QUIC_PACKET_SPACE {
     //
     uint64_t CurrentKeyPhaseBytesSent;
 
+    //
+    // The largest ECT(0) and CE counts the peer has reported in ACK frames.
+    //
+    uint64_t EcnEctCounter;
+    uint64_t EcnCeCounter;
+
     //
     // The current KEY_PHASE of the packet space.
     //
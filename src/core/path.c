@@ -31,6 +31,9 @@ QuicPathInitialize(
     Path->Mtu = QUIC_DEFAULT_PATH_MTU;
     Path->SmoothedRtt = MS_TO_US(Connection->Settings.InitialRttMs);
     Path->RttVariance = Path->SmoothedRtt / 2;
+    Path->EcnValidationState =
+        Connection->Settings.EcnEnabled ?
+            QUIC_ECN_VALIDATION_TESTING : QUIC_ECN_VALIDATION_FAILED;
 
     QuicTraceLogConnInfo(
         PathInitialized,
@@ -129,15 +132,15 @@ QuicPathSetValid(
     Path->IsPeerValidated = TRUE;
     QuicPathSetAllowance(Connection, Path, UINT32_MAX);
 
-    if (Path->IsPeerValidated && Reason == QUIC_PATH_VALID_PATH_RESPONSE) {
+    if (Path->IsActive && Reason == QUIC_PATH_VALID_PATH_RESPONSE) {
         //
-        // If the active path was just validated, then let's queue up a PMTUD
-        // packet.
+        // If the active path was just validated, then let's start searching
+        // for its MTU.
         //
         // TODO - If minimum MTU was not validated, we might want to validate
         // that first instead.
         //
-        QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_PMTUD);
+        QuicMtuDiscoveryNewSearch(Connection, Path);
     }
 }
 
@@ -240,6 +243,8 @@ QuicPathSetActive(
             // We assume port only changes don't change the PMTU.
             //
             Path->IsMinMtuValidated = PrevActivePath.IsMinMtuValidated;
+            Path->Mtu = PrevActivePath.Mtu;
+            Path->MtuDiscovery = PrevActivePath.MtuDiscovery;
         }
 
         Connection->Paths[0] = *Path;
@@ -255,5 +260,8 @@ QuicPathSetActive(
 
     if (!UdpPortChangeOnly) {
         QuicCongestionControlReset(&Connection->CongestionControl);
+        if (Connection->Paths[0].IsPeerValidated) {
+            QuicMtuDiscoveryNewSearch(Connection, &Connection->Paths[0]);
+        }
     }
 }
@@ -5,6 +5,16 @@
 
 --*/
 
+//
+// ECN validation state of a path (RFC 9000, Section 13.4.2).
+//
+typedef enum QUIC_ECN_VALIDATION_STATE {
+    QUIC_ECN_VALIDATION_TESTING,    // Marking the first packets sent on the path.
+    QUIC_ECN_VALIDATION_UNKNOWN,    // Not marking; waiting for the test packets to be ACKed.
+    QUIC_ECN_VALIDATION_CAPABLE,    // Validated; marking all packets.
+    QUIC_ECN_VALIDATION_FAILED      // Validation failed (or ECN is disabled).
+} QUIC_ECN_VALIDATION_STATE;
+
 //
 // Represents all the per-path information of a connection.
 //
@@ -67,11 +77,31 @@ typedef struct QUIC_PATH {
     //
     uint8_t PartitionUpdated : 1;
 
+    //
+    // The ECN validation state (QUIC_ECN_VALIDATION_STATE) for this path.
+    //
+    uint8_t EcnValidationState : 2;
+
+    //
+    // The number of ECT(0) packets sent while testing ECN on this path.
+    //
+    uint8_t EcnTestingPacketCount;
+
+    //
+    // The number of ECT(0) test packets sent on this path declared lost.
+    //
+    uint8_t EcnTestingLostPacketCount;
+
     //
     // The currently calculated path MTU.
     //
     uint16_t Mtu;
 
+    //
+    // The state of the search for a larger path MTU.
+    //
+    QUIC_MTU_DISCOVERY MtuDiscovery;
+
     //
     // The binding used for sending/receiving UDP packets.
     //
@@ -179,6 +209,33 @@ QuicPathDecrementAllowance(
         Path->Allowance <= Amount ? 0 : (Path->Allowance - Amount));
 }
 
+//
+// Called when a packet marked ECT(0) on the path is declared lost. If all the
+// ECN test packets are lost, validation fails (RFC 9000, Section 13.4.2.1).
+// Returns TRUE if that happened.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+inline
+BOOLEAN
+QuicPathOnEcnPacketLost(
+    _In_ QUIC_PATH* Path
+    )
+{
+    if (Path->EcnValidationState != QUIC_ECN_VALIDATION_TESTING &&
+        Path->EcnValidationState != QUIC_ECN_VALIDATION_UNKNOWN) {
+        return FALSE;
+    }
+
+    ++Path->EcnTestingLostPacketCount;
+    if (Path->EcnValidationState == QUIC_ECN_VALIDATION_UNKNOWN &&
+        Path->EcnTestingLostPacketCount >= Path->EcnTestingPacketCount) {
+        Path->EcnValidationState = QUIC_ECN_VALIDATION_FAILED;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
 typedef enum QUIC_PATH_VALID_REASON {
     QUIC_PATH_VALID_INITIAL_TOKEN,
     QUIC_PATH_VALID_HANDSHAKE_PACKET,
@@ -41,11 +41,13 @@ extern "C" {
 //
 #include "quicdef.h"
 #include "cid.h"
+#include "mtu_discovery.h"
 #include "path.h"
 #include "transport_params.h"
 #include "lookup.h"
 #include "timer_wheel.h"
 #include "settings.h"
+#include "tls_pool.h"
 #include "library.h"
 #include "binding.h"
 #include "api.h"
@@ -60,6 +62,8 @@ extern "C" {
 #include "worker.h"
 #include "ack_tracker.h"
 #include "packet_space.h"
+#include "cubic.h"
+#include "bbr.h"
 #include "congestion_control.h"
 #include "loss_detection.h"
 #include "send.h"
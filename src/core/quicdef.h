@@ -16,6 +16,7 @@ typedef struct QUIC_CONNECTION QUIC_CONNECTION;
 typedef struct QUIC_STREAM QUIC_STREAM;
 typedef struct QUIC_PACKET_BUILDER QUIC_PACKET_BUILDER;
 typedef struct QUIC_PATH QUIC_PATH;
+typedef struct QUIC_CRYPTO QUIC_CRYPTO;
 
 /*************************************************************
                     PROTOCOL CONSTANTS
@@ -88,6 +89,14 @@ typedef struct QUIC_PATH QUIC_PATH;
 //
 #define QUIC_MIN_ACK_SEND_NUMBER                2
 
+//
+// When the ACK_FREQUENCY extension is negotiated, the number of ACKs to ask
+// the peer for per congestion window, and the upper bound on the number of
+// ACK eliciting packets it may then receive before acknowledging.
+//
+#define QUIC_ACK_FREQUENCY_ACKS_PER_WINDOW      4
+#define QUIC_MAX_ACK_ELICITING_THRESHOLD        20
+
 //
 // The size of the stateless reset token.
 //
@@ -132,6 +141,54 @@ typedef struct QUIC_PATH QUIC_PATH;
 //
 #define QUIC_MAX_WORKER_QUEUE_DELAY             250
 
+//
+// The minimum average queue delay (in us) a worker must be seeing before an
+// idle sibling takes one of its queued connections. Below it, keeping the
+// connection on the worker its datagrams are steered to is worth more.
+//
+#define QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US    1000
+
+//
+// The length of the interval (in us) over which each worker measures its own
+// load and its connections' processing time, for rebalancing.
+//
+#define QUIC_WORKER_LOAD_INTERVAL_US            100000
+
+//
+// The minimum load (percent of the interval spent processing connections) at
+// which a worker migrates a heavy connection to a less loaded worker, and how
+// much more loaded (in percentage points) it must be than that worker.
+//
+#define QUIC_WORKER_REBALANCE_MIN_LOAD          75
+#define QUIC_WORKER_REBALANCE_MIN_LOAD_GAP      25
+
+//
+// The minimum share of an interval (in percent) a connection must have been
+// processed for to be worth migrating.
+//
+#define QUIC_WORKER_REBALANCE_MIN_CONN_LOAD     10
+
+//
+// The maximum number of loops a worker executing inline on a datapath thread
+// runs before yielding back to the datapath, so that receives don't starve.
+//
+#define QUIC_WORKER_INLINE_MAX_LOOPS            16
+
+//
+// The number of retired lookup entries at which busy workers free them, instead
+// of leaving it until they run out of work; and how often (in ms) idle workers
+// check whether retired entries can be freed yet.
+//
+#define QUIC_LOOKUP_RECLAIM_BATCH_SIZE          64
+#define QUIC_LOOKUP_RECLAIM_INTERVAL_MS         1
+
+//
+// The number of retired lookup entries at which removing another one waits for
+// a grace period to complete, instead of leaving that to the workers, which
+// can't free anything while readers keep getting preempted mid-lookup.
+//
+#define QUIC_LOOKUP_RETIRED_MAX                 4096
+
 //
 // The maximum number of simultaneous stateless operations that can be queued on
 // a single worker.
@@ -192,6 +249,12 @@ typedef struct QUIC_PATH QUIC_PATH;
 //
 #define QUIC_MAX_PENDING_DATAGRAMS              (QUIC_INITIAL_WINDOW_PACKETS + 5)
 
+//
+// The largest congestion window, in packets. The congestion window is a 32-bit
+// byte count, so no more minimum MTU packets than this are ever in flight.
+//
+#define QUIC_MAX_CONGESTION_WINDOW_PACKETS      (UINT32_MAX / QUIC_MIN_MTU)
+
 //
 // The maximum crypto FC window we will use/allow for client buffers.
 //
@@ -208,7 +271,8 @@ typedef struct QUIC_PATH QUIC_PATH;
 #define QUIC_DEFAULT_STREAM_FC_WINDOW_SIZE      0x8000  // 32768
 
 //
-// The initial stream receive buffer allocation size.
+// The default stream receive buffer chunk size. Chunks of this size are pooled
+// per worker.
 //
 #define QUIC_DEFAULT_STREAM_RECV_BUFFER_SIZE    0x1000  // 4096
 
@@ -236,6 +300,30 @@ QUIC_STATIC_ASSERT(IS_POWER_OF_TWO(QUIC_MAX_RANGE_DECODE_ACKS), L"Must be power
 //
 #define QUIC_DEFAULT_PATH_MTU                   QUIC_MIN_MTU
 
+//
+// The number of times a path MTU probe of a given size is sent before the size
+// is considered unsupported by the path.
+//
+#define QUIC_DPLPMTUD_MAX_PROBES                3
+
+//
+// The path MTU search stops once the remaining search range is smaller than
+// this number of bytes.
+//
+#define QUIC_DPLPMTUD_MIN_SEARCH_STEP           16
+
+//
+// The time, in milliseconds, after which a completed path MTU search is
+// restarted to detect an increase of the path MTU (PMTU_RAISE_TIMER).
+//
+#define QUIC_DPLPMTUD_RAISE_TIMER               600000
+
+//
+// The number of consecutive lost packets, larger than the base MTU, after
+// which the path is considered a black hole for the current MTU.
+//
+#define QUIC_DPLPMTUD_BLACK_HOLE_THRESHOLD      3
+
 //
 // The maximum time an app callback can take before we log a warning.
 // Apps should generally take less than a millisecond for each callback if at
@@ -289,6 +377,12 @@ QUIC_STATIC_ASSERT(
 //
 #define QUIC_RECV_BUFFER_DRAIN_RATIO            8
 
+//
+// The maximum number of buffers (receive buffer chunks or lent datagrams)
+// indicated to the app in a single stream receive event.
+//
+#define QUIC_MAX_RECV_BUFFER_COUNT              16
+
 //
 // The default value for send buffering being enabled or not.
 //
@@ -305,6 +399,15 @@ QUIC_STATIC_ASSERT(
 //
 #define QUIC_MAX_IDEAL_SEND_BUFFER_SIZE         0x8000000 // 134217728
 
+//
+// The size (in bytes) of the slabs that buffered send requests are copied
+// into. Requests larger than QUIC_SEND_BUFFER_SLAB_MAX_ALLOC, and small ones
+// once the connection's slabs add up to its ideal send buffer size, fall back
+// to their own allocation.
+//
+#define QUIC_SEND_BUFFER_SLAB_SIZE              0x4000 // 16384
+#define QUIC_SEND_BUFFER_SLAB_MAX_ALLOC         (QUIC_SEND_BUFFER_SLAB_SIZE / 4)
+
 //
 // The minimum number of bytes of send allowance we must have before we will
 // send another packet.
@@ -405,6 +508,48 @@ QUIC_STATIC_ASSERT(
 //
 #define QUIC_DEFAULT_SERVER_RESUMPTION_LEVEL    QUIC_SERVER_NO_RESUME
 
+//
+// The default value for ECN (marking ECT(0) and reacting to CE) being enabled
+// or not.
+//
+#define QUIC_DEFAULT_ECN_ENABLED                FALSE
+
+//
+// The default value for offloading server TLS handshake processing to the
+// TLS thread pool being enabled or not.
+//
+#define QUIC_DEFAULT_ASYNC_HANDSHAKE_ENABLED    FALSE
+
+//
+// The default value for the ACK_FREQUENCY extension (letting the peer control
+// how often we acknowledge, and asking it to acknowledge less often) being
+// enabled or not.
+//
+#define QUIC_DEFAULT_ACK_FREQUENCY_ENABLED      FALSE
+
+//
+// The default value for pacing with per-packet departure times (handed to the
+// datapath, which has the OS space the packets out) being enabled or not.
+//
+#define QUIC_DEFAULT_TX_TIME_PACING_ENABLED     FALSE
+
+//
+// The number of ECT(0) marked packets sent on a new path, before any of them
+// are acknowledged, to test whether the path supports ECN.
+//
+#define QUIC_ECN_TESTING_PACKET_COUNT           10
+
+//
+// The default congestion control algorithm used by new connections.
+//
+#define QUIC_DEFAULT_CONGESTION_CONTROL_ALGORITHM QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC
+
+//
+// The default largest MTU path MTU discovery searches up to. Larger (jumbo)
+// MTUs, up to QUIC_MAX_MTU, must be enabled by the app.
+//
+#define QUIC_DEFAULT_MAXIMUM_MTU                QUIC_ETHERNET_MTU
+
 //
 // Version of the wire-format for resumption tickets.
 // This needs to be incremented for each change in order or count of fields.
@@ -461,3 +606,9 @@ QUIC_STATIC_ASSERT(
 #define QUIC_SETTING_MAX_BYTES_PER_KEY_PHASE    "MaxBytesPerKey"
 
 #define QUIC_SETTING_SERVER_RESUMPTION_LEVEL    "ResumptionLevel"
+#define QUIC_SETTING_ECN_ENABLED                "EcnEnabled"
+#define QUIC_SETTING_ASYNC_HANDSHAKE_ENABLED    "AsyncHandshakeEnabled"
+#define QUIC_SETTING_ACK_FREQUENCY_ENABLED      "AckFrequencyEnabled"
+#define QUIC_SETTING_TX_TIME_PACING_ENABLED     "TxTimePacingEnabled"
+#define QUIC_SETTING_CONGESTION_CONTROL_ALGORITHM "CongestionControlAlgorithm"
+#define QUIC_SETTING_MAXIMUM_MTU                "MaximumMtu"
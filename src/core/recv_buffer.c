@@ -5,26 +5,29 @@
 
 Abstract:
 
-    The receive buffer is a dynamically sized circular buffer for reassembling
-    stream data and holding it until it's delivered to the client.
-
-    When the buffer is resized, all bytes in the buffer are copied to a new
-    backing memory of the requested size. The client must keep this in mind and
-    only resize the buffer infrequently, for instance by resizing exponentially,
-    or try to resize when few bytes are buffered.
+    The receive buffer is a dynamically sized buffer for reassembling stream
+    data and holding it until it's delivered to the client.
 
     There are two size variables, AllocBufferLength and VirtualBufferLength.
-    The first indicates the length of the physical buffer that has been
-    allocated. The second indicates the maximum size the physical buffer is
-    allowed to grow to. Generally, the physical buffer can stay much smaller
+    The first indicates the length of the physical memory that has been
+    allocated. The second indicates the maximum size the physical memory is
+    allowed to grow to. Generally, the physical memory can stay much smaller
     than the virtual buffer length if the application is draining the data as
     it comes in. Only when data is received faster than the application can
-    drain it does the physical buffer start to increase in size to accomodate
+    drain it does the physical memory start to increase in size to accomodate
     the queued up buffer.
 
-    When physical buffer space runs out, assuming more 'virtual' space is
-    available, the physical buffer will be reallocated and copied over.
-    Physical buffer space always doubles in size as it grows.
+    Streams use a chunked buffer: a ring of pointers to fixed size chunks, each
+    holding the bytes of one chunk aligned range of stream offsets. A chunk is
+    only allocated (generally from a per-worker pool) when bytes are copied into
+    it, and is freed as soon as all its bytes have been drained. Growing the
+    buffer never copies any data, and the application may be indicated
+    multiple buffers at a time (one per chunk).
+
+    The crypto stream needs all its data in a single contiguous buffer, so it
+    uses a CopyOnDrain buffer instead. When physical buffer space runs out,
+    assuming more 'virtual' space is available, this buffer is reallocated
+    and copied over. Physical buffer space always doubles in size as it grows.
 
     The VirtualBufferLength is what is used to report the maximum allowed
     stream offset to the peer. Again, if the application drains at a fast
@@ -48,13 +51,13 @@ Abstract:
 #endif
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
-QUIC_STATUS // TODO - Can only fail if PreallocatedBuffer == NULL
+QUIC_STATUS
 QuicRecvBufferInitialize(
     _Inout_ QUIC_RECV_BUFFER* RecvBuffer,
     _In_ uint32_t AllocBufferLength,
     _In_ uint32_t VirtualBufferLength,
     _In_ BOOLEAN CopyOnDrain,
-    _In_opt_ uint8_t* PreallocatedBuffer
+    _In_opt_ QUIC_POOL* ChunkPool
     )
 {
     QUIC_STATUS Status;
@@ -62,12 +65,16 @@ QuicRecvBufferInitialize(
     QUIC_DBG_ASSERT(AllocBufferLength != 0 && (AllocBufferLength & (AllocBufferLength - 1)) == 0);       // Power of 2
     QUIC_DBG_ASSERT(VirtualBufferLength != 0 && (VirtualBufferLength & (VirtualBufferLength - 1)) == 0); // Power of 2
     QUIC_DBG_ASSERT(AllocBufferLength <= VirtualBufferLength);
+    QUIC_DBG_ASSERT(!CopyOnDrain || ChunkPool == NULL);
 
-    if (PreallocatedBuffer != NULL) {
-        RecvBuffer->PreallocatedBuffer = PreallocatedBuffer;
-        RecvBuffer->Buffer = PreallocatedBuffer;
-    } else {
-        RecvBuffer->PreallocatedBuffer = NULL;
+    RecvBuffer->Buffer = NULL;
+    RecvBuffer->Chunks = NULL;
+    RecvBuffer->ChunkPool = NULL;
+    RecvBuffer->ChunkSize = 0;
+    RecvBuffer->ChunkCount = 0;
+    RecvBuffer->ChunkStart = 0;
+
+    if (CopyOnDrain) {
         RecvBuffer->Buffer = QUIC_ALLOC_NONPAGED(AllocBufferLength, QUIC_POOL_RECVBUF);
         if (RecvBuffer->Buffer == NULL) {
             QuicTraceEvent(
@@ -78,11 +85,21 @@ QuicRecvBufferInitialize(
             Status = QUIC_STATUS_OUT_OF_MEMORY;
             goto Error;
         }
+        RecvBuffer->AllocBufferLength = AllocBufferLength;
+
+    } else {
+        //
+        // The ring itself is only allocated once the first bytes need to be
+        // copied, so streams that never receive (or only receive lent bytes)
+        // don't allocate anything.
+        //
+        RecvBuffer->ChunkPool = ChunkPool;
+        RecvBuffer->ChunkSize = AllocBufferLength;
+        RecvBuffer->AllocBufferLength = 0;
     }
 
     QuicRangeInitialize(QUIC_MAX_RANGE_ALLOC_SIZE, &RecvBuffer->WrittenRanges);
 
-    RecvBuffer->AllocBufferLength = AllocBufferLength;
     RecvBuffer->VirtualBufferLength = VirtualBufferLength;
     RecvBuffer->BufferStart = 0;
     RecvBuffer->BaseOffset = 0;
@@ -96,6 +113,28 @@ Error:
     return Status;
 }
 
+//
+// Frees the chunk at the given index in the ring, if allocated.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicRecvBufferFreeChunk(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer,
+    _In_ uint32_t ChunkIndex
+    )
+{
+    uint8_t* Chunk = RecvBuffer->Chunks[ChunkIndex];
+    if (Chunk != NULL) {
+        if (RecvBuffer->ChunkPool != NULL) {
+            QuicPoolFree(RecvBuffer->ChunkPool, Chunk);
+        } else {
+            QUIC_FREE(Chunk, QUIC_POOL_RECVBUF);
+        }
+        RecvBuffer->Chunks[ChunkIndex] = NULL;
+        RecvBuffer->AllocBufferLength -= RecvBuffer->ChunkSize;
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicRecvBufferUninitialize(
@@ -103,12 +142,18 @@ QuicRecvBufferUninitialize(
     )
 {
     QuicRangeUninitialize(&RecvBuffer->WrittenRanges);
-    if (RecvBuffer->Buffer != RecvBuffer->PreallocatedBuffer) {
+    if (RecvBuffer->Chunks != NULL) {
+        for (uint32_t i = 0; i < RecvBuffer->ChunkCount; ++i) {
+            QuicRecvBufferFreeChunk(RecvBuffer, i);
+        }
+        QUIC_FREE(RecvBuffer->Chunks, QUIC_POOL_RECVBUF);
+        RecvBuffer->Chunks = NULL;
+    }
+    if (RecvBuffer->Buffer != NULL) {
         QUIC_FREE(RecvBuffer->Buffer, QUIC_POOL_RECVBUF);
     }
     RecvBuffer->Buffer = NULL;
-    if (RecvBuffer->OldBuffer != NULL &&
-        RecvBuffer->OldBuffer != RecvBuffer->PreallocatedBuffer) {
+    if (RecvBuffer->OldBuffer != NULL) {
         QUIC_FREE(RecvBuffer->OldBuffer, QUIC_POOL_RECVBUF);
     }
     RecvBuffer->OldBuffer = NULL;
@@ -143,6 +188,98 @@ QuicRecvBufferGetSpan(
     return (uint32_t)(QuicRecvBufferGetTotalLength(RecvBuffer) - RecvBuffer->BaseOffset);
 }
 
+//
+// Returns the index in the chunk ring of the chunk holding the stream offset.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicRecvBufferGetChunkIndex(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer,
+    _In_ uint64_t Offset
+    )
+{
+    QUIC_DBG_ASSERT(Offset / RecvBuffer->ChunkSize >= RecvBuffer->BaseOffset / RecvBuffer->ChunkSize);
+    uint64_t ChunkDelta =
+        Offset / RecvBuffer->ChunkSize -
+        RecvBuffer->BaseOffset / RecvBuffer->ChunkSize;
+    QUIC_DBG_ASSERT(ChunkDelta < RecvBuffer->ChunkCount);
+    return (uint32_t)((RecvBuffer->ChunkStart + ChunkDelta) % RecvBuffer->ChunkCount);
+}
+
+//
+// Makes sure the chunks holding the stream offsets from Offset up to
+// AbsoluteLength are allocated. Only the chunk pointers are moved if the ring
+// needs to grow; the chunks themselves never move.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicRecvBufferAllocChunks(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer,
+    _In_ uint64_t Offset,
+    _In_ uint64_t AbsoluteLength
+    )
+{
+    const uint32_t ChunkSize = RecvBuffer->ChunkSize;
+    uint64_t ChunksNeeded =
+        (AbsoluteLength - 1) / ChunkSize - RecvBuffer->BaseOffset / ChunkSize + 1;
+
+    if (ChunksNeeded > RecvBuffer->ChunkCount) {
+        //
+        // The ring hasn't been allocated yet, or the virtual buffer length grew
+        // since it was. A write may straddle one more chunk than the virtual
+        // length covers.
+        //
+        uint32_t NewChunkCount =
+            (RecvBuffer->VirtualBufferLength + ChunkSize - 1) / ChunkSize + 1;
+        QUIC_DBG_ASSERT(NewChunkCount >= ChunksNeeded);
+        uint8_t** NewChunks =
+            QUIC_ALLOC_NONPAGED(NewChunkCount * sizeof(uint8_t*), QUIC_POOL_RECVBUF);
+        if (NewChunks == NULL) {
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "recv_buffer chunks",
+                NewChunkCount * sizeof(uint8_t*));
+            return QUIC_STATUS_OUT_OF_MEMORY;
+        }
+        QuicZeroMemory(NewChunks, NewChunkCount * sizeof(uint8_t*));
+        for (uint32_t i = 0; i < RecvBuffer->ChunkCount; ++i) {
+            NewChunks[i] =
+                RecvBuffer->Chunks[(RecvBuffer->ChunkStart + i) % RecvBuffer->ChunkCount];
+        }
+        if (RecvBuffer->Chunks != NULL) {
+            QUIC_FREE(RecvBuffer->Chunks, QUIC_POOL_RECVBUF);
+        }
+        RecvBuffer->Chunks = NewChunks;
+        RecvBuffer->ChunkCount = NewChunkCount;
+        RecvBuffer->ChunkStart = 0;
+    }
+
+    for (uint64_t ChunkOffset = Offset - (Offset % ChunkSize);
+         ChunkOffset < AbsoluteLength;
+         ChunkOffset += ChunkSize) {
+        uint32_t ChunkIndex = QuicRecvBufferGetChunkIndex(RecvBuffer, ChunkOffset);
+        if (RecvBuffer->Chunks[ChunkIndex] == NULL) {
+            uint8_t* Chunk =
+                RecvBuffer->ChunkPool != NULL ?
+                    QuicPoolAlloc(RecvBuffer->ChunkPool) :
+                    QUIC_ALLOC_NONPAGED(ChunkSize, QUIC_POOL_RECVBUF);
+            if (Chunk == NULL) {
+                QuicTraceEvent(
+                    AllocFailure,
+                    "Allocation of '%s' failed. (%llu bytes)",
+                    "recv_buffer chunk",
+                    ChunkSize);
+                return QUIC_STATUS_OUT_OF_MEMORY;
+            }
+            RecvBuffer->Chunks[ChunkIndex] = Chunk;
+            RecvBuffer->AllocBufferLength += ChunkSize;
+        }
+    }
+
+    return QUIC_STATUS_SUCCESS;
+}
+
 //
 // Allocates a new contiguous buffer of the target size and copies the bytes
 // into it.
@@ -189,9 +326,13 @@ QuicRecvBufferResize(
                 Span - LengthTillWrap);
         }
 
-        if (RecvBuffer->ExternalBufferReference && RecvBuffer->OldBuffer == NULL) {
+        if (RecvBuffer->Buffer == NULL) {
+            //
+            // The buffer was trimmed, so there was nothing to copy.
+            //
+        } else if (RecvBuffer->ExternalBufferReference && RecvBuffer->OldBuffer == NULL) {
             RecvBuffer->OldBuffer = RecvBuffer->Buffer;
-        } else if (RecvBuffer->Buffer != RecvBuffer->PreallocatedBuffer) {
+        } else {
             QUIC_FREE(RecvBuffer->Buffer, QUIC_POOL_RECVBUF);
         }
 
@@ -205,6 +346,25 @@ Error:
     return Status;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicRecvBufferTrim(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer
+    )
+{
+    QUIC_DBG_ASSERT(RecvBuffer->CopyOnDrain);
+    if (RecvBuffer->Buffer == NULL ||
+        RecvBuffer->ExternalBufferReference ||
+        QuicRecvBufferGetSpan(RecvBuffer) != 0) {
+        return;
+    }
+
+    QUIC_FREE(RecvBuffer->Buffer, QUIC_POOL_RECVBUF);
+    RecvBuffer->Buffer = NULL;
+    RecvBuffer->AllocBufferLength = 0;
+    RecvBuffer->BufferStart = 0;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicRecvBufferSetVirtualBufferLength(
@@ -231,7 +391,7 @@ QuicRecvBufferWrite(
     _In_ QUIC_RECV_BUFFER* RecvBuffer,
     _In_ uint64_t BufferOffset,
     _In_ uint16_t BufferLength,
-    _In_reads_bytes_(BufferLength) uint8_t const* Buffer,
+    _In_reads_bytes_opt_(BufferLength) uint8_t const* Buffer,
     _Inout_ uint64_t* WriteLength,
     _Out_ BOOLEAN* ReadyToRead
     )
@@ -287,16 +447,32 @@ QuicRecvBufferWrite(
     }
 
     //
-    // Check to see if the input buffer is trying to write beyond the
-    // currently allocated length.
+    // Make sure there is room for the new data. Lent bytes don't need any.
     //
-    if (AbsoluteLength > RecvBuffer->BaseOffset + RecvBuffer->AllocBufferLength) {
+    if (Buffer == NULL) {
+        //
+        // Nothing to allocate.
+        //
+    } else if (RecvBuffer->ChunkSize != 0) {
+        Status =
+            QuicRecvBufferAllocChunks(
+                RecvBuffer,
+                BufferOffset < RecvBuffer->BaseOffset ?
+                    RecvBuffer->BaseOffset : BufferOffset,
+                AbsoluteLength);
+        if (QUIC_FAILED(Status)) {
+            goto Error;
+        }
+
+    } else if (AbsoluteLength > RecvBuffer->BaseOffset + RecvBuffer->AllocBufferLength) {
 
         //
         // Make room for the new data.
         //
 
-        uint32_t NewBufferLength = RecvBuffer->AllocBufferLength << 1;
+        uint32_t NewBufferLength =
+            RecvBuffer->AllocBufferLength == 0 ? // Trimmed
+                1 : RecvBuffer->AllocBufferLength << 1;
         while (AbsoluteLength > RecvBuffer->BaseOffset + NewBufferLength) {
             NewBufferLength <<= 1;
         }
@@ -333,6 +509,16 @@ QuicRecvBufferWrite(
         goto Error;
     }
 
+    if (Buffer == NULL) {
+        //
+        // The bytes are lent, so there is nothing to copy.
+        //
+        QUIC_DBG_ASSERT(UpdatedRange->Low == 0);
+        *ReadyToRead = TRUE;
+        Status = QUIC_STATUS_SUCCESS;
+        goto Error;
+    }
+
     //
     // Calculate the relative offset from the stream buffer's current base offset.
     //
@@ -345,6 +531,31 @@ QuicRecvBufferWrite(
         RelativeOffset = (uint32_t)(BufferOffset - RecvBuffer->BaseOffset);
     }
 
+    if (RecvBuffer->ChunkSize != 0) {
+        //
+        // Copy the data chunk by chunk.
+        //
+        uint64_t WriteOffset = RecvBuffer->BaseOffset + RelativeOffset;
+        while (BufferLength != 0) {
+            uint32_t ChunkOffset = (uint32_t)(WriteOffset % RecvBuffer->ChunkSize);
+            uint16_t CopyLength = BufferLength;
+            if (CopyLength > RecvBuffer->ChunkSize - ChunkOffset) {
+                CopyLength = (uint16_t)(RecvBuffer->ChunkSize - ChunkOffset);
+            }
+            uint8_t* Chunk =
+                RecvBuffer->Chunks[QuicRecvBufferGetChunkIndex(RecvBuffer, WriteOffset)];
+            QUIC_DBG_ASSERT(Chunk != NULL);
+            QuicCopyMemory(Chunk + ChunkOffset, Buffer, CopyLength);
+            WriteOffset += CopyLength;
+            Buffer += CopyLength;
+            BufferLength -= CopyLength;
+        }
+
+        *ReadyToRead = UpdatedRange->Low == 0;
+        Status = QUIC_STATUS_SUCCESS;
+        goto Error;
+    }
+
     //
     // Calculate the actual starting point in the buffer that we will write to,
     // accounting for wrap around.
@@ -438,7 +649,32 @@ QuicRecvBufferRead(
     RecvBuffer->ExternalBufferReference = TRUE;
     *BufferOffset = RecvBuffer->BaseOffset;
 
-    if (RecvBuffer->BufferStart + WrittenRangeLength > RecvBuffer->AllocBufferLength) {
+    if (RecvBuffer->ChunkSize != 0) {
+        //
+        // Return one buffer per chunk, up to the number of buffers the caller
+        // has room for. The rest is returned by the next read.
+        //
+        uint64_t ReadOffset = RecvBuffer->BaseOffset;
+        uint32_t Count = 0;
+        QUIC_DBG_ASSERT(*BufferCount >= 1);
+        while (WrittenRangeLength != 0 && Count < *BufferCount) {
+            uint32_t ChunkOffset = (uint32_t)(ReadOffset % RecvBuffer->ChunkSize);
+            uint32_t Length = RecvBuffer->ChunkSize - ChunkOffset;
+            if (Length > WrittenRangeLength) {
+                Length = (uint32_t)WrittenRangeLength;
+            }
+            uint8_t* Chunk =
+                RecvBuffer->Chunks[QuicRecvBufferGetChunkIndex(RecvBuffer, ReadOffset)];
+            QUIC_DBG_ASSERT(Chunk != NULL);
+            Buffers[Count].Length = Length;
+            Buffers[Count].Buffer = Chunk + ChunkOffset;
+            ReadOffset += Length;
+            WrittenRangeLength -= Length;
+            Count++;
+        }
+        *BufferCount = Count;
+
+    } else if (RecvBuffer->BufferStart + WrittenRangeLength > RecvBuffer->AllocBufferLength) {
         //
         // Circular buffer wrap around case.
         //
@@ -466,13 +702,14 @@ QuicRecvBufferDrain(
     _In_ uint64_t BufferLength
     )
 {
-    QUIC_DBG_ASSERT(RecvBuffer->ExternalBufferReference);
+    //
+    // Lent bytes are delivered without QuicRecvBufferRead, so there may not be
+    // an external reference.
+    //
     RecvBuffer->ExternalBufferReference = FALSE;
 
     if (RecvBuffer->OldBuffer != NULL) {
-        if (RecvBuffer->OldBuffer != RecvBuffer->PreallocatedBuffer) {
-            QUIC_FREE(RecvBuffer->OldBuffer, QUIC_POOL_RECVBUF);
-        }
+        QUIC_FREE(RecvBuffer->OldBuffer, QUIC_POOL_RECVBUF);
         RecvBuffer->OldBuffer = NULL;
     }
 
@@ -480,18 +717,45 @@ QuicRecvBufferDrain(
         return FALSE;
     }
 
+    if (RecvBuffer->Chunks != NULL) {
+        //
+        // Free all the chunks that have been completely drained.
+        //
+        uint64_t ChunksDrained =
+            (RecvBuffer->BaseOffset + BufferLength) / RecvBuffer->ChunkSize -
+            RecvBuffer->BaseOffset / RecvBuffer->ChunkSize;
+        uint32_t FreeCount =
+            ChunksDrained < RecvBuffer->ChunkCount ?
+                (uint32_t)ChunksDrained : RecvBuffer->ChunkCount;
+        for (uint32_t i = 0; i < FreeCount; ++i) {
+            QuicRecvBufferFreeChunk(
+                RecvBuffer,
+                (RecvBuffer->ChunkStart + i) % RecvBuffer->ChunkCount);
+        }
+        RecvBuffer->ChunkStart =
+            (uint32_t)((RecvBuffer->ChunkStart + ChunksDrained) % RecvBuffer->ChunkCount);
+    }
+
     RecvBuffer->BaseOffset += BufferLength;
     uint64_t TotalWrittenLength = QuicRangeGetMax(&RecvBuffer->WrittenRanges) + 1;
 
     if (RecvBuffer->BaseOffset == TotalWrittenLength) {
         //
-        // All buffer has been drained. Just reset start back to beginning.
+        // All buffer has been drained. Just reset start back to beginning, and
+        // don't hold on to the partially drained chunk either.
         //
         RecvBuffer->BufferStart = 0;
+        if (RecvBuffer->Chunks != NULL) {
+            QuicRecvBufferFreeChunk(RecvBuffer, RecvBuffer->ChunkStart);
+        }
         return TRUE;
     }
 
-    if (RecvBuffer->CopyOnDrain) {
+    if (RecvBuffer->ChunkSize != 0) {
+        //
+        // Nothing else to update.
+        //
+    } else if (RecvBuffer->CopyOnDrain) {
         QUIC_DBG_ASSERT(RecvBuffer->BufferStart == 0);
         //
         // Copy remaining bytes in the buffer to the beginning.
@@ -9,7 +9,9 @@ typedef struct QUIC_RECV_BUFFER {
 
     //
     // Flag to indicate that after a drain, copy any remaining bytes to the
-    // front of the buffer or reset the pointers to 0.
+    // front of the buffer or reset the pointers to 0. Such a buffer always
+    // uses a single contiguous allocation. Otherwise, the buffer is built from
+    // a ring of fixed size chunks.
     //
     BOOLEAN CopyOnDrain : 1;
 
@@ -22,23 +24,46 @@ typedef struct QUIC_RECV_BUFFER {
 
     //
     // Previous buffer that needs to be freed as soon as the external reference
-    // is released.
+    // is released. Only used by the contiguous buffer.
     //
     uint8_t * OldBuffer;
 
     //
-    // Circular buffer used for storing the writes.
+    // Contiguous buffer used for storing the writes.
     //
     uint8_t * Buffer;
 
     //
-    // Optional, preallocated initial buffer.
+    // Ring of chunk pointers used for storing the writes. Each chunk holds
+    // ChunkSize bytes at a ChunkSize aligned stream offset. Chunks are only
+    // allocated when bytes are copied into them and NULL otherwise. The ring
+    // itself is NULL until the first chunk is needed.
     //
-    uint8_t * PreallocatedBuffer;
+    uint8_t ** Chunks;
 
     //
-    // Length of memory allocated for 'Buffer'. Dynamically grows up to
-    // VirtualBufferLength.
+    // Optional pool to allocate the chunks from.
+    //
+    QUIC_POOL* ChunkPool;
+
+    //
+    // The size of each chunk in 'Chunks'. Zero for the contiguous buffer.
+    //
+    uint32_t ChunkSize;
+
+    //
+    // The number of entries in the 'Chunks' ring.
+    //
+    uint32_t ChunkCount;
+
+    //
+    // The index in 'Chunks' of the chunk that holds BaseOffset.
+    //
+    uint32_t ChunkStart;
+
+    //
+    // Length of memory allocated for 'Buffer' or all the allocated chunks.
+    // The contiguous buffer dynamically grows up to VirtualBufferLength.
     //
     uint32_t AllocBufferLength;
 
@@ -53,7 +78,7 @@ typedef struct QUIC_RECV_BUFFER {
     uint64_t BaseOffset;
 
     //
-    // Start of the head in the circular 'Buffer'.
+    // Start of the head in the contiguous circular 'Buffer'.
     //
     uint32_t BufferStart;
 
@@ -64,6 +89,11 @@ typedef struct QUIC_RECV_BUFFER {
 
 } QUIC_RECV_BUFFER;
 
+//
+// Initializes the receive buffer. For a chunked (not CopyOnDrain) buffer,
+// AllocBufferLength is the size of each chunk, and the optional ChunkPool must
+// allocate entries of that size.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 QuicRecvBufferInitialize(
@@ -71,7 +101,7 @@ QuicRecvBufferInitialize(
     _In_ uint32_t AllocBufferLength,
     _In_ uint32_t VirtualBufferLength,
     _In_ BOOLEAN CopyOnDrain,
-    _In_opt_ uint8_t* PreallocatedBuffer
+    _In_opt_ QUIC_POOL* ChunkPool
     );
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -89,6 +119,16 @@ QuicRecvBufferGetTotalLength(
     _In_ QUIC_RECV_BUFFER* RecvBuffer
     );
 
+//
+// Frees a contiguous (CopyOnDrain) buffer's allocation while it doesn't hold
+// any bytes. The next write allocates it again, only as large as needed.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicRecvBufferTrim(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer
+    );
+
 //
 // Changes the buffer's virtual buffer length.
 //
@@ -111,6 +151,10 @@ QuicRecvBufferHasUnreadData(
 //
 // Buffers a (possibly out-of-order or duplicate) range of bytes.
 //
+// If Buffer is NULL, the bytes are held (lent) by the caller: only the range is
+// accounted for and the caller must deliver the bytes itself. This is only
+// valid for new bytes directly following all the bytes already written.
+//
 // Returns TRUE if in-order bytes are ready to be delivered
 // to the client.
 //
@@ -120,7 +164,7 @@ QuicRecvBufferWrite(
     _In_ QUIC_RECV_BUFFER* RecvBuffer,
     _In_ uint64_t BufferOffset,
     _In_ uint16_t BufferLength,
-    _In_reads_bytes_(BufferLength) uint8_t const* Buffer,
+    _In_reads_bytes_opt_(BufferLength) uint8_t const* Buffer,
     _Inout_ uint64_t* WriteLength,
     _Out_ BOOLEAN* ReadyToRead
     );
@@ -144,7 +188,7 @@ QuicRecvBufferRead(
     );
 
 //
-// Marks a number of bytes at the beginning of the buffer as
+// Marks a number of bytes at the beginning of the buffer (read or lent) as
 // delivered (freeing space in the buffer).
 //
 // Invalidates the pointer returned by QuicRecvBufferRead.
@@ -85,9 +85,20 @@ MsQuicRegistrationOpen(
     }
 
     uint16_t WorkerThreadFlags = 0;
+    BOOLEAN InlineExecution = FALSE;
     switch (Registration->ExecProfile) {
     default:
     case QUIC_EXECUTION_PROFILE_LOW_LATENCY:
+        //
+        // Only app registrations with the low latency profile run their workers
+        // on the datapath threads. The others explicitly want threads of their
+        // own, and the internal one has to outlive the datapath.
+        //
+        InlineExecution =
+            Registration->ExecProfile == QUIC_EXECUTION_PROFILE_LOW_LATENCY &&
+            MsQuicLib.ExecutionMode == QUIC_EXECUTION_MODE_DATAPATH_INLINE &&
+            (QuicDataPathGetSupportedFeatures(MsQuicLib.Datapath) &
+                QUIC_DATAPATH_FEATURE_EXECUTION_CONTEXTS);
         WorkerThreadFlags = QUIC_THREAD_FLAG_NONE;
         break;
     case QUIC_EXECUTION_PROFILE_TYPE_MAX_THROUGHPUT:
@@ -121,6 +132,7 @@ MsQuicRegistrationOpen(
         QuicWorkerPoolInitialize(
             Registration,
             WorkerThreadFlags,
+            InlineExecution,
             Registration->NoPartitioning ? 1 : MsQuicLib.PartitionCount,
             &Registration->WorkerPool);
     if (QUIC_FAILED(Status)) {
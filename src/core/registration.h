@@ -26,7 +26,11 @@ typedef enum QUIC_CONNECTION_ACCEPT_RESULT {
 //
 typedef struct QUIC_REGISTRATION {
 
+#ifdef QUIC_CORE_UNIT_TEST
+    struct QUIC_HANDLE _;
+#else
     struct QUIC_HANDLE;
+#endif
 
 #ifdef QuicVerifierEnabledByAddr
     //
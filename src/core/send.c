@@ -33,6 +33,11 @@ QuicSendInitialize(
     )
 {
     QuicListInitializeHead(&Send->SendStreams);
+    for (uint8_t i = 0; i <= QUIC_STREAM_PRIORITY_URGENCY_MAX; ++i) {
+        QuicListInitializeHead(&Send->ReadyStreams[i]);
+    }
+    QuicListInitializeHead(&Send->SkippedStreams);
+    QuicListInitializeHead(&Send->FlowBlockedStreams);
     Send->MaxData = Settings->ConnFlowControlWindow;
 }
 
@@ -62,6 +67,7 @@ QuicSendUninitialize(
         Entry = Entry->Flink;
         Stream->SendFlags = 0;
         Stream->SendLink.Flink = NULL;
+        Stream->ScheduleState = QUIC_SEND_SCHEDULE_NONE;
 
         QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
     }
@@ -136,6 +142,84 @@ QuicSendQueueFlush(
     }
 }
 
+//
+// Removes the stream from the send queue and the scheduler's lists. The caller
+// is responsible for releasing the send reference.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendRemoveStream(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    UNREFERENCED_PARAMETER(Send);
+    QUIC_DBG_ASSERT(Stream->SendLink.Flink != NULL);
+    QUIC_DBG_ASSERT(Stream->ScheduleState != QUIC_SEND_SCHEDULE_NONE);
+    QuicListEntryRemove(&Stream->SendLink);
+    Stream->SendLink.Flink = NULL;
+    QuicListEntryRemove(&Stream->ScheduleLink);
+    Stream->ScheduleState = QUIC_SEND_SCHEDULE_NONE;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUnblockStream(
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    QUIC_DBG_ASSERT(Stream->ScheduleState == QUIC_SEND_SCHEDULE_FLOW_BLOCKED);
+    QuicListEntryRemove(&Stream->ScheduleLink);
+    //
+    // Insert at the head so the stream resumes where it left off.
+    //
+    QuicListInsertHead(
+        &Stream->Connection->Send.ReadyStreams[Stream->PriorityUrgency],
+        &Stream->ScheduleLink);
+    Stream->ScheduleState = QUIC_SEND_SCHEDULE_READY;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUpdateStreamPriority(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    //
+    // Skipped and flow blocked streams pick up the new urgency once they go
+    // back to the ready lists.
+    //
+    if (Stream->ScheduleState == QUIC_SEND_SCHEDULE_READY) {
+        QuicListEntryRemove(&Stream->ScheduleLink);
+        QuicListInsertTail(
+            &Send->ReadyStreams[Stream->PriorityUrgency],
+            &Stream->ScheduleLink);
+    }
+}
+
+//
+// Moves the streams skipped during the last flush back to the head of their
+// ready lists, in their original order.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendRestoreSkippedStreams(
+    _In_ QUIC_SEND* Send
+    )
+{
+    while (!QuicListIsEmpty(&Send->SkippedStreams)) {
+        QUIC_LIST_ENTRY* Entry = Send->SkippedStreams.Blink;
+        QUIC_STREAM* Stream =
+            QUIC_CONTAINING_RECORD(Entry, QUIC_STREAM, ScheduleLink);
+        QuicListEntryRemove(Entry);
+        QuicListInsertHead(
+            &Send->ReadyStreams[Stream->PriorityUrgency],
+            &Stream->ScheduleLink);
+        Stream->ScheduleState = QUIC_SEND_SCHEDULE_READY;
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicSendQueueFlushForStream(
@@ -150,6 +234,10 @@ QuicSendQueueFlushForStream(
         //
         QUIC_DBG_ASSERT(Stream->SendLink.Flink == NULL);
         QuicListInsertTail(&Send->SendStreams, &Stream->SendLink);
+        QuicListInsertTail(
+            &Send->ReadyStreams[Stream->PriorityUrgency],
+            &Stream->ScheduleLink);
+        Stream->ScheduleState = QUIC_SEND_SCHEDULE_READY;
         QuicStreamAddRef(Stream, QUIC_STREAM_REF_SEND);
     }
 
@@ -244,11 +332,11 @@ QuicSendSetSendFlag(
 
             QUIC_STREAM* Stream =
                 QUIC_CONTAINING_RECORD(
-                    QuicListRemoveHead(&Send->SendStreams), QUIC_STREAM, SendLink);
+                    Send->SendStreams.Flink, QUIC_STREAM, SendLink);
 
             QUIC_DBG_ASSERT(Stream->SendFlags != 0);
             Stream->SendFlags = 0;
-            Stream->SendLink.Flink = NULL;
+            QuicSendRemoveStream(Send, Stream);
 
             QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
         }
@@ -371,6 +459,15 @@ QuicSendSetStreamSendFlag(
         Stream->SendFlags |= SendFlags;
     }
 
+    if (SendFlags != 0 &&
+        Stream->ScheduleState == QUIC_SEND_SCHEDULE_FLOW_BLOCKED) {
+        //
+        // The frames may not be subject to flow control (e.g. retransmits),
+        // even if the flags were already set.
+        //
+        QuicSendUnblockStream(Stream);
+    }
+
     return SendFlags != 0;
 }
 
@@ -382,8 +479,6 @@ QuicSendClearStreamSendFlag(
     _In_ uint32_t SendFlags
     )
 {
-    UNREFERENCED_PARAMETER(Send);
-
     if (Stream->SendFlags & SendFlags) {
 
         QuicTraceLogStreamVerbose(
@@ -401,9 +496,7 @@ QuicSendClearStreamSendFlag(
             //
             // Since there are no flags left, remove the stream from the queue.
             //
-            QUIC_DBG_ASSERT(Stream->SendLink.Flink != NULL);
-            QuicListEntryRemove(&Stream->SendLink);
-            Stream->SendLink.Flink = NULL;
+            QuicSendRemoveStream(Send, Stream);
             QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
         }
     }
@@ -771,6 +864,45 @@ QuicSendWriteFrames(
                 return TRUE;
             }
         }
+
+        if (Send->SendFlags & QUIC_CONN_SEND_FLAG_ACK_FREQUENCY) {
+
+            QUIC_ACK_FREQUENCY_EX Frame;
+            Frame.SequenceNumber = Connection->AckFrequency.SendSeqNum;
+            Frame.AckElicitingThreshold = Connection->AckFrequency.PeerAckElicitingThreshold;
+            Frame.RequestedMaxAckDelay = Connection->AckFrequency.PeerMaxAckDelayUs;
+            Frame.ReorderingThreshold = Connection->AckFrequency.PeerReorderingThreshold;
+
+            if (QuicAckFrequencyFrameEncode(
+                    &Frame,
+                    &Builder->DatagramLength,
+                    AvailableBufferLength,
+                    Builder->Datagram->Buffer)) {
+
+                Send->SendFlags &= ~QUIC_CONN_SEND_FLAG_ACK_FREQUENCY;
+                Builder->Metadata->Frames[
+                    Builder->Metadata->FrameCount].ACK_FREQUENCY.Sequence =
+                        Frame.SequenceNumber;
+                if (QuicPacketBuilderAddFrame(Builder, QUIC_FRAME_ACK_FREQUENCY, TRUE)) {
+                    return TRUE;
+                }
+            } else {
+                RanOutOfRoom = TRUE;
+            }
+        }
+
+        if (Send->SendFlags & QUIC_CONN_SEND_FLAG_IMMEDIATE_ACK) {
+
+            if (Builder->DatagramLength < AvailableBufferLength) {
+                Builder->Datagram->Buffer[Builder->DatagramLength++] = QUIC_FRAME_IMMEDIATE_ACK;
+                Send->SendFlags &= ~QUIC_CONN_SEND_FLAG_IMMEDIATE_ACK;
+                if (QuicPacketBuilderAddFrame(Builder, QUIC_FRAME_IMMEDIATE_ACK, TRUE)) {
+                    return TRUE;
+                }
+            } else {
+                RanOutOfRoom = TRUE;
+            }
+        }
     }
 
     if (Send->SendFlags & QUIC_CONN_SEND_FLAG_PING) {
@@ -817,6 +949,13 @@ QuicSendCanSendStreamNow(
     return FALSE;
 }
 
+//
+// Returns the next stream to frame data from: the first stream that can send
+// from the most urgent non-empty ready list. Streams that can't send are moved
+// out of the ready lists so they aren't searched through again, until the next
+// flush or, for streams blocked by the peer's stream flow control, until the
+// block is removed.
+//
 _Success_(return != NULL)
 QUIC_STREAM*
 QuicSendGetNextStream(
@@ -827,39 +966,47 @@ QuicSendGetNextStream(
     QUIC_CONNECTION* Connection = QuicSendGetConnection(Send);
     QUIC_DBG_ASSERT(!QuicConnIsClosed(Connection) || QuicListIsEmpty(&Send->SendStreams));
 
-    QUIC_LIST_ENTRY* Entry = Send->SendStreams.Flink;
-    while (Entry != &Send->SendStreams) {
+    for (uint8_t Urgency = 0; Urgency <= QUIC_STREAM_PRIORITY_URGENCY_MAX; ++Urgency) {
 
-        //
-        // TODO: performance: We currently search through blocked
-        // streams repeatedly as we loop.
-        //
+        QUIC_LIST_ENTRY* ReadyStreams = &Send->ReadyStreams[Urgency];
+        while (!QuicListIsEmpty(ReadyStreams)) {
+
+            QUIC_STREAM* Stream =
+                QUIC_CONTAINING_RECORD(ReadyStreams->Flink, QUIC_STREAM, ScheduleLink);
 
-        QUIC_STREAM* Stream = QUIC_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink);
+            //
+            // Make sure, given the current state of the connection and the
+            // stream, that we can use the stream to frame a packet.
+            //
+            if (QuicSendCanSendStreamNow(Stream)) {
 
-        //
-        // Make sure, given the current state of the connection and the stream,
-        // that we can use the stream to frame a packet.
-        //
-        if (QuicSendCanSendStreamNow(Stream)) {
+                if (Stream->PriorityIncremental ||
+                    Connection->State.UseRoundRobinStreamScheduling) {
+                    //
+                    // Move the stream to the end of its urgency's queue.
+                    //
+                    QuicListEntryRemove(&Stream->ScheduleLink);
+                    QuicListInsertTail(ReadyStreams, &Stream->ScheduleLink);
 
-            if (Connection->State.UseRoundRobinStreamScheduling) {
-                //
-                // Move the stream to the end of the queue.
-                //
-                QuicListEntryRemove(&Stream->SendLink);
-                QuicListInsertTail(&Send->SendStreams, &Stream->SendLink);
+                    *PacketCount = QUIC_STREAM_SEND_BATCH_COUNT;
 
-                *PacketCount = QUIC_STREAM_SEND_BATCH_COUNT;
+                } else { // FIFO prioritization scheme
+                    *PacketCount = UINT32_MAX;
+                }
 
-            } else { // FIFO prioritization scheme
-                *PacketCount = UINT32_MAX;
+                return Stream;
             }
 
-            return Stream;
+            QuicListEntryRemove(&Stream->ScheduleLink);
+            if (Connection->Crypto.TlsState.WriteKey == QUIC_PACKET_KEY_1_RTT &&
+                (Stream->OutFlowBlockedReasons & QUIC_SEND_SCHEDULE_FLOW_BLOCK_REASONS)) {
+                QuicListInsertTail(&Send->FlowBlockedStreams, &Stream->ScheduleLink);
+                Stream->ScheduleState = QUIC_SEND_SCHEDULE_FLOW_BLOCKED;
+            } else {
+                QuicListInsertTail(&Send->SkippedStreams, &Stream->ScheduleLink);
+                Stream->ScheduleState = QUIC_SEND_SCHEDULE_SKIPPED;
+            }
         }
-
-        Entry = Entry->Flink;
     }
 
     return NULL;
@@ -992,6 +1139,8 @@ QuicSendFlush(
         QuicSendPathChallenges(Send);
     }
 
+    QuicSendRestoreSkippedStreams(Send);
+
     QUIC_PACKET_BUILDER Builder = { 0 };
     if (!QuicPacketBuilderInitialize(&Builder, Connection, Path)) {
         //
@@ -1113,8 +1262,7 @@ QuicSendFlush(
                 // If the stream no longer has anything to send, remove it from the
                 // list and release Send's reference on it.
                 //
-                QuicListEntryRemove(&Stream->SendLink);
-                Stream->SendLink.Flink = NULL;
+                QuicSendRemoveStream(Send, Stream);
                 QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
                 Stream = NULL;
 
@@ -1127,6 +1275,14 @@ QuicSendFlush(
             }
 
         } else if (SendFlags == QUIC_CONN_SEND_FLAG_PMTUD) {
+            if (!Connection->Paths[0].MtuDiscovery.IsSearching) {
+                //
+                // The search completed (or was reset) since the probe was
+                // queued.
+                //
+                Send->SendFlags &= ~QUIC_CONN_SEND_FLAG_PMTUD;
+                continue;
+            }
             if (!QuicPacketBuilderPrepareForPathMtuDiscovery(&Builder)) {
                 break;
             }
@@ -1136,10 +1292,11 @@ QuicSendFlush(
                 Builder.DatagramLength < Builder.Datagram->Length - Builder.EncryptionOverhead) {
                 //
                 // We are doing PMTUD, so make sure there is a PING frame in there, if
-                // we have room, just to make sure we get an ACK.
+                // we have room, so the probe is ack eliciting: we get an ACK and
+                // its loss gets detected.
                 //
                 Builder.Datagram->Buffer[Builder.DatagramLength++] = QUIC_FRAME_PING;
-                Builder.Metadata->Frames[Builder.Metadata->FrameCount++].Type = QUIC_FRAME_PING;
+                (void)QuicPacketBuilderAddFrame(&Builder, QUIC_FRAME_PING, TRUE);
                 WrotePacketFrames = TRUE;
             } else {
                 WrotePacketFrames = FALSE;
@@ -1149,6 +1306,13 @@ QuicSendFlush(
             //
             // Nothing else left to send right now.
             //
+            if (QuicCongestionControlCanSend(&Connection->CongestionControl)) {
+                //
+                // The window isn't full, so the amount of data sent is limited
+                // by the app (or flow control) and not the network.
+                //
+                QuicLossDetectionOnAppLimited(&Connection->LossDetection);
+            }
             Result = QUIC_SEND_COMPLETE;
             break;
         }
@@ -1220,15 +1384,25 @@ QuicSendStartDelayedAckTimer(
         !Connection->State.ClosedLocally &&
         !Connection->State.ClosedRemotely) {
 
+        //
+        // The peer's ACK_FREQUENCY request only applies to 1-RTT packets,
+        // which, once the handshake is confirmed, are the only ones left.
+        //
+        uint32_t MaxAckDelayMs = Connection->Settings.MaxAckDelayMs;
+        if (Connection->AckFrequency.MaxAckDelayMs != 0 &&
+            Connection->State.HandshakeConfirmed) {
+            MaxAckDelayMs = Connection->AckFrequency.MaxAckDelayMs;
+        }
+
         QuicTraceLogConnVerbose(
             StartAckDelayTimer,
             Connection,
             "Starting ACK_DELAY timer for %u ms",
-            Connection->Settings.MaxAckDelayMs);
+            MaxAckDelayMs);
         QuicConnTimerSet(
             Connection,
             QUIC_CONN_TIMER_ACK_DELAY,
-            Connection->Settings.MaxAckDelayMs); // TODO - Use smaller timeout when handshake data is outstanding.
+            MaxAckDelayMs); // TODO - Use smaller timeout when handshake data is outstanding.
         Send->DelayedAckTimerActive = TRUE;
     }
 }
@@ -85,6 +85,8 @@ QuicPacketTypeToEncryptLevel(
 #define QUIC_CONN_SEND_FLAG_PING                    0x00001000U
 #define QUIC_CONN_SEND_FLAG_HANDSHAKE_DONE          0x00002000U
 #define QUIC_CONN_SEND_FLAG_DATAGRAM                0x00004000U
+#define QUIC_CONN_SEND_FLAG_ACK_FREQUENCY           0x00008000U
+#define QUIC_CONN_SEND_FLAG_IMMEDIATE_ACK           0x00010000U
 #define QUIC_CONN_SEND_FLAG_PMTUD                   0x80000000U
 
 //
@@ -113,6 +115,8 @@ QuicPacketTypeToEncryptLevel(
     QUIC_CONN_SEND_FLAG_PATH_RESPONSE | \
     QUIC_CONN_SEND_FLAG_PING | \
     QUIC_CONN_SEND_FLAG_DATAGRAM | \
+    QUIC_CONN_SEND_FLAG_ACK_FREQUENCY | \
+    QUIC_CONN_SEND_FLAG_IMMEDIATE_ACK | \
     QUIC_CONN_SEND_FLAG_PMTUD \
 )
 
@@ -159,6 +163,26 @@ inline BOOLEAN HasStreamDataFrames(uint32_t Flags)
          QUIC_STREAM_SEND_FLAG_FIN);
 }
 
+//
+// The scheduling list a queued stream is in.
+//
+typedef enum QUIC_SEND_SCHEDULE_STATE {
+    QUIC_SEND_SCHEDULE_NONE,            // Not queued.
+    QUIC_SEND_SCHEDULE_READY,           // In ReadyStreams.
+    QUIC_SEND_SCHEDULE_SKIPPED,         // In SkippedStreams.
+    QUIC_SEND_SCHEDULE_FLOW_BLOCKED     // In FlowBlockedStreams.
+} QUIC_SEND_SCHEDULE_STATE;
+
+//
+// The stream level flow blocked reasons which keep a stream out of the
+// scheduler until they are removed.
+//
+#define QUIC_SEND_SCHEDULE_FLOW_BLOCK_REASONS \
+( \
+    QUIC_FLOW_BLOCKED_STREAM_FLOW_CONTROL | \
+    QUIC_FLOW_BLOCKED_STREAM_ID_FLOW_CONTROL \
+)
+
 typedef struct QUIC_SEND {
 
     //
@@ -187,6 +211,11 @@ typedef struct QUIC_SEND {
     //
     uint64_t NextPacketNumber;
 
+    //
+    // The number of packets sent with the ECT(0) codepoint.
+    //
+    uint64_t NumPacketsSentWithEct;
+
     //
     // Last time send flush occurred. Used for pacing calculations.
     //
@@ -224,6 +253,25 @@ typedef struct QUIC_SEND {
     //
     QUIC_LIST_ENTRY SendStreams;
 
+    //
+    // The streams of SendStreams the scheduler picks from, bucketed by
+    // urgency, most urgent first.
+    //
+    QUIC_LIST_ENTRY ReadyStreams[QUIC_STREAM_PRIORITY_URGENCY_MAX + 1];
+
+    //
+    // Streams found unable to send during the current flush. They go back to
+    // ReadyStreams at the start of the next flush.
+    //
+    QUIC_LIST_ENTRY SkippedStreams;
+
+    //
+    // Streams blocked by the peer's stream level flow control (see
+    // QUIC_SEND_SCHEDULE_FLOW_BLOCK_REASONS). They only go back to
+    // ReadyStreams once the block is removed or new frames are queued.
+    //
+    QUIC_LIST_ENTRY FlowBlockedStreams;
+
     //
     // The current token to send with an Initial packet.
     //
@@ -379,6 +427,26 @@ QuicSendSetStreamSendFlag(
     _In_ uint32_t SendFlag
     );
 
+//
+// Moves the stream back to the ready list after its stream level flow control
+// block was removed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUnblockStream(
+    _In_ QUIC_STREAM* Stream
+    );
+
+//
+// Moves a queued stream to the ready list matching its (new) priority.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUpdateStreamPriority(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    );
+
 //
 // Clears the given QUIC_STREAM_SEND_FLAG_* and removes the Stream from the
 // send queue if it no longer has anything pending.
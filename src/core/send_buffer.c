@@ -15,7 +15,15 @@ Abstract:
     bytes it should keep posted.
 
     We copy requests into fixed-sized blocks when possible, and fall back on
-    QUIC_ALLOC for large send requests.
+    QUIC_ALLOC for large send requests. The blocks are slabs taken from a
+    per-worker pool: small requests are carved off the connection's current
+    slab back to back, and each slab tracks how many of its bytes are still
+    outstanding. Once every request copied into a slab has been acknowledged
+    (or canceled), the slab goes back to the pool, so a steady stream of small
+    buffered sends never touches the general allocator. Since a single
+    long-lived request pins its whole slab, the slabs a connection holds are
+    capped at (about) IdealBytes; past that, small requests get their own
+    allocation too, until enough slabs drain.
 
     We buffer send requests until we've buffered AT LEAST the desired number
     of bytes, rather than using the ideal buffer size as a hard limit. This
@@ -74,9 +82,122 @@ QuicSendBufferUninitialize(
     _In_ QUIC_SEND_BUFFER* SendBuffer
     )
 {
+    //
+    // Every buffered request has been completed (and freed) by now, which
+    // releases the last slab.
+    //
+    QUIC_DBG_ASSERT(SendBuffer->Slab == NULL);
+    QUIC_DBG_ASSERT(SendBuffer->SlabCount == 0);
     UNREFERENCED_PARAMETER(SendBuffer);
 }
 
+//
+// Each allocation carved from a slab is prefixed with a pointer to the slab,
+// or NULL for a small allocation that didn't fit in one.
+//
+#define QUIC_SEND_BUFFER_SLAB_PREFIX sizeof(QUIC_SEND_BUFFER_SLAB*)
+
+//
+// The number of usable bytes in a slab, after its header.
+//
+#define QUIC_SEND_BUFFER_SLAB_CAPACITY \
+    (QUIC_SEND_BUFFER_SLAB_SIZE - (uint32_t)sizeof(QUIC_SEND_BUFFER_SLAB))
+
+//
+// The number of slab bytes used by an allocation of the given size.
+//
+#define QUIC_SEND_BUFFER_SLAB_ALLOC_LENGTH(Size) \
+    ((uint32_t)ALIGN_UP(QUIC_SEND_BUFFER_SLAB_PREFIX + (Size), void*))
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+uint8_t*
+QuicSendBufferSlabAlloc(
+    _Inout_ QUIC_SEND_BUFFER* SendBuffer,
+    _In_ uint32_t Size
+    )
+{
+    const uint32_t AllocLength = QUIC_SEND_BUFFER_SLAB_ALLOC_LENGTH(Size);
+    QUIC_SEND_BUFFER_SLAB* Slab = SendBuffer->Slab;
+
+    if (Slab != NULL &&
+        Slab->UsedBytes + AllocLength > QUIC_SEND_BUFFER_SLAB_CAPACITY) {
+        //
+        // Retire the full slab. It still has outstanding bytes (an empty slab
+        // is always released), and the last of them to be freed returns it to
+        // the pool.
+        //
+        QUIC_DBG_ASSERT(Slab->OutstandingBytes != 0);
+        SendBuffer->Slab = Slab = NULL;
+    }
+
+    if (Slab == NULL) {
+        if ((uint64_t)SendBuffer->SlabCount * QUIC_SEND_BUFFER_SLAB_SIZE >
+                SendBuffer->IdealBytes) {
+            //
+            // The retired slabs are held up by requests that haven't been
+            // acknowledged yet. Don't pin any more memory behind them.
+            //
+            uint8_t* Chunk =
+                (uint8_t*)QUIC_ALLOC_NONPAGED(
+                    QUIC_SEND_BUFFER_SLAB_PREFIX + Size, QUIC_POOL_SENDBUF);
+            if (Chunk == NULL) {
+                return NULL;
+            }
+            *(QUIC_SEND_BUFFER_SLAB**)Chunk = NULL;
+            return Chunk + QUIC_SEND_BUFFER_SLAB_PREFIX;
+        }
+
+        QUIC_CONNECTION* Connection = QuicSendBufferGetConnection(SendBuffer);
+        Slab = QuicPoolAlloc(&Connection->Worker->SendBufferSlabPool);
+        if (Slab == NULL) {
+            return NULL;
+        }
+        Slab->UsedBytes = 0;
+        Slab->OutstandingBytes = 0;
+        SendBuffer->Slab = Slab;
+        SendBuffer->SlabCount++;
+    }
+
+    uint8_t* Chunk = (uint8_t*)(Slab + 1) + Slab->UsedBytes;
+    *(QUIC_SEND_BUFFER_SLAB**)Chunk = Slab;
+    Slab->UsedBytes += AllocLength;
+    Slab->OutstandingBytes += AllocLength;
+
+    return Chunk + QUIC_SEND_BUFFER_SLAB_PREFIX;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSendBufferSlabFree(
+    _Inout_ QUIC_SEND_BUFFER* SendBuffer,
+    _In_ uint8_t* Buf,
+    _In_ uint32_t Size
+    )
+{
+    const uint32_t AllocLength = QUIC_SEND_BUFFER_SLAB_ALLOC_LENGTH(Size);
+    QUIC_SEND_BUFFER_SLAB* Slab =
+        *(QUIC_SEND_BUFFER_SLAB**)(Buf - QUIC_SEND_BUFFER_SLAB_PREFIX);
+
+    if (Slab == NULL) {
+        QUIC_FREE(Buf - QUIC_SEND_BUFFER_SLAB_PREFIX, QUIC_POOL_SENDBUF);
+        return;
+    }
+
+    QUIC_DBG_ASSERT(Slab->OutstandingBytes >= AllocLength);
+    Slab->OutstandingBytes -= AllocLength;
+
+    if (Slab->OutstandingBytes == 0) {
+        if (Slab == SendBuffer->Slab) {
+            SendBuffer->Slab = NULL;
+        }
+        QUIC_DBG_ASSERT(SendBuffer->SlabCount != 0);
+        SendBuffer->SlabCount--;
+        QUIC_CONNECTION* Connection = QuicSendBufferGetConnection(SendBuffer);
+        QuicPoolFree(&Connection->Worker->SendBufferSlabPool, Slab);
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Success_(return != NULL)
 uint8_t*
@@ -85,7 +206,12 @@ QuicSendBufferAlloc(
     _In_ uint32_t Size
     )
 {
-    uint8_t* Buf = (uint8_t*)QUIC_ALLOC_NONPAGED(Size, QUIC_POOL_SENDBUF);
+    uint8_t* Buf;
+    if (Size <= QUIC_SEND_BUFFER_SLAB_MAX_ALLOC) {
+        Buf = QuicSendBufferSlabAlloc(SendBuffer, Size);
+    } else {
+        Buf = (uint8_t*)QUIC_ALLOC_NONPAGED(Size, QUIC_POOL_SENDBUF);
+    }
 
     if (Buf != NULL) {
         SendBuffer->BufferedBytes += Size;
@@ -108,7 +234,11 @@ QuicSendBufferFree(
     _In_ uint32_t Size
     )
 {
-    QUIC_FREE(Buf, QUIC_POOL_SENDBUF);
+    if (Size <= QUIC_SEND_BUFFER_SLAB_MAX_ALLOC) {
+        QuicSendBufferSlabFree(SendBuffer, Buf, Size);
+    } else {
+        QUIC_FREE(Buf, QUIC_POOL_SENDBUF);
+    }
     SendBuffer->BufferedBytes -= Size;
 }
 
@@ -5,6 +5,28 @@
 
 --*/
 
+//
+// Header at the start of each slab that small buffered requests are copied
+// into. Each allocation carved from the slab is prefixed with a pointer back
+// to this header so it can be released without a lookup. Small requests that
+// don't get a slab are prefixed with NULL instead.
+//
+typedef struct QUIC_SEND_BUFFER_SLAB {
+
+    //
+    // Number of bytes already handed out from the slab.
+    //
+    uint32_t UsedBytes;
+
+    //
+    // Number of handed out bytes that haven't been freed yet. The slab is
+    // returned to the pool once this drops to zero, whether it's still the
+    // current one or not.
+    //
+    uint32_t OutstandingBytes;
+
+} QUIC_SEND_BUFFER_SLAB;
+
 typedef struct QUIC_SEND_BUFFER {
 
     //
@@ -27,6 +49,19 @@ typedef struct QUIC_SEND_BUFFER {
     //
     uint64_t IdealBytes;
 
+    //
+    // The slab new small buffered requests are copied into, allocated from
+    // the worker's pool. NULL until the first such request.
+    //
+    QUIC_SEND_BUFFER_SLAB* Slab;
+
+    //
+    // The number of slabs (current and retired) that still have outstanding
+    // bytes. A single long-lived request keeps its whole slab allocated, so
+    // this is bounded by IdealBytes.
+    //
+    uint32_t SlabCount;
+
 } QUIC_SEND_BUFFER;
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
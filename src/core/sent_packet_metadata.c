@@ -14,6 +14,10 @@ Abstract:
     contained in the packet. The allocator uses a different pool for each
     possible size.
 
+    Outstanding metadata is tracked in a QUIC_SENT_PACKET_RING, a ring buffer
+    of slots indexed by packet number. Processing an ACK range only visits
+    the slots in that range, instead of every packet sent before it.
+
 --*/
 
 #include "precomp.h"
@@ -121,3 +125,245 @@ QuicSentPacketPoolReturnPacketMetadata(
     QuicSentPacketMetadataReleaseFrames(Metadata);
     QuicPoolFree(Pool->Pools + Metadata->FrameCount - 1, Metadata);
 }
+
+QUIC_STATIC_ASSERT(
+    QUIC_SENT_PACKET_RING_MAX_SIZE >= 2 * (uint64_t)QUIC_MAX_CONGESTION_WINDOW_PACKETS,
+    "The sent packet ring must be able to track a full congestion window");
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingInitialize(
+    _Out_ QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    Ring->Packets = NULL;
+    Ring->BasePacketNumber = 0;
+    Ring->Head = 0;
+    Ring->Span = 0;
+    Ring->Capacity = 0;
+    Ring->Count = 0;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingUninitialize(
+    _In_ QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    QUIC_DBG_ASSERT(Ring->Count == 0);
+    if (Ring->Packets != NULL) {
+        QUIC_FREE(Ring->Packets, QUIC_POOL_SENT_PACKET_RING);
+        Ring->Packets = NULL;
+    }
+    Ring->Capacity = 0;
+}
+
+//
+// Returns the slot for a packet number within the current span.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA**
+QuicSentPacketRingGetSlot(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    QUIC_DBG_ASSERT(PacketNumber >= Ring->BasePacketNumber);
+    QUIC_DBG_ASSERT(PacketNumber < Ring->BasePacketNumber + Ring->Span);
+    return
+        Ring->Packets +
+        ((Ring->Head + (uint32_t)(PacketNumber - Ring->BasePacketNumber)) &
+            (Ring->Capacity - 1));
+}
+
+//
+// Grows the slot array so that it can hold at least NewSpan slots. The
+// current span is moved to the start of the new array.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicSentPacketRingGrow(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t NewSpan
+    )
+{
+    if (NewSpan > QUIC_SENT_PACKET_RING_MAX_SIZE) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "sent packet ring (too large)",
+            NewSpan * sizeof(QUIC_SENT_PACKET_METADATA*));
+        return FALSE;
+    }
+
+    uint32_t NewCapacity =
+        Ring->Capacity == 0 ? QUIC_SENT_PACKET_RING_INITIAL_SIZE : Ring->Capacity;
+    while (NewCapacity < NewSpan) {
+        NewCapacity <<= 1;
+    }
+
+    const size_t AllocLength = NewCapacity * sizeof(QUIC_SENT_PACKET_METADATA*);
+    QUIC_SENT_PACKET_METADATA** NewPackets =
+        QUIC_ALLOC_NONPAGED(AllocLength, QUIC_POOL_SENT_PACKET_RING);
+    if (NewPackets == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "sent packet ring",
+            AllocLength);
+        return FALSE;
+    }
+    QuicZeroMemory(NewPackets, AllocLength);
+
+    if (Ring->Packets != NULL) {
+        const uint32_t FirstLength = min(Ring->Span, Ring->Capacity - Ring->Head);
+        QuicCopyMemory(
+            NewPackets,
+            Ring->Packets + Ring->Head,
+            FirstLength * sizeof(QUIC_SENT_PACKET_METADATA*));
+        QuicCopyMemory(
+            NewPackets + FirstLength,
+            Ring->Packets,
+            (Ring->Span - FirstLength) * sizeof(QUIC_SENT_PACKET_METADATA*));
+        QUIC_FREE(Ring->Packets, QUIC_POOL_SENT_PACKET_RING);
+    }
+
+    Ring->Packets = NewPackets;
+    Ring->Capacity = NewCapacity;
+    Ring->Head = 0;
+
+    return TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicSentPacketRingInsert(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_METADATA* Metadata
+    )
+{
+    const uint64_t PacketNumber = Metadata->PacketNumber;
+
+    if (Ring->Count == 0) {
+        if (Ring->Capacity == 0 && !QuicSentPacketRingGrow(Ring, 1)) {
+            return QUIC_STATUS_OUT_OF_MEMORY;
+        }
+        Ring->BasePacketNumber = PacketNumber;
+        Ring->Span = 1;
+
+    } else if (PacketNumber >= QuicSentPacketRingGetEnd(Ring)) {
+        //
+        // The common case: a newer packet than any already tracked.
+        //
+        const uint64_t NewSpan = PacketNumber - Ring->BasePacketNumber + 1;
+        if (NewSpan > Ring->Capacity && !QuicSentPacketRingGrow(Ring, NewSpan)) {
+            return QUIC_STATUS_OUT_OF_MEMORY;
+        }
+        Ring->Span = (uint32_t)NewSpan;
+
+    } else if (PacketNumber < Ring->BasePacketNumber) {
+        //
+        // An older packet than any already tracked. This happens when packets
+        // from different encryption levels are moved between rings out of
+        // order.
+        //
+        const uint64_t NewSpan =
+            QuicSentPacketRingGetEnd(Ring) - PacketNumber;
+        if (NewSpan > Ring->Capacity && !QuicSentPacketRingGrow(Ring, NewSpan)) {
+            return QUIC_STATUS_OUT_OF_MEMORY;
+        }
+        Ring->Head =
+            (Ring->Head - (uint32_t)(Ring->BasePacketNumber - PacketNumber)) &
+            (Ring->Capacity - 1);
+        Ring->BasePacketNumber = PacketNumber;
+        Ring->Span = (uint32_t)NewSpan;
+    }
+
+    QUIC_SENT_PACKET_METADATA** Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+    QUIC_DBG_ASSERT(*Slot == NULL);
+    *Slot = Metadata;
+    Ring->Count++;
+
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingRemove(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    if (Ring->Count == 0 ||
+        PacketNumber < Ring->BasePacketNumber ||
+        PacketNumber >= QuicSentPacketRingGetEnd(Ring)) {
+        return NULL;
+    }
+
+    QUIC_SENT_PACKET_METADATA** Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+    QUIC_SENT_PACKET_METADATA* Metadata = *Slot;
+    if (Metadata == NULL) {
+        return NULL;
+    }
+    *Slot = NULL;
+
+    if (--Ring->Count == 0) {
+        Ring->Span = 0;
+        if (Ring->Capacity > QUIC_SENT_PACKET_RING_INITIAL_SIZE) {
+            //
+            // Release the memory grown for a burst. The next insert starts
+            // again from the initial size.
+            //
+            QUIC_FREE(Ring->Packets, QUIC_POOL_SENT_PACKET_RING);
+            Ring->Packets = NULL;
+            Ring->Capacity = 0;
+            Ring->Head = 0;
+        }
+        return Metadata;
+    }
+
+    //
+    // Keep both ends of the span on tracked packets.
+    //
+    if (PacketNumber == Ring->BasePacketNumber) {
+        do {
+            Ring->Head = (Ring->Head + 1) & (Ring->Capacity - 1);
+            Ring->BasePacketNumber++;
+            Ring->Span--;
+        } while (Ring->Packets[Ring->Head] == NULL);
+
+    } else if (PacketNumber == QuicSentPacketRingGetEnd(Ring) - 1) {
+        do {
+            Ring->Span--;
+        } while (*QuicSentPacketRingGetSlot(Ring, QuicSentPacketRingGetEnd(Ring) - 1) == NULL);
+    }
+
+    return Metadata;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetNext(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    if (Ring->Count == 0) {
+        return NULL;
+    }
+
+    if (PacketNumber < Ring->BasePacketNumber) {
+        PacketNumber = Ring->BasePacketNumber;
+    }
+
+    const uint64_t End = QuicSentPacketRingGetEnd(Ring);
+    for (; PacketNumber < End; ++PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Metadata =
+            *QuicSentPacketRingGetSlot(Ring, PacketNumber);
+        if (Metadata != NULL) {
+            return Metadata;
+        }
+    }
+
+    return NULL;
+}
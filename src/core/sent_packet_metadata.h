@@ -49,6 +49,9 @@ typedef struct QUIC_SENT_FRAME_METADATA {
         struct {
             QUIC_VAR_INT Sequence;
         } RETIRE_CONNECTION_ID;
+        struct {
+            QUIC_VAR_INT Sequence;
+        } ACK_FREQUENCY;
         struct {
             uint8_t Data[8];
         } PATH_CHALLENGE;
@@ -81,6 +84,8 @@ typedef struct QUIC_SEND_PACKET_FLAGS {
     BOOLEAN IsPMTUD                 : 1;
     BOOLEAN KeyPhase                : 1;
     BOOLEAN SuspectedLost           : 1;
+    BOOLEAN EcnEctSet               : 1;
+    BOOLEAN IsAppLimited            : 1;
 #if DEBUG
     BOOLEAN Freed                   : 1;
 #endif
@@ -99,6 +104,14 @@ typedef struct QUIC_SENT_PACKET_METADATA {
     uint16_t PacketLength;
     uint8_t PathId;
 
+    //
+    // Snapshot of the connection's delivery state when the packet was sent,
+    // used to compute a delivery rate sample once it is acknowledged.
+    //
+    uint64_t TotalBytesDelivered;
+    uint32_t DeliveredTime; // In microseconds
+    uint32_t DeliveryIntervalStart; // In microseconds
+
     //
     // Hints about the QUIC packet and included frames.
     //
@@ -185,3 +198,128 @@ QuicSentPacketPoolReturnPacketMetadata(
     _In_ QUIC_SENT_PACKET_POOL* Pool,
     _In_ QUIC_SENT_PACKET_METADATA* Metadata
     );
+
+//
+// The initial number of slots allocated for a sent packet ring.
+//
+#define QUIC_SENT_PACKET_RING_INITIAL_SIZE  64
+
+//
+// The largest number of packet numbers a sent packet ring may span (64 MB of
+// slots). It leaves room for twice the largest congestion window in packets,
+// to cover ACK-only packets and gaps left by lost packets.
+//
+#define QUIC_SENT_PACKET_RING_MAX_SIZE      0x800000u
+
+//
+// A ring buffer of sent packet metadata, indexed by packet number. Since all
+// encryption levels share a single packet number sequence, a packet can be
+// found (and removed) with a single index computation, and an acknowledged
+// range only touches the slots it covers. Slots for packet numbers that are
+// no longer (or never were) tracked are NULL, as are all slots outside of the
+// current span. The slot array grows as needed and is freed whenever the ring
+// drains, so a burst doesn't pin a large array for the connection's lifetime.
+//
+typedef struct QUIC_SENT_PACKET_RING {
+
+    //
+    // Slot array, with Capacity (a power of 2) entries.
+    //
+    QUIC_SENT_PACKET_METADATA** Packets;
+
+    //
+    // The packet number of the slot at Head. Only valid when Count != 0.
+    //
+    uint64_t BasePacketNumber;
+
+    //
+    // Index of the oldest tracked packet's slot.
+    //
+    uint32_t Head;
+
+    //
+    // The number of slots from Head up to and including the slot of the
+    // newest tracked packet.
+    //
+    uint32_t Span;
+
+    uint32_t Capacity;
+
+    //
+    // The number of non-NULL slots.
+    //
+    uint32_t Count;
+
+} QUIC_SENT_PACKET_RING;
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingInitialize(
+    _Out_ QUIC_SENT_PACKET_RING* Ring
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingUninitialize(
+    _In_ QUIC_SENT_PACKET_RING* Ring
+    );
+
+//
+// Starts tracking a packet. Fails if the slot array needed to be grown and
+// the allocation failed.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicSentPacketRingInsert(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_METADATA* Metadata
+    );
+
+//
+// Stops tracking a packet number. Returns the metadata if it was tracked.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingRemove(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    );
+
+//
+// Returns the tracked packet with the smallest packet number greater than or
+// equal to PacketNumber, or NULL if there isn't one.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetNext(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    );
+
+//
+// Returns the tracked packet with the smallest packet number, or NULL if the
+// ring is empty.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+inline
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetFirst(
+    _In_ const QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    return Ring->Count == 0 ? NULL : Ring->Packets[Ring->Head];
+}
+
+//
+// Returns the packet number just past the newest tracked packet. Only valid
+// when the ring isn't empty.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+inline
+uint64_t
+QuicSentPacketRingGetEnd(
+    _In_ const QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    return Ring->BasePacketNumber + Ring->Span;
+}
@@ -98,6 +98,24 @@ QuicSettingsSetDefault(
     if (!Settings->IsSet.ServerResumptionLevel) {
         Settings->ServerResumptionLevel = QUIC_DEFAULT_SERVER_RESUMPTION_LEVEL;
     }
+    if (!Settings->IsSet.EcnEnabled) {
+        Settings->EcnEnabled = QUIC_DEFAULT_ECN_ENABLED;
+    }
+    if (!Settings->IsSet.AsyncHandshakeEnabled) {
+        Settings->AsyncHandshakeEnabled = QUIC_DEFAULT_ASYNC_HANDSHAKE_ENABLED;
+    }
+    if (!Settings->IsSet.AckFrequencyEnabled) {
+        Settings->AckFrequencyEnabled = QUIC_DEFAULT_ACK_FREQUENCY_ENABLED;
+    }
+    if (!Settings->IsSet.TxTimePacingEnabled) {
+        Settings->TxTimePacingEnabled = QUIC_DEFAULT_TX_TIME_PACING_ENABLED;
+    }
+    if (!Settings->IsSet.CongestionControlAlgorithm) {
+        Settings->CongestionControlAlgorithm = QUIC_DEFAULT_CONGESTION_CONTROL_ALGORITHM;
+    }
+    if (!Settings->IsSet.MaximumMtu) {
+        Settings->MaximumMtu = QUIC_DEFAULT_MAXIMUM_MTU;
+    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -185,6 +203,24 @@ QuicSettingsCopy(
     if (!Destination->IsSet.ServerResumptionLevel) {
         Destination->ServerResumptionLevel = Source->ServerResumptionLevel;
     }
+    if (!Destination->IsSet.EcnEnabled) {
+        Destination->EcnEnabled = Source->EcnEnabled;
+    }
+    if (!Destination->IsSet.AsyncHandshakeEnabled) {
+        Destination->AsyncHandshakeEnabled = Source->AsyncHandshakeEnabled;
+    }
+    if (!Destination->IsSet.AckFrequencyEnabled) {
+        Destination->AckFrequencyEnabled = Source->AckFrequencyEnabled;
+    }
+    if (!Destination->IsSet.TxTimePacingEnabled) {
+        Destination->TxTimePacingEnabled = Source->TxTimePacingEnabled;
+    }
+    if (!Destination->IsSet.CongestionControlAlgorithm) {
+        Destination->CongestionControlAlgorithm = Source->CongestionControlAlgorithm;
+    }
+    if (!Destination->IsSet.MaximumMtu) {
+        Destination->MaximumMtu = Source->MaximumMtu;
+    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -329,6 +365,38 @@ QuicSettingApply(
         Destination->ServerResumptionLevel = Source->ServerResumptionLevel;
         Destination->IsSet.ServerResumptionLevel = TRUE;
     }
+    if (Source->IsSet.EcnEnabled && (!Destination->IsSet.EcnEnabled || OverWrite)) {
+        Destination->EcnEnabled = Source->EcnEnabled;
+        Destination->IsSet.EcnEnabled = TRUE;
+    }
+
+    if (Source->IsSet.AsyncHandshakeEnabled && (!Destination->IsSet.AsyncHandshakeEnabled || OverWrite)) {
+        Destination->AsyncHandshakeEnabled = Source->AsyncHandshakeEnabled;
+        Destination->IsSet.AsyncHandshakeEnabled = TRUE;
+    }
+    if (Source->IsSet.AckFrequencyEnabled && (!Destination->IsSet.AckFrequencyEnabled || OverWrite)) {
+        Destination->AckFrequencyEnabled = Source->AckFrequencyEnabled;
+        Destination->IsSet.AckFrequencyEnabled = TRUE;
+    }
+
+    if (Source->IsSet.TxTimePacingEnabled && (!Destination->IsSet.TxTimePacingEnabled || OverWrite)) {
+        Destination->TxTimePacingEnabled = Source->TxTimePacingEnabled;
+        Destination->IsSet.TxTimePacingEnabled = TRUE;
+    }
+    if (Source->IsSet.CongestionControlAlgorithm && (!Destination->IsSet.CongestionControlAlgorithm || OverWrite)) {
+        if (Source->CongestionControlAlgorithm >= QUIC_CONGESTION_CONTROL_ALGORITHM_MAX) {
+            return FALSE;
+        }
+        Destination->CongestionControlAlgorithm = Source->CongestionControlAlgorithm;
+        Destination->IsSet.CongestionControlAlgorithm = TRUE;
+    }
+    if (Source->IsSet.MaximumMtu && (!Destination->IsSet.MaximumMtu || OverWrite)) {
+        if (Source->MaximumMtu < QUIC_MIN_MTU || Source->MaximumMtu > QUIC_MAX_MTU) {
+            return FALSE;
+        }
+        Destination->MaximumMtu = Source->MaximumMtu;
+        Destination->IsSet.MaximumMtu = TRUE;
+    }
     return TRUE;
 }
 
@@ -624,6 +692,78 @@ QuicSettingsLoad(
         }
         Settings->ServerResumptionLevel = (uint8_t)Value;
     }
+
+    if (!Settings->IsSet.EcnEnabled) {
+        Value = QUIC_DEFAULT_ECN_ENABLED;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_ECN_ENABLED,
+            (uint8_t*)&Value,
+            &ValueLen);
+        Settings->EcnEnabled = !!Value;
+    }
+
+    if (!Settings->IsSet.AsyncHandshakeEnabled) {
+        Value = QUIC_DEFAULT_ASYNC_HANDSHAKE_ENABLED;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_ASYNC_HANDSHAKE_ENABLED,
+            (uint8_t*)&Value,
+            &ValueLen);
+        Settings->AsyncHandshakeEnabled = !!Value;
+    }
+
+    if (!Settings->IsSet.AckFrequencyEnabled) {
+        Value = QUIC_DEFAULT_ACK_FREQUENCY_ENABLED;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_ACK_FREQUENCY_ENABLED,
+            (uint8_t*)&Value,
+            &ValueLen);
+        Settings->AckFrequencyEnabled = !!Value;
+    }
+
+    if (!Settings->IsSet.TxTimePacingEnabled) {
+        Value = QUIC_DEFAULT_TX_TIME_PACING_ENABLED;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_TX_TIME_PACING_ENABLED,
+            (uint8_t*)&Value,
+            &ValueLen);
+        Settings->TxTimePacingEnabled = !!Value;
+    }
+
+    if (!Settings->IsSet.CongestionControlAlgorithm) {
+        Value = QUIC_DEFAULT_CONGESTION_CONTROL_ALGORITHM;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_CONGESTION_CONTROL_ALGORITHM,
+            (uint8_t*)&Value,
+            &ValueLen);
+        if (Value >= QUIC_CONGESTION_CONTROL_ALGORITHM_MAX) {
+            Value = QUIC_DEFAULT_CONGESTION_CONTROL_ALGORITHM;
+        }
+        Settings->CongestionControlAlgorithm = (uint16_t)Value;
+    }
+
+    if (!Settings->IsSet.MaximumMtu) {
+        Value = QUIC_DEFAULT_MAXIMUM_MTU;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_MAXIMUM_MTU,
+            (uint8_t*)&Value,
+            &ValueLen);
+        if (Value < QUIC_MIN_MTU || Value > QUIC_MAX_MTU) {
+            Value = QUIC_DEFAULT_MAXIMUM_MTU;
+        }
+        Settings->MaximumMtu = (uint16_t)Value;
+    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -639,6 +779,8 @@ QuicSettingsDump(
     QuicTraceLogVerbose(SettingDumpMaxOperationsPerDrain,   "[sett] MaxOperationsPerDrain  = %hhu", Settings->MaxOperationsPerDrain);
     QuicTraceLogVerbose(SettingDumpRetryMemoryLimit,        "[sett] RetryMemoryLimit       = %hu", Settings->RetryMemoryLimit);
     QuicTraceLogVerbose(SettingDumpLoadBalancingMode,       "[sett] LoadBalancingMode      = %hu", Settings->LoadBalancingMode);
+    QuicTraceLogVerbose(SettingDumpCongestionControlAlgorithm, "[sett] CongestionControlAlgorithm = %hu", Settings->CongestionControlAlgorithm);
+    QuicTraceLogVerbose(SettingDumpMaximumMtu,              "[sett] MaximumMtu             = %hu", Settings->MaximumMtu);
     QuicTraceLogVerbose(SettingDumpMaxStatelessOperations,  "[sett] MaxStatelessOperations = %u", Settings->MaxStatelessOperations);
     QuicTraceLogVerbose(SettingDumpMaxWorkerQueueDelayUs,   "[sett] MaxWorkerQueueDelayUs  = %u", Settings->MaxWorkerQueueDelayUs);
     QuicTraceLogVerbose(SettingDumpInitialWindowPackets,    "[sett] InitialWindowPackets   = %u", Settings->InitialWindowPackets);
@@ -658,6 +800,10 @@ QuicSettingsDump(
     QuicTraceLogVerbose(SettingDumpConnFlowControlWindow,   "[sett] ConnFlowControlWindow  = %u", Settings->ConnFlowControlWindow);
     QuicTraceLogVerbose(SettingDumpMaxBytesPerKey,          "[sett] MaxBytesPerKey         = %llu", Settings->MaxBytesPerKey);
     QuicTraceLogVerbose(SettingDumpServerResumptionLevel,   "[sett] ServerResumptionLevel  = %hhu", Settings->ServerResumptionLevel);
+    QuicTraceLogVerbose(SettingDumpEcnEnabled,              "[sett] EcnEnabled             = %hhu", Settings->EcnEnabled);
+    QuicTraceLogVerbose(SettingDumpAsyncHandshakeEnabled,   "[sett] AsyncHandshakeEnabled  = %hhu", Settings->AsyncHandshakeEnabled);
+    QuicTraceLogVerbose(SettingDumpAckFrequencyEnabled,     "[sett] AckFrequencyEnabled    = %hhu", Settings->AckFrequencyEnabled);
+    QuicTraceLogVerbose(SettingDumpTxTimePacingEnabled,     "[sett] TxTimePacingEnabled    = %hhu", Settings->TxTimePacingEnabled);
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -692,6 +838,12 @@ QuicSettingsDumpNew(
     if (Settings->IsSet.LoadBalancingMode) {
         QuicTraceLogVerbose(SettingDumpLoadBalancingMode,       "[sett] LoadBalancingMode      = %hu", Settings->LoadBalancingMode);
     }
+    if (Settings->IsSet.CongestionControlAlgorithm) {
+        QuicTraceLogVerbose(SettingDumpCongestionControlAlgorithm, "[sett] CongestionControlAlgorithm = %hu", Settings->CongestionControlAlgorithm);
+    }
+    if (Settings->IsSet.MaximumMtu) {
+        QuicTraceLogVerbose(SettingDumpMaximumMtu,              "[sett] MaximumMtu             = %hu", Settings->MaximumMtu);
+    }
     if (Settings->IsSet.MaxStatelessOperations) {
         QuicTraceLogVerbose(SettingDumpMaxStatelessOperations,  "[sett] MaxStatelessOperations = %u", Settings->MaxStatelessOperations);
     }
@@ -749,4 +901,16 @@ QuicSettingsDumpNew(
     if (Settings->IsSet.ServerResumptionLevel) {
         QuicTraceLogVerbose(SettingDumpServerResumptionLevel,   "[sett] ServerResumptionLevel  = %hhu", Settings->ServerResumptionLevel);
     }
+    if (Settings->IsSet.EcnEnabled) {
+        QuicTraceLogVerbose(SettingDumpEcnEnabled,              "[sett] EcnEnabled             = %hhu", Settings->EcnEnabled);
+    }
+    if (Settings->IsSet.AsyncHandshakeEnabled) {
+        QuicTraceLogVerbose(SettingDumpAsyncHandshakeEnabled,   "[sett] AsyncHandshakeEnabled  = %hhu", Settings->AsyncHandshakeEnabled);
+    }
+    if (Settings->IsSet.AckFrequencyEnabled) {
+        QuicTraceLogVerbose(SettingDumpAckFrequencyEnabled,     "[sett] AckFrequencyEnabled    = %hhu", Settings->AckFrequencyEnabled);
+    }
+    if (Settings->IsSet.TxTimePacingEnabled) {
+        QuicTraceLogVerbose(SettingDumpTxTimePacingEnabled,     "[sett] TxTimePacingEnabled    = %hhu", Settings->TxTimePacingEnabled);
+    }
 }
@@ -28,7 +28,6 @@ QuicStreamInitialize(
 {
     QUIC_STATUS Status;
     QUIC_STREAM* Stream;
-    uint8_t* PreallocatedRecvBuffer = NULL;
     uint32_t InitialRecvBufferLength;
     QUIC_WORKER* Worker = Connection->Worker;
 
@@ -48,8 +47,11 @@ QuicStreamInitialize(
     Stream->Flags.SendEnabled = TRUE;
     Stream->Flags.ReceiveEnabled = TRUE;
     Stream->RecvMaxLength = UINT64_MAX;
+    Stream->PriorityUrgency = QUIC_STREAM_PRIORITY_URGENCY_DEFAULT;
     Stream->RefCount = 1;
+    Stream->ApiSendRequestsTail = &Stream->ApiSendRequests;
     Stream->SendRequestsTail = &Stream->SendRequests;
+    Stream->RecvLentDatagramsTail = &Stream->RecvLentDatagrams;
     QuicDispatchLockInitialize(&Stream->ApiSendRequestLock);
     QuicRefInitialize(&Stream->RefCount);
     QuicRangeInitialize(
@@ -86,21 +88,14 @@ QuicStreamInitialize(
     }
 
     InitialRecvBufferLength = Connection->Settings.StreamRecvBufferDefault;
-    if (InitialRecvBufferLength == QUIC_DEFAULT_STREAM_RECV_BUFFER_SIZE) {
-        PreallocatedRecvBuffer = QuicPoolAlloc(&Worker->DefaultReceiveBufferPool);
-        if (PreallocatedRecvBuffer == NULL) {
-            Status = QUIC_STATUS_OUT_OF_MEMORY;
-            goto Exit;
-        }
-    }
-
     Status =
         QuicRecvBufferInitialize(
             &Stream->RecvBuffer,
             InitialRecvBufferLength,
             Connection->Settings.StreamRecvWindowDefault,
             FALSE,
-            PreallocatedRecvBuffer);
+            InitialRecvBufferLength == QUIC_DEFAULT_STREAM_RECV_BUFFER_SIZE ?
+                &Worker->DefaultReceiveBufferPool : NULL);
     if (QUIC_FAILED(Status)) {
         goto Exit;
     }
@@ -117,7 +112,6 @@ QuicStreamInitialize(
     Stream->Flags.Initialized = TRUE;
     *NewStream = Stream;
     Stream = NULL;
-    PreallocatedRecvBuffer = NULL;
     QuicPerfCounterIncrement(QUIC_PERF_COUNTER_STRM_ACTIVE);
 
 Exit:
@@ -127,9 +121,6 @@ Exit:
         Stream->Flags.Freed = TRUE;
         QuicPoolFree(&Worker->StreamPool, Stream);
     }
-    if (PreallocatedRecvBuffer) {
-        QuicPoolFree(&Worker->DefaultReceiveBufferPool, PreallocatedRecvBuffer);
-    }
 
     return Status;
 }
@@ -161,17 +152,12 @@ QuicStreamFree(
     QuicDispatchLockRelease(&Connection->Streams.AllStreamsLock);
 #endif
 
+    QuicStreamRecvReleaseLentDatagrams(Stream, UINT64_MAX);
     QuicRecvBufferUninitialize(&Stream->RecvBuffer);
     QuicRangeUninitialize(&Stream->SparseAckRanges);
     QuicDispatchLockUninitialize(&Stream->ApiSendRequestLock);
     QuicRefUninitialize(&Stream->RefCount);
 
-    if (Stream->RecvBuffer.PreallocatedBuffer) {
-        QuicPoolFree(
-            &Worker->DefaultReceiveBufferPool,
-            Stream->RecvBuffer.PreallocatedBuffer);
-    }
-
     Stream->Flags.Freed = TRUE;
     QuicPoolFree(&Worker->StreamPool, Stream);
 
@@ -513,11 +499,46 @@ QuicStreamParamSet(
         const void* Buffer
     )
 {
-    UNREFERENCED_PARAMETER(Stream);
-    UNREFERENCED_PARAMETER(Param);
-    UNREFERENCED_PARAMETER(BufferLength);
-    UNREFERENCED_PARAMETER(Buffer);
-    return QUIC_STATUS_INVALID_PARAMETER;
+    QUIC_STATUS Status;
+
+    switch (Param)
+    {
+    case QUIC_PARAM_STREAM_PRIORITY: {
+
+        if (BufferLength != sizeof(QUIC_STREAM_PRIORITY) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        const QUIC_STREAM_PRIORITY* Priority = (const QUIC_STREAM_PRIORITY*)Buffer;
+        if (Priority->Urgency > QUIC_STREAM_PRIORITY_URGENCY_MAX) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        Stream->PriorityIncremental = !!Priority->Incremental;
+        if (Stream->PriorityUrgency != Priority->Urgency) {
+            Stream->PriorityUrgency = Priority->Urgency;
+            QuicSendUpdateStreamPriority(&Stream->Connection->Send, Stream);
+        }
+
+        QuicTraceLogStreamInfo(
+            UpdatePriority,
+            Stream,
+            "New send priority: urgency %hhu, incremental %hhu",
+            Stream->PriorityUrgency,
+            Stream->PriorityIncremental);
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    default:
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        break;
+    }
+
+    return Status;
 }
 
 QUIC_STATUS
@@ -601,6 +622,26 @@ QuicStreamParamGet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_STREAM_PRIORITY:
+
+        if (*BufferLength < sizeof(QUIC_STREAM_PRIORITY)) {
+            *BufferLength = sizeof(QUIC_STREAM_PRIORITY);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(QUIC_STREAM_PRIORITY);
+        ((QUIC_STREAM_PRIORITY*)Buffer)->Urgency = Stream->PriorityUrgency;
+        ((QUIC_STREAM_PRIORITY*)Buffer)->Incremental = Stream->PriorityIncremental;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
     default:
         Status = QUIC_STATUS_INVALID_PARAMETER;
         break;
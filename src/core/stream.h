@@ -135,6 +135,8 @@ typedef union QUIC_STREAM_FLAGS {
         BOOLEAN ReceiveFlushQueued      : 1;    // The receive flush operation is queued.
         BOOLEAN ReceiveDataPending      : 1;    // Data (or FIN) is queued and ready for delivery.
         BOOLEAN ReceiveCallPending      : 1;    // There is an uncompleted receive to the app.
+        BOOLEAN ReceiveCallActive       : 1;    // A receive callback is being indicated to the app.
+        BOOLEAN ReceiveCompleteInline   : 1;    // The app completed the receive from the callback.
 
         BOOLEAN HandleSendShutdown      : 1;    // Send shutdown complete callback delivered.
         BOOLEAN HandleShutdown          : 1;    // Shutdown callback delivered.
@@ -185,7 +187,11 @@ typedef enum QUIC_STREAM_REF {
 //
 typedef struct QUIC_STREAM {
 
+#ifdef QUIC_CORE_UNIT_TEST
+    struct QUIC_HANDLE _;
+#else
     struct QUIC_HANDLE;
+#endif
 
     //
     // Number of references to the handle.
@@ -213,6 +219,12 @@ typedef struct QUIC_STREAM {
     //
     QUIC_LIST_ENTRY SendLink;
 
+    //
+    // The list entry in one of the output module's scheduling lists, while
+    // the stream is in the send list.
+    //
+    QUIC_LIST_ENTRY ScheduleLink;
+
 #if DEBUG
     //
     // The list entry in the stream set's list of all allocated streams.
@@ -246,6 +258,17 @@ typedef struct QUIC_STREAM {
     //
     uint8_t OutFlowBlockedReasons; // Set of QUIC_FLOW_BLOCKED_* flags
 
+    //
+    // The send priority set by the application.
+    //
+    uint8_t PriorityUrgency;
+    BOOLEAN PriorityIncremental;
+
+    //
+    // Which scheduling list ScheduleLink is currently in.
+    //
+    uint8_t ScheduleState; // QUIC_SEND_SCHEDULE_STATE
+
     //
     // Send State
     //
@@ -262,6 +285,24 @@ typedef struct QUIC_STREAM {
     //
     QUIC_DISPATCH_LOCK ApiSendRequestLock;
     QUIC_SEND_REQUEST* ApiSendRequests;
+    QUIC_SEND_REQUEST** ApiSendRequestsTail;
+
+    //
+    // Link in a STRM_SEND_BATCH operation's (or the connection's inline) list
+    // of streams to flush. Only valid while the stream's ApiSendRequests list
+    // is non-empty.
+    //
+    QUIC_STREAM* ApiSendBatchNext;
+
+    //
+    // A shutdown requested by the app from a callback on the worker thread,
+    // deferred until the current operation completes. Linked in the
+    // connection's inline shutdown list via InlineShutdownNext. Only valid
+    // while InlineShutdownFlags is nonzero.
+    //
+    QUIC_STREAM* InlineShutdownNext;
+    QUIC_STREAM_SHUTDOWN_FLAGS InlineShutdownFlags;
+    QUIC_VAR_INT InlineShutdownErrorCode;
 
     //
     // Queued send requests.
@@ -375,6 +416,21 @@ typedef struct QUIC_STREAM {
     //
     uint64_t RecvPendingLength;
 
+    //
+    // The length completed by the app via StreamReceiveComplete from within
+    // the receive callback. Only valid when ReceiveCompleteInline is set.
+    //
+    uint64_t RecvInlineCompleteLength;
+
+    //
+    // The datagrams holding stream data lent to the stream, in stream order,
+    // and the number of lent bytes not yet consumed by the app. The lent
+    // bytes always start at RecvBuffer.BaseOffset.
+    //
+    QUIC_RECV_DATAGRAM* RecvLentDatagrams;
+    QUIC_RECV_DATAGRAM** RecvLentDatagramsTail;
+    uint64_t RecvLentLength;
+
     //
     // The handler for the API client's callbacks.
     //
@@ -674,6 +730,10 @@ QuicStreamRemoveOutFlowBlockedReason(
             "[strm][%p] Send Blocked Flags: %hhu",
             Stream,
             Stream->OutFlowBlockedReasons);
+        if (Stream->ScheduleState == QUIC_SEND_SCHEDULE_FLOW_BLOCKED &&
+            (Reason & QUIC_SEND_SCHEDULE_FLOW_BLOCK_REASONS)) {
+            QuicSendUnblockStream(Stream);
+        }
         return TRUE;
     }
     return FALSE;
@@ -701,6 +761,19 @@ QuicStreamIndicateSendShutdownComplete(
     _In_ BOOLEAN GracefulShutdown
     );
 
+//
+// Appends a send request to the stream's API send request list. On success,
+// NeedsFlush indicates the list was previously empty and the caller must queue
+// an operation to flush it.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicStreamSendQueueApiRequest(
+    _In_ QUIC_STREAM* Stream,
+    _In_ QUIC_SEND_REQUEST* SendRequest,
+    _Out_ BOOLEAN* NeedsFlush
+    );
+
 //
 // Indicates data has been queued up to be sent out on the stream.
 //
@@ -710,6 +783,27 @@ QuicStreamSendFlush(
     _In_ QUIC_STREAM* Stream
     );
 
+//
+// Sets the FIN flag on the last send request in the stream's API send request
+// list, so that a graceful shutdown is processed in order after it. Returns
+// FALSE if the list is empty.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicStreamSendQueueApiFin(
+    _In_ QUIC_STREAM* Stream
+    );
+
+//
+// Flushes each stream in a list linked via ApiSendBatchNext, releasing the
+// operation reference held on each.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicStreamSendFlushBatch(
+    _In_opt_ QUIC_STREAM* Streams
+    );
+
 //
 // Copies the bytes of a send request and completes it early.
 //
@@ -804,7 +898,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamRecv(
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN EncryptedWith0Rtt,
+    _In_ QUIC_RECV_PACKET* Packet,
     _In_ QUIC_FRAME_TYPE FrameType,
     _In_ uint16_t BufferLength,
     _In_reads_bytes_(BufferLength)
@@ -813,6 +907,17 @@ QuicStreamRecv(
     _Inout_ BOOLEAN* UpdatedFlowControl
     );
 
+//
+// Returns the datagrams lent to the stream, for the given number of consumed
+// bytes (UINT64_MAX for all of them).
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicStreamRecvReleaseLentDatagrams(
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint64_t BufferLength
+    );
+
 //
 // Processes queued events and delivers them to the API client.
 //
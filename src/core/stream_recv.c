@@ -265,7 +265,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamProcessStreamFrame(
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN EncryptedWith0Rtt,
+    _In_ QUIC_RECV_PACKET* Packet,
     _In_ const QUIC_STREAM_EX* Frame
     )
 {
@@ -342,6 +342,19 @@ QuicStreamProcessStreamFrame(
             Stream->Connection->Send.MaxData -
             Stream->Connection->Send.OrderedStreamBytesReceived;
 
+        //
+        // If enabled, new in-order data is lent to the stream straight from
+        // the datagram instead of being copied, as long as only lent data is
+        // buffered ahead of it. Only one frame per datagram can be lent, and
+        // only from 1-RTT packets, since nothing is coalesced after them.
+        //
+        BOOLEAN Lend =
+            Stream->Connection->State.RecvBufferLending &&
+            Packet->IsShortHeader &&
+            !Packet->LentToStream &&
+            Frame->Offset == QuicRecvBufferGetTotalLength(&Stream->RecvBuffer) &&
+            Frame->Offset == Stream->RecvBuffer.BaseOffset + Stream->RecvLentLength;
+
         //
         // Write any nonduplicate data to the receive buffer.
         // QuicRecvBufferWrite will indicate if there is data to deliver.
@@ -351,13 +364,25 @@ QuicStreamProcessStreamFrame(
                 &Stream->RecvBuffer,
                 Frame->Offset,
                 (uint16_t)Frame->Length,
-                Frame->Data,
+                Lend ? NULL : Frame->Data,
                 &WriteLength,
                 &ReadyToDeliver);
         if (QUIC_FAILED(Status)) {
             goto Error;
         }
 
+        if (Lend) {
+            QUIC_DBG_ASSERT(WriteLength == Frame->Length);
+            Packet->LentToStream = TRUE;
+            Packet->LentBuffer = Frame->Data;
+            Packet->LentLength = (uint16_t)Frame->Length;
+            Packet->LentNext = NULL;
+            *Stream->RecvLentDatagramsTail =
+                QuicDataPathRecvPacketToRecvDatagram(Packet);
+            Stream->RecvLentDatagramsTail = &Packet->LentNext;
+            Stream->RecvLentLength += Frame->Length;
+        }
+
         //
         // Keep track of the total ordered bytes received.
         //
@@ -372,7 +397,7 @@ QuicStreamProcessStreamFrame(
                 "Flow control window exhausted!");
         }
 
-        if (EncryptedWith0Rtt) {
+        if (Packet->EncryptedWith0Rtt) {
             //
             // Keep track of the maximum length of the 0-RTT payload so that we
             // can indicate that appropriately to the API client.
@@ -431,7 +456,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamRecv(
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN EncryptedWith0Rtt,
+    _In_ QUIC_RECV_PACKET* Packet,
     _In_ QUIC_FRAME_TYPE FrameType,
     _In_ uint16_t BufferLength,
     _In_reads_bytes_(BufferLength)
@@ -545,7 +570,7 @@ QuicStreamRecv(
 
         Status =
             QuicStreamProcessStreamFrame(
-                Stream, EncryptedWith0Rtt, &Frame);
+                Stream, Packet, &Frame);
 
         break;
     }
@@ -682,21 +707,43 @@ QuicStreamRecvFlush(
     BOOLEAN FlushRecv = TRUE;
     while (FlushRecv) {
 
-        QUIC_BUFFER RecvBuffers[2];
+        QUIC_BUFFER RecvBuffers[QUIC_MAX_RECV_BUFFER_COUNT];
         QUIC_STREAM_EVENT Event = {0};
         Event.Type = QUIC_STREAM_EVENT_RECEIVE;
-        Event.RECEIVE.BufferCount = 2;
+        Event.RECEIVE.BufferCount = ARRAYSIZE(RecvBuffers);
         Event.RECEIVE.Buffers = RecvBuffers;
 
-        //
-        // Try to read the next available buffers.
-        //
-        BOOLEAN DataAvailable =
-            QuicRecvBufferRead(
-                &Stream->RecvBuffer,
-                &Event.RECEIVE.AbsoluteOffset,
-                &Event.RECEIVE.BufferCount,
-                RecvBuffers);
+        BOOLEAN DataAvailable;
+        if (Stream->RecvLentLength != 0) {
+            //
+            // Indicate the lent data directly from the datagrams. Lent data
+            // always comes before any data copied to the receive buffer.
+            //
+            uint32_t BufferCount = 0;
+            QUIC_RECV_DATAGRAM* Datagram = Stream->RecvLentDatagrams;
+            while (Datagram != NULL && BufferCount < Event.RECEIVE.BufferCount) {
+                QUIC_RECV_PACKET* Packet =
+                    QuicDataPathRecvDatagramToRecvPacket(Datagram);
+                RecvBuffers[BufferCount].Buffer = (uint8_t*)Packet->LentBuffer;
+                RecvBuffers[BufferCount].Length = Packet->LentLength;
+                BufferCount++;
+                Datagram = Packet->LentNext;
+            }
+            Event.RECEIVE.AbsoluteOffset = Stream->RecvBuffer.BaseOffset;
+            Event.RECEIVE.BufferCount = BufferCount;
+            DataAvailable = TRUE;
+
+        } else {
+            //
+            // Try to read the next available buffers.
+            //
+            DataAvailable =
+                QuicRecvBufferRead(
+                    &Stream->RecvBuffer,
+                    &Event.RECEIVE.AbsoluteOffset,
+                    &Event.RECEIVE.BufferCount,
+                    RecvBuffers);
+        }
 
         if (DataAvailable) {
             for (uint32_t i = 0; i < Event.RECEIVE.BufferCount; ++i) {
@@ -743,7 +790,26 @@ QuicStreamRecvFlush(
             Event.RECEIVE.BufferCount,
             Event.RECEIVE.Flags);
 
+        Stream->Flags.ReceiveCallActive = TRUE;
         QUIC_STATUS Status = QuicStreamIndicateEvent(Stream, &Event);
+        Stream->Flags.ReceiveCallActive = FALSE;
+
+        if (Stream->Flags.ReceiveCompleteInline) {
+            //
+            // The app called StreamReceiveComplete from within the callback.
+            // If it also pended the receive, process the completion now,
+            // instead of in a separate operation. Otherwise, the return
+            // status wins and the completion is ignored, just as it would be
+            // if it were processed after the callback.
+            //
+            Stream->Flags.ReceiveCompleteInline = FALSE;
+            if (Status == QUIC_STATUS_PENDING) {
+                FlushRecv =
+                    QuicStreamReceiveComplete(Stream, Stream->RecvInlineCompleteLength);
+                continue;
+            }
+        }
+
         if (Status == QUIC_STATUS_PENDING) {
             if (Stream->Flags.ReceiveCallPending) {
                 //
@@ -827,6 +893,10 @@ QuicStreamReceiveComplete(
     //
     // Reclaim any buffer space comsumed by the app.
     //
+    if (Stream->RecvLentLength != 0) {
+        QUIC_DBG_ASSERT(BufferLength <= Stream->RecvLentLength);
+        QuicStreamRecvReleaseLentDatagrams(Stream, BufferLength);
+    }
     if (Stream->RecvPendingLength == 0 ||
         QuicRecvBufferDrain(&Stream->RecvBuffer, BufferLength)) {
         //
@@ -910,6 +980,48 @@ QuicStreamReceiveComplete(
     return FALSE;
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicStreamRecvReleaseLentDatagrams(
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint64_t BufferLength
+    )
+{
+    while (Stream->RecvLentDatagrams != NULL && BufferLength != 0) {
+
+        QUIC_RECV_DATAGRAM* Datagram = Stream->RecvLentDatagrams;
+        QUIC_RECV_PACKET* Packet = QuicDataPathRecvDatagramToRecvPacket(Datagram);
+
+        if (BufferLength < Packet->LentLength) {
+            //
+            // Only part of the datagram's data was consumed.
+            //
+            Packet->LentBuffer += BufferLength;
+            Packet->LentLength -= (uint16_t)BufferLength;
+            Stream->RecvLentLength -= BufferLength;
+            break;
+        }
+
+        BufferLength -= Packet->LentLength;
+        Stream->RecvLentLength -= Packet->LentLength;
+        Stream->RecvLentDatagrams = Packet->LentNext;
+
+        //
+        // If the connection is already done with the datagram, it's up to the
+        // stream to return it.
+        //
+        Packet->LentToStream = FALSE;
+        if (Packet->ReleasedWhileLent) {
+            QuicDataPathBindingReturnRecvDatagrams(Datagram);
+        }
+    }
+
+    if (Stream->RecvLentDatagrams == NULL) {
+        QUIC_DBG_ASSERT(Stream->RecvLentLength == 0);
+        Stream->RecvLentDatagramsTail = &Stream->RecvLentDatagrams;
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamRecvSetEnabledState(
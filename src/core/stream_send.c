@@ -120,6 +120,7 @@ QuicStreamSendShutdown(
     Stream->Flags.SendEnabled = FALSE;
     QUIC_SEND_REQUEST* ApiSendRequests = Stream->ApiSendRequests;
     Stream->ApiSendRequests = NULL;
+    Stream->ApiSendRequestsTail = &Stream->ApiSendRequests;
     QuicDispatchLockRelease(&Stream->ApiSendRequestLock);
 
     if (Graceful) {
@@ -475,6 +476,56 @@ QuicStreamSendBufferRequest(
     return QUIC_STATUS_SUCCESS;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicStreamSendQueueApiRequest(
+    _In_ QUIC_STREAM* Stream,
+    _In_ QUIC_SEND_REQUEST* SendRequest,
+    _Out_ BOOLEAN* NeedsFlush
+    )
+{
+    QUIC_STATUS Status;
+
+    QuicDispatchLockAcquire(&Stream->ApiSendRequestLock);
+    if (!Stream->Flags.SendEnabled) {
+        *NeedsFlush = FALSE;
+        Status = QUIC_STATUS_INVALID_STATE;
+    } else {
+        //
+        // No new flush is necessary if a previous send hasn't been flushed
+        // yet.
+        //
+        *NeedsFlush = Stream->ApiSendRequests == NULL;
+        *Stream->ApiSendRequestsTail = SendRequest;
+        Stream->ApiSendRequestsTail = &SendRequest->Next;
+        Status = QUIC_STATUS_SUCCESS;
+    }
+    QuicDispatchLockRelease(&Stream->ApiSendRequestLock);
+
+    return Status;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicStreamSendQueueApiFin(
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    BOOLEAN Queued = FALSE;
+
+    QuicDispatchLockAcquire(&Stream->ApiSendRequestLock);
+    if (Stream->Flags.SendEnabled && Stream->ApiSendRequests != NULL) {
+        QUIC_SEND_REQUEST* Last =
+            QUIC_CONTAINING_RECORD(
+                Stream->ApiSendRequestsTail, QUIC_SEND_REQUEST, Next);
+        Last->Flags |= QUIC_SEND_FLAG_FIN;
+        Queued = TRUE;
+    }
+    QuicDispatchLockRelease(&Stream->ApiSendRequestLock);
+
+    return Queued;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicStreamSendFlush(
@@ -484,6 +535,7 @@ QuicStreamSendFlush(
     QuicDispatchLockAcquire(&Stream->ApiSendRequestLock);
     QUIC_SEND_REQUEST* ApiSendRequests = Stream->ApiSendRequests;
     Stream->ApiSendRequests = NULL;
+    Stream->ApiSendRequestsTail = &Stream->ApiSendRequests;
     QuicDispatchLockRelease(&Stream->ApiSendRequestLock);
     int64_t TotalBytesSent = 0;
 
@@ -593,6 +645,26 @@ QuicStreamSendFlush(
     QuicPerfCounterAdd(QUIC_PERF_COUNTER_APP_SEND_BYTES, TotalBytesSent);
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicStreamSendFlushBatch(
+    _In_opt_ QUIC_STREAM* Streams
+    )
+{
+    while (Streams != NULL) {
+        QUIC_STREAM* Stream = Streams;
+        Streams = Stream->ApiSendBatchNext;
+
+        //
+        // Unlink before flushing, since the stream may be added to another
+        // batch as soon as its API send request list is emptied.
+        //
+        Stream->ApiSendBatchNext = NULL;
+        QuicStreamSendFlush(Stream);
+        QuicStreamRelease(Stream, QUIC_STREAM_REF_OPERATION);
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Ret_range_(0, Len)
 uint16_t
@@ -0,0 +1,181 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    The TLS pool is a small set of threads that run TLS handshake processing
+    off of the workers. A connection that opts in (AsyncHandshakeEnabled)
+    prepares its received crypto data on the worker and then hands the crypto
+    object off to the pool. While the pool owns it, the connection is parked:
+    the worker doesn't drain its operations or fire its timers, but keeps
+    processing all its other connections. Once TLS completes, the result is
+    posted back to the connection as a TLS complete operation.
+
+--*/
+
+#include "precomp.h"
+#ifdef QUIC_CLOG
+#include "tls_pool.c.clog.h"
+#endif
+
+//
+// Thread callback for processing the requests queued on the pool.
+//
+QUIC_THREAD_CALLBACK(QuicTlsPoolThread, Context);
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicTlsPoolInitialize(
+    _In_ uint16_t ThreadCount,
+    _Out_ QUIC_TLS_POOL** NewTlsPool
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    QUIC_DBG_ASSERT(ThreadCount > 0);
+
+    const size_t TlsPoolSize =
+        sizeof(QUIC_TLS_POOL) + ThreadCount * sizeof(QUIC_THREAD);
+
+    QUIC_TLS_POOL* TlsPool = QUIC_ALLOC_NONPAGED(TlsPoolSize, QUIC_POOL_TLS_POOL);
+    if (TlsPool == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "QUIC_TLS_POOL",
+            TlsPoolSize);
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    QuicZeroMemory(TlsPool, TlsPoolSize);
+    TlsPool->Enabled = TRUE;
+    QuicEventInitialize(&TlsPool->Ready, FALSE, FALSE);
+    QuicDispatchLockInitialize(&TlsPool->Lock);
+    QuicListInitializeHead(&TlsPool->Requests);
+
+    for (uint16_t i = 0; i < ThreadCount; ++i) {
+        QUIC_THREAD_CONFIG ThreadConfig = {
+            QUIC_THREAD_FLAG_NONE,
+            i,
+            "quic_tls",
+            QuicTlsPoolThread,
+            TlsPool
+        };
+
+        Status = QuicThreadCreate(&ThreadConfig, &TlsPool->Threads[i]);
+        if (QUIC_FAILED(Status)) {
+            QuicTraceLogWarning(
+                TlsPoolThreadCreateFailed,
+                "[tlsp] Failed to create thread, 0x%x",
+                Status);
+            break;
+        }
+        TlsPool->ThreadCount++;
+    }
+
+    if (QUIC_FAILED(Status)) {
+        QuicTlsPoolUninitialize(TlsPool);
+        return Status;
+    }
+
+    QuicTraceLogInfo(
+        TlsPoolCreated,
+        "[tlsp] Created with %hu threads",
+        ThreadCount);
+
+    *NewTlsPool = TlsPool;
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicTlsPoolUninitialize(
+    _In_ QUIC_TLS_POOL* TlsPool
+    )
+{
+    //
+    // Each exiting thread sets the event again, so a single set wakes them all.
+    //
+    TlsPool->Enabled = FALSE;
+    QuicEventSet(TlsPool->Ready);
+    for (uint16_t i = 0; i < TlsPool->ThreadCount; ++i) {
+        QuicThreadWait(&TlsPool->Threads[i]);
+        QuicThreadDelete(&TlsPool->Threads[i]);
+    }
+
+    //
+    // Connections hold a reference while queued here, so by the time the
+    // library is unloaded there must be nothing left.
+    //
+    QUIC_TEL_ASSERT(QuicListIsEmpty(&TlsPool->Requests));
+
+    QuicDispatchLockUninitialize(&TlsPool->Lock);
+    QuicEventUninitialize(TlsPool->Ready);
+    QUIC_FREE(TlsPool, QUIC_POOL_TLS_POOL);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicTlsPoolQueue(
+    _In_ QUIC_TLS_POOL* TlsPool,
+    _In_ QUIC_CRYPTO* Crypto
+    )
+{
+    QuicDispatchLockAcquire(&TlsPool->Lock);
+    QuicListInsertTail(&TlsPool->Requests, &Crypto->TlsPoolLink);
+    QuicDispatchLockRelease(&TlsPool->Lock);
+    QuicEventSet(TlsPool->Ready);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CRYPTO*
+QuicTlsPoolDequeue(
+    _In_ QUIC_TLS_POOL* TlsPool
+    )
+{
+    QUIC_CRYPTO* Crypto = NULL;
+    BOOLEAN MoreRequests = FALSE;
+    QuicDispatchLockAcquire(&TlsPool->Lock);
+    if (!QuicListIsEmpty(&TlsPool->Requests)) {
+        Crypto =
+            QUIC_CONTAINING_RECORD(
+                QuicListRemoveHead(&TlsPool->Requests), QUIC_CRYPTO, TlsPoolLink);
+        MoreRequests = !QuicListIsEmpty(&TlsPool->Requests);
+    }
+    QuicDispatchLockRelease(&TlsPool->Lock);
+
+    if (MoreRequests) {
+        //
+        // The event is auto-reset, so pass the wake on to another thread to
+        // pick up the rest of the queue in parallel.
+        //
+        QuicEventSet(TlsPool->Ready);
+    }
+
+    return Crypto;
+}
+
+QUIC_THREAD_CALLBACK(QuicTlsPoolThread, Context)
+{
+    QUIC_TLS_POOL* TlsPool = (QUIC_TLS_POOL*)Context;
+
+    while (TRUE) {
+        QuicEventWaitForever(TlsPool->Ready);
+        if (!TlsPool->Enabled) {
+            break;
+        }
+
+        QUIC_CRYPTO* Crypto;
+        while ((Crypto = QuicTlsPoolDequeue(TlsPool)) != NULL) {
+            QuicCryptoProcessOffloadedData(Crypto);
+        }
+    }
+
+    //
+    // Wake up the next thread so it can exit too.
+    //
+    QuicEventSet(TlsPool->Ready);
+
+    QUIC_THREAD_RETURN(QUIC_STATUS_SUCCESS);
+}
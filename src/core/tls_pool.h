@@ -0,0 +1,76 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+--*/
+
+//
+// A set of threads dedicated to running TLS handshake processing on behalf of
+// connections, so that the expensive public key cryptography doesn't stall the
+// workers (and every other connection queued on them).
+//
+typedef struct QUIC_TLS_POOL {
+
+    //
+    // TRUE if the pool is currently running.
+    //
+    BOOLEAN Enabled;
+
+    //
+    // The number of threads in the pool.
+    //
+    uint16_t ThreadCount;
+
+    //
+    // An event to kick the threads.
+    //
+    QUIC_EVENT Ready;
+
+    //
+    // Serializes access to the request list.
+    //
+    QUIC_DISPATCH_LOCK Lock;
+
+    //
+    // Queue of crypto objects with TLS processing to be done.
+    //
+    QUIC_LIST_ENTRY Requests;
+
+    //
+    // The threads processing requests.
+    //
+    _Field_size_(ThreadCount)
+    QUIC_THREAD Threads[0];
+
+} QUIC_TLS_POOL;
+
+//
+// Creates a new TLS pool with the given number of threads.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicTlsPoolInitialize(
+    _In_ uint16_t ThreadCount,
+    _Out_ QUIC_TLS_POOL** NewTlsPool
+    );
+
+//
+// Stops the pool's threads and frees the pool.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicTlsPoolUninitialize(
+    _In_ QUIC_TLS_POOL* TlsPool
+    );
+
+//
+// Queues the crypto object to have its prepared TLS data processed by one of
+// the pool's threads.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicTlsPoolQueue(
+    _In_ QUIC_TLS_POOL* TlsPool,
+    _In_ QUIC_CRYPTO* Crypto
+    );
@@ -0,0 +1,255 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the congestion control algorithm dispatch and the delivery
+    rate sampling that feeds it.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "CongestionControlTest.cpp.clog.h"
+#endif
+
+#define TEST_MTU                1280
+#define TEST_INITIAL_WINDOW     10
+
+struct CcConnection {
+    QUIC_CONNECTION* Connection;
+    QUIC_CONGESTION_CONTROL* Cc;
+    uint64_t NextPacketNumber;
+    CcConnection(QUIC_CONGESTION_CONTROL_ALGORITHM Algorithm) : NextPacketNumber(0) {
+        Connection =
+            (QUIC_CONNECTION*)QUIC_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+        QuicZeroMemory(Connection, sizeof(*Connection));
+        Connection->Paths[0].Mtu = TEST_MTU;
+        Connection->Settings.CongestionControlAlgorithm = (uint16_t)Algorithm;
+        Connection->Settings.InitialWindowPackets = TEST_INITIAL_WINDOW;
+        Connection->Settings.SendIdleTimeoutMs = 1000;
+        Cc = &Connection->CongestionControl;
+        QuicCongestionControlInitialize(Cc, &Connection->Settings);
+    }
+    ~CcConnection() {
+        QUIC_FREE(Connection, QUIC_POOL_TEST);
+    }
+    void Send(uint32_t Packets) {
+        Cc->BytesInFlight += Packets * TEST_MTU;
+        NextPacketNumber += Packets;
+    }
+    void Ack(uint32_t Packets, uint32_t TimeNow, uint64_t DeliveryRate = 0) {
+        QUIC_ACK_EVENT AckEvent;
+        QuicZeroMemory(&AckEvent, sizeof(AckEvent));
+        AckEvent.TimeNow = TimeNow;
+        AckEvent.LargestAck = NextPacketNumber - 1;
+        AckEvent.LargestSentPacketNumber = NextPacketNumber - 1;
+        AckEvent.NumRetransmittableBytes = Packets * TEST_MTU;
+        AckEvent.SmoothedRtt = MS_TO_US(10);
+        AckEvent.MinRtt = MS_TO_US(10);
+        AckEvent.MinRttValid = TRUE;
+        AckEvent.DeliveryRate = DeliveryRate;
+        QuicCongestionControlOnDataAcknowledged(Cc, &AckEvent);
+    }
+    void Lose(uint32_t Packets, BOOLEAN PersistentCongestion = FALSE) {
+        QuicCongestionControlOnDataLost(
+            Cc,
+            NextPacketNumber - 1,
+            NextPacketNumber - 1,
+            Packets * TEST_MTU,
+            PersistentCongestion);
+    }
+};
+
+TEST(CongestionControlTest, Dispatch)
+{
+    CcConnection Cubic(QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC);
+    ASSERT_EQ(&QuicCongestionControlCubicDispatch, Cubic.Cc->Dispatch);
+    ASSERT_EQ((uint32_t)TEST_MTU * TEST_INITIAL_WINDOW, Cubic.Cc->CongestionWindow);
+
+    CcConnection Bbr(QUIC_CONGESTION_CONTROL_ALGORITHM_BBR);
+    ASSERT_EQ(&QuicCongestionControlBbrDispatch, Bbr.Cc->Dispatch);
+    ASSERT_EQ((uint32_t)TEST_MTU * TEST_INITIAL_WINDOW, Bbr.Cc->CongestionWindow);
+    ASSERT_EQ(UINT32_MAX, Bbr.Cc->SlowStartThreshold);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_STARTUP, Bbr.Cc->Bbr.State);
+}
+
+TEST(CongestionControlTest, CubicReducesOnLoss)
+{
+    CcConnection Conn(QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC);
+    Conn.Cc->CongestionWindow = 100 * TEST_MTU;
+    Conn.Send(100);
+    Conn.Lose(1);
+    ASSERT_EQ(1u, Conn.Connection->Stats.Send.CongestionCount);
+    ASSERT_LT(Conn.Cc->CongestionWindow, 100u * TEST_MTU);
+    ASSERT_EQ(Conn.Cc->CongestionWindow, Conn.Cc->SlowStartThreshold);
+}
+
+TEST(CongestionControlTest, BbrIgnoresRandomLoss)
+{
+    CcConnection Conn(QUIC_CONGESTION_CONTROL_ALGORITHM_BBR);
+    Conn.Send(TEST_INITIAL_WINDOW);
+    Conn.Ack(TEST_INITIAL_WINDOW, MS_TO_US(10));
+    const uint32_t Window = Conn.Cc->CongestionWindow;
+
+    //
+    // A single loss in a round of 100 packets is under the loss threshold, so
+    // it must neither count as congestion nor bound the window.
+    //
+    Conn.Send(100);
+    Conn.Lose(1);
+    Conn.Ack(99, MS_TO_US(20));
+    ASSERT_EQ(0u, Conn.Connection->Stats.Send.CongestionCount);
+    ASSERT_EQ(UINT32_MAX, Conn.Cc->Bbr.InflightHi);
+    ASSERT_GE(Conn.Cc->CongestionWindow, Window);
+}
+
+TEST(CongestionControlTest, BbrBoundsOnHighLoss)
+{
+    CcConnection Conn(QUIC_CONGESTION_CONTROL_ALGORITHM_BBR);
+    Conn.Send(TEST_INITIAL_WINDOW);
+    Conn.Ack(TEST_INITIAL_WINDOW, MS_TO_US(10));
+
+    Conn.Send(100);
+    Conn.Lose(20);
+    Conn.Ack(80, MS_TO_US(20));
+    ASSERT_EQ(1u, Conn.Connection->Stats.Send.CongestionCount);
+    ASSERT_NE(UINT32_MAX, Conn.Cc->Bbr.InflightHi);
+    ASSERT_LE(Conn.Cc->CongestionWindow, Conn.Cc->Bbr.InflightHi);
+    ASSERT_TRUE(Conn.Cc->Bbr.BtlBwFound);
+}
+
+TEST(CongestionControlTest, PersistentCongestion)
+{
+    for (uint32_t i = 0; i < QUIC_CONGESTION_CONTROL_ALGORITHM_MAX; ++i) {
+        CcConnection Conn((QUIC_CONGESTION_CONTROL_ALGORITHM)i);
+        Conn.Cc->CongestionWindow = 100 * TEST_MTU;
+        Conn.Cc->BytesInFlightMax = 100 * TEST_MTU;
+        Conn.Send(100);
+        Conn.Lose(100, TRUE);
+        ASSERT_EQ(1u, Conn.Connection->Stats.Send.PersistentCongestionCount);
+        ASSERT_EQ(
+            (uint32_t)TEST_MTU * QUIC_PERSISTENT_CONGESTION_WINDOW_PACKETS,
+            Conn.Cc->CongestionWindow);
+        ASSERT_EQ(0u, Conn.Cc->BytesInFlight);
+
+        if (i == QUIC_CONGESTION_CONTROL_ALGORITHM_BBR) {
+            //
+            // The window grows back, but only up to the reduced bound, even
+            // though the (stale) bandwidth estimate would allow more.
+            //
+            const uint32_t InflightHi = Conn.Cc->Bbr.InflightHi;
+            ASSERT_LT(InflightHi, 100u * TEST_MTU);
+            for (uint32_t j = 0; j < 50; ++j) {
+                Conn.Send(10);
+                Conn.Ack(10, MS_TO_US(10 * (j + 1)), 1000 * 1000 * 1000);
+                ASSERT_LE(Conn.Cc->CongestionWindow, InflightHi);
+            }
+        }
+    }
+}
+
+struct RateSampler {
+    QUIC_LOSS_DETECTION LossDetection;
+    QUIC_PATH Path;
+    QUIC_SENT_PACKET_METADATA Packets[16];
+    RateSampler() {
+        QuicZeroMemory(&LossDetection, sizeof(LossDetection));
+        QuicZeroMemory(&Path, sizeof(Path));
+        QuicZeroMemory(Packets, sizeof(Packets));
+        Path.GotFirstRttSample = TRUE;
+        Path.MinRtt = MS_TO_US(10);
+    }
+    void Send(uint32_t Index, uint32_t SentTime) {
+        Packets[Index].PacketNumber = Index;
+        Packets[Index].PacketLength = 1000;
+        Packets[Index].SentTime = SentTime;
+        QuicLossDetectionSaveDeliveryState(&LossDetection, &Packets[Index]);
+        LossDetection.PacketsInFlight++;
+    }
+    uint64_t Ack(uint32_t First, uint32_t Count, uint32_t TimeNow, bool* AppLimited = nullptr) {
+        QUIC_RATE_SAMPLE RateSample;
+        QuicZeroMemory(&RateSample, sizeof(RateSample));
+        for (uint32_t i = First; i < First + Count; ++i) {
+            QuicLossDetectionOnPacketDelivered(
+                &LossDetection, &RateSample, &Packets[i], TimeNow);
+            LossDetection.PacketsInFlight--;
+        }
+        if (AppLimited != nullptr) {
+            *AppLimited = RateSample.IsAppLimited;
+        }
+        return
+            QuicLossDetectionGetDeliveryRate(
+                &LossDetection, &RateSample, &Path, TimeNow);
+    }
+};
+
+TEST(CongestionControlTest, DeliveryRate)
+{
+    RateSampler Sampler;
+    for (uint32_t i = 0; i < 10; ++i) {
+        Sampler.Send(i, i * 100);
+    }
+    //
+    // 10000 bytes delivered 20ms after the flight started.
+    //
+    ASSERT_EQ(500000u, Sampler.Ack(0, 10, MS_TO_US(20)));
+    ASSERT_EQ(10000u, Sampler.LossDetection.TotalBytesDelivered);
+
+    //
+    // The next flight measures from the previous delivery.
+    //
+    for (uint32_t i = 10; i < 15; ++i) {
+        Sampler.Send(i, MS_TO_US(20));
+    }
+    ASSERT_EQ(250000u, Sampler.Ack(10, 5, MS_TO_US(40)));
+}
+
+TEST(CongestionControlTest, DeliveryRateShortInterval)
+{
+    //
+    // Intervals shorter than the min RTT don't produce a sample.
+    //
+    RateSampler Sampler;
+    Sampler.Send(0, 0);
+    ASSERT_EQ(0u, Sampler.Ack(0, 1, MS_TO_US(5)));
+
+    Sampler.Path.GotFirstRttSample = FALSE;
+    Sampler.Send(1, MS_TO_US(5));
+    ASSERT_EQ(0u, Sampler.Ack(1, 1, MS_TO_US(50)));
+}
+
+TEST(CongestionControlTest, DeliveryRateSendInterval)
+{
+    //
+    // When the sampled packets were sent over a longer interval than they
+    // were acknowledged in, the send interval is used.
+    //
+    RateSampler Sampler;
+    Sampler.Send(0, 0);
+    Sampler.Send(1, MS_TO_US(1));
+    ASSERT_EQ(50000u, Sampler.Ack(0, 1, MS_TO_US(20)));
+    for (uint32_t i = 2; i < 10; ++i) {
+        Sampler.Send(i, MS_TO_US(20 + (i - 2) * 5));
+    }
+    ASSERT_EQ(
+        9000ull * S_TO_US(1) / MS_TO_US(55),
+        Sampler.Ack(1, 9, MS_TO_US(60)));
+}
+
+TEST(CongestionControlTest, DeliveryRateAppLimited)
+{
+    RateSampler Sampler;
+    Sampler.LossDetection.AppLimitedUntil = 1000;
+    Sampler.Send(0, 0);
+    bool AppLimited = false;
+    ASSERT_NE(0u, Sampler.Ack(0, 1, MS_TO_US(20), &AppLimited));
+    ASSERT_TRUE(AppLimited);
+
+    Sampler.LossDetection.AppLimitedUntil = 0;
+    Sampler.Send(1, MS_TO_US(20));
+    ASSERT_NE(0u, Sampler.Ack(1, 1, MS_TO_US(40), &AppLimited));
+    ASSERT_FALSE(AppLimited);
+}
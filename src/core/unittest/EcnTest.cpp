@@ -0,0 +1,88 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the path ECN validation state.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "EcnTest.cpp.clog.h"
+#endif
+
+struct EcnPath {
+    QUIC_PATH Path;
+    EcnPath() {
+        QuicZeroMemory(&Path, sizeof(Path));
+        Path.EcnValidationState = QUIC_ECN_VALIDATION_TESTING;
+    }
+    void SendTestPackets(uint8_t Count) {
+        for (uint8_t i = 0; i < Count; ++i) {
+            ASSERT_EQ(QUIC_ECN_VALIDATION_TESTING, Path.EcnValidationState);
+            if (++Path.EcnTestingPacketCount >= QUIC_ECN_TESTING_PACKET_COUNT) {
+                Path.EcnValidationState = QUIC_ECN_VALIDATION_UNKNOWN;
+            }
+        }
+    }
+};
+
+TEST(EcnTest, AllTestPacketsLost)
+{
+    EcnPath Path;
+    Path.SendTestPackets(QUIC_ECN_TESTING_PACKET_COUNT);
+    ASSERT_EQ(QUIC_ECN_VALIDATION_UNKNOWN, Path.Path.EcnValidationState);
+    for (uint8_t i = 0; i < QUIC_ECN_TESTING_PACKET_COUNT - 1; ++i) {
+        ASSERT_FALSE(QuicPathOnEcnPacketLost(&Path.Path));
+        ASSERT_EQ(QUIC_ECN_VALIDATION_UNKNOWN, Path.Path.EcnValidationState);
+    }
+    ASSERT_TRUE(QuicPathOnEcnPacketLost(&Path.Path));
+    ASSERT_EQ(QUIC_ECN_VALIDATION_FAILED, Path.Path.EcnValidationState);
+    ASSERT_FALSE(QuicPathOnEcnPacketLost(&Path.Path));
+}
+
+TEST(EcnTest, LostWhileTesting)
+{
+    //
+    // Losing every packet sent so far doesn't fail validation while the path
+    // is still sending test packets.
+    //
+    EcnPath Path;
+    Path.SendTestPackets(QUIC_ECN_TESTING_PACKET_COUNT / 2);
+    for (uint8_t i = 0; i < QUIC_ECN_TESTING_PACKET_COUNT / 2; ++i) {
+        ASSERT_FALSE(QuicPathOnEcnPacketLost(&Path.Path));
+    }
+    ASSERT_EQ(QUIC_ECN_VALIDATION_TESTING, Path.Path.EcnValidationState);
+
+    Path.SendTestPackets(QUIC_ECN_TESTING_PACKET_COUNT / 2);
+    ASSERT_EQ(QUIC_ECN_VALIDATION_UNKNOWN, Path.Path.EcnValidationState);
+    for (uint8_t i = 0; i < QUIC_ECN_TESTING_PACKET_COUNT / 2 - 1; ++i) {
+        ASSERT_FALSE(QuicPathOnEcnPacketLost(&Path.Path));
+    }
+    ASSERT_TRUE(QuicPathOnEcnPacketLost(&Path.Path));
+    ASSERT_EQ(QUIC_ECN_VALIDATION_FAILED, Path.Path.EcnValidationState);
+}
+
+TEST(EcnTest, SomeTestPacketsLost)
+{
+    EcnPath Path;
+    Path.SendTestPackets(QUIC_ECN_TESTING_PACKET_COUNT);
+    for (uint8_t i = 0; i < QUIC_ECN_TESTING_PACKET_COUNT - 1; ++i) {
+        ASSERT_FALSE(QuicPathOnEcnPacketLost(&Path.Path));
+    }
+    ASSERT_EQ(QUIC_ECN_VALIDATION_UNKNOWN, Path.Path.EcnValidationState);
+}
+
+TEST(EcnTest, LostAfterValidation)
+{
+    EcnPath Path;
+    Path.SendTestPackets(QUIC_ECN_TESTING_PACKET_COUNT);
+    Path.Path.EcnValidationState = QUIC_ECN_VALIDATION_CAPABLE;
+    for (uint8_t i = 0; i < QUIC_ECN_TESTING_PACKET_COUNT * 2; ++i) {
+        ASSERT_FALSE(QuicPathOnEcnPacketLost(&Path.Path));
+    }
+    ASSERT_EQ(QUIC_ECN_VALIDATION_CAPABLE, Path.Path.EcnValidationState);
+}
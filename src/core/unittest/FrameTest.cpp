@@ -802,6 +802,39 @@ TEST_P(DataBlockedFrameTest, DecodeDataBlockedFrameFail) {
 
 INSTANTIATE_TEST_SUITE_P(FrameTest, DataBlockedFrameTest, ::testing::ValuesIn(DataBlockedFrameParams::GenerateDecodeFailParams()));
 
+TEST(FrameTest, AckFrequencyFrameEncodeDecode)
+{
+    QUIC_ACK_FREQUENCY_EX Frame = {1, 19, 25000, 3};
+    QUIC_ACK_FREQUENCY_EX DecodedFrame = {0, 0, 0, 0};
+    uint8_t Buffer[9];
+    uint16_t BufferLength = (uint16_t)sizeof(Buffer);
+    uint16_t Offset = 0;
+
+    QuicZeroMemory(Buffer, sizeof(Buffer));
+    ASSERT_TRUE(QuicAckFrequencyFrameEncode(&Frame, &Offset, BufferLength, Buffer));
+    ASSERT_EQ(BufferLength, Offset);
+
+    //
+    // The frame type doesn't fit in a single byte.
+    //
+    QUIC_VAR_INT FrameType = 0;
+    Offset = 0;
+    ASSERT_TRUE(QuicVarIntDecode(BufferLength, Buffer, &Offset, &FrameType));
+    ASSERT_EQ((QUIC_VAR_INT)QUIC_FRAME_ACK_FREQUENCY, FrameType);
+    ASSERT_EQ(2, Offset);
+    ASSERT_TRUE(QuicAckFrequencyFrameDecode(BufferLength, Buffer, &Offset, &DecodedFrame));
+
+    ASSERT_EQ(Frame.SequenceNumber, DecodedFrame.SequenceNumber);
+    ASSERT_EQ(Frame.AckElicitingThreshold, DecodedFrame.AckElicitingThreshold);
+    ASSERT_EQ(Frame.RequestedMaxAckDelay, DecodedFrame.RequestedMaxAckDelay);
+    ASSERT_EQ(Frame.ReorderingThreshold, DecodedFrame.ReorderingThreshold);
+
+    Offset = 0;
+    ASSERT_FALSE(QuicAckFrequencyFrameEncode(&Frame, &Offset, BufferLength - 1, Buffer));
+    Offset = 2;
+    ASSERT_FALSE(QuicAckFrequencyFrameDecode(BufferLength - 1, Buffer, &Offset, &DecodedFrame));
+}
+
 TEST(FrameTest, StreamDataBlockedFrameEncodeDecode)
 {
     QUIC_STREAM_DATA_BLOCKED_EX Frame = {127, 255};
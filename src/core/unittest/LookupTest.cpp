@@ -0,0 +1,521 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the CID lookup tables and the deferred freeing of the
+    entries removed from them.
+
+--*/
+
+#include "main.h"
+#include <atomic>
+#ifdef QUIC_CLOG
+#include "LookupTest.cpp.clog.h"
+#endif
+
+extern "C"
+void
+MsQuicCalculatePartitionMask(
+    void
+    );
+
+#define LOOKUP_TEST_CID_LENGTH          8
+#define LOOKUP_TEST_STABLE_CID_COUNT    64
+#define LOOKUP_TEST_CHURN_CID_COUNT     512
+#define LOOKUP_TEST_CHURN_ROUNDS        20
+#define LOOKUP_TEST_READER_COUNT        4
+
+//
+// Sets up the library state used by the lookup, like MsQuicLibraryInitialize
+// does, and restores it afterwards.
+//
+struct LookupLibrary {
+    uint16_t ProcessorCount;
+    uint16_t PartitionCount;
+    uint16_t PartitionMask;
+    uint8_t CidServerIdLength;
+    BOOLEAN SendRetryEnabled;
+    QUIC_LIBRARY_PP* PerProc;
+    LookupLibrary(uint16_t NewPartitionCount) {
+        ProcessorCount = MsQuicLib.ProcessorCount;
+        PartitionCount = MsQuicLib.PartitionCount;
+        PartitionMask = MsQuicLib.PartitionMask;
+        CidServerIdLength = MsQuicLib.CidServerIdLength;
+        SendRetryEnabled = MsQuicLib.SendRetryEnabled;
+        PerProc = MsQuicLib.PerProc;
+
+        MsQuicLib.ProcessorCount = (uint16_t)QuicProcActiveCount();
+        MsQuicLib.PartitionCount = NewPartitionCount;
+        MsQuicCalculatePartitionMask();
+        MsQuicLib.CidServerIdLength = 0;
+        MsQuicLib.PerProc =
+            (QUIC_LIBRARY_PP*)QUIC_ALLOC_NONPAGED(
+                MsQuicLib.ProcessorCount * sizeof(QUIC_LIBRARY_PP),
+                QUIC_POOL_TEST);
+        QuicZeroMemory(MsQuicLib.PerProc, MsQuicLib.ProcessorCount * sizeof(QUIC_LIBRARY_PP));
+        QuicDispatchLockInitialize(&MsQuicLib.LookupEpochLock);
+        MsQuicLib.LookupEpoch = 0;
+        QuicZeroMemory(&MsQuicLib.LookupRetired, sizeof(MsQuicLib.LookupRetired));
+        QuicZeroMemory(&MsQuicLib.LookupPending, sizeof(MsQuicLib.LookupPending));
+    }
+    ~LookupLibrary() {
+        QuicLookupSynchronize();
+        QuicDispatchLockUninitialize(&MsQuicLib.LookupEpochLock);
+        QUIC_FREE(MsQuicLib.PerProc, QUIC_POOL_TEST);
+
+        MsQuicLib.ProcessorCount = ProcessorCount;
+        MsQuicLib.PartitionCount = PartitionCount;
+        MsQuicLib.PartitionMask = PartitionMask;
+        MsQuicLib.CidServerIdLength = CidServerIdLength;
+        MsQuicLib.SendRetryEnabled = SendRetryEnabled;
+        MsQuicLib.PerProc = PerProc;
+    }
+};
+
+struct LookupConnection {
+    QUIC_CONNECTION* Connection;
+    LookupConnection() {
+        Connection =
+            (QUIC_CONNECTION*)QUIC_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+        QuicZeroMemory(Connection, sizeof(*Connection));
+        QuicConnAddRef(Connection, QUIC_CONN_REF_HANDLE_OWNER); // Never freed by the lookup.
+    }
+    ~LookupConnection() {
+        QUIC_FREE(Connection, QUIC_POOL_TEST);
+    }
+    //
+    // The number of references held by the lookup (or its retired entries).
+    //
+    uint32_t LookupRefs() const {
+        return Connection->RefCount - 1;
+    }
+    bool AddCid(QUIC_LOOKUP* Lookup, uint32_t Id) {
+        uint8_t Data[LOOKUP_TEST_CID_LENGTH] = {0};
+        QuicCopyMemory(Data, &Id, sizeof(Id));
+        QUIC_CID_HASH_ENTRY* SourceCid =
+            QuicCidNewSource(Connection, sizeof(Data), Data);
+        if (SourceCid == nullptr) {
+            return false;
+        }
+        if (!QuicLookupAddLocalCid(Lookup, SourceCid, nullptr)) {
+            QUIC_FREE(SourceCid, QUIC_POOL_CIDHASH);
+            return false;
+        }
+        QuicListPushEntry(&Connection->SourceCids, &SourceCid->Link);
+        return true;
+    }
+    //
+    // Removes the most recently added CID.
+    //
+    void RemoveCid(QUIC_LOOKUP* Lookup) {
+        QUIC_CID_HASH_ENTRY* SourceCid =
+            QUIC_CONTAINING_RECORD(
+                Connection->SourceCids.Next,
+                QUIC_CID_HASH_ENTRY,
+                Link);
+        QuicLookupRemoveLocalCid(Lookup, SourceCid, &Connection->SourceCids.Next);
+    }
+};
+
+static
+QUIC_CONNECTION*
+LookupTestFind(
+    QUIC_LOOKUP* Lookup,
+    uint32_t Id
+    )
+{
+    uint8_t Data[LOOKUP_TEST_CID_LENGTH] = {0};
+    QuicCopyMemory(Data, &Id, sizeof(Id));
+    QUIC_CONNECTION* Connection =
+        QuicLookupFindConnectionByLocalCid(Lookup, Data, sizeof(Data));
+    if (Connection != nullptr) {
+        QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_RESULT);
+    }
+    return Connection;
+}
+
+TEST(LookupTest, InsertRemove)
+{
+    LookupLibrary Lib(4);
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+
+    LookupConnection Conn1, Conn2;
+    for (uint32_t i = 0; i < 50; ++i) {
+        ASSERT_TRUE(Conn1.AddCid(&Lookup, i));
+        ASSERT_TRUE(Conn2.AddCid(&Lookup, 100 + i));
+    }
+    ASSERT_FALSE(Conn2.AddCid(&Lookup, 0)); // Collision
+    ASSERT_EQ(50u, Conn1.LookupRefs());
+
+    for (uint32_t i = 0; i < 50; ++i) {
+        ASSERT_EQ(Conn1.Connection, LookupTestFind(&Lookup, i));
+        ASSERT_EQ(Conn2.Connection, LookupTestFind(&Lookup, 100 + i));
+    }
+    ASSERT_EQ(nullptr, LookupTestFind(&Lookup, 50));
+
+    //
+    // Removed CIDs aren't found anymore, but keep their connection reference
+    // until they are freed after a grace period.
+    //
+    for (uint32_t i = 0; i < 25; ++i) {
+        Conn1.RemoveCid(&Lookup);
+    }
+    for (uint32_t i = 0; i < 50; ++i) {
+        ASSERT_EQ(i < 25 ? Conn1.Connection : nullptr, LookupTestFind(&Lookup, i));
+    }
+    ASSERT_EQ(50u, Conn1.LookupRefs());
+    QuicLookupSynchronize();
+    ASSERT_EQ(25u, Conn1.LookupRefs());
+
+    QuicLookupRemoveLocalCids(&Lookup, Conn1.Connection);
+    QuicLookupRemoveLocalCids(&Lookup, Conn2.Connection);
+    ASSERT_EQ(nullptr, LookupTestFind(&Lookup, 0));
+    ASSERT_EQ(nullptr, LookupTestFind(&Lookup, 100));
+    QuicLookupSynchronize();
+    ASSERT_EQ(0u, Conn1.LookupRefs());
+    ASSERT_EQ(0u, Conn2.LookupRefs());
+
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST(LookupTest, SingleConnection)
+{
+    //
+    // Without partitioning, readers hold the lock, so removal frees right away.
+    //
+    LookupLibrary Lib(4);
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+
+    LookupConnection Conn;
+    ASSERT_TRUE(Conn.AddCid(&Lookup, 1));
+    ASSERT_TRUE(Conn.AddCid(&Lookup, 2));
+    ASSERT_EQ(Conn.Connection, LookupTestFind(&Lookup, 2));
+    Conn.RemoveCid(&Lookup);
+    ASSERT_EQ(nullptr, LookupTestFind(&Lookup, 2));
+    ASSERT_EQ(1u, Conn.LookupRefs());
+    ASSERT_EQ(0u, MsQuicLib.LookupRetired.Count);
+
+    QuicLookupRemoveLocalCids(&Lookup, Conn.Connection);
+    ASSERT_EQ(0u, Conn.LookupRefs());
+
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST(LookupTest, Reclaim)
+{
+    LookupLibrary Lib(1);
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+    ASSERT_FALSE(QuicLookupReclaim());
+
+    LookupConnection Conn;
+    ASSERT_TRUE(Conn.AddCid(&Lookup, 1));
+    Conn.RemoveCid(&Lookup);
+    ASSERT_EQ(1u, MsQuicLib.LookupRetired.Count);
+
+    //
+    // The first call starts the grace period, and with no readers around, the
+    // next one frees the CID.
+    //
+    ASSERT_TRUE(QuicLookupReclaim());
+    ASSERT_EQ(1u, Conn.LookupRefs());
+    ASSERT_FALSE(QuicLookupReclaim());
+    ASSERT_EQ(0u, Conn.LookupRefs());
+
+    //
+    // A reader that started before the grace period holds it up.
+    //
+    ASSERT_TRUE(Conn.AddCid(&Lookup, 2));
+    QUIC_IRQL PrevIrql;
+    long* Readers = QuicLookupReadBegin(&PrevIrql);
+    Conn.RemoveCid(&Lookup);
+    ASSERT_TRUE(QuicLookupReclaim());
+    ASSERT_TRUE(QuicLookupReclaim());
+    ASSERT_EQ(1u, Conn.LookupRefs());
+    QuicLookupReadEnd(Readers, PrevIrql);
+    ASSERT_FALSE(QuicLookupReclaim());
+    ASSERT_EQ(0u, Conn.LookupRefs());
+
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST(LookupTest, RetiredLimit)
+{
+    LookupLibrary Lib(1);
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+
+    LookupConnection Conn;
+    for (uint32_t i = 0; i < QUIC_LOOKUP_RETIRED_MAX; ++i) {
+        ASSERT_TRUE(Conn.AddCid(&Lookup, i));
+    }
+
+    //
+    // Without anything reclaiming them, the removed CIDs are freed by the
+    // removal that reaches the limit.
+    //
+    for (uint32_t i = 0; i < QUIC_LOOKUP_RETIRED_MAX; ++i) {
+        Conn.RemoveCid(&Lookup);
+        ASSERT_LT(
+            MsQuicLib.LookupRetired.Count + MsQuicLib.LookupPending.Count,
+            (uint32_t)QUIC_LOOKUP_RETIRED_MAX);
+    }
+    ASSERT_LT(Conn.LookupRefs(), (uint32_t)QUIC_LOOKUP_RETIRED_MAX);
+
+    QuicLookupSynchronize();
+    ASSERT_EQ(0u, Conn.LookupRefs());
+
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST(LookupTest, Resize)
+{
+    LookupLibrary Lib(1);
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+
+    //
+    // Growing the table well past its initial size retires the replaced
+    // bucket arrays.
+    //
+    LookupConnection Conn;
+    const uint32_t Count = QUIC_HASH_MIN_SIZE * 16;
+    for (uint32_t i = 0; i < Count; ++i) {
+        ASSERT_TRUE(Conn.AddCid(&Lookup, i));
+    }
+    ASSERT_NE(0u, MsQuicLib.LookupRetired.Count);
+    for (uint32_t i = 0; i < Count; ++i) {
+        ASSERT_EQ(Conn.Connection, LookupTestFind(&Lookup, i));
+    }
+    while (QuicLookupReclaim()) {
+    }
+    ASSERT_EQ(0u, MsQuicLib.LookupRetired.Count);
+    ASSERT_EQ(0u, MsQuicLib.LookupPending.Count);
+
+    QuicLookupRemoveLocalCids(&Lookup, Conn.Connection);
+    QuicLookupSynchronize();
+    ASSERT_EQ(0u, Conn.LookupRefs());
+
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST(LookupTest, RemoteHash)
+{
+    LookupLibrary Lib(4);
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+
+    LookupConnection Conn;
+    QUIC_ADDR RemoteAddress;
+    QuicZeroMemory(&RemoteAddress, sizeof(RemoteAddress));
+    QuicAddrSetFamily(&RemoteAddress, QUIC_ADDRESS_FAMILY_INET);
+    QuicAddrSetPort(&RemoteAddress, 4433);
+    const uint8_t RemoteCid[LOOKUP_TEST_CID_LENGTH] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    QUIC_CONNECTION* Collision;
+    ASSERT_TRUE(
+        QuicLookupAddRemoteHash(
+            &Lookup, Conn.Connection, &RemoteAddress, sizeof(RemoteCid), RemoteCid, &Collision));
+    ASSERT_EQ(nullptr, Collision);
+
+    QUIC_CONNECTION* Found =
+        QuicLookupFindConnectionByRemoteHash(
+            &Lookup, &RemoteAddress, sizeof(RemoteCid), RemoteCid);
+    ASSERT_EQ(Conn.Connection, Found);
+    QuicConnRelease(Found, QUIC_CONN_REF_LOOKUP_RESULT);
+
+    QuicLookupRemoveRemoteHash(&Lookup, Conn.Connection->RemoteHashEntry);
+    ASSERT_EQ(nullptr, Conn.Connection->RemoteHashEntry);
+    ASSERT_EQ(
+        nullptr,
+        QuicLookupFindConnectionByRemoteHash(
+            &Lookup, &RemoteAddress, sizeof(RemoteCid), RemoteCid));
+    ASSERT_EQ(1u, Conn.LookupRefs());
+    QuicLookupSynchronize();
+    ASSERT_EQ(0u, Conn.LookupRefs());
+
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST(LookupTest, Move)
+{
+    LookupLibrary Lib(4);
+    QUIC_LOOKUP LookupSrc, LookupDest;
+    QuicLookupInitialize(&LookupSrc);
+    QuicLookupInitialize(&LookupDest);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&LookupSrc));
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&LookupDest));
+
+    LookupConnection Conn;
+    for (uint32_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(Conn.AddCid(&LookupSrc, i));
+    }
+
+    //
+    // The CIDs are moved without waiting on readers of the source lookup, by
+    // retiring the originals.
+    //
+    QuicLookupMoveLocalConnectionIDs(&LookupSrc, &LookupDest, Conn.Connection);
+    for (uint32_t i = 0; i < 8; ++i) {
+        ASSERT_EQ(nullptr, LookupTestFind(&LookupSrc, i));
+        ASSERT_EQ(Conn.Connection, LookupTestFind(&LookupDest, i));
+    }
+    ASSERT_EQ(8u, MsQuicLib.LookupRetired.Count);
+    ASSERT_EQ(16u, Conn.LookupRefs());
+    QuicLookupSynchronize();
+    ASSERT_EQ(8u, Conn.LookupRefs());
+
+    uint32_t CidCount = 0;
+    for (QUIC_SINGLE_LIST_ENTRY* Entry = Conn.Connection->SourceCids.Next;
+        Entry != nullptr;
+        Entry = Entry->Next) {
+        QUIC_CID_HASH_ENTRY* SourceCid =
+            QUIC_CONTAINING_RECORD(Entry, QUIC_CID_HASH_ENTRY, Link);
+        ASSERT_TRUE(SourceCid->CID.IsInLookupTable);
+        ++CidCount;
+    }
+    ASSERT_EQ(8u, CidCount);
+
+    QuicLookupRemoveLocalCids(&LookupDest, Conn.Connection);
+    QuicLookupSynchronize();
+    ASSERT_EQ(0u, Conn.LookupRefs());
+
+    QuicLookupUninitialize(&LookupSrc);
+    QuicLookupUninitialize(&LookupDest);
+}
+
+struct LookupReaderContext {
+    QUIC_LOOKUP* Lookup;
+    QUIC_CONNECTION* Stable;
+    QUIC_CONNECTION* Churn;
+    std::atomic<bool> Stop;
+    std::atomic<uint32_t> Started;
+    std::atomic<uint32_t> Failures;
+    std::atomic<uint64_t> Lookups;
+};
+
+QUIC_THREAD_CALLBACK(LookupTestReaderThread, Context)
+{
+    LookupReaderContext* ReaderContext = (LookupReaderContext*)Context;
+    uint32_t Id = 0;
+
+    while (!ReaderContext->Stop) {
+        //
+        // The stable CIDs must always be found, while the churning ones may
+        // or may not be, but never for the wrong connection.
+        //
+        QUIC_CONNECTION* Connection =
+            LookupTestFind(ReaderContext->Lookup, Id % LOOKUP_TEST_STABLE_CID_COUNT);
+        if (Connection != ReaderContext->Stable) {
+            ReaderContext->Failures++;
+        }
+        Connection =
+            LookupTestFind(
+                ReaderContext->Lookup,
+                LOOKUP_TEST_STABLE_CID_COUNT + Id % LOOKUP_TEST_CHURN_CID_COUNT);
+        if (Connection != nullptr && Connection != ReaderContext->Churn) {
+            ReaderContext->Failures++;
+        }
+        if (++Id == 1) {
+            ReaderContext->Started++;
+        }
+        ReaderContext->Lookups++;
+    }
+
+    QUIC_THREAD_RETURN(0);
+}
+
+TEST(LookupTest, ConcurrentReaders)
+{
+    LookupLibrary Lib(4);
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+
+    LookupConnection Stable, Churn;
+    for (uint32_t i = 0; i < LOOKUP_TEST_STABLE_CID_COUNT; ++i) {
+        ASSERT_TRUE(Stable.AddCid(&Lookup, i));
+    }
+
+    LookupReaderContext Context;
+    Context.Lookup = &Lookup;
+    Context.Stable = Stable.Connection;
+    Context.Churn = Churn.Connection;
+    Context.Stop = false;
+    Context.Started = 0;
+    Context.Failures = 0;
+    Context.Lookups = 0;
+
+    QUIC_THREAD Threads[LOOKUP_TEST_READER_COUNT];
+    for (uint32_t i = 0; i < LOOKUP_TEST_READER_COUNT; ++i) {
+        QUIC_THREAD_CONFIG Config = {
+            0,
+            0,
+            "LookupTest",
+            LookupTestReaderThread,
+            &Context
+        };
+        TEST_QUIC_SUCCEEDED(QuicThreadCreate(&Config, &Threads[i]));
+    }
+
+    //
+    // Don't start until every reader is actually looking up CIDs, which on a
+    // busy or small machine may take a while.
+    //
+    while (Context.Started < LOOKUP_TEST_READER_COUNT) {
+        QuicSleep(1);
+    }
+
+    //
+    // Insert (resizing the tables) and remove CIDs under the readers, freeing
+    // the removed entries as their grace periods complete. Readers holding up
+    // grace periods must never let the retired entries pile up.
+    //
+    for (uint32_t Round = 0; Round < LOOKUP_TEST_CHURN_ROUNDS; ++Round) {
+        for (uint32_t i = 0; i < LOOKUP_TEST_CHURN_CID_COUNT; ++i) {
+            ASSERT_TRUE(Churn.AddCid(&Lookup, LOOKUP_TEST_STABLE_CID_COUNT + i));
+            if (i % 16 == 0) {
+                QuicLookupReclaim();
+            }
+        }
+        for (uint32_t i = 0; i < LOOKUP_TEST_CHURN_CID_COUNT; ++i) {
+            Churn.RemoveCid(&Lookup);
+            ASSERT_LT(
+                MsQuicLib.LookupRetired.Count + MsQuicLib.LookupPending.Count,
+                (uint32_t)QUIC_LOOKUP_RETIRED_MAX);
+            if (i % 16 == 0) {
+                QuicLookupReclaim();
+            }
+        }
+    }
+
+    Context.Stop = true;
+    for (uint32_t i = 0; i < LOOKUP_TEST_READER_COUNT; ++i) {
+        QuicThreadWait(&Threads[i]);
+        QuicThreadDelete(&Threads[i]);
+    }
+
+    ASSERT_EQ(0u, Context.Failures.load());
+    ASSERT_NE(0u, Context.Lookups.load());
+
+    while (QuicLookupReclaim()) {
+    }
+    ASSERT_EQ((uint32_t)LOOKUP_TEST_STABLE_CID_COUNT, Stable.LookupRefs());
+    ASSERT_EQ(0u, Churn.LookupRefs());
+
+    QuicLookupRemoveLocalCids(&Lookup, Stable.Connection);
+    QuicLookupSynchronize();
+    ASSERT_EQ(0u, Stable.LookupRefs());
+
+    QuicLookupUninitialize(&Lookup);
+}
@@ -0,0 +1,276 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the path MTU search and black hole detection.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "MtuDiscoveryTest.cpp.clog.h"
+#endif
+
+static
+void
+MtuTestReceive(
+    _In_ QUIC_DATAPATH_BINDING* /* Binding */,
+    _In_ void* /* Context */,
+    _In_ QUIC_RECV_DATAGRAM* /* DatagramChain */
+    )
+{
+}
+
+static
+void
+MtuTestUnreachable(
+    _In_ QUIC_DATAPATH_BINDING* /* Binding */,
+    _In_ void* /* Context */,
+    _In_ const QUIC_ADDR* /* RemoteAddress */
+    )
+{
+}
+
+struct MtuConnection {
+    QUIC_DATAPATH* Datapath;
+    QUIC_BINDING Binding;
+    QUIC_CONNECTION* Connection;
+    QUIC_PATH* Path;
+    uint64_t NextPacketNumber;
+    MtuConnection(uint16_t MaximumMtu = QUIC_DEFAULT_MAXIMUM_MTU) :
+        Datapath(nullptr), NextPacketNumber(0) {
+        QuicZeroMemory(&Binding, sizeof(Binding));
+        Connection =
+            (QUIC_CONNECTION*)QUIC_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+        QuicZeroMemory(Connection, sizeof(*Connection));
+        Connection->Settings.MaximumMtu = MaximumMtu;
+        Connection->Datagram.SendEnabled = TRUE;
+        Connection->Datagram.MaxSendLength = UINT16_MAX;
+        Connection->Send.FlushOperationPending = TRUE; // Don't queue operations.
+
+        Path = &Connection->Paths[0];
+        Path->IsActive = TRUE;
+        Path->Mtu = QUIC_DEFAULT_PATH_MTU;
+        Path->Binding = &Binding;
+        QuicAddrSetFamily(&Path->RemoteAddress, QUIC_ADDRESS_FAMILY_INET);
+    }
+    ~MtuConnection() {
+        if (Binding.DatapathBinding != nullptr) {
+            QuicDataPathBindingDelete(Binding.DatapathBinding);
+        }
+        if (Datapath != nullptr) {
+            QuicDataPathUninitialize(Datapath);
+        }
+        QUIC_FREE(Connection, QUIC_POOL_TEST);
+    }
+    void Bind() {
+        TEST_QUIC_SUCCEEDED(
+            QuicDataPathInitialize(0, MtuTestReceive, MtuTestUnreachable, &Datapath));
+        TEST_QUIC_SUCCEEDED(
+            QuicDataPathBindingCreate(
+                Datapath, nullptr, nullptr, nullptr, &Binding.DatapathBinding));
+    }
+    //
+    // The largest MTU the search may find: the smaller of the setting and the
+    // local interface MTU.
+    //
+    uint16_t MaxMtu() {
+        uint16_t Mtu = QuicDataPathBindingGetLocalMtu(Binding.DatapathBinding);
+        return Mtu < Connection->Settings.MaximumMtu ? Mtu : Connection->Settings.MaximumMtu;
+    }
+    void OnAck(uint16_t Mtu, BOOLEAN IsProbe) {
+        QuicMtuDiscoveryOnPacketAcknowledged(
+            Connection,
+            Path,
+            NextPacketNumber++,
+            MaxUdpPayloadSizeForFamily(QUIC_ADDRESS_FAMILY_INET, Mtu),
+            IsProbe);
+    }
+    void OnLoss(uint16_t Mtu, BOOLEAN IsProbe) {
+        QuicMtuDiscoveryOnPacketLost(
+            Connection,
+            Path,
+            NextPacketNumber++,
+            MaxUdpPayloadSizeForFamily(QUIC_ADDRESS_FAMILY_INET, Mtu),
+            IsProbe);
+    }
+    //
+    // Runs the search to completion on a path which drops everything larger
+    // than PathMtu and returns the number of probes sent.
+    //
+    uint32_t Search(uint16_t PathMtu) {
+        uint32_t ProbeCount = 0;
+        QuicMtuDiscoveryNewSearch(Connection, Path);
+        while (Path->MtuDiscovery.IsSearching) {
+            const uint16_t ProbeSize = Path->MtuDiscovery.ProbeSize;
+            ++ProbeCount;
+            if (ProbeSize <= PathMtu) {
+                OnAck(ProbeSize, TRUE);
+            } else {
+                OnLoss(ProbeSize, TRUE);
+            }
+            if (ProbeCount > 100) {
+                break;
+            }
+        }
+        return ProbeCount;
+    }
+};
+
+TEST(MtuDiscoveryTest, ProbesMaxMtuFirst)
+{
+    MtuConnection Conn;
+    Conn.Bind();
+    QuicMtuDiscoveryNewSearch(Conn.Connection, Conn.Path);
+    ASSERT_TRUE(Conn.Path->MtuDiscovery.IsSearching);
+    ASSERT_EQ(Conn.MaxMtu(), Conn.Path->MtuDiscovery.ProbeSize);
+    ASSERT_EQ(1u, Conn.Search(Conn.MaxMtu()));
+    ASSERT_EQ(Conn.MaxMtu(), Conn.Path->Mtu);
+    ASSERT_FALSE(Conn.Path->MtuDiscovery.IsSearching);
+}
+
+TEST(MtuDiscoveryTest, DefaultMaximumMtu)
+{
+    //
+    // Without the app opting in, the search doesn't go past a standard
+    // Ethernet MTU, even if the local interface supports more.
+    //
+    MtuConnection Conn;
+    Conn.Bind();
+    Conn.Search(QUIC_MAX_MTU);
+    ASSERT_LE(Conn.Path->Mtu, QUIC_ETHERNET_MTU);
+}
+
+TEST(MtuDiscoveryTest, JumboMtu)
+{
+    MtuConnection Conn(QUIC_MAX_MTU);
+    Conn.Bind();
+    Conn.Search(QUIC_MAX_MTU);
+    ASSERT_EQ(Conn.MaxMtu(), Conn.Path->Mtu);
+    ASSERT_LE(Conn.Path->Mtu, QUIC_MAX_MTU);
+}
+
+TEST(MtuDiscoveryTest, PeerMaxUdpPayloadSize)
+{
+    MtuConnection Conn;
+    Conn.Bind();
+    Conn.Connection->PeerTransportParams.Flags |= QUIC_TP_FLAG_MAX_UDP_PAYLOAD_SIZE;
+    Conn.Connection->PeerTransportParams.MaxUdpPayloadSize = 1300;
+    QuicMtuDiscoveryNewSearch(Conn.Connection, Conn.Path);
+    ASSERT_EQ(
+        PacketSizeFromUdpPayloadSize(QUIC_ADDRESS_FAMILY_INET, 1300),
+        Conn.Path->MtuDiscovery.ProbeSize);
+}
+
+TEST(MtuDiscoveryTest, BinarySearch)
+{
+    for (uint16_t MaximumMtu : { (uint16_t)QUIC_ETHERNET_MTU, (uint16_t)QUIC_MAX_MTU }) {
+        MtuConnection Conn(MaximumMtu);
+        Conn.Bind();
+        const uint16_t PathMtu =
+            QUIC_DEFAULT_PATH_MTU + (Conn.MaxMtu() - QUIC_DEFAULT_PATH_MTU) / 3;
+
+        uint32_t ProbeCount = Conn.Search(PathMtu);
+        ASSERT_FALSE(Conn.Path->MtuDiscovery.IsSearching);
+        ASSERT_LE(Conn.Path->Mtu, PathMtu);
+        ASSERT_GT(Conn.Path->Mtu + QUIC_DPLPMTUD_MIN_SEARCH_STEP, PathMtu);
+
+        //
+        // Each unsupported size is probed QUIC_DPLPMTUD_MAX_PROBES times and
+        // every probe halves the range.
+        //
+        ASSERT_LE(ProbeCount, 10u * QUIC_DPLPMTUD_MAX_PROBES);
+    }
+}
+
+TEST(MtuDiscoveryTest, ProbeRetransmit)
+{
+    MtuConnection Conn;
+    Conn.Bind();
+    QuicMtuDiscoveryNewSearch(Conn.Connection, Conn.Path);
+    const uint16_t ProbeSize = Conn.Path->MtuDiscovery.ProbeSize;
+    for (uint32_t i = 0; i < QUIC_DPLPMTUD_MAX_PROBES - 1; ++i) {
+        Conn.OnLoss(ProbeSize, TRUE);
+        ASSERT_EQ(ProbeSize, Conn.Path->MtuDiscovery.ProbeSize);
+    }
+
+    //
+    // Losing a probe for a size no longer being searched changes nothing.
+    //
+    Conn.OnLoss(QUIC_MIN_MTU, TRUE);
+    ASSERT_EQ(ProbeSize, Conn.Path->MtuDiscovery.ProbeSize);
+
+    Conn.OnLoss(ProbeSize, TRUE);
+    ASSERT_LT(Conn.Path->MtuDiscovery.ProbeSize, ProbeSize);
+    ASSERT_EQ(ProbeSize - 1, Conn.Path->MtuDiscovery.MaxMtu);
+}
+
+TEST(MtuDiscoveryTest, BlackHole)
+{
+    MtuConnection Conn;
+    Conn.Bind();
+    Conn.Search(Conn.MaxMtu());
+    const uint16_t Mtu = Conn.Path->Mtu;
+    ASSERT_GT(Mtu, QUIC_DEFAULT_PATH_MTU);
+
+    //
+    // Small packets being lost don't count, and an acknowledged large packet
+    // resets the count.
+    //
+    for (uint32_t i = 0; i < QUIC_DPLPMTUD_BLACK_HOLE_THRESHOLD; ++i) {
+        Conn.OnLoss(QUIC_DEFAULT_PATH_MTU, FALSE);
+    }
+    for (uint32_t i = 0; i < QUIC_DPLPMTUD_BLACK_HOLE_THRESHOLD - 1; ++i) {
+        Conn.OnLoss(Mtu, FALSE);
+    }
+    Conn.OnAck(Mtu, FALSE);
+    ASSERT_EQ(Mtu, Conn.Path->Mtu);
+
+    //
+    // Large packets sent before the last acknowledged one don't count either.
+    //
+    const uint64_t OldPacketNumber = Conn.NextPacketNumber - 2;
+    for (uint32_t i = 0; i < QUIC_DPLPMTUD_BLACK_HOLE_THRESHOLD; ++i) {
+        QuicMtuDiscoveryOnPacketLost(
+            Conn.Connection,
+            Conn.Path,
+            OldPacketNumber,
+            MaxUdpPayloadSizeForFamily(QUIC_ADDRESS_FAMILY_INET, Mtu),
+            FALSE);
+    }
+    ASSERT_EQ(Mtu, Conn.Path->Mtu);
+
+    for (uint32_t i = 0; i < QUIC_DPLPMTUD_BLACK_HOLE_THRESHOLD - 1; ++i) {
+        Conn.OnLoss(Mtu, FALSE);
+        ASSERT_EQ(Mtu, Conn.Path->Mtu);
+    }
+    Conn.OnLoss(Mtu, FALSE);
+
+    //
+    // The MTU falls back to the base and a new search starts.
+    //
+    ASSERT_EQ(QUIC_DEFAULT_PATH_MTU, Conn.Path->Mtu);
+    ASSERT_TRUE(Conn.Path->MtuDiscovery.IsSearching);
+}
+
+TEST(MtuDiscoveryTest, RaiseTimer)
+{
+    MtuConnection Conn;
+    Conn.Bind();
+    const uint16_t PathMtu = QUIC_DEFAULT_PATH_MTU + 100;
+    Conn.Search(PathMtu);
+    ASSERT_FALSE(Conn.Path->MtuDiscovery.IsSearching);
+
+    const uint32_t CompleteTime = Conn.Path->MtuDiscovery.SearchCompleteTime;
+    QuicMtuDiscoveryCheckSearchCompleteTimeout(
+        Conn.Connection, Conn.Path, CompleteTime + MS_TO_US(QUIC_DPLPMTUD_RAISE_TIMER) - 1);
+    ASSERT_FALSE(Conn.Path->MtuDiscovery.IsSearching);
+
+    QuicMtuDiscoveryCheckSearchCompleteTimeout(
+        Conn.Connection, Conn.Path, CompleteTime + MS_TO_US(QUIC_DPLPMTUD_RAISE_TIMER));
+    ASSERT_TRUE(Conn.Path->MtuDiscovery.IsSearching);
+    ASSERT_EQ(Conn.MaxMtu(), Conn.Path->MtuDiscovery.ProbeSize);
+}
@@ -0,0 +1,205 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the QUIC_RECV_BUFFER interface.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "RecvBufferTest.cpp.clog.h"
+#endif
+
+#define CHUNK_SIZE 64
+
+struct RecvBuffer {
+    QUIC_RECV_BUFFER RecvBuf {0};
+    RecvBuffer() { }
+    ~RecvBuffer() {
+        QuicRecvBufferUninitialize(&RecvBuf);
+    }
+    QUIC_STATUS Initialize(
+        uint32_t AllocBufferLength = CHUNK_SIZE,
+        uint32_t VirtualBufferLength = 4 * CHUNK_SIZE,
+        bool CopyOnDrain = false
+        ) {
+        return
+            QuicRecvBufferInitialize(
+                &RecvBuf,
+                AllocBufferLength,
+                VirtualBufferLength,
+                CopyOnDrain,
+                NULL);
+    }
+    QUIC_STATUS Write(
+        uint64_t WriteOffset,
+        uint16_t WriteLength,
+        BOOLEAN* ReadyToRead
+        ) {
+        uint8_t Data[UINT16_MAX];
+        for (uint16_t i = 0; i < WriteLength; ++i) {
+            Data[i] = (uint8_t)(WriteOffset + i);
+        }
+        uint64_t InOutWriteLength = UINT64_MAX;
+        return
+            QuicRecvBufferWrite(
+                &RecvBuf,
+                WriteOffset,
+                WriteLength,
+                Data,
+                &InOutWriteLength,
+                ReadyToRead);
+    }
+    uint64_t Read(uint32_t* BufferCount) {
+        QUIC_BUFFER Buffers[16];
+        uint64_t ReadOffset;
+        *BufferCount = ARRAYSIZE(Buffers);
+        if (!QuicRecvBufferRead(&RecvBuf, &ReadOffset, BufferCount, Buffers)) {
+            return 0;
+        }
+        uint64_t Length = 0;
+        for (uint32_t i = 0; i < *BufferCount; ++i) {
+            for (uint32_t j = 0; j < Buffers[i].Length; ++j) {
+                EXPECT_EQ((uint8_t)(ReadOffset + Length + j), Buffers[i].Buffer[j]);
+            }
+            Length += Buffers[i].Length;
+        }
+        return Length;
+    }
+    bool Drain(uint64_t DrainLength) {
+        return QuicRecvBufferDrain(&RecvBuf, DrainLength) != FALSE;
+    }
+};
+
+TEST(RecvBufferTest, ChunkedWriteAcrossChunks)
+{
+    RecvBuffer RecvBuf;
+    BOOLEAN ReadyToRead;
+    TEST_QUIC_SUCCEEDED(RecvBuf.Initialize());
+    ASSERT_EQ(0u, RecvBuf.RecvBuf.AllocBufferLength);
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(0, 100, &ReadyToRead));
+    ASSERT_TRUE(ReadyToRead);
+    ASSERT_EQ(2u * CHUNK_SIZE, RecvBuf.RecvBuf.AllocBufferLength);
+    uint32_t BufferCount;
+    ASSERT_EQ(100u, RecvBuf.Read(&BufferCount));
+    ASSERT_EQ(2u, BufferCount);
+    ASSERT_TRUE(RecvBuf.Drain(100));
+    ASSERT_EQ(0u, RecvBuf.RecvBuf.AllocBufferLength);
+}
+
+TEST(RecvBufferTest, ChunkedOutOfOrder)
+{
+    RecvBuffer RecvBuf;
+    BOOLEAN ReadyToRead;
+    uint32_t BufferCount;
+    TEST_QUIC_SUCCEEDED(RecvBuf.Initialize());
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(3 * CHUNK_SIZE, 10, &ReadyToRead));
+    ASSERT_FALSE(ReadyToRead);
+    ASSERT_EQ(1u * CHUNK_SIZE, RecvBuf.RecvBuf.AllocBufferLength);
+    ASSERT_EQ(0u, RecvBuf.Read(&BufferCount));
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(0, 3 * CHUNK_SIZE, &ReadyToRead));
+    ASSERT_TRUE(ReadyToRead);
+    ASSERT_EQ(3u * CHUNK_SIZE + 10, RecvBuf.Read(&BufferCount));
+    ASSERT_EQ(4u, BufferCount);
+    ASSERT_FALSE(RecvBuf.Drain(2 * CHUNK_SIZE + 1));
+    ASSERT_EQ(2u * CHUNK_SIZE, RecvBuf.RecvBuf.AllocBufferLength);
+    ASSERT_EQ(CHUNK_SIZE + 9u, RecvBuf.Read(&BufferCount));
+    ASSERT_EQ(2u, BufferCount);
+    ASSERT_TRUE(RecvBuf.Drain(CHUNK_SIZE + 9));
+}
+
+TEST(RecvBufferTest, ChunkedRingWrapAndGrow)
+{
+    RecvBuffer RecvBuf;
+    BOOLEAN ReadyToRead;
+    uint32_t BufferCount;
+    TEST_QUIC_SUCCEEDED(RecvBuf.Initialize());
+    uint64_t Offset = 0;
+    for (uint32_t i = 0; i < 10; ++i) {
+        TEST_QUIC_SUCCEEDED(RecvBuf.Write(Offset, 3 * CHUNK_SIZE, &ReadyToRead));
+        ASSERT_TRUE(ReadyToRead);
+        ASSERT_EQ(3u * CHUNK_SIZE, RecvBuf.Read(&BufferCount));
+        ASSERT_TRUE(RecvBuf.Drain(3 * CHUNK_SIZE));
+        Offset += 3 * CHUNK_SIZE;
+        TEST_QUIC_SUCCEEDED(RecvBuf.Write(Offset, 10, &ReadyToRead));
+        ASSERT_EQ(10u, RecvBuf.Read(&BufferCount));
+        ASSERT_TRUE(RecvBuf.Drain(10));
+        Offset += 10;
+    }
+    ASSERT_EQ(QUIC_STATUS_BUFFER_TOO_SMALL, RecvBuf.Write(Offset, 5 * CHUNK_SIZE, &ReadyToRead));
+    QuicRecvBufferSetVirtualBufferLength(&RecvBuf.RecvBuf, 8 * CHUNK_SIZE);
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(Offset + CHUNK_SIZE, 4 * CHUNK_SIZE, &ReadyToRead));
+    ASSERT_FALSE(ReadyToRead);
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(Offset, CHUNK_SIZE, &ReadyToRead));
+    ASSERT_TRUE(ReadyToRead);
+    ASSERT_EQ(5u * CHUNK_SIZE, RecvBuf.Read(&BufferCount));
+    ASSERT_EQ(6u, BufferCount);
+    ASSERT_TRUE(RecvBuf.Drain(5 * CHUNK_SIZE));
+    ASSERT_EQ(0u, RecvBuf.RecvBuf.AllocBufferLength);
+}
+
+TEST(RecvBufferTest, ChunkedLazyRing)
+{
+    RecvBuffer RecvBuf;
+    BOOLEAN ReadyToRead;
+    uint32_t BufferCount;
+    TEST_QUIC_SUCCEEDED(RecvBuf.Initialize());
+    ASSERT_EQ(NULL, RecvBuf.RecvBuf.Chunks);
+    uint64_t WriteLength = UINT64_MAX;
+    TEST_QUIC_SUCCEEDED(
+        QuicRecvBufferWrite(&RecvBuf.RecvBuf, 0, 100, NULL, &WriteLength, &ReadyToRead));
+    ASSERT_TRUE(ReadyToRead);
+    ASSERT_TRUE(RecvBuf.Drain(100));
+    ASSERT_EQ(NULL, RecvBuf.RecvBuf.Chunks); // Lent bytes don't need the ring.
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(100, 10, &ReadyToRead));
+    ASSERT_TRUE(ReadyToRead);
+    ASSERT_NE(nullptr, RecvBuf.RecvBuf.Chunks);
+    ASSERT_EQ(1u * CHUNK_SIZE, RecvBuf.RecvBuf.AllocBufferLength);
+    ASSERT_EQ(10u, RecvBuf.Read(&BufferCount));
+    ASSERT_TRUE(RecvBuf.Drain(10));
+}
+
+TEST(RecvBufferTest, CopyOnDrainContiguous)
+{
+    RecvBuffer RecvBuf;
+    BOOLEAN ReadyToRead;
+    uint32_t BufferCount;
+    TEST_QUIC_SUCCEEDED(RecvBuf.Initialize(CHUNK_SIZE, 4 * CHUNK_SIZE, true));
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(0, 3 * CHUNK_SIZE, &ReadyToRead));
+    ASSERT_TRUE(ReadyToRead);
+    ASSERT_EQ(4u * CHUNK_SIZE, RecvBuf.RecvBuf.AllocBufferLength);
+    ASSERT_EQ(3u * CHUNK_SIZE, RecvBuf.Read(&BufferCount));
+    ASSERT_EQ(1u, BufferCount);
+    ASSERT_FALSE(RecvBuf.Drain(CHUNK_SIZE));
+    ASSERT_EQ(2u * CHUNK_SIZE, RecvBuf.Read(&BufferCount));
+    ASSERT_EQ(1u, BufferCount);
+    ASSERT_TRUE(RecvBuf.Drain(2 * CHUNK_SIZE));
+}
+
+TEST(RecvBufferTest, CopyOnDrainTrim)
+{
+    RecvBuffer RecvBuf;
+    BOOLEAN ReadyToRead;
+    uint32_t BufferCount;
+    TEST_QUIC_SUCCEEDED(RecvBuf.Initialize(CHUNK_SIZE, 4 * CHUNK_SIZE, true));
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(0, 10, &ReadyToRead));
+    QuicRecvBufferTrim(&RecvBuf.RecvBuf); // Not empty, so no-op.
+    ASSERT_EQ(1u * CHUNK_SIZE, RecvBuf.RecvBuf.AllocBufferLength);
+    ASSERT_EQ(10u, RecvBuf.Read(&BufferCount));
+    ASSERT_TRUE(RecvBuf.Drain(10));
+    QuicRecvBufferTrim(&RecvBuf.RecvBuf);
+    ASSERT_EQ(0u, RecvBuf.RecvBuf.AllocBufferLength);
+    ASSERT_EQ(NULL, RecvBuf.RecvBuf.Buffer);
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(20, 30, &ReadyToRead));
+    ASSERT_FALSE(ReadyToRead);
+    TEST_QUIC_SUCCEEDED(RecvBuf.Write(10, 10, &ReadyToRead));
+    ASSERT_TRUE(ReadyToRead);
+    ASSERT_EQ(64u, RecvBuf.RecvBuf.AllocBufferLength);
+    ASSERT_EQ(40u, RecvBuf.Read(&BufferCount));
+    ASSERT_EQ(1u, BufferCount);
+    ASSERT_TRUE(RecvBuf.Drain(40));
+}
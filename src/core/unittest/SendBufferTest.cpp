@@ -0,0 +1,152 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the send buffer allocations.
+
+--*/
+
+#include "main.h"
+#include <vector>
+#ifdef QUIC_CLOG
+#include "SendBufferTest.cpp.clog.h"
+#endif
+
+#define TEST_SMALL_ALLOC    100
+
+struct SendBufferConnection {
+    QUIC_WORKER* Worker;
+    QUIC_CONNECTION* Connection;
+    QUIC_SEND_BUFFER* SendBuffer;
+    SendBufferConnection() {
+        Worker = (QUIC_WORKER*)QUIC_ALLOC_NONPAGED(sizeof(QUIC_WORKER), QUIC_POOL_TEST);
+        QuicZeroMemory(Worker, sizeof(*Worker));
+        QuicPoolInitialize(
+            FALSE, QUIC_SEND_BUFFER_SLAB_SIZE, QUIC_POOL_SENDBUF, &Worker->SendBufferSlabPool);
+        Connection =
+            (QUIC_CONNECTION*)QUIC_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+        QuicZeroMemory(Connection, sizeof(*Connection));
+        Connection->Worker = Worker;
+        SendBuffer = &Connection->SendBuffer;
+        QuicSendBufferInitialize(SendBuffer);
+    }
+    ~SendBufferConnection() {
+        QuicSendBufferUninitialize(SendBuffer);
+        QUIC_FREE(Connection, QUIC_POOL_TEST);
+        QuicPoolUninitialize(&Worker->SendBufferSlabPool);
+        QUIC_FREE(Worker, QUIC_POOL_TEST);
+    }
+    uint8_t* Alloc(uint32_t Size) {
+        uint8_t* Buf = QuicSendBufferAlloc(SendBuffer, Size);
+        EXPECT_NE(nullptr, Buf);
+        memset(Buf, (uint8_t)Size, Size);
+        return Buf;
+    }
+    void Free(uint8_t* Buf, uint32_t Size) {
+        for (uint32_t i = 0; i < Size; ++i) {
+            ASSERT_EQ((uint8_t)Size, Buf[i]);
+        }
+        QuicSendBufferFree(SendBuffer, Buf, Size);
+    }
+};
+
+TEST(SendBufferTest, SmallAllocsShareSlab)
+{
+    SendBufferConnection Conn;
+    uint8_t* Buf1 = Conn.Alloc(TEST_SMALL_ALLOC);
+    uint8_t* Buf2 = Conn.Alloc(TEST_SMALL_ALLOC + 1);
+    ASSERT_EQ(1u, Conn.SendBuffer->SlabCount);
+    ASSERT_NE(nullptr, Conn.SendBuffer->Slab);
+    ASSERT_GT(Buf2, Buf1);
+    ASSERT_LT(Buf2, Buf1 + QUIC_SEND_BUFFER_SLAB_SIZE);
+    ASSERT_EQ(2u * TEST_SMALL_ALLOC + 1, Conn.SendBuffer->BufferedBytes);
+
+    //
+    // The slab goes back to the pool as soon as it's drained, even though it's
+    // still the current one.
+    //
+    Conn.Free(Buf1, TEST_SMALL_ALLOC);
+    ASSERT_EQ(1u, Conn.SendBuffer->SlabCount);
+    Conn.Free(Buf2, TEST_SMALL_ALLOC + 1);
+    ASSERT_EQ(0u, Conn.SendBuffer->SlabCount);
+    ASSERT_EQ(nullptr, Conn.SendBuffer->Slab);
+    ASSERT_EQ(0u, Conn.SendBuffer->BufferedBytes);
+}
+
+TEST(SendBufferTest, LargeAllocsBypassSlab)
+{
+    SendBufferConnection Conn;
+    uint8_t* Buf = Conn.Alloc(QUIC_SEND_BUFFER_SLAB_MAX_ALLOC + 1);
+    ASSERT_EQ(0u, Conn.SendBuffer->SlabCount);
+    ASSERT_EQ(nullptr, Conn.SendBuffer->Slab);
+    Conn.Free(Buf, QUIC_SEND_BUFFER_SLAB_MAX_ALLOC + 1);
+    ASSERT_EQ(0u, Conn.SendBuffer->BufferedBytes);
+}
+
+TEST(SendBufferTest, RetiredSlab)
+{
+    SendBufferConnection Conn;
+    const uint32_t PerSlab =
+        (QUIC_SEND_BUFFER_SLAB_SIZE - sizeof(QUIC_SEND_BUFFER_SLAB)) /
+        (QUIC_SEND_BUFFER_SLAB_MAX_ALLOC + sizeof(void*));
+
+    std::vector<uint8_t*> Bufs;
+    for (uint32_t i = 0; i < PerSlab + 1; ++i) {
+        Bufs.push_back(Conn.Alloc(QUIC_SEND_BUFFER_SLAB_MAX_ALLOC));
+    }
+    ASSERT_EQ(2u, Conn.SendBuffer->SlabCount);
+
+    //
+    // Draining the retired slab frees it without touching the current one.
+    //
+    QUIC_SEND_BUFFER_SLAB* Current = Conn.SendBuffer->Slab;
+    for (uint32_t i = 0; i < PerSlab; ++i) {
+        Conn.Free(Bufs[i], QUIC_SEND_BUFFER_SLAB_MAX_ALLOC);
+    }
+    ASSERT_EQ(1u, Conn.SendBuffer->SlabCount);
+    ASSERT_EQ(Current, Conn.SendBuffer->Slab);
+
+    Conn.Free(Bufs[PerSlab], QUIC_SEND_BUFFER_SLAB_MAX_ALLOC);
+    ASSERT_EQ(0u, Conn.SendBuffer->SlabCount);
+}
+
+TEST(SendBufferTest, PinnedSlabsBounded)
+{
+    //
+    // Keep one small request outstanding in every slab, as a stalled stream
+    // interleaved with a busy one would.
+    //
+    SendBufferConnection Conn;
+    const uint32_t MaxSlabCount =
+        (uint32_t)(Conn.SendBuffer->IdealBytes / QUIC_SEND_BUFFER_SLAB_SIZE) + 1;
+
+    std::vector<uint8_t*> Pinned;
+    for (uint32_t i = 0; i < 4 * MaxSlabCount; ++i) {
+        Pinned.push_back(Conn.Alloc(TEST_SMALL_ALLOC));
+        std::vector<uint8_t*> Bufs;
+        for (uint32_t j = 0; j < 4; ++j) {
+            Bufs.push_back(Conn.Alloc(QUIC_SEND_BUFFER_SLAB_MAX_ALLOC));
+        }
+        for (uint8_t* Buf : Bufs) {
+            Conn.Free(Buf, QUIC_SEND_BUFFER_SLAB_MAX_ALLOC);
+        }
+        ASSERT_LE(Conn.SendBuffer->SlabCount, MaxSlabCount);
+    }
+    ASSERT_EQ(MaxSlabCount, Conn.SendBuffer->SlabCount);
+
+    for (uint8_t* Buf : Pinned) {
+        Conn.Free(Buf, TEST_SMALL_ALLOC);
+    }
+    ASSERT_EQ(0u, Conn.SendBuffer->SlabCount);
+    ASSERT_EQ(0u, Conn.SendBuffer->BufferedBytes);
+
+    //
+    // Once the slabs drain, small requests use them again.
+    //
+    uint8_t* Buf = Conn.Alloc(TEST_SMALL_ALLOC);
+    ASSERT_EQ(1u, Conn.SendBuffer->SlabCount);
+    Conn.Free(Buf, TEST_SMALL_ALLOC);
+}
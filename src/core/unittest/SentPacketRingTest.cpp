@@ -0,0 +1,183 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the QUIC_SENT_PACKET_RING interface.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "SentPacketRingTest.cpp.clog.h"
+#endif
+
+struct SentPacketRing {
+    QUIC_SENT_PACKET_RING Ring;
+    QUIC_SENT_PACKET_METADATA Packets[1024];
+    SentPacketRing() {
+        QuicSentPacketRingInitialize(&Ring);
+        for (uint32_t i = 0; i < ARRAYSIZE(Packets); ++i) {
+            QuicZeroMemory(&Packets[i], sizeof(Packets[i]));
+            Packets[i].PacketNumber = i;
+        }
+    }
+    ~SentPacketRing() {
+        while (QuicSentPacketRingGetFirst(&Ring) != NULL) {
+            QuicSentPacketRingRemove(&Ring, QuicSentPacketRingGetFirst(&Ring)->PacketNumber);
+        }
+        QuicSentPacketRingUninitialize(&Ring);
+    }
+    QUIC_STATUS Insert(uint64_t PacketNumber) {
+        return QuicSentPacketRingInsert(&Ring, &Packets[PacketNumber]);
+    }
+    bool Remove(uint64_t PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketRingRemove(&Ring, PacketNumber);
+        if (Packet != NULL) {
+            EXPECT_EQ(PacketNumber, Packet->PacketNumber);
+        }
+        return Packet != NULL;
+    }
+    uint64_t First() {
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketRingGetFirst(&Ring);
+        return Packet == NULL ? UINT64_MAX : Packet->PacketNumber;
+    }
+    uint64_t Next(uint64_t PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketRingGetNext(&Ring, PacketNumber);
+        return Packet == NULL ? UINT64_MAX : Packet->PacketNumber;
+    }
+};
+
+TEST(SentPacketRingTest, Empty)
+{
+    SentPacketRing Ring;
+    ASSERT_EQ(UINT64_MAX, Ring.First());
+    ASSERT_EQ(UINT64_MAX, Ring.Next(0));
+    ASSERT_FALSE(Ring.Remove(0));
+}
+
+TEST(SentPacketRingTest, InsertRemoveInOrder)
+{
+    SentPacketRing Ring;
+    for (uint64_t i = 10; i < 20; ++i) {
+        TEST_QUIC_SUCCEEDED(Ring.Insert(i));
+    }
+    ASSERT_EQ(10u, Ring.Ring.Count);
+    ASSERT_EQ(10u, Ring.First());
+    ASSERT_EQ(20u, QuicSentPacketRingGetEnd(&Ring.Ring));
+    ASSERT_FALSE(Ring.Remove(9));
+    ASSERT_FALSE(Ring.Remove(20));
+    for (uint64_t i = 10; i < 20; ++i) {
+        ASSERT_EQ(i, Ring.First());
+        ASSERT_TRUE(Ring.Remove(i));
+    }
+    ASSERT_EQ(0u, Ring.Ring.Count);
+    ASSERT_EQ(UINT64_MAX, Ring.First());
+}
+
+TEST(SentPacketRingTest, Holes)
+{
+    SentPacketRing Ring;
+    TEST_QUIC_SUCCEEDED(Ring.Insert(1));
+    TEST_QUIC_SUCCEEDED(Ring.Insert(5));
+    TEST_QUIC_SUCCEEDED(Ring.Insert(9));
+    ASSERT_EQ(9u, Ring.Ring.Span);
+    ASSERT_EQ(5u, Ring.Next(2));
+    ASSERT_EQ(9u, Ring.Next(6));
+    ASSERT_EQ(UINT64_MAX, Ring.Next(10));
+    ASSERT_FALSE(Ring.Remove(3));
+    ASSERT_TRUE(Ring.Remove(1));
+    ASSERT_EQ(5u, Ring.First());
+    ASSERT_EQ(5u, Ring.Ring.Span);
+    ASSERT_TRUE(Ring.Remove(9));
+    ASSERT_EQ(1u, Ring.Ring.Span);
+    ASSERT_EQ(6u, QuicSentPacketRingGetEnd(&Ring.Ring));
+}
+
+TEST(SentPacketRingTest, InsertBeforeFirst)
+{
+    SentPacketRing Ring;
+    TEST_QUIC_SUCCEEDED(Ring.Insert(100));
+    TEST_QUIC_SUCCEEDED(Ring.Insert(3));
+    TEST_QUIC_SUCCEEDED(Ring.Insert(50));
+    ASSERT_EQ(3u, Ring.First());
+    ASSERT_EQ(50u, Ring.Next(4));
+    ASSERT_EQ(100u, Ring.Next(51));
+    ASSERT_GE(Ring.Ring.Capacity, 98u);
+}
+
+TEST(SentPacketRingTest, WrapAndGrow)
+{
+    SentPacketRing Ring;
+    uint64_t Low = 0;
+    uint64_t High = 0;
+    //
+    // Slide a window of outstanding packets around the ring a few times
+    // before growing it, so growth has to unwrap the slots.
+    //
+    while (High < 3 * QUIC_SENT_PACKET_RING_INITIAL_SIZE) {
+        TEST_QUIC_SUCCEEDED(Ring.Insert(High++));
+        if (High - Low > QUIC_SENT_PACKET_RING_INITIAL_SIZE / 2) {
+            ASSERT_TRUE(Ring.Remove(Low++));
+        }
+    }
+    ASSERT_EQ((uint32_t)QUIC_SENT_PACKET_RING_INITIAL_SIZE, Ring.Ring.Capacity);
+    while (High < ARRAYSIZE(Ring.Packets)) {
+        TEST_QUIC_SUCCEEDED(Ring.Insert(High++));
+    }
+    ASSERT_EQ(High - Low, (uint64_t)Ring.Ring.Count);
+    for (uint64_t i = Low; i < High; ++i) {
+        ASSERT_EQ(i, Ring.Next(i));
+    }
+}
+
+TEST(SentPacketRingTest, ShrinkWhenDrained)
+{
+    SentPacketRing Ring;
+    for (uint64_t i = 0; i < ARRAYSIZE(Ring.Packets); ++i) {
+        TEST_QUIC_SUCCEEDED(Ring.Insert(i));
+    }
+    ASSERT_GE(Ring.Ring.Capacity, (uint32_t)ARRAYSIZE(Ring.Packets));
+    for (uint64_t i = 0; i < ARRAYSIZE(Ring.Packets) - 1; ++i) {
+        ASSERT_TRUE(Ring.Remove(i));
+    }
+    ASSERT_NE(nullptr, Ring.Ring.Packets);
+
+    //
+    // Removing the last packet frees the grown slot array.
+    //
+    ASSERT_TRUE(Ring.Remove(ARRAYSIZE(Ring.Packets) - 1));
+    ASSERT_EQ(nullptr, Ring.Ring.Packets);
+    ASSERT_EQ(0u, Ring.Ring.Capacity);
+
+    TEST_QUIC_SUCCEEDED(Ring.Insert(5));
+    ASSERT_EQ((uint32_t)QUIC_SENT_PACKET_RING_INITIAL_SIZE, Ring.Ring.Capacity);
+    ASSERT_EQ(5u, Ring.First());
+
+    //
+    // A ring that never grew keeps its initial slot array.
+    //
+    ASSERT_TRUE(Ring.Remove(5));
+    ASSERT_NE(nullptr, Ring.Ring.Packets);
+    ASSERT_EQ((uint32_t)QUIC_SENT_PACKET_RING_INITIAL_SIZE, Ring.Ring.Capacity);
+}
+
+TEST(SentPacketRingTest, MaxSize)
+{
+    SentPacketRing Ring;
+    QUIC_SENT_PACKET_METADATA Packet;
+    QuicZeroMemory(&Packet, sizeof(Packet));
+    Packet.PacketNumber = QUIC_SENT_PACKET_RING_MAX_SIZE;
+
+    TEST_QUIC_SUCCEEDED(Ring.Insert(0));
+    ASSERT_EQ(QUIC_STATUS_OUT_OF_MEMORY, QuicSentPacketRingInsert(&Ring.Ring, &Packet));
+    ASSERT_EQ(1u, Ring.Ring.Count);
+    ASSERT_EQ((uint32_t)QUIC_SENT_PACKET_RING_INITIAL_SIZE, Ring.Ring.Capacity);
+
+    Packet.PacketNumber = QUIC_SENT_PACKET_RING_MAX_SIZE - 1;
+    TEST_QUIC_SUCCEEDED(QuicSentPacketRingInsert(&Ring.Ring, &Packet));
+    ASSERT_EQ(QUIC_SENT_PACKET_RING_MAX_SIZE, Ring.Ring.Capacity);
+    ASSERT_EQ(&Packet, QuicSentPacketRingRemove(&Ring.Ring, Packet.PacketNumber));
+}
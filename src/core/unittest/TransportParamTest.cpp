@@ -34,6 +34,7 @@ void CompareTransportParams(
     COMPARE_TP_FIELD(IDLE_TIMEOUT, IdleTimeout);
     COMPARE_TP_FIELD(MAX_ACK_DELAY, MaxAckDelay);
     COMPARE_TP_FIELD(ACTIVE_CONNECTION_ID_LIMIT, ActiveConnectionIdLimit);
+    COMPARE_TP_FIELD(MIN_ACK_DELAY, MinAckDelay);
     //COMPARE_TP_FIELD(InitialSourceConnectionID);
     //COMPARE_TP_FIELD(InitialSourceConnectionIDLength);
     if (IsServer) { // TODO
@@ -97,6 +98,44 @@ TEST(TransportParamTest, Preset1)
     EncodeDecodeAndCompare(&Original);
 }
 
+TEST(TransportParamTest, MinAckDelay)
+{
+    QUIC_TRANSPORT_PARAMETERS Original;
+    QuicZeroMemory(&Original, sizeof(Original));
+    Original.Flags |= QUIC_TP_FLAG_MAX_ACK_DELAY | QUIC_TP_FLAG_MIN_ACK_DELAY;
+    Original.MaxAckDelay = 25;
+    Original.MinAckDelay = 1000;
+    EncodeDecodeAndCompare(&Original);
+}
+
+TEST(TransportParamTest, MinAckDelayTooLarge)
+{
+    QUIC_TRANSPORT_PARAMETERS Original;
+    QuicZeroMemory(&Original, sizeof(Original));
+    Original.Flags |= QUIC_TP_FLAG_MAX_ACK_DELAY | QUIC_TP_FLAG_MIN_ACK_DELAY;
+    Original.MaxAckDelay = 1;
+    Original.MinAckDelay = 1001;
+
+    uint32_t BufferLength;
+    auto Buffer =
+        QuicCryptoTlsEncodeTransportParameters(
+            &JunkConnection, FALSE, &Original, NULL, &BufferLength);
+    ASSERT_NE(nullptr, Buffer);
+
+    QUIC_TRANSPORT_PARAMETERS Decoded;
+    BOOLEAN DecodedSuccessfully =
+        QuicCryptoTlsDecodeTransportParameters(
+            &JunkConnection,
+            FALSE,
+            Buffer + QuicTlsTPHeaderSize,
+            (uint16_t)(BufferLength - QuicTlsTPHeaderSize),
+            &Decoded);
+
+    QUIC_FREE(Buffer, QUIC_POOL_TLS_TRANSPARAMS);
+
+    ASSERT_FALSE(DecodedSuccessfully);
+}
+
 TEST(TransportParamTest, ZeroTP)
 {
     QUIC_TRANSPORT_PARAMETERS OriginalTP;
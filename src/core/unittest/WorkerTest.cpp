@@ -0,0 +1,197 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for moving queued connections between the workers of a pool.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "WorkerTest.cpp.clog.h"
+#endif
+
+extern "C"
+void
+MsQuicCalculatePartitionMask(
+    void
+    );
+
+extern "C"
+void
+QuicWorkerRequestSteal(
+    _In_ QUIC_WORKER* Worker
+    );
+
+extern "C"
+QUIC_WORKER*
+QuicWorkerGetStealingWorker(
+    _In_ QUIC_WORKER* Worker
+    );
+
+extern "C"
+void
+QuicWorkerUpdateConnectionPartition(
+    _In_ const QUIC_WORKER* Worker,
+    _In_ QUIC_CONNECTION* Connection
+    );
+
+#define TEST_WORKER_COUNT 4
+
+//
+// A pool of workers with just the state needed for stealing. Nothing is ever
+// queued on them; the backlog is faked with a single list entry.
+//
+struct WorkerPool {
+    QUIC_WORKER_POOL* Pool;
+    QUIC_LIST_ENTRY Backlog[TEST_WORKER_COUNT];
+    WorkerPool() {
+        const size_t PoolSize =
+            sizeof(QUIC_WORKER_POOL) + TEST_WORKER_COUNT * sizeof(QUIC_WORKER);
+        Pool = (QUIC_WORKER_POOL*)QUIC_ALLOC_NONPAGED(PoolSize, QUIC_POOL_TEST);
+        QuicZeroMemory(Pool, PoolSize);
+        Pool->WorkerCount = TEST_WORKER_COUNT;
+        for (uint16_t i = 0; i < TEST_WORKER_COUNT; ++i) {
+            QUIC_WORKER* Worker = &Pool->Workers[i];
+            Worker->Enabled = TRUE;
+            Worker->IsActive = TRUE;
+            Worker->WorkerPool = Pool;
+            QuicDispatchLockInitialize(&Worker->Lock);
+            QuicListInitializeHead(&Worker->Connections);
+        }
+    }
+    ~WorkerPool() {
+        for (uint16_t i = 0; i < TEST_WORKER_COUNT; ++i) {
+            QuicDispatchLockUninitialize(&Pool->Workers[i].Lock);
+        }
+        QUIC_FREE(Pool, QUIC_POOL_TEST);
+    }
+    QUIC_WORKER* operator[](uint16_t Index) { return &Pool->Workers[Index]; }
+    void SetBacklog(uint16_t Index, uint32_t QueueDelay) {
+        QUIC_WORKER* Worker = &Pool->Workers[Index];
+        Worker->AverageQueueDelay = QueueDelay;
+        if (QuicListIsEmpty(&Worker->Connections)) {
+            QuicListInsertTail(&Worker->Connections, &Backlog[Index]);
+        }
+    }
+    void ClearBacklog(uint16_t Index) {
+        QUIC_WORKER* Worker = &Pool->Workers[Index];
+        Worker->AverageQueueDelay = 0;
+        QuicListInitializeHead(&Worker->Connections);
+    }
+};
+
+TEST(WorkerTest, StealThreshold)
+{
+    WorkerPool Workers;
+
+    //
+    // A sibling with connections queued, but not enough queue delay, is left
+    // alone.
+    //
+    Workers.SetBacklog(1, QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US - 1);
+    QuicWorkerRequestSteal(Workers[0]);
+    ASSERT_EQ(0, Workers[1]->StealRequest);
+
+    //
+    // Neither is a sibling with enough queue delay, but nothing queued.
+    //
+    Workers.ClearBacklog(1);
+    Workers[1]->AverageQueueDelay = QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US;
+    QuicWorkerRequestSteal(Workers[0]);
+    ASSERT_EQ(0, Workers[1]->StealRequest);
+
+    Workers.SetBacklog(1, QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US);
+    QuicWorkerRequestSteal(Workers[0]);
+    ASSERT_EQ(1, Workers[1]->StealRequest);
+    ASSERT_EQ(Workers[0], QuicWorkerGetStealingWorker(Workers[1]));
+    ASSERT_EQ(0, Workers[1]->StealRequest);
+    ASSERT_EQ(nullptr, QuicWorkerGetStealingWorker(Workers[1]));
+}
+
+TEST(WorkerTest, StealWorstQueueDelay)
+{
+    WorkerPool Workers;
+    Workers.SetBacklog(1, 2 * QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US);
+    Workers.SetBacklog(2, 4 * QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US);
+    Workers.SetBacklog(3, 3 * QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US);
+    Workers[3]->IsActive = FALSE;
+
+    QuicWorkerRequestSteal(Workers[0]);
+    ASSERT_EQ(0, Workers[1]->StealRequest);
+    ASSERT_EQ(1, Workers[2]->StealRequest);
+    ASSERT_EQ(0, Workers[3]->StealRequest);
+
+    //
+    // A worker that was already asked isn't asked again by another one.
+    //
+    QuicWorkerRequestSteal(Workers[3]);
+    ASSERT_EQ(4, Workers[1]->StealRequest);
+    ASSERT_EQ(1, Workers[2]->StealRequest);
+}
+
+TEST(WorkerTest, StealBacklogDrained)
+{
+    WorkerPool Workers;
+    Workers.SetBacklog(1, QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US);
+    QuicWorkerRequestSteal(Workers[0]);
+    ASSERT_EQ(1, Workers[1]->StealRequest);
+
+    //
+    // By the time the victim acts on the request, its backlog may be gone, in
+    // which case the request is just dropped.
+    //
+    Workers.ClearBacklog(1);
+    ASSERT_EQ(nullptr, QuicWorkerGetStealingWorker(Workers[1]));
+    ASSERT_EQ(0, Workers[1]->StealRequest);
+
+    Workers.SetBacklog(1, QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US - 1);
+    Workers[1]->StealRequest = 1;
+    ASSERT_EQ(nullptr, QuicWorkerGetStealingWorker(Workers[1]));
+    ASSERT_EQ(0, Workers[1]->StealRequest);
+
+    Workers.SetBacklog(1, QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US);
+    Workers[1]->StealRequest = 1;
+    Workers[0]->Enabled = FALSE;
+    ASSERT_EQ(nullptr, QuicWorkerGetStealingWorker(Workers[1]));
+}
+
+TEST(WorkerTest, MigratedPartition)
+{
+    const uint16_t PartitionCount = MsQuicLib.PartitionCount;
+    MsQuicLib.PartitionCount = TEST_WORKER_COUNT;
+    MsQuicCalculatePartitionMask();
+
+    WorkerPool Workers;
+    QUIC_REGISTRATION Registration;
+    QuicZeroMemory(&Registration, sizeof(Registration));
+    QUIC_CONNECTION* Connection =
+        (QUIC_CONNECTION*)QUIC_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+    QuicZeroMemory(Connection, sizeof(*Connection));
+    Connection->Registration = &Registration;
+    Connection->PartitionID = QuicPartitionIdCreate(1);
+
+    //
+    // The partition ID follows the connection to its new worker, and its path
+    // no longer pulls it back to the partition its datagrams arrive on.
+    //
+    QuicWorkerUpdateConnectionPartition(Workers[3], Connection);
+    ASSERT_EQ(3, QuicPartitionIdGetIndex(Connection->PartitionID));
+    ASSERT_TRUE(Connection->Paths[0].PartitionUpdated);
+
+    //
+    // Without partitioning, there's nothing to update.
+    //
+    Registration.NoPartitioning = TRUE;
+    Connection->Paths[0].PartitionUpdated = FALSE;
+    QuicWorkerUpdateConnectionPartition(Workers[2], Connection);
+    ASSERT_EQ(3, QuicPartitionIdGetIndex(Connection->PartitionID));
+    ASSERT_FALSE(Connection->Paths[0].PartitionUpdated);
+
+    QUIC_FREE(Connection, QUIC_POOL_TEST);
+    MsQuicLib.PartitionCount = PartitionCount;
+    MsQuicCalculatePartitionMask();
+}
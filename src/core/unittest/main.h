@@ -7,6 +7,13 @@
 
 #pragma once
 
+//
+// C++ doesn't support the anonymous QUIC_HANDLE member of the core handle
+// structs, so have them name it instead. Otherwise the tests would see a
+// different field layout than the C code they call into.
+//
+#define QUIC_CORE_UNIT_TEST 1
+
 #include "precomp.h"
 
 #undef min // gtest headers conflict with previous definitions of min/max.
@@ -29,17 +29,35 @@ Abstract:
 //
 QUIC_THREAD_CALLBACK(QuicWorkerThread, Context);
 
+//
+// Execution context callback for running the worker on a datapath thread.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_EXECUTION_CONTEXT_RUN)
+BOOLEAN
+QuicWorkerRunExecutionContext(
+    _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext,
+    _In_ uint64_t TimeNow
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicWorkerUninitialize(
     _In_ QUIC_WORKER* Worker
     );
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerStop(
+    _In_ QUIC_WORKER* Worker
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicWorkerInitialize(
     _In_opt_ const void* Owner,
     _In_ uint16_t ThreadFlags,
+    _In_ BOOLEAN InlineExecution,
     _In_ uint16_t IdealProcessor,
     _Inout_ QUIC_WORKER* Worker
     )
@@ -55,6 +73,7 @@ QuicWorkerInitialize(
 
     Worker->Enabled = TRUE;
     Worker->IdealProcessor = IdealProcessor;
+    Worker->LoadIntervalStart = QuicTimeUs32();
     QuicDispatchLockInitialize(&Worker->Lock);
     QuicEventInitialize(&Worker->Ready, FALSE, FALSE);
     QuicListInitializeHead(&Worker->Connections);
@@ -62,6 +81,7 @@ QuicWorkerInitialize(
     QuicPoolInitialize(FALSE, sizeof(QUIC_STREAM), QUIC_POOL_STREAM, &Worker->StreamPool);
     QuicPoolInitialize(FALSE, QUIC_DEFAULT_STREAM_RECV_BUFFER_SIZE, QUIC_POOL_SBUF, &Worker->DefaultReceiveBufferPool);
     QuicPoolInitialize(FALSE, sizeof(QUIC_SEND_REQUEST), QUIC_POOL_SEND_REQUEST, &Worker->SendRequestPool);
+    QuicPoolInitialize(FALSE, QUIC_SEND_BUFFER_SLAB_SIZE, QUIC_POOL_SENDBUF, &Worker->SendBufferSlabPool);
     QuicSentPacketPoolInitialize(&Worker->SentPacketPool);
     QuicPoolInitialize(FALSE, sizeof(QUIC_API_CONTEXT), QUIC_POOL_API_CTX, &Worker->ApiContextPool);
     QuicPoolInitialize(FALSE, sizeof(QUIC_STATELESS_CONTEXT), QUIC_POOL_STATELESS_CTX, &Worker->StatelessContextPool);
@@ -72,23 +92,62 @@ QuicWorkerInitialize(
         goto Error;
     }
 
-    QUIC_THREAD_CONFIG ThreadConfig = {
-        ThreadFlags,
-        IdealProcessor,
-        "quic_worker",
-        QuicWorkerThread,
-        Worker
-    };
+    if (InlineExecution) {
+        QUIC_EXECUTION_CONTEXT* ExecutionContext =
+            QUIC_ALLOC_NONPAGED(sizeof(QUIC_EXECUTION_CONTEXT), QUIC_POOL_WORKER);
+        if (ExecutionContext == NULL) {
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "QUIC_EXECUTION_CONTEXT",
+                sizeof(QUIC_EXECUTION_CONTEXT));
+            Status = QUIC_STATUS_OUT_OF_MEMORY;
+            goto Error;
+        }
 
-    Status = QuicThreadCreate(&ThreadConfig, &Worker->Thread);
-    if (QUIC_FAILED(Status)) {
-        QuicTraceEvent(
-            WorkerErrorStatus,
-            "[wrkr][%p] ERROR, %u, %s.",
-            Worker,
-            Status,
-            "QuicThreadCreate");
-        goto Error;
+        QuicZeroMemory(ExecutionContext, sizeof(QUIC_EXECUTION_CONTEXT));
+        ExecutionContext->Context = Worker;
+        ExecutionContext->Run = QuicWorkerRunExecutionContext;
+        ExecutionContext->NextTimeUs = UINT64_MAX;
+
+        Status =
+            QuicDataPathAddExecutionContext(
+                MsQuicLib.Datapath,
+                IdealProcessor,
+                ExecutionContext);
+        if (QUIC_FAILED(Status)) {
+            QuicTraceEvent(
+                WorkerErrorStatus,
+                "[wrkr][%p] ERROR, %u, %s.",
+                Worker,
+                Status,
+                "QuicDataPathAddExecutionContext");
+            QUIC_FREE(ExecutionContext, QUIC_POOL_WORKER);
+            goto Error;
+        }
+
+        Worker->ExecutionContext = ExecutionContext;
+        Worker->InlineExecution = TRUE;
+
+    } else {
+        QUIC_THREAD_CONFIG ThreadConfig = {
+            ThreadFlags,
+            IdealProcessor,
+            "quic_worker",
+            QuicWorkerThread,
+            Worker
+        };
+
+        Status = QuicThreadCreate(&ThreadConfig, &Worker->Thread);
+        if (QUIC_FAILED(Status)) {
+            QuicTraceEvent(
+                WorkerErrorStatus,
+                "[wrkr][%p] ERROR, %u, %s.",
+                Worker,
+                Status,
+                "QuicThreadCreate");
+            goto Error;
+        }
     }
 
 Error:
@@ -119,7 +178,23 @@ QuicWorkerUninitialize(
     //
     // Wait for the thread to finish.
     //
-    QuicEventSet(Worker->Ready);
+    if (Worker->InlineExecution) {
+        if (QuicDataPathIsExecutionContextThread(Worker->ExecutionContext)) {
+            //
+            // The datapath thread can't run the worker while it's busy with
+            // this call, so stop the worker here instead. The execution context
+            // is left to free itself once the thread gets back to it.
+            //
+            QuicWorkerStop(Worker);
+            Worker->ExecutionContext->Context = NULL;
+            QuicDataPathWakeExecutionContext(Worker->ExecutionContext);
+        } else {
+            QuicDataPathWakeExecutionContext(Worker->ExecutionContext);
+            QuicEventWaitForever(Worker->Ready);
+        }
+    } else {
+        QuicEventSet(Worker->Ready);
+    }
     if (Worker->Thread) {
         QuicThreadWait(&Worker->Thread);
         QuicThreadDelete(&Worker->Thread);
@@ -131,6 +206,7 @@ QuicWorkerUninitialize(
     QuicPoolUninitialize(&Worker->StreamPool);
     QuicPoolUninitialize(&Worker->DefaultReceiveBufferPool);
     QuicPoolUninitialize(&Worker->SendRequestPool);
+    QuicPoolUninitialize(&Worker->SendBufferSlabPool);
     QuicSentPacketPoolUninitialize(&Worker->SentPacketPool);
     QuicPoolUninitialize(&Worker->ApiContextPool);
     QuicPoolUninitialize(&Worker->StatelessContextPool);
@@ -171,6 +247,22 @@ QuicWorkerIsIdle(
         QuicListIsEmpty(&Worker->Operations);
 }
 
+//
+// Kicks the worker to process newly queued work.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicWorkerWake(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    if (Worker->InlineExecution) {
+        QuicDataPathWakeExecutionContext(Worker->ExecutionContext);
+    } else {
+        QuicEventSet(Worker->Ready);
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicWorkerQueueConnection(
@@ -208,7 +300,7 @@ QuicWorkerQueueConnection(
     }
 
     if (WakeWorkerThread) {
-        QuicEventSet(Worker->Ready);
+        QuicWorkerWake(Worker);
     }
 }
 
@@ -239,7 +331,7 @@ QuicWorkerMoveConnection(
     QuicDispatchLockRelease(&Worker->Lock);
 
     if (WakeWorkerThread) {
-        QuicEventSet(Worker->Ready);
+        QuicWorkerWake(Worker);
     }
 }
 
@@ -277,7 +369,7 @@ QuicWorkerQueueOperation(
         QuicPacketLogDrop(Binding, Packet, "Worker operation limit reached");
         QuicOperationFree(Worker, Operation);
     } else if (WakeWorkerThread) {
-        QuicEventSet(Worker->Ready);
+        QuicWorkerWake(Worker);
     }
 }
 
@@ -417,14 +509,279 @@ QuicWorkerProcessTimers(
         QUIC_CONNECTION* Connection =
             QUIC_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
 
+        if (QuicCryptoIsOffloadPending(&Connection->Crypto)) {
+            //
+            // The connection's state is owned by the TLS pool. Its timers get
+            // put back in the wheel when the offload completes.
+            //
+            continue;
+        }
+
         Connection->WorkerThreadID = Worker->ThreadID;
         QuicConfigurationAttachSilo(Connection->Configuration);
         QuicConnTimerExpired(Connection, TimeNow);
+        QuicConnFlushInlineApiCalls(Connection);
         QuicConfigurationDetachSilo();
         Connection->WorkerThreadID = 0;
     }
 }
 
+//
+// Returns TRUE if the connection can be moved to another worker in the pool
+// without waiting on anything else.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicWorkerCanMigrateConnection(
+    _In_ const QUIC_CONNECTION* Connection
+    )
+{
+    //
+    // A connection whose handle isn't closed yet holds up the rundown of its
+    // registration, which keeps the new worker alive.
+    //
+    return
+        Connection->Registration != NULL &&
+        !Connection->State.UpdateWorker &&
+        !Connection->State.HandleClosed &&
+        !Connection->State.Uninitialized &&
+        !QuicCryptoIsOffloadPending(&Connection->Crypto);
+}
+
+//
+// Called by a worker that is about to go idle. Asks the sibling worker with
+// the worst queue delay, among those with connections queued and a queue delay
+// of at least QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US, to hand one of them over.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerRequestSteal(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    QUIC_WORKER_POOL* WorkerPool = Worker->WorkerPool;
+    if (WorkerPool->WorkerCount < 2) {
+        return;
+    }
+
+    //
+    // N.B. The other workers' queue delays are read without synchronization, so
+    // this is just a hint. The victim makes the actual decision.
+    //
+    QUIC_WORKER* Victim = NULL;
+    for (uint16_t i = 0; i < WorkerPool->WorkerCount; ++i) {
+        QUIC_WORKER* Sibling = &WorkerPool->Workers[i];
+        if (Sibling == Worker ||
+            !Sibling->Enabled ||
+            !Sibling->IsActive ||
+            Sibling->StealRequest != 0 ||
+            Sibling->AverageQueueDelay < QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US ||
+            (Victim != NULL && Sibling->AverageQueueDelay <= Victim->AverageQueueDelay)) {
+            continue;
+        }
+
+        QuicDispatchLockAcquire(&Sibling->Lock);
+        BOOLEAN HasBacklog = !QuicListIsEmpty(&Sibling->Connections);
+        QuicDispatchLockRelease(&Sibling->Lock);
+
+        if (HasBacklog) {
+            Victim = Sibling;
+        }
+    }
+
+    if (Victim != NULL) {
+        const short Thief = (short)(Worker - WorkerPool->Workers) + 1;
+        (void)InterlockedCompareExchange16(&Victim->StealRequest, Thief, 0);
+    }
+}
+
+//
+// Returns the idle worker that asked to take one of this worker's queued
+// connections, if there is one and this worker still has a backlog: other
+// connections queued and a queue delay over the stealing threshold.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_WORKER*
+QuicWorkerGetStealingWorker(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    const short Thief = Worker->StealRequest;
+    if (Thief == 0) {
+        return NULL;
+    }
+    (void)InterlockedCompareExchange16(&Worker->StealRequest, 0, Thief);
+
+    if (Worker->AverageQueueDelay < QUIC_WORKER_STEAL_MIN_QUEUE_DELAY_US) {
+        return NULL;
+    }
+
+    QuicDispatchLockAcquire(&Worker->Lock);
+    BOOLEAN HasBacklog = !QuicListIsEmpty(&Worker->Connections);
+    QuicDispatchLockRelease(&Worker->Lock);
+
+    QUIC_WORKER* Stealer = &Worker->WorkerPool->Workers[Thief - 1];
+    return HasBacklog && Stealer->Enabled ? Stealer : NULL;
+}
+
+//
+// Points the connection's partition ID at the worker it's being migrated to.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerUpdateConnectionPartition(
+    _In_ const QUIC_WORKER* Worker,
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    if (Connection->Registration->NoPartitioning) {
+        return;
+    }
+
+    //
+    // The partition ID picks the connection's worker whenever it's reassigned
+    // (and the worker index is the partition index), so it has to follow the
+    // migration. The current path's datagrams are still steered to the old
+    // partition, so mark the path as updated already. Otherwise the receive
+    // path would move the connection straight back.
+    //
+    Connection->PartitionID =
+        QuicPartitionIdCreate((uint16_t)(Worker - Worker->WorkerPool->Workers));
+    Connection->Paths[0].PartitionUpdated = TRUE;
+}
+
+//
+// Returns the load (percent of the last interval spent processing connections)
+// of another worker.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+uint32_t
+QuicWorkerGetLoad(
+    _In_ const QUIC_WORKER* Worker,
+    _In_ uint32_t TimeNow
+    )
+{
+    //
+    // A worker only rolls its interval over when it processes a connection,
+    // so one that hasn't for a couple intervals has been idle.
+    //
+    const uint32_t SinceIntervalStart =
+        QuicTimeDiff32(Worker->LoadIntervalStart, TimeNow);
+    if (SinceIntervalStart >= 2 * QUIC_WORKER_LOAD_INTERVAL_US &&
+        SinceIntervalStart < (UINT32_MAX >> 1)) {
+        return 0;
+    }
+    return Worker->Load;
+}
+
+//
+// Rolls the worker's load interval over when it's complete, and decides
+// whether a heavy connection should be migrated to a less loaded worker in the
+// next one.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerUpdateLoad(
+    _In_ QUIC_WORKER* Worker,
+    _In_ uint32_t TimeNow
+    )
+{
+    const uint32_t Elapsed = QuicTimeDiff32(Worker->LoadIntervalStart, TimeNow);
+    if (Elapsed < QUIC_WORKER_LOAD_INTERVAL_US) {
+        return;
+    }
+
+    Worker->Load =
+        (uint32_t)(((uint64_t)Worker->LoadIntervalBusyTime * 100) / Elapsed);
+    Worker->LoadIntervalBusyTime = 0;
+    Worker->LoadIntervalStart = TimeNow;
+    Worker->LoadIntervalId++;
+    Worker->RebalanceWorker = NULL;
+
+    if (Worker->Load < QUIC_WORKER_REBALANCE_MIN_LOAD) {
+        return;
+    }
+
+    QUIC_WORKER_POOL* WorkerPool = Worker->WorkerPool;
+    QUIC_WORKER* Target = NULL;
+    uint32_t TargetLoad = Worker->Load;
+    for (uint16_t i = 0; i < WorkerPool->WorkerCount; ++i) {
+        QUIC_WORKER* Sibling = &WorkerPool->Workers[i];
+        if (Sibling != Worker && Sibling->Enabled) {
+            uint32_t SiblingLoad = QuicWorkerGetLoad(Sibling, TimeNow);
+            if (SiblingLoad < TargetLoad) {
+                Target = Sibling;
+                TargetLoad = SiblingLoad;
+            }
+        }
+    }
+
+    if (Target != NULL &&
+        Worker->Load - TargetLoad >= QUIC_WORKER_REBALANCE_MIN_LOAD_GAP) {
+        //
+        // Moving a connection with more load than the difference would just
+        // move the imbalance over to the other worker.
+        //
+        Worker->RebalanceWorker = Target;
+        Worker->RebalanceMaxConnLoad = Worker->Load - TargetLoad;
+    }
+}
+
+//
+// Accounts the time spent draining the connection to it and the worker, and
+// returns a less loaded worker to migrate it to, if it is heavy enough to be
+// worth migrating.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_WORKER*
+QuicWorkerAccountProcessing(
+    _In_ QUIC_WORKER* Worker,
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ uint32_t DrainStart
+    )
+{
+    const uint32_t TimeNow = QuicTimeUs32();
+    const uint32_t DrainTime = QuicTimeDiff32(DrainStart, TimeNow);
+
+    QuicWorkerUpdateLoad(Worker, TimeNow);
+    Worker->LoadIntervalBusyTime += DrainTime;
+
+    if (Connection->Stats.Schedule.LoadIntervalId != Worker->LoadIntervalId) {
+        Connection->Stats.Schedule.LastIntervalProcessingTime =
+            Connection->Stats.Schedule.LoadIntervalId + 1 == Worker->LoadIntervalId ?
+                Connection->Stats.Schedule.IntervalProcessingTime : 0;
+        Connection->Stats.Schedule.IntervalProcessingTime = 0;
+        Connection->Stats.Schedule.LoadIntervalId = Worker->LoadIntervalId;
+    }
+    Connection->Stats.Schedule.IntervalProcessingTime += DrainTime;
+    Connection->Stats.Schedule.ProcessingTime += DrainTime;
+
+    if (Worker->RebalanceWorker == NULL ||
+        !Connection->State.Connected ||
+        !QuicWorkerCanMigrateConnection(Connection)) {
+        return NULL;
+    }
+
+    const uint32_t ConnLoad =
+        (uint32_t)(((uint64_t)Connection->Stats.Schedule.LastIntervalProcessingTime * 100) /
+            QUIC_WORKER_LOAD_INTERVAL_US);
+    if (ConnLoad < QUIC_WORKER_REBALANCE_MIN_CONN_LOAD ||
+        ConnLoad >= Worker->RebalanceMaxConnLoad) {
+        return NULL;
+    }
+
+    QUIC_WORKER* NewWorker = Worker->RebalanceWorker;
+    Worker->RebalanceWorker = NULL;
+    QuicTraceLogConnInfo(
+        RebalanceWorker,
+        Connection,
+        "Rebalancing to worker %p (conn load %u%%, worker load %u%%)",
+        NewWorker,
+        ConnLoad,
+        Worker->Load);
+    return NewWorker;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicWorkerProcessConnection(
@@ -447,46 +804,104 @@ QuicWorkerProcessConnection(
                 QuicTimeUs32()));
     }
 
-    //
-    // Set the thread ID so reentrant API calls will execute inline.
-    //
-    Connection->WorkerThreadID = Worker->ThreadID;
-    Connection->Stats.Schedule.DrainCount++;
+    QUIC_WORKER* NewWorker = NULL;
+    BOOLEAN StillHasWorkToDo;
+    if (QuicCryptoIsOffloadPending(&Connection->Crypto) &&
+        !Connection->State.UpdateWorker) {
+        //
+        // The TLS pool owns the connection's state until the offload completes,
+        // at which point the connection is queued again. Leave it alone until
+        // then, including its thread ID and worker assignment.
+        //
+        // N.B. A connection that was moved to this worker with its offload only
+        // prepared is still owned by the worker, which hands it off below.
+        //
+        StillHasWorkToDo = FALSE;
 
-    if (Connection->State.UpdateWorker) {
+    } else if (Worker->StealRequest != 0 &&
+        QuicWorkerCanMigrateConnection(Connection) &&
+        (NewWorker = QuicWorkerGetStealingWorker(Worker)) != NULL) {
         //
-        // If the connection is uninitialized already, it shouldn't have been
-        // queued to move to a new worker in the first place.
+        // Hand the connection over, without processing it, to the idle worker
+        // that asked for it.
         //
-        QUIC_DBG_ASSERT(!Connection->State.Uninitialized);
+        QuicTraceLogConnInfo(
+            StolenByWorker,
+            Connection,
+            "Stolen by worker %p",
+            NewWorker);
+        Connection->State.UpdateWorker = TRUE;
+        StillHasWorkToDo = TRUE;
 
+    } else {
         //
-        // The connection was recently placed into this worker and needs any
-        // pre-existing timers to be transitioned to this worker for processing.
+        // Set the thread ID so reentrant API calls will execute inline.
         //
-        Connection->State.UpdateWorker = FALSE;
-        QuicTimerWheelUpdateConnection(&Worker->TimerWheel, Connection);
+        Connection->WorkerThreadID = Worker->ThreadID;
+        Connection->Stats.Schedule.DrainCount++;
+
+        if (Connection->State.UpdateWorker) {
+            //
+            // If the connection is uninitialized already, it shouldn't have been
+            // queued to move to a new worker in the first place.
+            //
+            QUIC_DBG_ASSERT(!Connection->State.Uninitialized);
+
+            //
+            // The connection was recently placed into this worker and needs any
+            // pre-existing timers to be transitioned to this worker for processing.
+            //
+            Connection->State.UpdateWorker = FALSE;
+            QuicTimerWheelUpdateConnection(&Worker->TimerWheel, Connection);
+
+            //
+            // Start measuring the connection's load over again, so it has to prove
+            // heavy on this worker before it can be moved again.
+            //
+            Connection->Stats.Schedule.LoadIntervalId = Worker->LoadIntervalId;
+            Connection->Stats.Schedule.IntervalProcessingTime = 0;
+            Connection->Stats.Schedule.LastIntervalProcessingTime = 0;
+
+            //
+            // When the worker changes the app layer needs to be informed so that
+            // it can stay in sync with the per-processor partitioning state.
+            //
+            QUIC_CONNECTION_EVENT Event;
+            Event.Type = QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED;
+            Event.IDEAL_PROCESSOR_CHANGED.IdealProcessor = Worker->IdealProcessor;
+            QuicTraceLogConnVerbose(
+                IndicateIdealProcChanged,
+                Connection,
+                "Indicating QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED");
+            (void)QuicConnIndicateEvent(Connection, &Event);
+        }
 
         //
-        // When the worker changes the app layer needs to be informed so that
-        // it can stay in sync with the per-processor partitioning state.
+        // Process some operations.
         //
-        QUIC_CONNECTION_EVENT Event;
-        Event.Type = QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED;
-        Event.IDEAL_PROCESSOR_CHANGED.IdealProcessor = Worker->IdealProcessor;
-        QuicTraceLogConnVerbose(
-            IndicateIdealProcChanged,
-            Connection,
-            "Indicating QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED");
-        (void)QuicConnIndicateEvent(Connection, &Event);
-    }
+        const uint32_t DrainStart = QuicTimeUs32();
+        StillHasWorkToDo =
+            QuicConnDrainOperations(Connection) | Connection->State.UpdateWorker;
+        Connection->WorkerThreadID = 0;
 
-    //
-    // Process some operations.
-    //
-    BOOLEAN StillHasWorkToDo =
-        QuicConnDrainOperations(Connection) | Connection->State.UpdateWorker;
-    Connection->WorkerThreadID = 0;
+        if (!Connection->State.UpdateWorker) {
+            NewWorker = QuicWorkerAccountProcessing(Worker, Connection, DrainStart);
+            if (NewWorker != NULL) {
+                Connection->State.UpdateWorker = TRUE;
+                StillHasWorkToDo = TRUE;
+            }
+        }
+
+        if (!Connection->State.UpdateWorker &&
+            Connection->Crypto.TlsOffloadState == QUIC_TLS_OFFLOAD_PREPARED) {
+            //
+            // Now that the worker is done with the connection, hand the prepared
+            // TLS processing off to the TLS pool. If the connection is moving to a
+            // new worker, the new worker hands it off instead.
+            //
+            QuicCryptoQueueOffload(&Connection->Crypto);
+        }
+    }
 
     //
     // Determine whether the connection needs to be requeued.
@@ -532,8 +947,13 @@ QuicWorkerProcessConnection(
             // processed on the other worker.
             //
             QuicTimerWheelRemoveConnection(&Worker->TimerWheel, Connection);
-            QUIC_FRE_ASSERT(Connection->Registration != NULL);
-            QuicRegistrationQueueNewConnection(Connection->Registration, Connection);
+            if (NewWorker != NULL) {
+                QuicWorkerUpdateConnectionPartition(NewWorker, Connection);
+                QuicWorkerAssignConnection(NewWorker, Connection);
+            } else {
+                QUIC_FRE_ASSERT(Connection->Registration != NULL);
+                QuicRegistrationQueueNewConnection(Connection->Registration, Connection);
+            }
             QUIC_DBG_ASSERT(Worker != Connection->Worker);
             QuicWorkerMoveConnection(Connection->Worker, Connection);
         }
@@ -546,97 +966,89 @@ QuicWorkerProcessConnection(
     }
 }
 
-QUIC_THREAD_CALLBACK(QuicWorkerThread, Context)
+//
+// Runs a single loop of the worker. Returns TRUE if there may be more work to
+// do right away. Otherwise, the worker should wait to be woken, or for Delay
+// milliseconds for the next timer to expire (UINT64_MAX if there are none).
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicWorkerLoop(
+    _In_ QUIC_WORKER* Worker,
+    _Out_ uint64_t* Delay
+    )
 {
-    QUIC_WORKER* Worker = (QUIC_WORKER*)Context;
-
-    Worker->ThreadID = QuicCurThreadID();
-    Worker->IsActive = TRUE;
-    QuicTraceEvent(
-        WorkerStart,
-        "[wrkr][%p] Start",
-        Worker);
-
     //
-    // TODO - Review how often QuicTimeUs64() is called in the thread. Perhaps
-    // we can get it down to once per loop, passing the value along.
+    // For every loop of the worker thread, in an attempt to balance things,
+    // a single connection will be processed (if available), followed by a
+    // single stateless operation (if available), and then by any expired
+    // timers (which just queue more operations on connections).
     //
 
-    while (Worker->Enabled) {
-
-        //
-        // For every loop of the worker thread, in an attempt to balance things,
-        // a single connection will be processed (if available), followed by a
-        // single stateless operation (if available), and then by any expired
-        // timers (which just queue more operations on connections).
-        //
+    QUIC_CONNECTION* Connection = QuicWorkerGetNextConnection(Worker);
+    if (Connection != NULL) {
+        QuicWorkerProcessConnection(Worker, Connection);
+    }
 
-        QUIC_CONNECTION* Connection = QuicWorkerGetNextConnection(Worker);
-        if (Connection != NULL) {
-            QuicWorkerProcessConnection(Worker, Connection);
-        }
+    QUIC_OPERATION* Operation = QuicWorkerGetNextOperation(Worker);
+    if (Operation != NULL) {
+        QuicBindingProcessStatelessOperation(
+            Operation->Type,
+            Operation->STATELESS.Context);
+        QuicOperationFree(Worker, Operation);
+        QuicPerfCounterIncrement(QUIC_PERF_COUNTER_WORK_OPER_COMPLETED);
+    }
 
-        QUIC_OPERATION* Operation = QuicWorkerGetNextOperation(Worker);
-        if (Operation != NULL) {
-            QuicBindingProcessStatelessOperation(
-                Operation->Type,
-                Operation->STATELESS.Context);
-            QuicOperationFree(Worker, Operation);
-            QuicPerfCounterIncrement(QUIC_PERF_COUNTER_WORK_OPER_COMPLETED);
-        }
+    //
+    // Get the delay until the next timer expires. Check to see if any
+    // timers have expired; if so, process them. If not, only wait for the
+    // next timer if we have run out of connections and stateless operations
+    // to process.
+    //
+    *Delay = QuicTimerWheelGetWaitTime(&Worker->TimerWheel);
 
+    if (*Delay == 0) {
         //
-        // Get the delay until the next timer expires. Check to see if any
-        // timers have expired; if so, process them. If not, only wait for the
-        // next timer if we have run out of connections and stateless operations
-        // to process.
+        // Timers are ready to be processed.
         //
-        uint64_t Delay = QuicTimerWheelGetWaitTime(&Worker->TimerWheel);
-
-        if (Delay == 0) {
-            //
-            // Timers are ready to be processed.
-            //
-            QuicWorkerProcessTimers(Worker);
-
-        } else if (Connection != NULL || Operation != NULL) {
-            //
-            // There still may be more connections or stateless operations to be
-            // processed. Continue processing until there are no more. Then the
-            // thread can wait for the timer delay.
-            //
-            continue;
-
-        } else if (Delay != UINT64_MAX) {
-            //
-            // Since we have no connections and no stateless operations to
-            // process at the moment, we need to wait for the ready event or the
-            // next timer to expire.
-            //
-            if (Delay >= (uint64_t)UINT32_MAX) {
-                Delay = UINT32_MAX - 1; // Max has special meaning for most platforms.
-            }
-            QuicWorkerToggleActivityState(Worker, (uint32_t)Delay);
-            QuicWorkerResetQueueDelay(Worker);
-            BOOLEAN ReadySet =
-                QuicEventWaitWithTimeout(Worker->Ready, (uint32_t)Delay);
-            QuicWorkerToggleActivityState(Worker, ReadySet);
-
-            if (!ReadySet) {
-                QuicWorkerProcessTimers(Worker);
-            }
+        QuicWorkerProcessTimers(Worker);
+        return TRUE;
+    }
 
-        } else {
-            //
-            // No active timers running, so just wait for the ready event.
-            //
-            QuicWorkerToggleActivityState(Worker, UINT32_MAX);
-            QuicWorkerResetQueueDelay(Worker);
-            QuicEventWaitForever(Worker->Ready);
-            QuicWorkerToggleActivityState(Worker, TRUE);
+    //
+    // Free the lookup entries retired by connections, in batches while busy,
+    // or whenever out of other work. Until they are all freed, keep waking up
+    // to check whether their grace period has completed.
+    //
+    // N.B. The counts are read without the lock, only as a hint.
+    //
+    BOOLEAN MoreWork = Connection != NULL || Operation != NULL;
+    if (!MoreWork ||
+        MsQuicLib.LookupRetired.Count >= QUIC_LOOKUP_RECLAIM_BATCH_SIZE) {
+        if ((MsQuicLib.LookupRetired.Count != 0 || MsQuicLib.LookupPending.Count != 0) &&
+            QuicLookupReclaim() &&
+            *Delay > QUIC_LOOKUP_RECLAIM_INTERVAL_MS) {
+            *Delay = QUIC_LOOKUP_RECLAIM_INTERVAL_MS;
         }
     }
 
+    //
+    // There still may be more connections or stateless operations to be
+    // processed. Continue processing until there are no more. Then the
+    // thread can wait for the timer delay.
+    //
+    return MoreWork;
+}
+
+//
+// Called once the worker is disabled, to clean up anything still queued.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerStop(
+    _In_ QUIC_WORKER* Worker
+    )
+{
     //
     // Because the registration layer only waits for the rundown to complete,
     // and because the connection releases the rundown on handle close,
@@ -682,14 +1094,181 @@ QUIC_THREAD_CALLBACK(QuicWorkerThread, Context)
         WorkerStop,
         "[wrkr][%p] Stop",
         Worker);
+}
+
+QUIC_THREAD_CALLBACK(QuicWorkerThread, Context)
+{
+    QUIC_WORKER* Worker = (QUIC_WORKER*)Context;
+
+    Worker->ThreadID = QuicCurThreadID();
+    Worker->IsActive = TRUE;
+    QuicTraceEvent(
+        WorkerStart,
+        "[wrkr][%p] Start",
+        Worker);
+
+    //
+    // TODO - Review how often QuicTimeUs64() is called in the thread. Perhaps
+    // we can get it down to once per loop, passing the value along.
+    //
+
+    while (Worker->Enabled) {
+
+        uint64_t Delay;
+        if (QuicWorkerLoop(Worker, &Delay)) {
+            continue;
+        }
+
+        if (Delay != UINT64_MAX) {
+            //
+            // Since we have no connections and no stateless operations to
+            // process at the moment, we need to wait for the ready event or the
+            // next timer to expire.
+            //
+            if (Delay >= (uint64_t)UINT32_MAX) {
+                Delay = UINT32_MAX - 1; // Max has special meaning for most platforms.
+            }
+            QuicWorkerRequestSteal(Worker);
+            QuicWorkerToggleActivityState(Worker, (uint32_t)Delay);
+            QuicWorkerResetQueueDelay(Worker);
+            BOOLEAN ReadySet =
+                QuicEventWaitWithTimeout(Worker->Ready, (uint32_t)Delay);
+            QuicWorkerToggleActivityState(Worker, ReadySet);
+
+            if (!ReadySet) {
+                QuicWorkerProcessTimers(Worker);
+            }
+
+        } else {
+            //
+            // No active timers running, so just wait for the ready event.
+            //
+            QuicWorkerRequestSteal(Worker);
+            QuicWorkerToggleActivityState(Worker, UINT32_MAX);
+            QuicWorkerResetQueueDelay(Worker);
+            QuicEventWaitForever(Worker->Ready);
+            QuicWorkerToggleActivityState(Worker, TRUE);
+        }
+    }
+
+    QuicWorkerStop(Worker);
+
     QUIC_THREAD_RETURN(QUIC_STATUS_SUCCESS);
 }
 
+//
+// Called the first time the worker is run on its datapath thread.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerStartInline(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    Worker->ThreadID = QuicCurThreadID();
+    Worker->IsActive = TRUE;
+    QuicTraceEvent(
+        WorkerStart,
+        "[wrkr][%p] Start",
+        Worker);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_EXECUTION_CONTEXT_RUN)
+BOOLEAN
+QuicWorkerRunExecutionContext(
+    _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext,
+    _In_ uint64_t TimeNow
+    )
+{
+    QUIC_WORKER* Worker = (QUIC_WORKER*)ExecutionContext->Context;
+    UNREFERENCED_PARAMETER(TimeNow);
+
+    if (Worker == NULL) {
+        //
+        // The worker was already stopped and cleaned up on this thread.
+        //
+        QUIC_FREE(ExecutionContext, QUIC_POOL_WORKER);
+        return FALSE;
+    }
+
+    if (!Worker->Enabled) {
+        QuicWorkerStop(Worker);
+        QuicEventSet(Worker->Ready); // The worker may be freed after this.
+        QUIC_FREE(ExecutionContext, QUIC_POOL_WORKER);
+        return FALSE;
+    }
+
+    if (Worker->ThreadID == 0) {
+        QuicWorkerStartInline(Worker);
+    } else if (!Worker->IsActive) {
+        QuicWorkerToggleActivityState(Worker, TRUE);
+    }
+
+    for (uint32_t i = 0; i < QUIC_WORKER_INLINE_MAX_LOOPS; ++i) {
+        uint64_t Delay;
+        if (!QuicWorkerLoop(Worker, &Delay)) {
+            //
+            // Nothing left to do, so let the datapath thread wait for the next
+            // receive, wake or timer.
+            //
+            QuicWorkerRequestSteal(Worker);
+            QuicWorkerToggleActivityState(
+                Worker, Delay >= (uint64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)Delay);
+            QuicWorkerResetQueueDelay(Worker);
+            ExecutionContext->NextTimeUs =
+                Delay == UINT64_MAX ? UINT64_MAX : QuicTimeUs64() + MS_TO_US(Delay);
+            return TRUE;
+        }
+    }
+
+    //
+    // There's more work to do, but yield to the datapath first.
+    //
+    ExecutionContext->Ready = TRUE;
+    return TRUE;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerWaitForOperation(
+    _In_ QUIC_WORKER* Worker,
+    _In_ QUIC_EVENT* Completed
+    )
+{
+    if (!Worker->InlineExecution ||
+        !QuicDataPathIsExecutionContextThread(Worker->ExecutionContext)) {
+        QuicEventWaitForever(*Completed);
+        return;
+    }
+
+    //
+    // The worker runs on this datapath thread, which is busy with this call,
+    // so the worker would never get to the operation. Run it here instead,
+    // until it has.
+    //
+    if (Worker->ThreadID == 0) {
+        QuicWorkerStartInline(Worker);
+    }
+    while (!QuicEventWaitWithTimeout(*Completed, 0)) {
+        uint64_t Delay;
+        if (!QuicWorkerLoop(Worker, &Delay)) {
+            //
+            // The operation is held up by something else, such as TLS
+            // processing on the TLS pool, which queues the connection again
+            // once done.
+            //
+            (void)QuicEventWaitWithTimeout(*Completed, 1);
+        }
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicWorkerPoolInitialize(
     _In_opt_ const void* Owner,
     _In_ uint16_t ThreadFlags,
+    _In_ BOOLEAN InlineExecution,
     _In_ uint16_t WorkerCount,
     _Out_ QUIC_WORKER_POOL** NewWorkerPool
     )
@@ -718,7 +1297,14 @@ QuicWorkerPoolInitialize(
     //
 
     for (uint16_t i = 0; i < WorkerCount; i++) {
-        Status = QuicWorkerInitialize(Owner, ThreadFlags, i, &WorkerPool->Workers[i]);
+        WorkerPool->Workers[i].WorkerPool = WorkerPool;
+        Status =
+            QuicWorkerInitialize(
+                Owner,
+                ThreadFlags,
+                InlineExecution,
+                i,
+                &WorkerPool->Workers[i]);
         if (QUIC_FAILED(Status)) {
             for (uint16_t j = 0; j < i; j++) {
                 QuicWorkerUninitialize(&WorkerPool->Workers[j]);
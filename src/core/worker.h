@@ -20,6 +20,12 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     //
     BOOLEAN IsActive;
 
+    //
+    // TRUE if the worker is run by a datapath thread, through ExecutionContext,
+    // instead of by a thread of its own.
+    //
+    BOOLEAN InlineExecution;
+
     //
     // The worker's ideal processor.
     //
@@ -35,13 +41,42 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     //
     uint32_t AverageQueueDelay;
 
+    //
+    // The worker pool this worker belongs to.
+    //
+    QUIC_WORKER_POOL* WorkerPool;
+
+    //
+    // One more than the pool index of an idle worker that asked to take one of
+    // this worker's queued connections, or zero.
+    //
+    short StealRequest;
+
+    //
+    // Load accounting for rebalancing. Load is the percent of the last full
+    // interval spent processing connections, and is read by the other workers
+    // without synchronization.
+    //
+    uint32_t LoadIntervalId;
+    uint32_t LoadIntervalStart;     // QuicTimeUs32
+    uint32_t LoadIntervalBusyTime;  // Microseconds
+    uint32_t Load;
+
+    //
+    // The less loaded worker to migrate a heavy connection to, if any. Only set
+    // for (at most) a single migration per interval.
+    //
+    QUIC_WORKER* RebalanceWorker;
+    uint32_t RebalanceMaxConnLoad;
+
     //
     // Timers for the worker's connections.
     //
     QUIC_TIMER_WHEEL TimerWheel;
 
     //
-    // An event to kick the thread.
+    // An event to kick the thread. For inline execution, it's instead set once
+    // the worker has stopped.
     //
     QUIC_EVENT Ready;
 
@@ -50,6 +85,13 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     //
     QUIC_THREAD Thread;
 
+    //
+    // The datapath execution context, for inline execution. Allocated separately
+    // so that it can outlive the worker, if the worker is cleaned up on the
+    // datapath thread that runs it.
+    //
+    QUIC_EXECUTION_CONTEXT* ExecutionContext;
+
     //
     // Serializes access to the connection and operation lists.
     //
@@ -70,6 +112,7 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     QUIC_POOL StreamPool; // QUIC_STREAM
     QUIC_POOL DefaultReceiveBufferPool; // QUIC_DEFAULT_STREAM_RECV_BUFFER_SIZE
     QUIC_POOL SendRequestPool; // QUIC_SEND_REQUEST
+    QUIC_POOL SendBufferSlabPool; // QUIC_SEND_BUFFER_SLAB_SIZE
     QUIC_SENT_PACKET_POOL SentPacketPool; // QUIC_SENT_PACKET_METADATA
     QUIC_POOL ApiContextPool; // QUIC_API_CONTEXT
     QUIC_POOL StatelessContextPool; // QUIC_STATELESS_CONTEXT
@@ -122,6 +165,7 @@ QUIC_STATUS
 QuicWorkerPoolInitialize(
     _In_opt_ const void* Owner,
     _In_ uint16_t ThreadFlags,
+    _In_ BOOLEAN InlineExecution,
     _In_ uint16_t WorkerCount,
     _Out_ QUIC_WORKER_POOL** WorkerPool
     );
@@ -174,6 +218,18 @@ QuicWorkerQueueConnection(
     _In_ QUIC_CONNECTION* Connection
     );
 
+//
+// Waits for an operation, queued to one of the worker's connections by a
+// blocking API call, to be processed. If the worker runs on the current
+// (datapath) thread, the worker is run here until then.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerWaitForOperation(
+    _In_ QUIC_WORKER* Worker,
+    _In_ QUIC_EVENT* Completed
+    );
+
 //
 // Queues the operation onto the worker, and kicks the worker thread if
 // necessary.
@@ -77,6 +77,11 @@ typedef enum QUIC_EXECUTION_PROFILE {
     QUIC_EXECUTION_PROFILE_TYPE_REAL_TIME
 } QUIC_EXECUTION_PROFILE;
 
+typedef enum QUIC_EXECUTION_MODE {
+    QUIC_EXECUTION_MODE_WORKER_THREADS,         // Default
+    QUIC_EXECUTION_MODE_DATAPATH_INLINE         // Workers run on the datapath threads
+} QUIC_EXECUTION_MODE;
+
 typedef enum QUIC_LOAD_BALANCING_MODE {
     QUIC_LOAD_BALANCING_DISABLED,               // Default
     QUIC_LOAD_BALANCING_SERVER_ID_IP            // Encodes IP address in Server ID
@@ -120,6 +125,12 @@ typedef enum QUIC_SERVER_RESUMPTION_LEVEL {
     QUIC_SERVER_RESUME_AND_ZERORTT
 } QUIC_SERVER_RESUMPTION_LEVEL;
 
+typedef enum QUIC_CONGESTION_CONTROL_ALGORITHM {
+    QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC,
+    QUIC_CONGESTION_CONTROL_ALGORITHM_BBR,
+    QUIC_CONGESTION_CONTROL_ALGORITHM_MAX
+} QUIC_CONGESTION_CONTROL_ALGORITHM;
+
 typedef enum QUIC_SEND_RESUMPTION_FLAGS {
     QUIC_SEND_RESUMPTION_FLAG_NONE          = 0x0000,
     QUIC_SEND_RESUMPTION_FLAG_FINAL         = 0x0001    // Free TLS state after sending this ticket.
@@ -133,6 +144,20 @@ typedef enum QUIC_STREAM_SCHEDULING_SCHEME {
     QUIC_STREAM_SCHEDULING_SCHEME_COUNT                     // The number of stream scheduling schemes.
 } QUIC_STREAM_SCHEDULING_SCHEME;
 
+#define QUIC_STREAM_PRIORITY_URGENCY_MAX        7   // Least urgent.
+#define QUIC_STREAM_PRIORITY_URGENCY_DEFAULT    3
+
+//
+// Send priority of a stream, modeled after the HTTP extensible priorities
+// (RFC 9218). Streams with a lower urgency value are always served first.
+// Among streams of the same urgency, incremental streams share the bandwidth
+// round robin, while non-incremental streams are sent one after the other.
+//
+typedef struct QUIC_STREAM_PRIORITY {
+    uint8_t Urgency;        // 0 (most urgent) to QUIC_STREAM_PRIORITY_URGENCY_MAX
+    BOOLEAN Incremental;
+} QUIC_STREAM_PRIORITY;
+
 typedef enum QUIC_STREAM_OPEN_FLAGS {
     QUIC_STREAM_OPEN_FLAG_NONE              = 0x0000,
     QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL    = 0x0001,   // Indicates the stream is unidirectional.
@@ -396,7 +421,13 @@ typedef struct QUIC_SETTINGS {
             uint64_t MigrationEnabled           : 1;
             uint64_t DatagramReceiveEnabled     : 1;
             uint64_t ServerResumptionLevel      : 1;
-            uint64_t RESERVED                   : 38;
+            uint64_t EcnEnabled                 : 1;
+            uint64_t CongestionControlAlgorithm : 1;
+            uint64_t AsyncHandshakeEnabled      : 1;
+            uint64_t AckFrequencyEnabled        : 1;
+            uint64_t TxTimePacingEnabled        : 1;
+            uint64_t MaximumMtu                 : 1;
+            uint64_t RESERVED                   : 32;
         } IsSet;
     };
 
@@ -420,13 +451,18 @@ typedef struct QUIC_SETTINGS {
     uint16_t PeerUnidiStreamCount;
     uint16_t RetryMemoryLimit;              // Global only
     uint16_t LoadBalancingMode;             // Global only
+    uint16_t CongestionControlAlgorithm;    // QUIC_CONGESTION_CONTROL_ALGORITHM
+    uint16_t MaximumMtu;
     uint8_t MaxOperationsPerDrain;
     uint8_t SendBufferingEnabled    : 1;
     uint8_t PacingEnabled           : 1;
     uint8_t MigrationEnabled        : 1;
     uint8_t DatagramReceiveEnabled  : 1;
     uint8_t ServerResumptionLevel   : 2;    // QUIC_SERVER_RESUMPTION_LEVEL
-    uint8_t RESERVED                : 2;
+    uint8_t EcnEnabled              : 1;
+    uint8_t AsyncHandshakeEnabled   : 1;
+    uint8_t AckFrequencyEnabled     : 1;
+    uint8_t TxTimePacingEnabled     : 1;
 
 } QUIC_SETTINGS;
 
@@ -484,6 +520,7 @@ typedef enum QUIC_PARAM_LEVEL {
 #define QUIC_PARAM_GLOBAL_LOAD_BALACING_MODE            2   // uint16_t - QUIC_LOAD_BALANCING_MODE
 #define QUIC_PARAM_GLOBAL_PERF_COUNTERS                 3   // uint64_t[] - Array size is QUIC_PERF_COUNTER_MAX
 #define QUIC_PARAM_GLOBAL_SETTINGS                      4   // QUIC_SETTINGS
+#define QUIC_PARAM_GLOBAL_EXECUTION_MODE                5   // uint16_t - QUIC_EXECUTION_MODE
 
 //
 // Parameters for QUIC_PARAM_LEVEL_REGISTRATION.
@@ -523,6 +560,8 @@ typedef enum QUIC_PARAM_LEVEL {
 #define QUIC_PARAM_CONN_DISABLE_1RTT_ENCRYPTION         15  // uint8_t (BOOLEAN)
 #endif
 #define QUIC_PARAM_CONN_RESUMPTION_TICKET               16  // uint8_t[]
+#define QUIC_PARAM_CONN_RECV_BUFFER_LENDING             17  // uint8_t (BOOLEAN)
+#define QUIC_PARAM_CONN_MEMORY_USAGE                    18  // uint64_t - bytes
 
 //
 // Parameters for QUIC_PARAM_LEVEL_TLS.
@@ -541,6 +580,7 @@ typedef struct QUIC_SCHANNEL_CONTEXT_ATTRIBUTE_W {
 #define QUIC_PARAM_STREAM_ID                            0   // QUIC_UINT62
 #define QUIC_PARAM_STREAM_0RTT_LENGTH                   1   // uint64_t
 #define QUIC_PARAM_STREAM_IDEAL_SEND_BUFFER_SIZE        2   // uint64_t - bytes
+#define QUIC_PARAM_STREAM_PRIORITY                      3   // QUIC_STREAM_PRIORITY
 
 typedef
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -1043,6 +1083,42 @@ QUIC_STATUS
     _In_opt_ void* ClientSendContext
     );
 
+//
+// A single send in a StreamSendBatch call.
+//
+typedef struct QUIC_STREAM_SEND_BATCH_ENTRY {
+    //
+    // The stream to send on. If NULL, a new stream is opened on the connection
+    // with OpenFlags, Handler and Context, and its handle is returned here for
+    // the app to close. A stream is only opened if the send is queued; if the
+    // entry fails, this stays NULL.
+    //
+    /* inout */ HQUIC Stream;
+    /* in */    QUIC_STREAM_OPEN_FLAGS OpenFlags;
+    /* in */    QUIC_STREAM_CALLBACK_HANDLER Handler;
+    /* in */    void* Context;
+    _Field_size_(BufferCount)
+    /* in */    const QUIC_BUFFER* Buffers;
+    /* in */    uint32_t BufferCount;
+    /* in */    QUIC_SEND_FLAGS Flags;
+    /* in */    void* ClientSendContext;
+    /* out */   QUIC_STATUS Status;
+} QUIC_STREAM_SEND_BATCH_ENTRY;
+
+//
+// Sends data on multiple streams of a connection in a single call. Each entry
+// behaves like a StreamSend call and has its own result set in Status.
+//
+typedef
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+(QUIC_API * QUIC_STREAM_SEND_BATCH_FN)(
+    _In_ _Pre_defensive_ HQUIC Connection,
+    _Inout_updates_(EntryCount) _Pre_defensive_
+        QUIC_STREAM_SEND_BATCH_ENTRY* Entries,
+    _In_ uint32_t EntryCount
+    );
+
 //
 // Completes a previously pended receive callback.
 //
@@ -1129,6 +1205,8 @@ typedef struct QUIC_API_TABLE {
 
     QUIC_DATAGRAM_SEND_FN               DatagramSend;
 
+    QUIC_STREAM_SEND_BATCH_FN           StreamSendBatch;
+
 } QUIC_API_TABLE;
 
 //
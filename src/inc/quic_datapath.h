@@ -57,15 +57,27 @@ typedef enum QUIC_ECN_TYPE {
 #define QUIC_MIN_MTU 1280
 
 //
-// The maximum IP MTU this implementation supports for QUIC.
+// The IP MTU of standard (non-jumbo) Ethernet. Datapaths that don't support
+// larger datagrams limit their bindings to this MTU.
 //
-#define QUIC_MAX_MTU 1500
+#define QUIC_ETHERNET_MTU 1500
+
+//
+// The maximum IP MTU this implementation supports for QUIC (jumbo frames).
+//
+#define QUIC_MAX_MTU 9000
+
+//
+// The buffer size that must be allocated to fit a UDP payload on a standard
+// Ethernet path.
+//
+#define MAX_UDP_PAYLOAD_LENGTH (QUIC_ETHERNET_MTU - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE)
 
 //
 // The buffer size that must be allocated to fit the maximum UDP payload we
 // support.
 //
-#define MAX_UDP_PAYLOAD_LENGTH (QUIC_MAX_MTU - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE)
+#define MAX_JUMBO_UDP_PAYLOAD_LENGTH (QUIC_MAX_MTU - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE)
 
 //
 // Helper function for calculating the length of a UDP packet, for a given
@@ -275,6 +287,8 @@ QuicDataPathUninitialize(
 #define QUIC_DATAPATH_FEATURE_RECV_SIDE_SCALING     0x0001
 #define QUIC_DATAPATH_FEATURE_RECV_COALESCING       0x0002
 #define QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION     0x0004
+#define QUIC_DATAPATH_FEATURE_EXECUTION_CONTEXTS    0x0008
+#define QUIC_DATAPATH_FEATURE_SEND_DEPARTURE_TIME   0x0010
 
 //
 // Queries the currently supported features of the datapath.
@@ -305,6 +319,90 @@ QuicDataPathResolveAddress(
     _Inout_ QUIC_ADDR* Address
     );
 
+//
+// An execution context is a unit of work (such as a QUIC worker) that is run by
+// one of the datapath's threads, in between processing receives, instead of on
+// a thread of its own. Only supported if the datapath has the
+// QUIC_DATAPATH_FEATURE_EXECUTION_CONTEXTS feature.
+//
+typedef struct QUIC_EXECUTION_CONTEXT QUIC_EXECUTION_CONTEXT;
+
+//
+// Function pointer type for running an execution context. Called when the
+// context has been woken or its NextTimeUs has been reached. Returns FALSE once
+// the context is done, after which the datapath no longer references it.
+//
+typedef
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_EXECUTION_CONTEXT_RUN)
+BOOLEAN
+(QUIC_EXECUTION_CONTEXT_RUN)(
+    _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext,
+    _In_ uint64_t TimeNow // QuicTimeUs64
+    );
+
+typedef QUIC_EXECUTION_CONTEXT_RUN *QUIC_EXECUTION_CONTEXT_RUN_HANDLER;
+
+typedef struct QUIC_EXECUTION_CONTEXT {
+
+    //
+    // Owned by the datapath.
+    //
+    QUIC_EXECUTION_CONTEXT* Next;
+    void* DatapathContext;
+
+    //
+    // Set by the owner before the context is added.
+    //
+    void* Context;
+    QUIC_EXECUTION_CONTEXT_RUN_HANDLER Run;
+
+    //
+    // The time (QuicTimeUs64) the context next needs to run, or UINT64_MAX.
+    // Only updated from the run callback.
+    //
+    uint64_t NextTimeUs;
+
+    //
+    // TRUE if the context needs to run as soon as possible.
+    //
+    BOOLEAN volatile Ready;
+
+} QUIC_EXECUTION_CONTEXT;
+
+//
+// Adds an execution context to be run by the datapath thread with the given
+// index (modulo the number of threads). The context stays on that thread until
+// its run callback returns FALSE.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicDataPathAddExecutionContext(
+    _In_ QUIC_DATAPATH* Datapath,
+    _In_ uint32_t Index,
+    _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    );
+
+//
+// Marks the execution context ready and wakes its datapath thread, if needed.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicDataPathWakeExecutionContext(
+    _In_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    );
+
+//
+// Returns TRUE if the current thread is the datapath thread that runs the
+// execution context. Anything run on that thread must never wait on the
+// context, since the context can't run until the thread gets back to it.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicDataPathIsExecutionContextThread(
+    _In_ const QUIC_EXECUTION_CONTEXT* ExecutionContext
+    );
+
 //
 // The following APIs are specific to a single UDP port abstraction.
 //
@@ -421,6 +519,21 @@ QuicDataPathBindingFreeSendDatagram(
     _In_ QUIC_BUFFER* SendDatagram
     );
 
+//
+// Sets the earliest time (QuicTimeUs64) the datagram most recently returned
+// from QuicDataPathBindingAllocSendDatagram may leave the host, so that the OS
+// paces it instead of sending it immediately. Must be called before the
+// datagram is written to, and only if the datapath has the
+// QUIC_DATAPATH_FEATURE_SEND_DEPARTURE_TIME feature.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicDataPathBindingSetSendDepartureTime(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ QUIC_BUFFER* SendDatagram,
+    _In_ uint64_t DepartureTime
+    );
+
 //
 // Returns whether the send context buffer limit has been reached.
 //
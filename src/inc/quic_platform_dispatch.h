@@ -112,6 +112,26 @@ QUIC_STATUS
     _Inout_ QUIC_ADDR* Address
     );
 
+typedef
+QUIC_STATUS
+(*QUIC_DATAPATH_ADD_EXECUTION_CONTEXT)(
+    _In_ QUIC_DATAPATH* Datapath,
+    _In_ uint32_t Index,
+    _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    );
+
+typedef
+void
+(*QUIC_DATAPATH_WAKE_EXECUTION_CONTEXT)(
+    _In_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    );
+
+typedef
+BOOLEAN
+(*QUIC_DATAPATH_IS_EXECUTION_CONTEXT_THREAD)(
+    _In_ const QUIC_EXECUTION_CONTEXT* ExecutionContext
+    );
+
 typedef
 QUIC_STATUS
 (*QUIC_DATAPATH_BINDING_CREATE)(
@@ -181,6 +201,14 @@ void
     _In_ QUIC_BUFFER* SendBuffer
     );
 
+typedef
+void
+(*QUIC_DATAPATH_BINDING_SET_SEND_DEPARTURE_TIME)(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ QUIC_BUFFER* SendBuffer,
+    _In_ uint64_t DepartureTime
+    );
+
 typedef
 BOOLEAN
 (*QUIC_DATAPATH_BINDING_IS_SEND_CONTEXT_FULL)(
@@ -240,6 +268,9 @@ typedef struct QUIC_PLATFORM_DISPATCH {
     QUIC_DATAPATH_RECVBUFFER_TO_RECVCONTEXT DatapathRecvPacketToRecvContext;
     QUIC_DATAPATH_IS_PADDING_PREFERRED DatapathIsPaddingPreferred;
     QUIC_DATAPATH_RESOLVE_ADDRESS DatapathResolveAddress;
+    QUIC_DATAPATH_ADD_EXECUTION_CONTEXT DatapathAddExecutionContext;
+    QUIC_DATAPATH_WAKE_EXECUTION_CONTEXT DatapathWakeExecutionContext;
+    QUIC_DATAPATH_IS_EXECUTION_CONTEXT_THREAD DatapathIsExecutionContextThread;
     QUIC_DATAPATH_BINDING_CREATE DatapathBindingCreate;
     QUIC_DATAPATH_BINDING_DELETE DatapathBindingDelete;
     QUIC_DATPATH_BINDING_GET_LOCAL_MTU DatapathBindingGetLocalMtu;
@@ -251,6 +282,7 @@ typedef struct QUIC_PLATFORM_DISPATCH {
     QUIC_DATAPATH_BINDING_IS_SEND_CONTEXT_FULL DatapathBindingIsSendContextFull;
     QUIC_DATAPATH_BINDING_ALLOC_SEND_BUFFER DatapathBindingAllocSendBuffer;
     QUIC_DATAPATH_BINDING_FREE_SEND_BUFFER DatapathBindingFreeSendBuffer;
+    QUIC_DATAPATH_BINDING_SET_SEND_DEPARTURE_TIME DatapathBindingSetSendDepartureTime;
     QUIC_DATAPATH_BINDING_SEND DatapathBindingSend;
     QUIC_DATAPATH_BINDING_SET_PARAM DatapathBindingSetParam;
     QUIC_DATAPATH_BINDING_GET_PARAM DatapathBindingGetParam;
@@ -40,6 +40,7 @@ Environment:
 #include <msquic_linux.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
@@ -93,6 +94,12 @@ QuicPlatformUninitialize(
 
 #define UNREFERENCED_PARAMETER(P) (void)(P)
 
+#define ALIGN_DOWN(length, type) \
+    ((size_t)(length) & ~(sizeof(type) - 1))
+
+#define ALIGN_UP(length, type) \
+    (ALIGN_DOWN(((size_t)(length) + sizeof(type) - 1), type))
+
 #define QuicNetByteSwapShort(x) htons((x))
 
 #define SIZEOF_STRUCT_MEMBER(StructType, StructMember) sizeof(((StructType *)0)->StructMember)
@@ -175,6 +182,50 @@ InterlockedIncrement64(
     return __sync_add_and_fetch(Addend, (int64_t)1);
 }
 
+inline
+long
+ReadAcquire(
+    _In_ long const volatile *Source
+    )
+{
+    return __atomic_load_n(Source, __ATOMIC_ACQUIRE);
+}
+
+inline
+void
+WriteRelease(
+    _Out_ long volatile *Destination,
+    _In_ long Value
+    )
+{
+    __atomic_store_n(Destination, Value, __ATOMIC_RELEASE);
+}
+
+inline
+void*
+ReadPointerAcquire(
+    _In_ void* const volatile *Source
+    )
+{
+    return __atomic_load_n(Source, __ATOMIC_ACQUIRE);
+}
+
+inline
+void
+WritePointerRelease(
+    _Out_ void* volatile *Destination,
+    _In_ void* Value
+    )
+{
+    __atomic_store_n(Destination, Value, __ATOMIC_RELEASE);
+}
+
+//
+// Used in spin loops. Gives up the processor, since the thread being waited
+// on may have been preempted.
+//
+#define YieldProcessor() sched_yield()
+
 //
 // Assertion interfaces.
 //
@@ -251,6 +302,58 @@ QuicFree(
 #define QUIC_ALLOC_NONPAGED(Size, Tag) QuicAlloc(Size, Tag)
 #define QUIC_FREE(Mem, Tag) QuicFree((void*)Mem, Tag)
 
+#define QUIC_POOL_MAXIMUM_DEPTH   256 // Copied from EX_MAXIMUM_LOOKASIDE_DEPTH_BASE
+
+//
+// The number of free entries cached per processor, in front of the global
+// depot.
+//
+#define QUIC_POOL_CPU_CACHE_DEPTH 6
+
+//
+// The maximum number of per processor caches a pool has. Processors beyond
+// this share caches. Pools are generally already per processor in the core, so
+// this keeps the free memory a pool retains from growing with the processor
+// count: the caches plus the depot never hold more than QUIC_POOL_MAXIMUM_DEPTH
+// entries, just like a Windows lookaside list.
+//
+#define QUIC_POOL_MAX_CPU_CACHE_COUNT 16
+
+//
+// The number of free entries the global depot can hold.
+//
+#define QUIC_POOL_DEPOT_DEPTH (QUIC_POOL_MAXIMUM_DEPTH / 2)
+
+#define QUIC_CACHE_LINE_SIZE 64
+
+//
+// A per processor cache of free pool entries. Each slot is either NULL or
+// holds one free entry, and is only ever accessed with atomic exchanges so
+// that a thread migrating between processors is harmless.
+//
+
+typedef struct QUIC_POOL_CPU_CACHE {
+
+    //
+    // Free entries cached on this processor.
+    //
+
+    void* Entries[QUIC_POOL_CPU_CACHE_DEPTH];
+
+} __attribute__((aligned(QUIC_CACHE_LINE_SIZE))) QUIC_POOL_CPU_CACHE;
+
+//
+// A cell in the lock-free global depot of free pool entries.
+//
+
+typedef struct QUIC_POOL_DEPOT_CELL {
+
+    size_t Sequence;
+
+    void* Entry;
+
+} QUIC_POOL_DEPOT_CELL;
+
 //
 // Represents a QUIC memory pool used for fixed sized allocations.
 //
@@ -258,23 +361,34 @@ QuicFree(
 typedef struct QUIC_POOL {
 
     //
-    // List of free entries.
+    // Per processor caches of free entries. NULL if the pool couldn't allocate
+    // its caches, in which case all allocations go to the system allocator.
     //
 
-    QUIC_SINGLE_LIST_ENTRY ListHead;
+    QUIC_POOL_CPU_CACHE* CpuCaches;
 
     //
-    // Number of free entries in the list.
+    // Number of per processor caches.
     //
 
-    uint16_t ListDepth;
+    uint32_t CpuCacheCount;
+
+    //
+    // Bounded lock-free queue (of QUIC_POOL_DEPOT_DEPTH cells) holding free
+    // entries that didn't fit in a per processor cache.
+    //
+
+    QUIC_POOL_DEPOT_CELL* Depot;
+
+    size_t DepotEnqueuePos;
+
+    size_t DepotDequeuePos;
 
     //
-    // Lock to synchronize access to the List.
-    // LINUX_TODO: Check how to make this lock free?
+    // The raw allocation backing CpuCaches and Depot.
     //
 
-    pthread_mutex_t Lock;
+    void* Allocation;
 
     //
     // Size of entries.
@@ -290,8 +404,6 @@ typedef struct QUIC_POOL {
 
 } QUIC_POOL;
 
-#define QUIC_POOL_MAXIMUM_DEPTH   256 // Copied from EX_MAXIMUM_LOOKASIDE_DEPTH_BASE
-
 void
 QuicPoolInitialize(
     _In_ BOOLEAN IsPaged,
@@ -408,6 +520,16 @@ typedef QUIC_RW_LOCK QUIC_DISPATCH_RW_LOCK;
 
 #define QuicDispatchRwLockReleaseExclusive QuicRwLockReleaseExclusive
 
+//
+// IRQL interfaces. There are no IRQLs in user mode.
+//
+
+typedef uint8_t QUIC_IRQL;
+
+#define QuicIrqlRaiseToDispatch(PrevIrql) (*(PrevIrql) = 0)
+
+#define QuicIrqlLower(PrevIrql) UNREFERENCED_PARAMETER(PrevIrql)
+
 //
 // Reference Count Interface
 //
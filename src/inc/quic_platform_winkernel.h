@@ -375,6 +375,16 @@ typedef struct QUIC_DISPATCH_RW_LOCK {
 #define QuicDispatchRwLockReleaseShared(Lock) ExReleaseSpinLockShared(&(Lock)->SpinLock, (Lock)->PrevIrql)
 #define QuicDispatchRwLockReleaseExclusive(Lock) ExReleaseSpinLockExclusive(&(Lock)->SpinLock, (Lock)->PrevIrql)
 
+//
+// IRQL interfaces.
+//
+
+typedef KIRQL QUIC_IRQL;
+
+#define QuicIrqlRaiseToDispatch(PrevIrql) KeRaiseIrql(DISPATCH_LEVEL, PrevIrql)
+
+#define QuicIrqlLower(PrevIrql) KeLowerIrql(PrevIrql)
+
 //
 // Reference Count Interface
 //
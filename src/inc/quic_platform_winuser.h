@@ -397,6 +397,16 @@ typedef SRWLOCK QUIC_DISPATCH_RW_LOCK;
 #define QuicDispatchRwLockReleaseShared(Lock) ReleaseSRWLockShared(Lock)
 #define QuicDispatchRwLockReleaseExclusive(Lock) ReleaseSRWLockExclusive(Lock)
 
+//
+// IRQL interfaces. There are no IRQLs in user mode.
+//
+
+typedef UINT8 QUIC_IRQL;
+
+#define QuicIrqlRaiseToDispatch(PrevIrql) (*(PrevIrql) = 0)
+
+#define QuicIrqlLower(PrevIrql) UNREFERENCED_PARAMETER(PrevIrql)
+
 //
 // Reference Count Interface
 //
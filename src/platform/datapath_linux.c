@@ -20,6 +20,8 @@ Environment:
 #include <inttypes.h>
 #include <linux/in6.h>
 #include <arpa/inet.h>
+#include <netinet/udp.h>
+#include <linux/filter.h>
 #include "quic_platform_dispatch.h"
 #ifdef QUIC_CLOG
 #include "datapath_linux.c.clog.h"
@@ -29,12 +31,85 @@ QUIC_STATIC_ASSERT((SIZEOF_STRUCT_MEMBER(QUIC_BUFFER, Length) <= sizeof(size_t))
 QUIC_STATIC_ASSERT((SIZEOF_STRUCT_MEMBER(QUIC_BUFFER, Buffer) == sizeof(void*)), "(sizeof(QUIC_BUFFER.Buffer) == sizeof(void*) must be TRUE.");
 
 //
-// TODO: Support batching.
+// The maximum number of UDP datagrams that can be sent with one call.
 //
-#define QUIC_MAX_BATCH_SEND 1
+#define QUIC_MAX_BATCH_SEND 32
 
 //
-// A receive block to receive a UDP packet over the sockets.
+// The maximum number of UDP messages that can be received with one call.
+//
+#define QUIC_MAX_BATCH_RECV 16
+
+//
+// The maximum number of UDP messages that can be received with one call when
+// receive coalescing is enabled. Each message may contain many datagrams.
+//
+#define QUIC_MAX_BATCH_RECV_COALESCED 4
+
+//
+// Older headers may not define the UDP GSO/GRO socket options.
+//
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+//
+// Older headers may not define the departure time (EDT) socket option and
+// its configuration structure.
+//
+#ifndef SO_TXTIME
+#define SO_TXTIME 61
+#define SCM_TXTIME SO_TXTIME
+#endif
+
+typedef struct QUIC_SOCK_TXTIME {
+    clockid_t ClockId;
+    uint32_t Flags;
+} QUIC_SOCK_TXTIME;
+
+//
+// Segments of a GSO send share the departure time of the first segment, so a
+// datagram that should leave more than this many microseconds later than that
+// starts a new send buffer instead.
+//
+#define QUIC_GSO_DEPARTURE_TIME_SLACK_US 250
+
+//
+// Older headers may not define the reuseport steering socket option.
+//
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+//
+// The maximum UDP receive coalescing payload.
+//
+#define MAX_URO_PAYLOAD_LENGTH (UINT16_MAX - QUIC_UDP_HEADER_SIZE)
+
+//
+// The maximum number of UDP datagrams the kernel coalesces into one receive.
+//
+#define URO_MAX_DATAGRAMS_PER_INDICATION 64
+
+//
+// The maximum number of segments the kernel will split a single GSO send into.
+//
+#define QUIC_MAX_GSO_SEGMENTS 64
+
+//
+// The maximum single buffer size for sending coalesced payloads. It must fit
+// in a single (IPv4) UDP datagram, including the IP and UDP headers.
+//
+#define QUIC_LARGE_SEND_BUFFER_SIZE \
+    (UINT16_MAX - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE)
+
+//
+// A receive block to receive a UDP packet over the sockets. When receive
+// coalescing (GRO) is enabled, a single receive block may contain multiple
+// UDP datagrams, all sharing the same 4-tuple.
 //
 typedef struct QUIC_DATAPATH_RECV_BLOCK {
     //
@@ -43,9 +118,10 @@ typedef struct QUIC_DATAPATH_RECV_BLOCK {
     QUIC_POOL* OwningPool;
 
     //
-    // The recv buffer used by MsQuic.
+    // The number of datagrams (indicated to MsQuic) that still reference this
+    // recv block.
     //
-    QUIC_RECV_DATAGRAM RecvPacket;
+    long ReferenceCount;
 
     //
     // Represents the address (source and destination) information of the
@@ -53,18 +129,31 @@ typedef struct QUIC_DATAPATH_RECV_BLOCK {
     //
     QUIC_TUPLE Tuple;
 
-    //
-    // Buffer that actually stores the UDP payload.
-    //
-    uint8_t Buffer[MAX_UDP_PAYLOAD_LENGTH];
-
     //
     // This follows the recv block.
     //
+    // QUIC_RECV_DATAGRAM RecvDatagram;
+    // QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT DatagramContext;
     // QUIC_RECV_PACKET RecvContext;
+    //
+    // repeated once per datagram (Datapath->DatagramStride bytes apart) and
+    // then the buffer that actually stores the UDP payload, at
+    // Datapath->RecvPayloadOffset.
+    //
 
 } QUIC_DATAPATH_RECV_BLOCK;
 
+//
+// Per datagram context in a receive block.
+//
+typedef struct QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT {
+    //
+    // The recv block owning this datagram.
+    //
+    QUIC_DATAPATH_RECV_BLOCK* RecvBlock;
+
+} QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT;
+
 //
 // Send context.
 //
@@ -100,6 +189,11 @@ typedef struct QUIC_DATAPATH_SEND_CONTEXT {
     //
     QUIC_ECN_TYPE ECN;
 
+    //
+    // The send segmentation size; zero if segmentation is not performed.
+    //
+    uint16_t SegmentSize;
+
     //
     // The proc context owning this send context.
     //
@@ -108,11 +202,14 @@ typedef struct QUIC_DATAPATH_SEND_CONTEXT {
     //
     // BufferCount - The buffer count in use.
     //
-    // CurrentIndex - The current index of the Buffers to be sent.
+    // CurrentIndex - The current index of the Buffers to be sent. Buffers
+    // before this index have already been handed to the socket (i.e. by a
+    // previous, partially completed call to sendmmsg).
     //
     // Buffers - Send buffers.
     //
-    // Iovs - IO vectors used for doing sends on the socket.
+    // Iovs - IO vectors used for doing sends on the socket. Each buffer is
+    // sent as its own datagram, described by its own IO vector.
     //
     // TODO: Better way to reconcile layout difference
     // between QUIC_BUFFER and struct iovec?
@@ -122,6 +219,27 @@ typedef struct QUIC_DATAPATH_SEND_CONTEXT {
     QUIC_BUFFER Buffers[QUIC_MAX_BATCH_SEND];
     struct iovec Iovs[QUIC_MAX_BATCH_SEND];
 
+    //
+    // The earliest departure time (QuicTimeUs64) of each buffer, passed to the
+    // kernel with SCM_TXTIME. Zero to send as soon as possible.
+    //
+    uint64_t DepartureTimes[QUIC_MAX_BATCH_SEND];
+
+    //
+    // The pool each buffer was allocated from. Unsegmented datagrams larger
+    // than a standard Ethernet payload (jumbo frames) come from the large
+    // buffer pool.
+    //
+    QUIC_POOL* BufferPools[QUIC_MAX_BATCH_SEND];
+
+    //
+    // The QUIC_BUFFER returned to the client for segmented sends. When
+    // segmentation is used, each entry in Buffers is a large backing buffer
+    // containing multiple equal-sized segments, and this buffer points to the
+    // current segment being written by the client.
+    //
+    QUIC_BUFFER ClientBuffer;
+
 } QUIC_DATAPATH_SEND_CONTEXT;
 
 //
@@ -140,16 +258,9 @@ typedef struct QUIC_SOCKET_CONTEXT {
     int SocketFd;
 
     //
-    // The cleanup event FD used by this socket context.
-    //
-    int CleanupFd;
-
-    //
-    // Used to register different event FD with epoll.
+    // Link in the processor context's list of pending cleanups.
     //
-#define QUIC_SOCK_EVENT_CLEANUP 0
-#define QUIC_SOCK_EVENT_SOCKET  1
-    uint8_t EventContexts[2];
+    QUIC_LIST_ENTRY CleanupLink;
 
     //
     // Indicates if sends are waiting for the socket to be write ready.
@@ -157,26 +268,27 @@ typedef struct QUIC_SOCKET_CONTEXT {
     BOOLEAN SendWaiting;
 
     //
-    // The I/O vector for receive datagrams.
+    // The I/O vectors for receive datagrams.
     //
-    struct iovec RecvIov;
+    struct iovec RecvIovs[QUIC_MAX_BATCH_RECV];
 
     //
-    // The control buffer used in RecvMsgHdr.
+    // The control buffers used in RecvMsgHdrs.
     //
-    char RecvMsgControl[CMSG_SPACE(sizeof(struct in6_pktinfo)) +
-                        CMSG_SPACE(sizeof(struct in_pktinfo)) +
-                        2 * CMSG_SPACE(sizeof(int))];
+    char RecvMsgControl[QUIC_MAX_BATCH_RECV][
+        CMSG_SPACE(sizeof(struct in6_pktinfo)) +
+        CMSG_SPACE(sizeof(struct in_pktinfo)) +
+        3 * CMSG_SPACE(sizeof(int))];
 
     //
-    // The buffer used to receive msg headers on socket.
+    // The buffers used to receive msg headers on socket.
     //
-    struct msghdr RecvMsgHdr;
+    struct mmsghdr RecvMsgHdrs[QUIC_MAX_BATCH_RECV];
 
     //
-    // The receive block currently being used for receives on this socket.
+    // The receive blocks currently being used for receives on this socket.
     //
-    QUIC_DATAPATH_RECV_BLOCK* CurrentRecvBlock;
+    QUIC_DATAPATH_RECV_BLOCK* CurrentRecvBlocks[QUIC_MAX_BATCH_RECV];
 
     //
     // The head of list containg all pending sends on this socket.
@@ -225,6 +337,11 @@ typedef struct QUIC_DATAPATH_BINDING {
     //
     BOOLEAN Shutdown : 1;
 
+    //
+    // Indicates not all of the listener's sockets joined the reuseport group.
+    //
+    BOOLEAN ReusePortFailed : 1;
+
     //
     // The MTU for this binding.
     //
@@ -267,6 +384,33 @@ typedef struct QUIC_DATAPATH_PROC_CONTEXT {
     //
     QUIC_THREAD EpollWaitThread;
 
+    //
+    // The identifier of the epoll wait thread.
+    //
+    QUIC_THREAD_ID ThreadID;
+
+    //
+    // Serializes access to the pending lists, which are filled by other
+    // threads and drained by the epoll wait thread.
+    //
+    QUIC_LOCK PendingLock;
+
+    //
+    // Socket contexts to be cleaned up by the epoll wait thread.
+    //
+    QUIC_LIST_ENTRY PendingCleanups;
+
+    //
+    // Execution contexts newly added to the epoll wait thread.
+    //
+    QUIC_EXECUTION_CONTEXT* PendingExecutionContexts;
+
+    //
+    // Execution contexts run by the epoll wait thread. Only accessed by the
+    // thread itself.
+    //
+    QUIC_EXECUTION_CONTEXT* ExecutionContexts;
+
     //
     // Pool of receive packet contexts and buffers to be shared by all sockets
     // on this core.
@@ -278,6 +422,12 @@ typedef struct QUIC_DATAPATH_PROC_CONTEXT {
     //
     QUIC_POOL SendBufferPool;
 
+    //
+    // Pool of large segmented send buffers to be shared by all sockets on this
+    // core.
+    //
+    QUIC_POOL LargeSendBufferPool;
+
     //
     // Pool of send contexts to be shared by all sockets on this core.
     //
@@ -297,10 +447,36 @@ typedef struct QUIC_DATAPATH {
 
     //
     // The max send batch size.
-    // TODO: See how send batching can be enabled.
     //
     uint8_t MaxSendBatchSize;
 
+    //
+    // Set of supported features.
+    //
+    uint32_t Features;
+
+    //
+    // The number of messages to receive with one call.
+    //
+    uint32_t RecvBatchSize;
+
+    //
+    // The size of each receive datagram array element, including client context,
+    // internal context, and padding.
+    //
+    uint32_t DatagramStride;
+
+    //
+    // The offset of the receive payload buffer from the start of the receive
+    // block.
+    //
+    uint32_t RecvPayloadOffset;
+
+    //
+    // The maximum receive payload length of a single receive block.
+    //
+    uint32_t RecvPayloadLength;
+
     //
     // A reference rundown on the datapath binding.
     //
@@ -355,9 +531,11 @@ QuicProcessorContextInitialize(
     QUIC_DBG_ASSERT(Datapath != NULL);
 
     RecvPacketLength =
-        sizeof(QUIC_DATAPATH_RECV_BLOCK) + Datapath->ClientRecvContextLength;
+        Datapath->RecvPayloadOffset + Datapath->RecvPayloadLength;
 
     ProcContext->Index = Index;
+    QuicLockInitialize(&ProcContext->PendingLock);
+    QuicListInitializeHead(&ProcContext->PendingCleanups);
     QuicPoolInitialize(
         TRUE,
         RecvPacketLength,
@@ -368,6 +546,11 @@ QuicProcessorContextInitialize(
         MAX_UDP_PAYLOAD_LENGTH,
         QUIC_POOL_DATA,
         &ProcContext->SendBufferPool);
+    QuicPoolInitialize(
+        TRUE,
+        QUIC_LARGE_SEND_BUFFER_SIZE,
+        QUIC_POOL_DATA,
+        &ProcContext->LargeSendBufferPool);
     QuicPoolInitialize(
         TRUE,
         sizeof(QUIC_DATAPATH_SEND_CONTEXT),
@@ -456,8 +639,10 @@ Exit:
         if (EpollFd != INVALID_SOCKET_FD) {
             close(EpollFd);
         }
+        QuicLockUninitialize(&ProcContext->PendingLock);
         QuicPoolUninitialize(&ProcContext->RecvBlockPool);
         QuicPoolUninitialize(&ProcContext->SendBufferPool);
+        QuicPoolUninitialize(&ProcContext->LargeSendBufferPool);
         QuicPoolUninitialize(&ProcContext->SendContextPool);
     }
 
@@ -474,15 +659,111 @@ QuicProcessorContextUninitialize(
     QuicThreadWait(&ProcContext->EpollWaitThread);
     QuicThreadDelete(&ProcContext->EpollWaitThread);
 
+    QUIC_DBG_ASSERT(QuicListIsEmpty(&ProcContext->PendingCleanups));
+    QUIC_DBG_ASSERT(ProcContext->PendingExecutionContexts == NULL);
+    QUIC_DBG_ASSERT(ProcContext->ExecutionContexts == NULL);
+
     epoll_ctl(ProcContext->EpollFd, EPOLL_CTL_DEL, ProcContext->EventFd, NULL);
     close(ProcContext->EventFd);
     close(ProcContext->EpollFd);
 
+    QuicLockUninitialize(&ProcContext->PendingLock);
     QuicPoolUninitialize(&ProcContext->RecvBlockPool);
     QuicPoolUninitialize(&ProcContext->SendBufferPool);
+    QuicPoolUninitialize(&ProcContext->LargeSendBufferPool);
     QuicPoolUninitialize(&ProcContext->SendContextPool);
 }
 
+void
+QuicDataPathQuerySockoptSupport(
+    _Inout_ QUIC_DATAPATH* Datapath
+    )
+{
+    int Result;
+    int Option;
+    socklen_t OptionLength;
+
+    int UdpSocket = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+    if (UdpSocket == INVALID_SOCKET_FD) {
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            errno,
+            "UDP sockopt helper socket failed to open");
+        return;
+    }
+
+    //
+    // Send segmentation (GSO) is supported if the kernel knows the socket
+    // option (Linux 4.18+).
+    //
+    Option = 0;
+    OptionLength = sizeof(Option);
+    Result =
+        getsockopt(
+            UdpSocket,
+            SOL_UDP,
+            UDP_SEGMENT,
+            (void*)&Option,
+            &OptionLength);
+    if (Result == SOCKET_ERROR) {
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            errno,
+            "getsockopt(UDP_SEGMENT) failed");
+    } else {
+        Datapath->Features |= QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION;
+    }
+
+    //
+    // Receive coalescing (GRO) is supported if the kernel accepts the socket
+    // option (Linux 5.0+).
+    //
+    Option = TRUE;
+    Result =
+        setsockopt(
+            UdpSocket,
+            SOL_UDP,
+            UDP_GRO,
+            (const void*)&Option,
+            sizeof(Option));
+    if (Result == SOCKET_ERROR) {
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            errno,
+            "setsockopt(UDP_GRO) failed");
+    } else {
+        Datapath->Features |= QUIC_DATAPATH_FEATURE_RECV_COALESCING;
+    }
+
+    //
+    // Departure times are supported if the kernel accepts the socket option
+    // (Linux 4.19+). The times are only honored if the interface uses a qdisc
+    // that implements them (i.e. fq); otherwise datagrams go out immediately.
+    //
+    QUIC_SOCK_TXTIME TxTime = { CLOCK_MONOTONIC, 0 };
+    Result =
+        setsockopt(
+            UdpSocket,
+            SOL_SOCKET,
+            SO_TXTIME,
+            (const void*)&TxTime,
+            sizeof(TxTime));
+    if (Result == SOCKET_ERROR) {
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            errno,
+            "setsockopt(SO_TXTIME) failed");
+    } else {
+        Datapath->Features |= QUIC_DATAPATH_FEATURE_SEND_DEPARTURE_TIME;
+    }
+
+    close(UdpSocket);
+}
+
 QUIC_STATUS
 QuicDataPathInitialize(
     _In_ uint32_t ClientRecvContextLength,
@@ -530,6 +811,31 @@ QuicDataPathInitialize(
     Datapath->MaxSendBatchSize = QUIC_MAX_BATCH_SEND;
     QuicRundownInitialize(&Datapath->BindingsRundown);
 
+    QuicDataPathQuerySockoptSupport(Datapath);
+    Datapath->Features |= QUIC_DATAPATH_FEATURE_EXECUTION_CONTEXTS;
+
+    if (Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING) {
+        Datapath->RecvBatchSize = QUIC_MAX_BATCH_RECV_COALESCED;
+        Datapath->RecvPayloadLength = MAX_URO_PAYLOAD_LENGTH;
+    } else {
+        Datapath->RecvBatchSize = QUIC_MAX_BATCH_RECV;
+        Datapath->RecvPayloadLength = MAX_JUMBO_UDP_PAYLOAD_LENGTH;
+    }
+
+    uint32_t MessageCount =
+        (Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING)
+            ? URO_MAX_DATAGRAMS_PER_INDICATION : 1;
+
+    Datapath->DatagramStride =
+        ALIGN_UP(
+            sizeof(QUIC_RECV_DATAGRAM) +
+            sizeof(QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT) +
+            ClientRecvContextLength,
+            void*);
+    Datapath->RecvPayloadOffset =
+        (uint32_t)ALIGN_UP(sizeof(QUIC_DATAPATH_RECV_BLOCK), void*) +
+        MessageCount * Datapath->DatagramStride;
+
     //
     // Initialize the per processor contexts.
     //
@@ -588,8 +894,7 @@ QuicDataPathGetSupportedFeatures(
     _In_ QUIC_DATAPATH* Datapath
     )
 {
-    UNREFERENCED_PARAMETER(Datapath);
-    return 0;
+    return Datapath->Features;
 }
 
 BOOLEAN
@@ -600,15 +905,111 @@ QuicDataPathIsPaddingPreferred(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathIsPaddingPreferred(Datapath);
 #else
-    UNREFERENCED_PARAMETER(Datapath);
     //
-    // The windows implementation returns TRUE only if GSO is supported and
-    // this DAL implementation doesn't support GSO currently.
+    // When GSO is used, all but the last datagram in a segmented send must be
+    // padded to the segment size.
+    //
+    return !!(Datapath->Features & QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION);
+#endif
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicDataPathAddExecutionContext(
+    _In_ QUIC_DATAPATH* Datapath,
+    _In_ uint32_t Index,
+    _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    )
+{
+#ifdef QUIC_PLATFORM_DISPATCH_TABLE
+    return
+        PlatDispatch->DatapathAddExecutionContext(
+            Datapath,
+            Index,
+            ExecutionContext);
+#else
+    QUIC_DATAPATH_PROC_CONTEXT* ProcContext =
+        &Datapath->ProcContexts[Index % Datapath->ProcCount];
+
+    //
+    // Run the context as soon as the thread picks it up, so that it can
+    // initialize itself there.
+    //
+    ExecutionContext->DatapathContext = ProcContext;
+    ExecutionContext->Ready = TRUE;
+
+    QuicLockAcquire(&ProcContext->PendingLock);
+    ExecutionContext->Next = ProcContext->PendingExecutionContexts;
+    ProcContext->PendingExecutionContexts = ExecutionContext;
+    QuicLockRelease(&ProcContext->PendingLock);
+
+    const eventfd_t Value = 1;
+    eventfd_write(ProcContext->EventFd, Value);
+
+    return QUIC_STATUS_SUCCESS;
+#endif
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicDataPathWakeExecutionContext(
+    _In_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    )
+{
+#ifdef QUIC_PLATFORM_DISPATCH_TABLE
+    PlatDispatch->DatapathWakeExecutionContext(ExecutionContext);
+#else
+    QUIC_DATAPATH_PROC_CONTEXT* ProcContext =
+        (QUIC_DATAPATH_PROC_CONTEXT*)ExecutionContext->DatapathContext;
+
+    //
+    // If the context is already ready, whoever set it also took care of waking
+    // the thread. And if this is the context's own thread, it checks for ready
+    // contexts before waiting again anyway.
     //
-    return FALSE;
+    if (!ExecutionContext->Ready) {
+        ExecutionContext->Ready = TRUE;
+        if (ProcContext->ThreadID != QuicCurThreadID()) {
+            const eventfd_t Value = 1;
+            eventfd_write(ProcContext->EventFd, Value);
+        }
+    }
+#endif
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicDataPathIsExecutionContextThread(
+    _In_ const QUIC_EXECUTION_CONTEXT* ExecutionContext
+    )
+{
+#ifdef QUIC_PLATFORM_DISPATCH_TABLE
+    return PlatDispatch->DatapathIsExecutionContextThread(ExecutionContext);
+#else
+    const QUIC_DATAPATH_PROC_CONTEXT* ProcContext =
+        (const QUIC_DATAPATH_PROC_CONTEXT*)ExecutionContext->DatapathContext;
+    return ProcContext->ThreadID == QuicCurThreadID();
 #endif
 }
 
+//
+// Returns the processor context whose epoll wait thread is the current thread,
+// if any.
+//
+QUIC_DATAPATH_PROC_CONTEXT*
+QuicDataPathGetCurrentProcContext(
+    _In_ QUIC_DATAPATH* Datapath
+    )
+{
+    const QUIC_THREAD_ID ThreadID = QuicCurThreadID();
+    for (uint32_t i = 0; i < Datapath->ProcCount; ++i) {
+        if (Datapath->ProcContexts[i].ThreadID == ThreadID) {
+            return &Datapath->ProcContexts[i];
+        }
+    }
+    return NULL;
+}
+
 QUIC_DATAPATH_RECV_BLOCK*
 QuicDataPathAllocRecvBlock(
     _In_ QUIC_DATAPATH* Datapath,
@@ -626,12 +1027,23 @@ QuicDataPathAllocRecvBlock(
     } else {
         QuicZeroMemory(RecvBlock, sizeof(*RecvBlock));
         RecvBlock->OwningPool = &Datapath->ProcContexts[ProcIndex].RecvBlockPool;
-        RecvBlock->RecvPacket.Buffer = RecvBlock->Buffer;
-        RecvBlock->RecvPacket.Allocated = TRUE;
     }
     return RecvBlock;
 }
 
+QUIC_RECV_DATAGRAM*
+QuicDataPathRecvBlockGetDatagram(
+    _In_ const QUIC_DATAPATH* Datapath,
+    _In_ QUIC_DATAPATH_RECV_BLOCK* RecvBlock,
+    _In_ uint32_t Index
+    )
+{
+    return (QUIC_RECV_DATAGRAM*)
+        ((uint8_t*)RecvBlock +
+            ALIGN_UP(sizeof(QUIC_DATAPATH_RECV_BLOCK), void*) +
+            Index * Datapath->DatagramStride);
+}
+
 void
 QuicDataPathPopulateTargetAddress(
     _In_ QUIC_ADDRESS_FAMILY Family,
@@ -749,7 +1161,6 @@ Exit:
 QUIC_STATUS
 QuicSocketContextInitialize(
     _Inout_ QUIC_SOCKET_CONTEXT* SocketContext,
-    _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext,
     _In_ const QUIC_ADDR* LocalAddress,
     _In_ const QUIC_ADDR* RemoteAddress
     )
@@ -762,44 +1173,6 @@ QuicSocketContextInitialize(
 
     QUIC_DATAPATH_BINDING* Binding = SocketContext->Binding;
 
-    for (uint32_t i = 0; i < ARRAYSIZE(SocketContext->EventContexts); ++i) {
-        SocketContext->EventContexts[i] = i;
-    }
-
-    SocketContext->CleanupFd = eventfd(0, EFD_CLOEXEC);
-    if (SocketContext->CleanupFd == INVALID_SOCKET_FD) {
-        Status = errno;
-        QuicTraceEvent(
-            DatapathErrorStatus,
-            "[ udp][%p] ERROR, %u, %s.",
-            Binding,
-            Status,
-            "eventfd failed");
-        goto Exit;
-    }
-
-    struct epoll_event EvtFdEpEvt = {
-        .events = EPOLLIN,
-        .data = {
-            .ptr = &SocketContext->EventContexts[QUIC_SOCK_EVENT_CLEANUP]
-        }
-    };
-
-    if (epoll_ctl(
-            ProcContext->EpollFd,
-            EPOLL_CTL_ADD,
-            SocketContext->CleanupFd,
-            &EvtFdEpEvt) != 0) {
-        Status = errno;
-        QuicTraceEvent(
-            DatapathErrorStatus,
-            "[ udp][%p] ERROR, %u, %s.",
-            Binding,
-            Status,
-            "epoll_ctl(EPOLL_CTL_ADD) failed");
-        goto Exit;
-    }
-
     //
     // Create datagram socket.
     //
@@ -938,15 +1311,64 @@ QuicSocketContextInitialize(
     }
 
     //
-    // Set socket option to receive TOS (= DSCP + ECN) information from the
-    // incoming packet.
+    // Enable receive coalescing, if supported.
     //
-    Option = TRUE;
-    Result =
-        setsockopt(
-            SocketContext->SocketFd,
-            IPPROTO_IPV6,
-            IPV6_RECVTCLASS,
+    if (Binding->Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING) {
+        Option = TRUE;
+        Result =
+            setsockopt(
+                SocketContext->SocketFd,
+                SOL_UDP,
+                UDP_GRO,
+                (const void*)&Option,
+                sizeof(Option));
+        if (Result == SOCKET_ERROR) {
+            Status = errno;
+            QuicTraceEvent(
+                DatapathErrorStatus,
+                "[ udp][%p] ERROR, %u, %s.",
+                Binding,
+                Status,
+                "setsockopt(UDP_GRO) failed");
+            goto Exit;
+        }
+    }
+
+    //
+    // Enable departure times on sends, if supported. The clock must match the
+    // one QuicTimeUs64 uses.
+    //
+    if (Binding->Datapath->Features & QUIC_DATAPATH_FEATURE_SEND_DEPARTURE_TIME) {
+        QUIC_SOCK_TXTIME TxTime = { CLOCK_MONOTONIC, 0 };
+        Result =
+            setsockopt(
+                SocketContext->SocketFd,
+                SOL_SOCKET,
+                SO_TXTIME,
+                (const void*)&TxTime,
+                sizeof(TxTime));
+        if (Result == SOCKET_ERROR) {
+            Status = errno;
+            QuicTraceEvent(
+                DatapathErrorStatus,
+                "[ udp][%p] ERROR, %u, %s.",
+                Binding,
+                Status,
+                "setsockopt(SO_TXTIME) failed");
+            goto Exit;
+        }
+    }
+
+    //
+    // Set socket option to receive TOS (= DSCP + ECN) information from the
+    // incoming packet.
+    //
+    Option = TRUE;
+    Result =
+        setsockopt(
+            SocketContext->SocketFd,
+            IPPROTO_IPV6,
+            IPV6_RECVTCLASS,
             (const void*)&Option,
             sizeof(Option));
     if (Result == SOCKET_ERROR) {
@@ -1024,6 +1446,38 @@ QuicSocketContextInitialize(
         goto Exit;
     }
 
+    //
+    // The per-processor sockets of a listener form a reuseport group, so that
+    // the kernel distributes (or steers, see
+    // QuicDataPathBindingSetReusePortSteering) the incoming datagrams across
+    // them, instead of delivering everything to the last one bound. Connected
+    // sockets only ever receive from their one peer, so they don't need it.
+    //
+    if (RemoteAddress == NULL) {
+        Option = TRUE;
+        Result =
+            setsockopt(
+                SocketContext->SocketFd,
+                SOL_SOCKET,
+                SO_REUSEPORT,
+                (const void*)&Option,
+                sizeof(Option));
+        if (Result == SOCKET_ERROR) {
+            //
+            // Not fatal. SO_REUSEADDR still lets the socket share the port, but
+            // the group no longer matches the processor indexes, so don't
+            // steer it.
+            //
+            QuicTraceEvent(
+                DatapathErrorStatus,
+                "[ udp][%p] ERROR, %u, %s.",
+                Binding,
+                errno,
+                "setsockopt(SO_REUSEPORT) failed");
+            Binding->ReusePortFailed = TRUE;
+        }
+    }
+
     QuicCopyMemory(&MappedAddress, &Binding->LocalAddress, sizeof(MappedAddress));
     if (MappedAddress.Ipv6.sin6_family == QUIC_ADDRESS_FAMILY_INET6) {
         MappedAddress.Ipv6.sin6_family = AF_INET6;
@@ -1069,6 +1523,36 @@ QuicSocketContextInitialize(
                 "connect failed");
             goto Exit;
         }
+
+        //
+        // Now that the socket is connected the route is known, so use its MTU
+        // as the upper bound for path MTU discovery. Dual-mode sockets may
+        // only answer one of the two options, depending on the route.
+        //
+        int RouteMtu = 0;
+        socklen_t RouteMtuLength = sizeof(RouteMtu);
+        Result =
+            getsockopt(
+                SocketContext->SocketFd,
+                IPPROTO_IPV6,
+                IPV6_MTU,
+                (void*)&RouteMtu,
+                &RouteMtuLength);
+        if (Result == SOCKET_ERROR) {
+            RouteMtuLength = sizeof(RouteMtu);
+            Result =
+                getsockopt(
+                    SocketContext->SocketFd,
+                    IPPROTO_IP,
+                    IP_MTU,
+                    (void*)&RouteMtu,
+                    &RouteMtuLength);
+        }
+        if (Result != SOCKET_ERROR &&
+            RouteMtu >= QUIC_MIN_MTU &&
+            RouteMtu < (int)Binding->Mtu) {
+            Binding->Mtu = (uint16_t)RouteMtu;
+        }
     }
 
 
@@ -1120,8 +1604,16 @@ QuicSocketContextUninitialize(
 {
     epoll_ctl(ProcContext->EpollFd, EPOLL_CTL_DEL, SocketContext->SocketFd, NULL);
 
+    //
+    // The epoll wait thread may still have events for the socket it already
+    // dequeued, so it completes the clean up once it's done with them.
+    //
+    QuicLockAcquire(&ProcContext->PendingLock);
+    QuicListInsertTail(&ProcContext->PendingCleanups, &SocketContext->CleanupLink);
+    QuicLockRelease(&ProcContext->PendingLock);
+
     const eventfd_t Value = 1;
-    eventfd_write(SocketContext->CleanupFd, Value);
+    eventfd_write(ProcContext->EventFd, Value);
 }
 
 void
@@ -1130,8 +1622,12 @@ QuicSocketContextUninitializeComplete(
     _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext
     )
 {
-    if (SocketContext->CurrentRecvBlock != NULL) {
-        QuicDataPathBindingReturnRecvDatagrams(&SocketContext->CurrentRecvBlock->RecvPacket);
+    for (uint32_t i = 0; i < ARRAYSIZE(SocketContext->CurrentRecvBlocks); ++i) {
+        if (SocketContext->CurrentRecvBlocks[i] != NULL) {
+            QuicPoolFree(
+                SocketContext->CurrentRecvBlocks[i]->OwningPool,
+                SocketContext->CurrentRecvBlocks[i]);
+        }
     }
 
     while (!QuicListIsEmpty(&SocketContext->PendingSendContextHead)) {
@@ -1143,47 +1639,78 @@ QuicSocketContextUninitializeComplete(
     }
 
     epoll_ctl(ProcContext->EpollFd, EPOLL_CTL_DEL, SocketContext->SocketFd, NULL);
-    epoll_ctl(ProcContext->EpollFd, EPOLL_CTL_DEL, SocketContext->CleanupFd, NULL);
-    close(SocketContext->CleanupFd);
     close(SocketContext->SocketFd);
 
     QuicRundownRelease(&SocketContext->Binding->Rundown);
 }
 
+//
+// Completes the clean up of any socket contexts queued to the processor
+// context. Must be called on its epoll wait thread, while not processing any
+// epoll events.
+//
+void
+QuicProcessorContextProcessCleanups(
+    _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext
+    )
+{
+    QUIC_LIST_ENTRY Cleanups;
+    QuicListInitializeHead(&Cleanups);
+
+    QuicLockAcquire(&ProcContext->PendingLock);
+    QuicListMoveItems(&ProcContext->PendingCleanups, &Cleanups);
+    QuicLockRelease(&ProcContext->PendingLock);
+
+    while (!QuicListIsEmpty(&Cleanups)) {
+        QUIC_SOCKET_CONTEXT* SocketContext =
+            QUIC_CONTAINING_RECORD(
+                QuicListRemoveHead(&Cleanups), QUIC_SOCKET_CONTEXT, CleanupLink);
+        QUIC_DBG_ASSERT(SocketContext->Binding->Shutdown);
+        QuicSocketContextUninitializeComplete(SocketContext, ProcContext);
+    }
+}
+
 QUIC_STATUS
 QuicSocketContextPrepareReceive(
     _In_ QUIC_SOCKET_CONTEXT* SocketContext
     )
 {
-    if (SocketContext->CurrentRecvBlock == NULL) {
-        SocketContext->CurrentRecvBlock =
-            QuicDataPathAllocRecvBlock(
-                SocketContext->Binding->Datapath,
-                QuicProcCurrentNumber());
-        if (SocketContext->CurrentRecvBlock == NULL) {
-            QuicTraceEvent(
-                AllocFailure,
-                "Allocation of '%s' failed. (%llu bytes)",
-                "QUIC_DATAPATH_RECV_BLOCK",
-                0);
-            return QUIC_STATUS_OUT_OF_MEMORY;
+    QUIC_DATAPATH* Datapath = SocketContext->Binding->Datapath;
+
+    for (uint32_t i = 0; i < Datapath->RecvBatchSize; ++i) {
+        if (SocketContext->CurrentRecvBlocks[i] == NULL) {
+            SocketContext->CurrentRecvBlocks[i] =
+                QuicDataPathAllocRecvBlock(
+                    Datapath,
+                    QuicProcCurrentNumber());
+            if (SocketContext->CurrentRecvBlocks[i] == NULL) {
+                QuicTraceEvent(
+                    AllocFailure,
+                    "Allocation of '%s' failed. (%llu bytes)",
+                    "QUIC_DATAPATH_RECV_BLOCK",
+                    0);
+                return QUIC_STATUS_OUT_OF_MEMORY;
+            }
         }
-    }
 
-    SocketContext->RecvIov.iov_base = SocketContext->CurrentRecvBlock->RecvPacket.Buffer;
-    SocketContext->CurrentRecvBlock->RecvPacket.BufferLength = SocketContext->RecvIov.iov_len;
-    SocketContext->CurrentRecvBlock->RecvPacket.Tuple = (QUIC_TUPLE*)&SocketContext->CurrentRecvBlock->Tuple;
+        QUIC_DATAPATH_RECV_BLOCK* RecvBlock = SocketContext->CurrentRecvBlocks[i];
+        struct msghdr* MsgHdr = &SocketContext->RecvMsgHdrs[i].msg_hdr;
+
+        SocketContext->RecvIovs[i].iov_base =
+            (uint8_t*)RecvBlock + Datapath->RecvPayloadOffset;
+        SocketContext->RecvIovs[i].iov_len = Datapath->RecvPayloadLength;
 
-    QuicZeroMemory(&SocketContext->RecvMsgHdr, sizeof(SocketContext->RecvMsgHdr));
-    QuicZeroMemory(&SocketContext->RecvMsgControl, sizeof(SocketContext->RecvMsgControl));
+        QuicZeroMemory(&SocketContext->RecvMsgHdrs[i], sizeof(SocketContext->RecvMsgHdrs[i]));
+        QuicZeroMemory(&SocketContext->RecvMsgControl[i], sizeof(SocketContext->RecvMsgControl[i]));
 
-    SocketContext->RecvMsgHdr.msg_name = &SocketContext->CurrentRecvBlock->RecvPacket.Tuple->RemoteAddress;
-    SocketContext->RecvMsgHdr.msg_namelen = sizeof(SocketContext->CurrentRecvBlock->RecvPacket.Tuple->RemoteAddress);
-    SocketContext->RecvMsgHdr.msg_iov = &SocketContext->RecvIov;
-    SocketContext->RecvMsgHdr.msg_iovlen = 1;
-    SocketContext->RecvMsgHdr.msg_control = SocketContext->RecvMsgControl;
-    SocketContext->RecvMsgHdr.msg_controllen = sizeof(SocketContext->RecvMsgControl);
-    SocketContext->RecvMsgHdr.msg_flags = 0;
+        MsgHdr->msg_name = &RecvBlock->Tuple.RemoteAddress;
+        MsgHdr->msg_namelen = sizeof(RecvBlock->Tuple.RemoteAddress);
+        MsgHdr->msg_iov = &SocketContext->RecvIovs[i];
+        MsgHdr->msg_iovlen = 1;
+        MsgHdr->msg_control = SocketContext->RecvMsgControl[i];
+        MsgHdr->msg_controllen = sizeof(SocketContext->RecvMsgControl[i]);
+        MsgHdr->msg_flags = 0;
+    }
 
     return QUIC_STATUS_SUCCESS;
 }
@@ -1202,7 +1729,7 @@ QuicSocketContextStartReceive(
     struct epoll_event SockFdEpEvt = {
         .events = EPOLLIN | EPOLLET,
         .data = {
-            .ptr = &SocketContext->EventContexts[QUIC_SOCK_EVENT_SOCKET]
+            .ptr = SocketContext
         }
     };
 
@@ -1233,37 +1760,55 @@ Error:
     return Status;
 }
 
+//
+// Processes one completed message from a recvmmsg call. On success, the
+// datagrams in the receive block are appended to the chain being built in
+// DatagramChainTail, and the receive block is released from the socket
+// context.
+//
 void
 QuicSocketContextRecvComplete(
     _In_ QUIC_SOCKET_CONTEXT* SocketContext,
     _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext,
-    _In_ ssize_t BytesTransferred
+    _In_ uint32_t MessageIndex,
+    _Inout_ QUIC_RECV_DATAGRAM*** DatagramChainTail
     )
 {
-    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    QUIC_DATAPATH* Datapath = SocketContext->Binding->Datapath;
+    QUIC_DATAPATH_RECV_BLOCK* RecvBlock = SocketContext->CurrentRecvBlocks[MessageIndex];
+    struct msghdr* MsgHdr = &SocketContext->RecvMsgHdrs[MessageIndex].msg_hdr;
+    uint32_t BytesTransferred = SocketContext->RecvMsgHdrs[MessageIndex].msg_len;
 
-    QUIC_DBG_ASSERT(SocketContext->CurrentRecvBlock != NULL);
-    QUIC_RECV_DATAGRAM* RecvPacket = &SocketContext->CurrentRecvBlock->RecvPacket;
-    SocketContext->CurrentRecvBlock = NULL;
+    QUIC_DBG_ASSERT(RecvBlock != NULL);
+
+    if (MsgHdr->msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[ udp][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            (uint32_t)MsgHdr->msg_flags,
+            "recvmmsg truncated");
+        return;
+    }
 
     BOOLEAN FoundLocalAddr = FALSE;
     BOOLEAN FoundTOS = FALSE;
-    QUIC_ADDR* LocalAddr = &RecvPacket->Tuple->LocalAddress;
+    uint8_t TypeOfService = 0;
+    uint16_t MessageLength = 0;
+    QUIC_ADDR* LocalAddr = &RecvBlock->Tuple.LocalAddress;
     if (LocalAddr->Ipv6.sin6_family == AF_INET6) {
         LocalAddr->Ipv6.sin6_family = QUIC_ADDRESS_FAMILY_INET6;
     }
-    QUIC_ADDR* RemoteAddr = &RecvPacket->Tuple->RemoteAddress;
+    QUIC_ADDR* RemoteAddr = &RecvBlock->Tuple.RemoteAddress;
     if (RemoteAddr->Ipv6.sin6_family == AF_INET6) {
         RemoteAddr->Ipv6.sin6_family = QUIC_ADDRESS_FAMILY_INET6;
     }
     QuicConvertFromMappedV6(RemoteAddr, RemoteAddr);
 
-    RecvPacket->TypeOfService = 0;
-
     struct cmsghdr *CMsg;
-    for (CMsg = CMSG_FIRSTHDR(&SocketContext->RecvMsgHdr);
+    for (CMsg = CMSG_FIRSTHDR(MsgHdr);
          CMsg != NULL;
-         CMsg = CMSG_NXTHDR(&SocketContext->RecvMsgHdr, CMsg)) {
+         CMsg = CMSG_NXTHDR(MsgHdr, CMsg)) {
 
         if (CMsg->cmsg_level == IPPROTO_IPV6) {
             if (CMsg->cmsg_type == IPV6_PKTINFO) {
@@ -1276,7 +1821,7 @@ QuicSocketContextRecvComplete(
                 LocalAddr->Ipv6.sin6_scope_id = PktInfo6->ipi6_ifindex;
                 FoundLocalAddr = TRUE;
             } else if (CMsg->cmsg_type == IPV6_TCLASS) {
-                RecvPacket->TypeOfService = *(uint8_t *)CMSG_DATA(CMsg);
+                TypeOfService = *(uint8_t *)CMSG_DATA(CMsg);
                 FoundTOS = TRUE;
             }
         } else if (CMsg->cmsg_level == IPPROTO_IP) {
@@ -1288,9 +1833,14 @@ QuicSocketContextRecvComplete(
                 LocalAddr->Ipv6.sin6_scope_id = PktInfo->ipi_ifindex;
                 FoundLocalAddr = TRUE;
             } else if (CMsg->cmsg_type == IP_TOS) {
-                RecvPacket->TypeOfService = *(uint8_t *)CMSG_DATA(CMsg);
+                TypeOfService = *(uint8_t *)CMSG_DATA(CMsg);
                 FoundTOS = TRUE;
             }
+        } else if (CMsg->cmsg_level == SOL_UDP) {
+            if (CMsg->cmsg_type == UDP_GRO) {
+                QUIC_DBG_ASSERT(Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING);
+                MessageLength = (uint16_t)*(int*)CMSG_DATA(CMsg);
+            }
         }
     }
 
@@ -1301,29 +1851,64 @@ QuicSocketContextRecvComplete(
         DatapathRecv,
         "[ udp][%p] Recv %u bytes (segment=%hu) Src=%!ADDR! Dst=%!ADDR!",
         SocketContext->Binding,
-        (uint32_t)BytesTransferred,
-        (uint32_t)BytesTransferred,
+        BytesTransferred,
+        MessageLength,
         CLOG_BYTEARRAY(sizeof(*LocalAddr), LocalAddr),
         CLOG_BYTEARRAY(sizeof(*RemoteAddr), RemoteAddr));
 
-    QUIC_DBG_ASSERT(BytesTransferred <= RecvPacket->BufferLength);
-    RecvPacket->BufferLength = BytesTransferred;
-
-    RecvPacket->PartitionIndex = ProcContext->Index;
+    QUIC_DBG_ASSERT(BytesTransferred <= Datapath->RecvPayloadLength);
 
-    QUIC_DBG_ASSERT(SocketContext->Binding->Datapath->RecvHandler);
-    SocketContext->Binding->Datapath->RecvHandler(
-        SocketContext->Binding,
-        SocketContext->Binding->ClientContext,
-        RecvPacket);
-
-    Status = QuicSocketContextPrepareReceive(SocketContext);
+    if (BytesTransferred == 0) {
+        QuicTraceLogWarning(
+            DatapathRecvEmpty,
+            "[ udp][%p] Dropping datagram with empty payload.",
+            SocketContext->Binding);
+        return;
+    }
 
     //
-    // Prepare can only fail under low memory condition. Treat it as a fatal
-    // error.
+    // Without coalescing, the whole payload is a single datagram.
     //
-    QUIC_FRE_ASSERT(QUIC_SUCCEEDED(Status));
+    if (MessageLength == 0 || MessageLength > BytesTransferred) {
+        MessageLength = (uint16_t)BytesTransferred;
+    }
+
+    uint8_t* RecvPayload = (uint8_t*)RecvBlock + Datapath->RecvPayloadOffset;
+    uint32_t MessageCount = 0;
+
+    for (uint32_t Offset = 0; Offset < BytesTransferred; Offset += MessageLength) {
+        if (MessageCount == URO_MAX_DATAGRAMS_PER_INDICATION) {
+            QuicTraceLogWarning(
+                DatapathUroPreallocExceeded,
+                "[ udp][%p] Exceeded URO preallocation capacity.",
+                SocketContext->Binding);
+            break;
+        }
+
+        QUIC_RECV_DATAGRAM* Datagram =
+            QuicDataPathRecvBlockGetDatagram(Datapath, RecvBlock, MessageCount);
+        QuicZeroMemory(Datagram, sizeof(*Datagram));
+
+        QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT* DatagramContext =
+            (QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT*)(Datagram + 1);
+        DatagramContext->RecvBlock = RecvBlock;
+
+        Datagram->Buffer = RecvPayload + Offset;
+        Datagram->BufferLength =
+            BytesTransferred - Offset < MessageLength ?
+                (uint16_t)(BytesTransferred - Offset) : MessageLength;
+        Datagram->Tuple = &RecvBlock->Tuple;
+        Datagram->PartitionIndex = ProcContext->Index;
+        Datagram->TypeOfService = TypeOfService;
+        Datagram->Allocated = TRUE;
+
+        **DatagramChainTail = Datagram;
+        *DatagramChainTail = &Datagram->Next;
+        MessageCount++;
+    }
+
+    RecvBlock->ReferenceCount = (long)MessageCount;
+    SocketContext->CurrentRecvBlocks[MessageIndex] = NULL;
 }
 
 QUIC_STATUS
@@ -1340,7 +1925,7 @@ QuicSocketContextPendSend(
         struct epoll_event SockFdEpEvt = {
             .events = EPOLLIN | EPOLLOUT | EPOLLET,
             .data = {
-                .ptr = &SocketContext->EventContexts[QUIC_SOCK_EVENT_SOCKET]
+                .ptr = SocketContext
             }
         };
 
@@ -1411,7 +1996,7 @@ QuicSocketContextSendComplete(
         struct epoll_event SockFdEpEvt = {
             .events = EPOLLIN | EPOLLET,
             .data = {
-                .ptr = &SocketContext->EventContexts[QUIC_SOCK_EVENT_SOCKET]
+                .ptr = SocketContext
             }
         };
 
@@ -1464,25 +2049,11 @@ Exit:
 
 void
 QuicSocketContextProcessEvents(
-    _In_ void* EventPtr,
+    _In_ QUIC_SOCKET_CONTEXT* SocketContext,
     _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext,
     _In_ int Events
     )
 {
-    uint8_t EventType = *(uint8_t*)EventPtr;
-    QUIC_SOCKET_CONTEXT* SocketContext =
-        (QUIC_SOCKET_CONTEXT*)(
-            (uint8_t*)QUIC_CONTAINING_RECORD(EventPtr, QUIC_SOCKET_CONTEXT, EventContexts) -
-            EventType);
-
-    if (EventType == QUIC_SOCK_EVENT_CLEANUP) {
-        QUIC_DBG_ASSERT(SocketContext->Binding->Shutdown);
-        QuicSocketContextUninitializeComplete(SocketContext, ProcContext);
-        return;
-    }
-
-    QUIC_DBG_ASSERT(EventType == QUIC_SOCK_EVENT_SOCKET);
-
     if (EPOLLERR & Events) {
         int ErrNum = 0;
         socklen_t OptLen = sizeof(ErrNum);
@@ -1524,14 +2095,15 @@ QuicSocketContextProcessEvents(
     }
 
     if (EPOLLIN & Events) {
+        QUIC_DATAPATH* Datapath = SocketContext->Binding->Datapath;
         while (TRUE) {
-            QUIC_DBG_ASSERT(SocketContext->CurrentRecvBlock != NULL);
-
-            ssize_t Ret =
-                recvmsg(
+            int Ret =
+                recvmmsg(
                     SocketContext->SocketFd,
-                    &SocketContext->RecvMsgHdr,
-                    0);
+                    SocketContext->RecvMsgHdrs,
+                    Datapath->RecvBatchSize,
+                    0,
+                    NULL);
             if (Ret < 0) {
                 if (errno != EAGAIN && errno != EWOULDBLOCK) {
                     QuicTraceEvent(
@@ -1539,12 +2111,37 @@ QuicSocketContextProcessEvents(
                         "[ udp][%p] ERROR, %u, %s.",
                         SocketContext->Binding,
                         errno,
-                        "recvmsg failed");
+                        "recvmmsg failed");
                 }
                 break;
-            } else {
-                QuicSocketContextRecvComplete(SocketContext, ProcContext, Ret);
             }
+
+            QUIC_RECV_DATAGRAM* DatagramChain = NULL;
+            QUIC_RECV_DATAGRAM** DatagramChainTail = &DatagramChain;
+
+            for (int i = 0; i < Ret; ++i) {
+                QuicSocketContextRecvComplete(
+                    SocketContext,
+                    ProcContext,
+                    (uint32_t)i,
+                    &DatagramChainTail);
+            }
+
+            if (DatagramChain != NULL) {
+                QUIC_DBG_ASSERT(Datapath->RecvHandler);
+                Datapath->RecvHandler(
+                    SocketContext->Binding,
+                    SocketContext->Binding->ClientContext,
+                    DatagramChain);
+            }
+
+            QUIC_STATUS Status = QuicSocketContextPrepareReceive(SocketContext);
+
+            //
+            // Prepare can only fail under low memory condition. Treat it as a
+            // fatal error.
+            //
+            QUIC_FRE_ASSERT(QUIC_SUCCEEDED(Status));
         }
     }
 
@@ -1553,6 +2150,55 @@ QuicSocketContextProcessEvents(
     }
 }
 
+//
+// Attaches a classic BPF program to the binding's reuseport group that picks
+// the socket by the index of the CPU the datagram was received on (i.e. the
+// RSS CPU), modulo the number of sockets. The kernel indexes the group in the
+// order the sockets were bound, and QuicDataPathBindingCreate binds socket i
+// i-th and registers it with ProcContexts[i], whose index the upper layer uses
+// as the partition for the datagram. So CPU i maps to socket, epoll thread and
+// partition i % SocketCount, and all the datagrams of a flow end up on the
+// same socket, thread and worker, instead of being hashed across all of them.
+//
+void
+QuicDataPathBindingSetReusePortSteering(
+    _In_ QUIC_DATAPATH_BINDING* Binding,
+    _In_ uint32_t SocketCount
+    )
+{
+    struct sock_filter Code[] = {
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t)(SKF_AD_OFF + SKF_AD_CPU) },
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, SocketCount },
+        { BPF_RET | BPF_A, 0, 0, 0 }
+    };
+    struct sock_fprog Program = {
+        .len = ARRAYSIZE(Code),
+        .filter = Code
+    };
+
+    //
+    // The program applies to the whole group, so only attach it once.
+    //
+    int Result =
+        setsockopt(
+            Binding->SocketContexts[0].SocketFd,
+            SOL_SOCKET,
+            SO_ATTACH_REUSEPORT_CBPF,
+            (const void*)&Program,
+            sizeof(Program));
+    if (Result == SOCKET_ERROR) {
+        //
+        // Not fatal. The datagrams just get hashed across the group.
+        //
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[ udp][%p] ERROR, %u, %s.",
+            Binding,
+            errno,
+            "setsockopt(SO_ATTACH_REUSEPORT_CBPF) failed");
+    }
+}
+
 //
 // Datapath binding interface.
 //
@@ -1577,7 +2223,12 @@ QuicDataPathBindingCreate(
 #else
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
 
-    uint32_t SocketCount = Datapath->ProcCount; // TODO - Only use 1 for client (RemoteAddress != NULL) bindings?
+    //
+    // Every binding gets a socket per processor, so that sends always go out
+    // on the current processor's socket. Only listener bindings spread their
+    // receives across them though.
+    //
+    uint32_t SocketCount = Datapath->ProcCount;
     size_t BindingLength =
         sizeof(QUIC_DATAPATH_BINDING) +
         SocketCount * sizeof(QUIC_SOCKET_CONTEXT);
@@ -1614,8 +2265,6 @@ QuicDataPathBindingCreate(
     for (uint32_t i = 0; i < SocketCount; i++) {
         Binding->SocketContexts[i].Binding = Binding;
         Binding->SocketContexts[i].SocketFd = INVALID_SOCKET_FD;
-        Binding->SocketContexts[i].RecvIov.iov_len =
-            Binding->Mtu - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE;
         QuicListInitializeHead(&Binding->SocketContexts[i].PendingSendContextHead);
         QuicRundownAcquire(&Binding->Rundown);
     }
@@ -1626,7 +2275,6 @@ QuicDataPathBindingCreate(
         Status =
             QuicSocketContextInitialize(
                 &Binding->SocketContexts[i],
-                &Datapath->ProcContexts[i],
                 LocalAddress,
                 RemoteAddress);
         if (QUIC_FAILED(Status)) {
@@ -1634,6 +2282,10 @@ QuicDataPathBindingCreate(
         }
     }
 
+    if (RemoteAddress == NULL && SocketCount > 1 && !Binding->ReusePortFailed) {
+        QuicDataPathBindingSetReusePortSteering(Binding, SocketCount);
+    }
+
     QuicConvertFromMappedV6(&Binding->LocalAddress, &Binding->LocalAddress);
     Binding->LocalAddress.Ipv6.sin6_scope_id = 0;
 
@@ -1709,7 +2361,22 @@ QuicDataPathBindingDelete(
             &Binding->Datapath->ProcContexts[i]);
     }
 
-    QuicRundownReleaseAndWait(&Binding->Rundown);
+    QUIC_DATAPATH_PROC_CONTEXT* CurrentProcContext =
+        QuicDataPathGetCurrentProcContext(Binding->Datapath);
+    if (CurrentProcContext == NULL) {
+        QuicRundownReleaseAndWait(&Binding->Rundown);
+    } else {
+        //
+        // Called by an execution context on one of the epoll wait threads. The
+        // thread can't just block waiting for itself to clean up, and the other
+        // threads might be waiting on it as well, so it keeps completing the
+        // clean ups queued to it while it waits.
+        //
+        QuicRundownRelease(&Binding->Rundown);
+        do {
+            QuicProcessorContextProcessCleanups(CurrentProcContext);
+        } while (!QuicEventWaitWithTimeout(Binding->Rundown.RundownComplete, 1));
+    }
     QuicRundownRelease(&Binding->Datapath->BindingsRundown);
 
     QuicRundownUninitialize(&Binding->Rundown);
@@ -1801,11 +2468,10 @@ QuicDataPathRecvPacketToRecvDatagram(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathRecvContextToRecvPacket(RecvContext);
 #else
-    QUIC_DATAPATH_RECV_BLOCK* RecvBlock =
-        (QUIC_DATAPATH_RECV_BLOCK*)
-            ((char *)RecvContext - sizeof(QUIC_DATAPATH_RECV_BLOCK));
-
-    return &RecvBlock->RecvPacket;
+    return (QUIC_RECV_DATAGRAM*)
+        (((uint8_t*)RecvContext) -
+            sizeof(QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT) -
+            sizeof(QUIC_RECV_DATAGRAM));
 #endif
 }
 
@@ -1817,10 +2483,10 @@ QuicDataPathRecvDatagramToRecvPacket(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathRecvPacketToRecvContext(RecvPacket);
 #else
-    QUIC_DATAPATH_RECV_BLOCK* RecvBlock =
-        QUIC_CONTAINING_RECORD(RecvPacket, QUIC_DATAPATH_RECV_BLOCK, RecvPacket);
-
-    return (QUIC_RECV_PACKET*)(RecvBlock + 1);
+    return (QUIC_RECV_PACKET*)
+        (((uint8_t*)RecvPacket) +
+            sizeof(QUIC_RECV_DATAGRAM) +
+            sizeof(QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT));
 #endif
 }
 
@@ -1838,8 +2504,10 @@ QuicDataPathBindingReturnRecvDatagrams(
     while ((Datagram = DatagramChain) != NULL) {
         DatagramChain = DatagramChain->Next;
         QUIC_DATAPATH_RECV_BLOCK* RecvBlock =
-            QUIC_CONTAINING_RECORD(Datagram, QUIC_DATAPATH_RECV_BLOCK, RecvPacket);
-        QuicPoolFree(RecvBlock->OwningPool, RecvBlock);
+            ((QUIC_DATAPATH_RECV_DATAGRAM_CONTEXT*)(Datagram + 1))->RecvBlock;
+        if (InterlockedDecrement(&RecvBlock->ReferenceCount) == 0) {
+            QuicPoolFree(RecvBlock->OwningPool, RecvBlock);
+        }
     }
 #endif
 }
@@ -1857,7 +2525,6 @@ QuicDataPathBindingAllocSendContext(
             Binding,
             MaxPacketSize);
 #else
-    UNREFERENCED_PARAMETER(MaxPacketSize);
     QUIC_DBG_ASSERT(Binding != NULL);
 
     QUIC_DATAPATH_PROC_CONTEXT* ProcContext =
@@ -1876,6 +2543,9 @@ QuicDataPathBindingAllocSendContext(
     QuicZeroMemory(SendContext, sizeof(*SendContext));
     SendContext->Owner = ProcContext;
     SendContext->ECN = ECN;
+    SendContext->SegmentSize =
+        (Binding->Datapath->Features & QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION)
+            ? MaxPacketSize : 0;
 
 Exit:
 
@@ -1893,9 +2563,7 @@ QuicDataPathBindingFreeSendContext(
 #else
     size_t i = 0;
     for (i = 0; i < SendContext->BufferCount; ++i) {
-        QuicPoolFree(
-            &SendContext->Owner->SendBufferPool,
-            SendContext->Buffers[i].Buffer);
+        QuicPoolFree(SendContext->BufferPools[i], SendContext->Buffers[i].Buffer);
         SendContext->Buffers[i].Buffer = NULL;
     }
 
@@ -1903,56 +2571,206 @@ QuicDataPathBindingFreeSendContext(
 #endif
 }
 
-QUIC_BUFFER*
-QuicDataPathBindingAllocSendDatagram(
+#ifndef QUIC_PLATFORM_DISPATCH_TABLE
+
+static
+BOOLEAN
+QuicSendContextCanAllocSendSegment(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    QUIC_DBG_ASSERT(SendContext->SegmentSize > 0);
+    QUIC_DBG_ASSERT(SendContext->BufferCount > 0);
+    QUIC_DBG_ASSERT(SendContext->BufferCount <= SendContext->Owner->Datapath->MaxSendBatchSize);
+
+    //
+    // The kernel limits both the total size and the number of segments of a
+    // single GSO send.
+    //
+    uint32_t MaxLength = (uint32_t)SendContext->SegmentSize * QUIC_MAX_GSO_SEGMENTS;
+    if (MaxLength > QUIC_LARGE_SEND_BUFFER_SIZE) {
+        MaxLength = QUIC_LARGE_SEND_BUFFER_SIZE;
+    }
+
+    uint32_t BytesAvailable =
+        MaxLength -
+            (uint32_t)SendContext->Buffers[SendContext->BufferCount - 1].Length -
+            (uint32_t)SendContext->ClientBuffer.Length;
+
+    return MaxBufferLength <= BytesAvailable;
+}
+
+static
+BOOLEAN
+QuicSendContextCanAllocSend(
     _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
     _In_ uint16_t MaxBufferLength
     )
 {
-#ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return
-        PlatDispatch->DatapathBindingAllocSendBuffer(
-            SendContext,
-            MaxBufferLength);
-#else
-    QUIC_BUFFER* Buffer = NULL;
+        (SendContext->BufferCount < SendContext->Owner->Datapath->MaxSendBatchSize) ||
+        ((SendContext->SegmentSize > 0) &&
+            QuicSendContextCanAllocSendSegment(SendContext, MaxBufferLength));
+}
 
-    QUIC_DBG_ASSERT(SendContext != NULL);
-    QUIC_DBG_ASSERT(MaxBufferLength <= QUIC_MAX_MTU - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE);
+static
+void
+QuicSendContextFinalizeSendBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ BOOLEAN IsSendingImmediately
+    )
+{
+    if (SendContext->ClientBuffer.Length == 0) {
+        //
+        // There is no buffer segment outstanding at the client.
+        //
+        return;
+    }
 
-    if (SendContext->BufferCount ==
-            SendContext->Owner->Datapath->MaxSendBatchSize) {
-        QuicTraceEvent(
-            LibraryError,
-            "[ lib] ERROR, %s.",
-            "Max batch size limit hit");
-        goto Exit;
+    QUIC_DBG_ASSERT(SendContext->SegmentSize > 0 && SendContext->BufferCount > 0);
+    QUIC_DBG_ASSERT(SendContext->ClientBuffer.Length > 0 && SendContext->ClientBuffer.Length <= SendContext->SegmentSize);
+    QUIC_DBG_ASSERT(QuicSendContextCanAllocSendSegment(SendContext, 0));
+
+    //
+    // Append the client's buffer segment to our internal send buffer.
+    //
+    SendContext->Buffers[SendContext->BufferCount - 1].Length +=
+        SendContext->ClientBuffer.Length;
+
+    if (SendContext->ClientBuffer.Length == SendContext->SegmentSize) {
+        SendContext->ClientBuffer.Buffer += SendContext->SegmentSize;
+        SendContext->ClientBuffer.Length = 0;
+    } else {
+        //
+        // The next segment allocation must create a new backing buffer.
+        //
+        QUIC_DBG_ASSERT(IsSendingImmediately);
+        UNREFERENCED_PARAMETER(IsSendingImmediately);
+        SendContext->ClientBuffer.Buffer = NULL;
+        SendContext->ClientBuffer.Length = 0;
     }
+}
 
-    Buffer = &SendContext->Buffers[SendContext->BufferCount];
-    QuicZeroMemory(Buffer, sizeof(*Buffer));
+_Success_(return != NULL)
+static
+QUIC_BUFFER*
+QuicSendContextAllocBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ QUIC_POOL* BufferPool
+    )
+{
+    QUIC_DBG_ASSERT(SendContext->BufferCount < SendContext->Owner->Datapath->MaxSendBatchSize);
 
-    Buffer->Buffer = QuicPoolAlloc(&SendContext->Owner->SendBufferPool);
+    QUIC_BUFFER* Buffer = &SendContext->Buffers[SendContext->BufferCount];
+    Buffer->Buffer = QuicPoolAlloc(BufferPool);
     if (Buffer->Buffer == NULL) {
         QuicTraceEvent(
             AllocFailure,
             "Allocation of '%s' failed. (%llu bytes)",
             "Send Buffer",
             0);
-        Buffer = NULL;
-        goto Exit;
+        return NULL;
     }
+    SendContext->DepartureTimes[SendContext->BufferCount] = 0;
+    SendContext->BufferPools[SendContext->BufferCount] = BufferPool;
+    ++SendContext->BufferCount;
 
-    Buffer->Length = MaxBufferLength;
+    return Buffer;
+}
 
-    SendContext->Iovs[SendContext->BufferCount].iov_base = Buffer->Buffer;
-    SendContext->Iovs[SendContext->BufferCount].iov_len = Buffer->Length;
+_Success_(return != NULL)
+static
+QUIC_BUFFER*
+QuicSendContextAllocPacketBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    QUIC_BUFFER* Buffer =
+        QuicSendContextAllocBuffer(
+            SendContext,
+            MaxBufferLength > MAX_UDP_PAYLOAD_LENGTH ?
+                &SendContext->Owner->LargeSendBufferPool :
+                &SendContext->Owner->SendBufferPool);
+    if (Buffer != NULL) {
+        Buffer->Length = MaxBufferLength;
+    }
+    return Buffer;
+}
 
-    ++SendContext->BufferCount;
+_Success_(return != NULL)
+static
+QUIC_BUFFER*
+QuicSendContextAllocSegmentBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    QUIC_DBG_ASSERT(SendContext->SegmentSize > 0);
+    QUIC_DBG_ASSERT(MaxBufferLength <= SendContext->SegmentSize);
 
-Exit:
+    if (SendContext->ClientBuffer.Buffer != NULL &&
+        QuicSendContextCanAllocSendSegment(SendContext, MaxBufferLength)) {
 
-    return Buffer;
+        //
+        // All clear to return the next segment of our contiguous buffer.
+        //
+        SendContext->ClientBuffer.Length = MaxBufferLength;
+        return &SendContext->ClientBuffer;
+    }
+
+    QUIC_BUFFER* Buffer =
+        QuicSendContextAllocBuffer(SendContext, &SendContext->Owner->LargeSendBufferPool);
+    if (Buffer == NULL) {
+        return NULL;
+    }
+
+    //
+    // Provide a virtual QUIC_BUFFER to the client. Once the client has
+    // committed to a final send size, we'll append it to our internal backing
+    // buffer.
+    //
+    Buffer->Length = 0;
+    SendContext->ClientBuffer.Buffer = Buffer->Buffer;
+    SendContext->ClientBuffer.Length = MaxBufferLength;
+
+    return &SendContext->ClientBuffer;
+}
+
+#endif // QUIC_PLATFORM_DISPATCH_TABLE
+
+QUIC_BUFFER*
+QuicDataPathBindingAllocSendDatagram(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+#ifdef QUIC_PLATFORM_DISPATCH_TABLE
+    return
+        PlatDispatch->DatapathBindingAllocSendBuffer(
+            SendContext,
+            MaxBufferLength);
+#else
+    QUIC_DBG_ASSERT(SendContext != NULL);
+    QUIC_DBG_ASSERT(MaxBufferLength > 0);
+    QUIC_DBG_ASSERT(MaxBufferLength <= MAX_JUMBO_UDP_PAYLOAD_LENGTH);
+
+    QuicSendContextFinalizeSendBuffer(SendContext, FALSE);
+
+    if (!QuicSendContextCanAllocSend(SendContext, MaxBufferLength)) {
+        QuicTraceEvent(
+            LibraryError,
+            "[ lib] ERROR, %s.",
+            "Max batch size limit hit");
+        return NULL;
+    }
+
+    if (SendContext->SegmentSize == 0) {
+        return QuicSendContextAllocPacketBuffer(SendContext, MaxBufferLength);
+    } else {
+        return QuicSendContextAllocSegmentBuffer(SendContext, MaxBufferLength);
+    }
 #endif
 }
 
@@ -1965,12 +2783,88 @@ QuicDataPathBindingFreeSendDatagram(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     PlatDispatch->DatapathBindingFreeSendBuffer(SendContext, Datagram);
 #else
-    QuicPoolFree(&SendContext->Owner->SendBufferPool, Datagram->Buffer);
-    Datagram->Buffer = NULL;
+    //
+    // This must be the final send buffer; intermediate buffers cannot be freed.
+    //
+    QUIC_BUFFER* TailBuffer = &SendContext->Buffers[SendContext->BufferCount - 1];
 
-    QUIC_DBG_ASSERT(Datagram == &SendContext->Buffers[SendContext->BufferCount - 1]);
+    if (SendContext->SegmentSize == 0) {
+        QUIC_DBG_ASSERT(Datagram == TailBuffer);
 
-    --SendContext->BufferCount;
+        QuicPoolFree(
+            SendContext->BufferPools[SendContext->BufferCount - 1],
+            Datagram->Buffer);
+        Datagram->Buffer = NULL;
+        --SendContext->BufferCount;
+    } else {
+        QUIC_DBG_ASSERT(Datagram == &SendContext->ClientBuffer);
+        QUIC_DBG_ASSERT(Datagram->Buffer == TailBuffer->Buffer + TailBuffer->Length);
+
+        if (TailBuffer->Length == 0) {
+            QuicPoolFree(
+                SendContext->BufferPools[SendContext->BufferCount - 1],
+                TailBuffer->Buffer);
+            TailBuffer->Buffer = NULL;
+            --SendContext->BufferCount;
+        }
+
+        SendContext->ClientBuffer.Buffer = NULL;
+        SendContext->ClientBuffer.Length = 0;
+    }
+#endif
+}
+
+void
+QuicDataPathBindingSetSendDepartureTime(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ QUIC_BUFFER* SendDatagram,
+    _In_ uint64_t DepartureTime
+    )
+{
+#ifdef QUIC_PLATFORM_DISPATCH_TABLE
+    PlatDispatch->DatapathBindingSetSendDepartureTime(
+        SendContext,
+        SendDatagram,
+        DepartureTime);
+#else
+    QUIC_DATAPATH* Datapath = SendContext->Owner->Datapath;
+    QUIC_DBG_ASSERT(Datapath->Features & QUIC_DATAPATH_FEATURE_SEND_DEPARTURE_TIME);
+    QUIC_DBG_ASSERT(SendContext->BufferCount > 0);
+    const size_t TailIndex = SendContext->BufferCount - 1;
+
+    if (SendContext->SegmentSize == 0) {
+        QUIC_DBG_ASSERT(SendDatagram == &SendContext->Buffers[TailIndex]);
+        SendContext->DepartureTimes[TailIndex] = DepartureTime;
+        return;
+    }
+
+    QUIC_DBG_ASSERT(SendDatagram == &SendContext->ClientBuffer);
+    UNREFERENCED_PARAMETER(SendDatagram);
+
+    if (SendContext->Buffers[TailIndex].Length == 0) {
+        //
+        // This is the first segment of the buffer, so the whole buffer
+        // departs at its time.
+        //
+        SendContext->DepartureTimes[TailIndex] = DepartureTime;
+
+    } else if (DepartureTime >
+                SendContext->DepartureTimes[TailIndex] + QUIC_GSO_DEPARTURE_TIME_SLACK_US &&
+               SendContext->BufferCount < Datapath->MaxSendBatchSize) {
+        //
+        // The datagram should leave too long after the buffer's earlier
+        // segments. Nothing has been written to it yet, so just move it to the
+        // start of a new buffer. If that isn't possible, it goes out early.
+        //
+        QUIC_BUFFER* Buffer =
+            QuicSendContextAllocBuffer(
+                SendContext, &SendContext->Owner->LargeSendBufferPool);
+        if (Buffer != NULL) {
+            Buffer->Length = 0;
+            SendContext->ClientBuffer.Buffer = Buffer->Buffer;
+            SendContext->DepartureTimes[TailIndex + 1] = DepartureTime;
+        }
+    }
 #endif
 }
 
@@ -1993,7 +2887,7 @@ QuicDataPathBindingSend(
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
     QUIC_SOCKET_CONTEXT* SocketContext = NULL;
     QUIC_DATAPATH_PROC_CONTEXT* ProcContext = NULL;
-    ssize_t SentByteCount = 0;
+    int SentMessageCount = 0;
     QUIC_ADDR MappedRemoteAddress = {0};
     struct cmsghdr *CMsg = NULL;
     struct in_pktinfo *PktInfo = NULL;
@@ -2001,10 +2895,26 @@ QuicDataPathBindingSend(
     BOOLEAN SendPending = FALSE;
 
     static_assert(CMSG_SPACE(sizeof(struct in6_pktinfo)) >= CMSG_SPACE(sizeof(struct in_pktinfo)), "sizeof(struct in6_pktinfo) >= sizeof(struct in_pktinfo) failed");
-    char ControlBuffer[CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))] = {0};
+    char ControlBuffer[
+        CMSG_SPACE(sizeof(struct in6_pktinfo)) +   // IP_PKTINFO
+        CMSG_SPACE(sizeof(int)) +                  // IP_TOS
+        CMSG_SPACE(sizeof(uint16_t))               // UDP_SEGMENT
+        ] = {0};
+    struct mmsghdr Mhdrs[QUIC_MAX_BATCH_SEND];
+    char TxTimeControlBuffers[QUIC_MAX_BATCH_SEND][
+        sizeof(ControlBuffer) +
+        CMSG_SPACE(sizeof(uint64_t))               // SCM_TXTIME
+        ] __attribute__((aligned(sizeof(size_t))));
 
     QUIC_DBG_ASSERT(Binding != NULL && RemoteAddress != NULL && SendContext != NULL);
 
+    if (SendContext->BufferCount == 0) {
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    QuicSendContextFinalizeSendBuffer(SendContext, TRUE);
+
     SocketContext = &Binding->SocketContexts[QuicProcCurrentNumber()];
     ProcContext = &Binding->Datapath->ProcContexts[QuicProcCurrentNumber()];
 
@@ -2021,7 +2931,8 @@ QuicDataPathBindingSend(
         Binding,
         TotalSize,
         SendContext->BufferCount,
-        SendContext->Buffers[0].Length,
+        SendContext->SegmentSize > 0 ?
+            SendContext->SegmentSize : SendContext->Buffers[0].Length,
         CLOG_BYTEARRAY(sizeof(*RemoteAddress), RemoteAddress),
         CLOG_BYTEARRAY(sizeof(*LocalAddress), LocalAddress));
 
@@ -2034,11 +2945,15 @@ QuicDataPathBindingSend(
         MappedRemoteAddress.Ipv6.sin6_family = AF_INET6;
     }
 
+    //
+    // All the datagrams in the batch share the same addresses and ECN marking,
+    // so build the ancillary data once and reference it from every message.
+    //
     struct msghdr Mhdr = {
         .msg_name = &MappedRemoteAddress,
         .msg_namelen = sizeof(MappedRemoteAddress),
-        .msg_iov = SendContext->Iovs,
-        .msg_iovlen = SendContext->BufferCount,
+        .msg_iov = NULL,
+        .msg_iovlen = 1,
         .msg_control = ControlBuffer,
         .msg_controllen = CMSG_SPACE(sizeof(int)),
         .msg_flags = 0
@@ -2072,33 +2987,90 @@ QuicDataPathBindingSend(
         }
     }
 
-    SentByteCount = sendmsg(SocketContext->SocketFd, &Mhdr, 0);
+    if (SendContext->SegmentSize > 0) {
+        //
+        // Each buffer holds multiple back-to-back datagrams of SegmentSize
+        // bytes (the last may be shorter). Let the kernel split them.
+        //
+        Mhdr.msg_controllen += CMSG_SPACE(sizeof(uint16_t));
+        CMsg = CMSG_NXTHDR(&Mhdr, CMsg);
+        QUIC_DBG_ASSERT(CMsg != NULL);
+        CMsg->cmsg_level = SOL_UDP;
+        CMsg->cmsg_type = UDP_SEGMENT;
+        CMsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        *(uint16_t*)CMSG_DATA(CMsg) = SendContext->SegmentSize;
+    }
 
-    if (SentByteCount < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            Status =
-                QuicSocketContextPendSend(
-                    SocketContext,
-                    SendContext,
-                    ProcContext,
-                    LocalAddress,
-                    RemoteAddress);
-            if (QUIC_FAILED(Status)) {
+    //
+    // The end of the last control message. This may be short of
+    // msg_controllen, since the space reserved for the packet info is sized
+    // for IPv6.
+    //
+    const size_t ControlLength =
+        (size_t)((char*)CMsg - ControlBuffer) + CMSG_ALIGN(CMsg->cmsg_len);
+
+    for (size_t i = SendContext->CurrentIndex; i < SendContext->BufferCount; ++i) {
+        Mhdrs[i].msg_hdr = Mhdr;
+        Mhdrs[i].msg_hdr.msg_iov = &SendContext->Iovs[i];
+        Mhdrs[i].msg_len = 0;
+
+        if (SendContext->DepartureTimes[i] != 0) {
+            //
+            // The departure time differs per message, so the message gets its
+            // own copy of the shared ancillary data with the time appended.
+            //
+            QuicCopyMemory(TxTimeControlBuffers[i], ControlBuffer, ControlLength);
+            Mhdrs[i].msg_hdr.msg_control = TxTimeControlBuffers[i];
+            Mhdrs[i].msg_hdr.msg_controllen = ControlLength + CMSG_SPACE(sizeof(uint64_t));
+            CMsg = (struct cmsghdr*)(TxTimeControlBuffers[i] + ControlLength);
+            CMsg->cmsg_level = SOL_SOCKET;
+            CMsg->cmsg_type = SCM_TXTIME;
+            CMsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+            *(uint64_t*)CMSG_DATA(CMsg) = SendContext->DepartureTimes[i] * 1000; // Nanoseconds
+        }
+    }
+
+    //
+    // Hand the whole batch to the kernel in as few calls as possible. The
+    // kernel may accept only part of the batch, in which case we continue from
+    // where it left off.
+    //
+    while (SendContext->CurrentIndex < SendContext->BufferCount) {
+        SentMessageCount =
+            sendmmsg(
+                SocketContext->SocketFd,
+                &Mhdrs[SendContext->CurrentIndex],
+                (unsigned int)(SendContext->BufferCount - SendContext->CurrentIndex),
+                0);
+
+        if (SentMessageCount < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                Status =
+                    QuicSocketContextPendSend(
+                        SocketContext,
+                        SendContext,
+                        ProcContext,
+                        LocalAddress,
+                        RemoteAddress);
+                if (QUIC_FAILED(Status)) {
+                    goto Exit;
+                }
+
+                SendPending = TRUE;
+                goto Exit;
+            } else {
+                Status = errno;
+                QuicTraceEvent(
+                    DatapathErrorStatus,
+                    "[ udp][%p] ERROR, %u, %s.",
+                    SocketContext->Binding,
+                    Status,
+                    "sendmmsg failed");
                 goto Exit;
             }
-
-            SendPending = TRUE;
-            goto Exit;
-        } else {
-            Status = errno;
-            QuicTraceEvent(
-                DatapathErrorStatus,
-                "[ udp][%p] ERROR, %u, %s.",
-                SocketContext->Binding,
-                Status,
-                "sendmsg failed");
-            goto Exit;
         }
+
+        SendContext->CurrentIndex += (size_t)SentMessageCount;
     }
 
     Status = QUIC_STATUS_SUCCESS;
@@ -2137,6 +3109,75 @@ QuicDataPathBindingGetLocalMtu(
     })
 #endif
 
+//
+// Runs the execution contexts that are ready or have reached their next time,
+// and returns the epoll wait timeout (in milliseconds) until one of them needs
+// to run again.
+//
+int
+QuicProcessorContextRunExecutionContexts(
+    _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext
+    )
+{
+    if (ProcContext->PendingExecutionContexts != NULL) {
+        QuicLockAcquire(&ProcContext->PendingLock);
+        QUIC_EXECUTION_CONTEXT* NewExecutionContexts =
+            ProcContext->PendingExecutionContexts;
+        ProcContext->PendingExecutionContexts = NULL;
+        QuicLockRelease(&ProcContext->PendingLock);
+
+        while (NewExecutionContexts != NULL) {
+            QUIC_EXECUTION_CONTEXT* ExecutionContext = NewExecutionContexts;
+            NewExecutionContexts = ExecutionContext->Next;
+            ExecutionContext->Next = ProcContext->ExecutionContexts;
+            ProcContext->ExecutionContexts = ExecutionContext;
+        }
+    }
+
+    if (ProcContext->ExecutionContexts == NULL) {
+        return -1;
+    }
+
+    uint64_t TimeNow = QuicTimeUs64();
+    uint64_t NextTimeUs = UINT64_MAX;
+
+    QUIC_EXECUTION_CONTEXT** Link = &ProcContext->ExecutionContexts;
+    while (*Link != NULL) {
+        QUIC_EXECUTION_CONTEXT* ExecutionContext = *Link;
+        if (ExecutionContext->Ready || ExecutionContext->NextTimeUs <= TimeNow) {
+            //
+            // N.B. Ready must be cleared before running the context, so that a
+            // wake racing with the run isn't lost.
+            //
+            ExecutionContext->Ready = FALSE;
+            QUIC_EXECUTION_CONTEXT* Next = ExecutionContext->Next;
+            if (!ExecutionContext->Run(ExecutionContext, TimeNow)) {
+                *Link = Next; // The context may be freed already.
+                continue;
+            }
+        }
+
+        if (ExecutionContext->Ready) {
+            NextTimeUs = 0;
+        } else if (ExecutionContext->NextTimeUs < NextTimeUs) {
+            NextTimeUs = ExecutionContext->NextTimeUs;
+        }
+        Link = &ExecutionContext->Next;
+    }
+
+    if (NextTimeUs == UINT64_MAX) {
+        return -1;
+    }
+
+    TimeNow = QuicTimeUs64();
+    if (NextTimeUs <= TimeNow) {
+        return 0;
+    }
+
+    const uint64_t TimeoutMs = US_TO_MS(NextTimeUs - TimeNow + 999);
+    return TimeoutMs > INT32_MAX ? INT32_MAX : (int)TimeoutMs;
+}
+
 void*
 QuicDataPathWorkerThread(
     _In_ void* Context
@@ -2150,27 +3191,37 @@ QuicDataPathWorkerThread(
         "[ udp][%p] Worker start",
         ProcContext);
 
+    ProcContext->ThreadID = QuicCurThreadID();
+
     const size_t EpollEventCtMax = 16; // TODO: Experiment.
     struct epoll_event EpollEvents[EpollEventCtMax];
 
     while (!ProcContext->Datapath->Shutdown) {
+        //
+        // Any execution contexts run before waiting, so that the work queued by
+        // the last batch of receives is processed right away, on this thread.
+        //
+        int Timeout = QuicProcessorContextRunExecutionContexts(ProcContext);
+
         int ReadyEventCount =
             TEMP_FAILURE_RETRY(
                 epoll_wait(
                     ProcContext->EpollFd,
                     EpollEvents,
                     EpollEventCtMax,
-                    -1));
+                    Timeout));
 
         QUIC_FRE_ASSERT(ReadyEventCount >= 0);
         for (int i = 0; i < ReadyEventCount; i++) {
             if (EpollEvents[i].data.ptr == NULL) {
                 //
-                // The processor context is shutting down and the worker thread
-                // needs to clean up.
+                // The event FD is signaled when the processor context is
+                // shutting down, a socket context needs to be cleaned up or an
+                // execution context needs to run.
                 //
-                QUIC_DBG_ASSERT(ProcContext->Datapath->Shutdown);
-                break;
+                eventfd_t Value;
+                eventfd_read(ProcContext->EventFd, &Value);
+                continue;
             }
 
             QuicSocketContextProcessEvents(
@@ -2178,6 +3229,8 @@ QuicDataPathWorkerThread(
                 ProcContext,
                 EpollEvents[i].events);
         }
+
+        QuicProcessorContextProcessCleanups(ProcContext);
     }
 
     QuicTraceLogInfo(
@@ -2196,6 +3249,6 @@ QuicDataPathBindingIsSendContextFull(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathBindingIsSendContextFull(SendContext);
 #else
-    return SendContext->BufferCount == SendContext->Owner->Datapath->MaxSendBatchSize;
+    return !QuicSendContextCanAllocSend(SendContext, SendContext->SegmentSize);
 #endif
 }
@@ -852,6 +852,47 @@ QuicDataPathIsPaddingPreferred(
     return !!(Datapath->Features & QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION);
 }
 
+//
+// This datapath doesn't have QUIC_DATAPATH_FEATURE_EXECUTION_CONTEXTS, so the
+// execution context functions are never called.
+//
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicDataPathAddExecutionContext(
+    _In_ QUIC_DATAPATH* Datapath,
+    _In_ uint32_t Index,
+    _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    )
+{
+    UNREFERENCED_PARAMETER(Datapath);
+    UNREFERENCED_PARAMETER(Index);
+    UNREFERENCED_PARAMETER(ExecutionContext);
+    QUIC_DBG_ASSERT(FALSE);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicDataPathWakeExecutionContext(
+    _In_ QUIC_EXECUTION_CONTEXT* ExecutionContext
+    )
+{
+    UNREFERENCED_PARAMETER(ExecutionContext);
+    QUIC_FRE_ASSERT(FALSE);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicDataPathIsExecutionContextThread(
+    _In_ const QUIC_EXECUTION_CONTEXT* ExecutionContext
+    )
+{
+    UNREFERENCED_PARAMETER(ExecutionContext);
+    QUIC_FRE_ASSERT(FALSE);
+    return FALSE;
+}
+
 void
 QuicDataPathPopulateTargetAddress(
     _In_ ADDRESS_FAMILY Family,
@@ -1046,7 +1087,7 @@ QuicDataPathBindingCreate(
     } else {
         Binding->LocalAddress.si_family = QUIC_ADDRESS_FAMILY_INET6;
     }
-    Binding->Mtu = QUIC_MAX_MTU;
+    Binding->Mtu = QUIC_ETHERNET_MTU;
     QuicRundownAcquire(&Datapath->BindingsRundown);
 
     for (uint16_t i = 0; i < SocketCount; i++) {
@@ -2395,7 +2436,7 @@ QuicDataPathBindingAllocSendDatagram(
 {
     QUIC_DBG_ASSERT(SendContext != NULL);
     QUIC_DBG_ASSERT(MaxBufferLength > 0);
-    QUIC_DBG_ASSERT(MaxBufferLength <= QUIC_MAX_MTU - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE);
+    QUIC_DBG_ASSERT(MaxBufferLength <= MAX_UDP_PAYLOAD_LENGTH);
 
     QuicSendContextFinalizeSendBuffer(SendContext, FALSE);
 
@@ -2442,6 +2483,24 @@ QuicDataPathBindingFreeSendDatagram(
     }
 }
 
+//
+// This datapath doesn't have QUIC_DATAPATH_FEATURE_SEND_DEPARTURE_TIME, so this
+// is never called.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicDataPathBindingSetSendDepartureTime(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ QUIC_BUFFER* SendDatagram,
+    _In_ uint64_t DepartureTime
+    )
+{
+    UNREFERENCED_PARAMETER(SendContext);
+    UNREFERENCED_PARAMETER(SendDatagram);
+    UNREFERENCED_PARAMETER(DepartureTime);
+    QUIC_DBG_ASSERT(FALSE);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicDataPathBindingIsSendContextFull(
@@ -119,6 +119,28 @@ InterlockedIncrement64(
     _Inout_ _Interlocked_operand_ int64_t volatile *Addend
     );
 
+long
+ReadAcquire(
+    _In_ long const volatile *Source
+    );
+
+void
+WriteRelease(
+    _Out_ long volatile *Destination,
+    _In_ long Value
+    );
+
+void*
+ReadPointerAcquire(
+    _In_ void* const volatile *Source
+    );
+
+void
+WritePointerRelease(
+    _Out_ void* volatile *Destination,
+    _In_ void* Value
+    );
+
 _Must_inspect_result_
 _Success_(return != 0)
 BOOLEAN
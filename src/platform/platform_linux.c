@@ -200,6 +200,94 @@ QuicFree(
 #endif
 }
 
+#ifndef QUIC_PLATFORM_DISPATCH_TABLE
+
+QUIC_STATIC_ASSERT(
+    (QUIC_POOL_DEPOT_DEPTH & (QUIC_POOL_DEPOT_DEPTH - 1)) == 0,
+    "Depot depth must be a power of 2");
+QUIC_STATIC_ASSERT(
+    QUIC_POOL_MAX_CPU_CACHE_COUNT * QUIC_POOL_CPU_CACHE_DEPTH + QUIC_POOL_DEPOT_DEPTH <=
+        QUIC_POOL_MAXIMUM_DEPTH,
+    "Pools must not retain more than QUIC_POOL_MAXIMUM_DEPTH free entries");
+
+//
+// The depot is a bounded MPMC queue: each cell carries a sequence number that
+// tells producers and consumers whether the cell is free for the current lap,
+// which makes it immune to ABA without requiring double-width CAS.
+//
+
+static
+BOOLEAN
+QuicPoolDepotPush(
+    _Inout_ QUIC_POOL* Pool,
+    _In_ void* Entry
+    )
+{
+    size_t Pos = __atomic_load_n(&Pool->DepotEnqueuePos, __ATOMIC_RELAXED);
+    while (TRUE) {
+        QUIC_POOL_DEPOT_CELL* Cell = &Pool->Depot[Pos & (QUIC_POOL_DEPOT_DEPTH - 1)];
+        size_t Sequence = __atomic_load_n(&Cell->Sequence, __ATOMIC_ACQUIRE);
+        intptr_t Diff = (intptr_t)Sequence - (intptr_t)Pos;
+        if (Diff == 0) {
+            if (__atomic_compare_exchange_n(
+                    &Pool->DepotEnqueuePos, &Pos, Pos + 1,
+                    TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                Cell->Entry = Entry;
+                __atomic_store_n(&Cell->Sequence, Pos + 1, __ATOMIC_RELEASE);
+                return TRUE;
+            }
+        } else if (Diff < 0) {
+            return FALSE; // Full.
+        } else {
+            Pos = __atomic_load_n(&Pool->DepotEnqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static
+void*
+QuicPoolDepotPop(
+    _Inout_ QUIC_POOL* Pool
+    )
+{
+    size_t Pos = __atomic_load_n(&Pool->DepotDequeuePos, __ATOMIC_RELAXED);
+    while (TRUE) {
+        QUIC_POOL_DEPOT_CELL* Cell = &Pool->Depot[Pos & (QUIC_POOL_DEPOT_DEPTH - 1)];
+        size_t Sequence = __atomic_load_n(&Cell->Sequence, __ATOMIC_ACQUIRE);
+        intptr_t Diff = (intptr_t)Sequence - (intptr_t)(Pos + 1);
+        if (Diff == 0) {
+            if (__atomic_compare_exchange_n(
+                    &Pool->DepotDequeuePos, &Pos, Pos + 1,
+                    TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                void* Entry = Cell->Entry;
+                __atomic_store_n(
+                    &Cell->Sequence, Pos + QUIC_POOL_DEPOT_DEPTH, __ATOMIC_RELEASE);
+                return Entry;
+            }
+        } else if (Diff < 0) {
+            return NULL; // Empty.
+        } else {
+            Pos = __atomic_load_n(&Pool->DepotDequeuePos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static
+QUIC_POOL_CPU_CACHE*
+QuicPoolGetCpuCache(
+    _In_ QUIC_POOL* Pool
+    )
+{
+    //
+    // The processor number may be stale by the time the cache is used, but
+    // all cache slots are accessed atomically so that is only a performance
+    // concern.
+    //
+    return &Pool->CpuCaches[QuicProcCurrentNumber() % Pool->CpuCacheCount];
+}
+
+#endif // QUIC_PLATFORM_DISPATCH_TABLE
+
 void
 QuicPoolInitialize(
     _In_ BOOLEAN IsPaged,
@@ -212,8 +300,46 @@ QuicPoolInitialize(
     PlatDispatch->PoolInitialize(IsPaged, Size, Pool);
 #else
     UNREFERENCED_PARAMETER(IsPaged);
+    QuicZeroMemory(Pool, sizeof(*Pool));
     Pool->Size = Size;
     Pool->MemTag = Tag;
+
+    uint32_t CpuCacheCount = QuicProcMaxCount();
+    if (CpuCacheCount > QUIC_POOL_MAX_CPU_CACHE_COUNT) {
+        CpuCacheCount = QUIC_POOL_MAX_CPU_CACHE_COUNT;
+    }
+    size_t AllocationSize =
+        QUIC_CACHE_LINE_SIZE - 1 +
+        CpuCacheCount * sizeof(QUIC_POOL_CPU_CACHE) +
+        QUIC_POOL_DEPOT_DEPTH * sizeof(QUIC_POOL_DEPOT_CELL);
+
+    Pool->Allocation = QuicAlloc(AllocationSize, Tag);
+    if (Pool->Allocation == NULL) {
+        //
+        // Not fatal; the pool just degrades to the system allocator.
+        //
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "QUIC_POOL caches",
+            AllocationSize);
+        return;
+    }
+
+    QUIC_POOL_CPU_CACHE* CpuCaches =
+        (QUIC_POOL_CPU_CACHE*)
+            (((uintptr_t)Pool->Allocation + QUIC_CACHE_LINE_SIZE - 1) &
+             ~(uintptr_t)(QUIC_CACHE_LINE_SIZE - 1));
+    QuicZeroMemory(CpuCaches, CpuCacheCount * sizeof(QUIC_POOL_CPU_CACHE));
+
+    Pool->Depot = (QUIC_POOL_DEPOT_CELL*)(CpuCaches + CpuCacheCount);
+    for (size_t i = 0; i < QUIC_POOL_DEPOT_DEPTH; ++i) {
+        Pool->Depot[i].Sequence = i;
+        Pool->Depot[i].Entry = NULL;
+    }
+
+    Pool->CpuCaches = CpuCaches;
+    Pool->CpuCacheCount = CpuCacheCount;
 #endif
 }
 
@@ -225,7 +351,27 @@ QuicPoolUninitialize(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     PlatDispatch->PoolUninitialize(Pool);
 #else
-    UNREFERENCED_PARAMETER(Pool);
+    if (Pool->CpuCaches == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < Pool->CpuCacheCount; ++i) {
+        for (uint32_t j = 0; j < QUIC_POOL_CPU_CACHE_DEPTH; ++j) {
+            if (Pool->CpuCaches[i].Entries[j] != NULL) {
+                QuicFree(Pool->CpuCaches[i].Entries[j], Pool->MemTag);
+            }
+        }
+    }
+
+    void* Entry;
+    while ((Entry = QuicPoolDepotPop(Pool)) != NULL) {
+        QuicFree(Entry, Pool->MemTag);
+    }
+
+    QuicFree(Pool->Allocation, Pool->MemTag);
+    Pool->Allocation = NULL;
+    Pool->CpuCaches = NULL;
+    Pool->Depot = NULL;
 #endif
 }
 
@@ -237,13 +383,28 @@ QuicPoolAlloc(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->PoolAlloc(Pool);
 #else
-    void*Entry = QuicAlloc(Pool->Size, Pool->MemTag);
+    if (Pool->CpuCaches == NULL) {
+        return QuicAlloc(Pool->Size, Pool->MemTag);
+    }
+
+    QUIC_POOL_CPU_CACHE* Cache = QuicPoolGetCpuCache(Pool);
+    void* Entry = NULL;
+
+    for (uint32_t i = 0; i < QUIC_POOL_CPU_CACHE_DEPTH; ++i) {
+        if (__atomic_load_n(&Cache->Entries[i], __ATOMIC_RELAXED) != NULL) {
+            Entry = __atomic_exchange_n(&Cache->Entries[i], NULL, __ATOMIC_ACQUIRE);
+            if (Entry != NULL) {
+                return Entry;
+            }
+        }
+    }
 
+    Entry = QuicPoolDepotPop(Pool);
     if (Entry != NULL) {
-        QuicZeroMemory(Entry, Pool->Size);
+        return Entry;
     }
 
-    return Entry;
+    return QuicAlloc(Pool->Size, Pool->MemTag);
 #endif
 }
 
@@ -256,8 +417,26 @@ QuicPoolFree(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     PlatDispatch->PoolFree(Pool, Entry);
 #else
-    UNREFERENCED_PARAMETER(Pool);
-    QuicFree(Entry, Pool->MemTag);
+    if (Pool->CpuCaches == NULL) {
+        QuicFree(Entry, Pool->MemTag);
+        return;
+    }
+
+    QUIC_POOL_CPU_CACHE* Cache = QuicPoolGetCpuCache(Pool);
+
+    for (uint32_t i = 0; i < QUIC_POOL_CPU_CACHE_DEPTH; ++i) {
+        void* Expected = NULL;
+        if (__atomic_load_n(&Cache->Entries[i], __ATOMIC_RELAXED) == NULL &&
+            __atomic_compare_exchange_n(
+                &Cache->Entries[i], &Expected, Entry,
+                FALSE, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+
+    if (!QuicPoolDepotPush(Pool, Entry)) {
+        QuicFree(Entry, Pool->MemTag);
+    }
 #endif
 }
 
@@ -82,10 +82,11 @@ typedef struct QUIC_TLS {
     QUIC_TLS_RESULT_FLAGS ResultFlags;
 
     //
-    // Callback context and handler for QUIC TP.
+    // Callback context and handlers for QUIC TP and resumption tickets.
     //
     QUIC_CONNECTION* Connection;
     QUIC_TLS_RECEIVE_TP_CALLBACK_HANDLER ReceiveTPCallback;
+    QUIC_TLS_RECEIVE_TICKET_CALLBACK_HANDLER ReceiveResumptionCallback;
 
 #ifdef QUIC_TLS_SECRETS_SUPPORT
     //
@@ -237,46 +238,70 @@ QuicTlsSetEncryptionSecretsCallback(
 
     QUIC_SECRET Secret;
     QuicTlsNegotiatedCiphers(TlsContext, &Secret.Aead, &Secret.Hash);
-    QuicCopyMemory(Secret.Secret, WriteSecret, SecretLen);
 
-    QUIC_DBG_ASSERT(TlsState->WriteKeys[KeyType] == NULL);
-    Status =
-        QuicPacketKeyDerive(
-            KeyType,
-            &Secret,
-            "write secret",
-            TRUE,
-            &TlsState->WriteKeys[KeyType]);
-    if (QUIC_FAILED(Status)) {
-        TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
-        return -1;
-    }
+    //
+    // Early data only has a write secret on the client and a read secret on
+    // the server.
+    //
+    if (WriteSecret != NULL) {
+        QuicCopyMemory(Secret.Secret, WriteSecret, SecretLen);
 
-    TlsState->WriteKey = KeyType;
-    TlsContext->ResultFlags |= QUIC_TLS_RESULT_WRITE_KEY_UPDATED;
-    QuicCopyMemory(Secret.Secret, ReadSecret, SecretLen);
+        QUIC_DBG_ASSERT(TlsState->WriteKeys[KeyType] == NULL);
+        Status =
+            QuicPacketKeyDerive(
+                KeyType,
+                &Secret,
+                "write secret",
+                TRUE,
+                &TlsState->WriteKeys[KeyType]);
+        if (QUIC_FAILED(Status)) {
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
+            return -1;
+        }
 
-    QUIC_DBG_ASSERT(TlsState->ReadKeys[KeyType] == NULL);
-    Status =
-        QuicPacketKeyDerive(
-            KeyType,
-            &Secret,
-            "read secret",
-            TRUE,
-            &TlsState->ReadKeys[KeyType]);
-    if (QUIC_FAILED(Status)) {
-        TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
-        return -1;
+        TlsState->WriteKey = KeyType;
+        TlsContext->ResultFlags |= QUIC_TLS_RESULT_WRITE_KEY_UPDATED;
     }
 
-    if (TlsContext->IsServer && KeyType == QUIC_PACKET_KEY_1_RTT) {
-        //
-        // The 1-RTT read keys aren't actually allowed to be used until the
-        // handshake completes.
-        //
-    } else {
-        TlsState->ReadKey = KeyType;
-        TlsContext->ResultFlags |= QUIC_TLS_RESULT_READ_KEY_UPDATED;
+    if (ReadSecret != NULL) {
+        QuicCopyMemory(Secret.Secret, ReadSecret, SecretLen);
+
+        QUIC_DBG_ASSERT(TlsState->ReadKeys[KeyType] == NULL);
+        Status =
+            QuicPacketKeyDerive(
+                KeyType,
+                &Secret,
+                "read secret",
+                TRUE,
+                &TlsState->ReadKeys[KeyType]);
+        if (QUIC_FAILED(Status)) {
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
+            return -1;
+        }
+
+        if (KeyType == QUIC_PACKET_KEY_0_RTT) {
+            //
+            // The server only gets the 0-RTT read secret if it accepted the
+            // client's early data. The read key doesn't change though, as the
+            // handshake secrets immediately follow.
+            //
+            QUIC_DBG_ASSERT(TlsContext->IsServer);
+            QuicTraceLogConnInfo(
+                OpenSslEarlyDataAccepted,
+                TlsContext->Connection,
+                "Early data accepted");
+            TlsState->EarlyDataState = QUIC_TLS_EARLY_DATA_ACCEPTED;
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_EARLY_DATA_ACCEPT;
+
+        } else if (TlsContext->IsServer && KeyType == QUIC_PACKET_KEY_1_RTT) {
+            //
+            // The 1-RTT read keys aren't actually allowed to be used until the
+            // handshake completes.
+            //
+        } else {
+            TlsState->ReadKey = KeyType;
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_READ_KEY_UPDATED;
+        }
     }
 #ifdef QUIC_TLS_SECRETS_SUPPORT
     if (TlsContext->TlsSecrets != NULL) {
@@ -480,6 +505,124 @@ QuicTlsClientHelloCallback(
     return SSL_CLIENT_HELLO_SUCCESS;
 }
 
+//
+// Called on the client when a new session ticket has been received from the
+// server. The session is serialized and passed up to QUIC, which wraps it (along
+// with the server's transport parameters) in the resumption ticket indicated to
+// the app.
+//
+int
+QuicTlsClientNewSessionCallback(
+    _In_ SSL *Ssl,
+    _In_ SSL_SESSION *Session
+    )
+{
+    QUIC_TLS* TlsContext = SSL_get_app_data(Ssl);
+
+    int Length = i2d_SSL_SESSION(Session, NULL);
+    if (Length <= 0 || Length > UINT16_MAX) {
+        QuicTraceEvent(
+            TlsError,
+            "[ tls][%p] ERROR, %s.",
+            TlsContext->Connection,
+            "i2d_SSL_SESSION failed");
+        return 0;
+    }
+
+    uint8_t* Ticket = QUIC_ALLOC_NONPAGED((size_t)Length, QUIC_POOL_TLS_RESUMPTION);
+    if (Ticket == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "Session ticket",
+            (uint64_t)Length);
+        return 0;
+    }
+
+    uint8_t* TicketEnd = Ticket;
+    Length = i2d_SSL_SESSION(Session, &TicketEnd);
+
+    QuicTraceLogConnInfo(
+        OpenSslReceivedTicket,
+        TlsContext->Connection,
+        "Received session ticket, %u bytes",
+        (uint32_t)Length);
+
+    (void)TlsContext->ReceiveResumptionCallback(
+        TlsContext->Connection,
+        (uint32_t)Length,
+        Ticket);
+
+    QUIC_FREE(Ticket, QUIC_POOL_TLS_RESUMPTION);
+
+    //
+    // Returning 0 indicates no reference to the session was kept.
+    //
+    return 0;
+}
+
+//
+// Called on the server when a client's session ticket has been decrypted. QUIC
+// validates the resumption state it placed in the ticket's app data, which
+// decides whether the session (and any early data) is resumed.
+//
+SSL_TICKET_RETURN
+QuicTlsServerDecryptTicketCallback(
+    _In_ SSL *Ssl,
+    _In_ SSL_SESSION *Session,
+    _In_reads_(KeyNameLength) const unsigned char *KeyName,
+    _In_ size_t KeyNameLength,
+    _In_ SSL_TICKET_STATUS Status,
+    _In_ void *Arg
+    )
+{
+    UNREFERENCED_PARAMETER(KeyName);
+    UNREFERENCED_PARAMETER(KeyNameLength);
+    UNREFERENCED_PARAMETER(Arg);
+
+    QUIC_TLS* TlsContext = SSL_get_app_data(Ssl);
+
+    switch (Status) {
+    case SSL_TICKET_SUCCESS:
+    case SSL_TICKET_SUCCESS_RENEW:
+        break;
+    case SSL_TICKET_FATAL_ERR_MALLOC:
+    case SSL_TICKET_FATAL_ERR_OTHER:
+        return SSL_TICKET_RETURN_ABORT;
+    default:
+        //
+        // No (usable) ticket. Do a full handshake.
+        //
+        return SSL_TICKET_RETURN_IGNORE;
+    }
+
+    void* AppData = NULL;
+    size_t AppDataLength = 0;
+    if (!SSL_SESSION_get0_ticket_appdata(Session, &AppData, &AppDataLength) ||
+        AppData == NULL ||
+        AppDataLength == 0 ||
+        AppDataLength > UINT16_MAX) {
+        QuicTraceLogConnInfo(
+            OpenSslTicketMissingAppData,
+            TlsContext->Connection,
+            "Ignoring session ticket without resumption state");
+        return SSL_TICKET_RETURN_IGNORE;
+    }
+
+    if (!TlsContext->ReceiveResumptionCallback(
+            TlsContext->Connection,
+            (uint32_t)AppDataLength,
+            (const uint8_t*)AppData)) {
+        QuicTraceLogConnInfo(
+            OpenSslTicketRejected,
+            TlsContext->Connection,
+            "Session ticket rejected");
+        return SSL_TICKET_RETURN_IGNORE;
+    }
+
+    return SSL_TICKET_RETURN_USE;
+}
+
 SSL_QUIC_METHOD OpenSslQuicCallbacks = {
     QuicTlsSetEncryptionSecretsCallback,
     QuicTlsAddHandshakeDataCallback,
@@ -636,6 +779,15 @@ QuicTlsSecConfigCreate(
     }
 
     if (CredConfig->Flags & QUIC_CREDENTIAL_FLAG_CLIENT) {
+        //
+        // Sessions aren't cached by OpenSSL. They are passed up to the app to
+        // cache as resumption tickets instead.
+        //
+        SSL_CTX_set_session_cache_mode(
+            SecurityConfig->SSLCtx,
+            SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(SecurityConfig->SSLCtx, QuicTlsClientNewSessionCallback);
+
         BOOLEAN VerifyServerCertificate = TRUE; // !(Flags & QUIC_CERTIFICATE_FLAG_DISABLE_CERT_VALIDATION);
         if (!VerifyServerCertificate) {
             SSL_CTX_set_verify(SecurityConfig->SSLCtx, SSL_VERIFY_PEER, NULL);
@@ -723,6 +875,37 @@ QuicTlsSecConfigCreate(
 
         SSL_CTX_set_max_early_data(SecurityConfig->SSLCtx, UINT32_MAX);
         SSL_CTX_set_client_hello_cb(SecurityConfig->SSLCtx, QuicTlsClientHelloCallback, NULL);
+
+        //
+        // Session tickets are only sent when the app asks for one, with the
+        // QUIC resumption state as the ticket's app data.
+        //
+        Ret = SSL_CTX_set_num_tickets(SecurityConfig->SSLCtx, 0);
+        if (Ret != 1) {
+            QuicTraceEvent(
+                LibraryErrorStatus,
+                "[ lib] ERROR, %u, %s.",
+                ERR_get_error(),
+                "SSL_CTX_set_num_tickets failed");
+            Status = QUIC_STATUS_TLS_ERROR;
+            goto Exit;
+        }
+
+        Ret =
+            SSL_CTX_set_session_ticket_cb(
+                SecurityConfig->SSLCtx,
+                NULL,
+                QuicTlsServerDecryptTicketCallback,
+                NULL);
+        if (Ret != 1) {
+            QuicTraceEvent(
+                LibraryErrorStatus,
+                "[ lib] ERROR, %u, %s.",
+                ERR_get_error(),
+                "SSL_CTX_set_session_ticket_cb failed");
+            Status = QUIC_STATUS_TLS_ERROR;
+            goto Exit;
+        }
     }
 
     //
@@ -790,6 +973,7 @@ QuicTlsInitialize(
     TlsContext->AlpnBufferLength = Config->AlpnBufferLength;
     TlsContext->AlpnBuffer = Config->AlpnBuffer;
     TlsContext->ReceiveTPCallback = Config->ReceiveTPCallback;
+    TlsContext->ReceiveResumptionCallback = Config->ReceiveResumptionCallback;
 #ifdef QUIC_TLS_SECRETS_SUPPORT
     TlsContext->TlsSecrets = Config->TlsSecrets;
 #endif
@@ -846,9 +1030,10 @@ QuicTlsInitialize(
 
     SSL_set_app_data(TlsContext->Ssl, TlsContext);
 
+    SSL_set_quic_early_data_enabled(TlsContext->Ssl, 1);
+
     if (Config->IsServer) {
         SSL_set_accept_state(TlsContext->Ssl);
-        //SSL_set_quic_early_data_enabled(TlsContext->Ssl, 1);
     } else {
         SSL_set_connect_state(TlsContext->Ssl);
         SSL_set_tlsext_host_name(TlsContext->Ssl, TlsContext->SNI);
@@ -869,7 +1054,48 @@ QuicTlsInitialize(
     }
     QUIC_FREE(Config->LocalTPBuffer, QUIC_POOL_TLS_TRANSPARAMS);
 
-    State->EarlyDataState = QUIC_TLS_EARLY_DATA_UNSUPPORTED; // 0-RTT not currently supported.
+    if (Config->IsServer) {
+        //
+        // Not known until the ClientHello is processed.
+        //
+        State->EarlyDataState = QUIC_TLS_EARLY_DATA_UNKNOWN;
+
+    } else {
+        State->EarlyDataState = QUIC_TLS_EARLY_DATA_UNSUPPORTED;
+
+        if (Config->ResumptionTicketBuffer != NULL) {
+            const uint8_t* Ticket = Config->ResumptionTicketBuffer;
+            SSL_SESSION* Session =
+                d2i_SSL_SESSION(NULL, &Ticket, (long)Config->ResumptionTicketLength);
+            if (Session == NULL || SSL_set_session(TlsContext->Ssl, Session) != 1) {
+                //
+                // Just do a full handshake instead.
+                //
+                QuicTraceEvent(
+                    TlsError,
+                    "[ tls][%p] ERROR, %s.",
+                    TlsContext->Connection,
+                    "Failed to use resumption ticket");
+            } else {
+                if (SSL_SESSION_get_max_early_data(Session) != 0) {
+                    //
+                    // Early data is attempted, but not known to be accepted
+                    // until the server responds.
+                    //
+                    State->EarlyDataState = QUIC_TLS_EARLY_DATA_UNKNOWN;
+                }
+                QuicTraceLogConnInfo(
+                    OpenSslUsingResumptionTicket,
+                    TlsContext->Connection,
+                    "Resuming session (early data = %hhu)",
+                    State->EarlyDataState == QUIC_TLS_EARLY_DATA_UNKNOWN);
+            }
+            if (Session != NULL) {
+                SSL_SESSION_free(Session);
+            }
+            QUIC_FREE(Config->ResumptionTicketBuffer, QUIC_POOL_TLS_RESUMPTION);
+        }
+    }
 
     *NewTlsContext = TlsContext;
     TlsContext = NULL;
@@ -984,14 +1210,63 @@ QuicTlsProcessData(
 
     QUIC_DBG_ASSERT(Buffer != NULL || *BufferLength == 0);
 
+    TlsContext->State = State;
+    TlsContext->ResultFlags = 0;
+
     if (DataType == QUIC_TLS_TICKET_DATA) {
-        TlsContext->ResultFlags = QUIC_TLS_RESULT_ERROR;
+        QUIC_DBG_ASSERT(TlsContext->IsServer);
+        QUIC_DBG_ASSERT(State->HandshakeComplete);
 
         QuicTraceLogConnVerbose(
-            OpenSsslIgnoringTicket,
+            OpenSslSendTicketData,
             TlsContext->Connection,
-            "Ignoring %u ticket bytes",
+            "Sending ticket with %u bytes of resumption state",
             *BufferLength);
+
+        //
+        // Store the QUIC resumption state in the session so that it's part of
+        // the new ticket, and then write the NewSessionTicket message.
+        //
+        SSL_SESSION* Session = SSL_get_session(TlsContext->Ssl);
+        if (Session == NULL) {
+            QuicTraceEvent(
+                TlsError,
+                "[ tls][%p] ERROR, %s.",
+                TlsContext->Connection,
+                "SSL_get_session failed");
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
+            goto Exit;
+        }
+
+        if (SSL_SESSION_set1_ticket_appdata(Session, Buffer, *BufferLength) != 1) {
+            QuicTraceEvent(
+                TlsError,
+                "[ tls][%p] ERROR, %s.",
+                TlsContext->Connection,
+                "SSL_SESSION_set1_ticket_appdata failed");
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
+            goto Exit;
+        }
+
+        if (SSL_new_session_ticket(TlsContext->Ssl) != 1) {
+            QuicTraceEvent(
+                TlsError,
+                "[ tls][%p] ERROR, %s.",
+                TlsContext->Connection,
+                "SSL_new_session_ticket failed");
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
+            goto Exit;
+        }
+
+        Ret = SSL_do_handshake(TlsContext->Ssl);
+        if (Ret != 1) {
+            QuicTraceLogConnError(
+                OpenSslTicketWriteError,
+                TlsContext->Connection,
+                "Failed to write session ticket: %d",
+                SSL_get_error(TlsContext->Ssl, Ret));
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
+        }
         goto Exit;
     }
 
@@ -1003,9 +1278,6 @@ QuicTlsProcessData(
             *BufferLength);
     }
 
-    TlsContext->State = State;
-    TlsContext->ResultFlags = 0;
-
     if (SSL_provide_quic_data(
             TlsContext->Ssl,
             (OSSL_ENCRYPTION_LEVEL)TlsContext->State->ReadKey,
@@ -1085,8 +1357,20 @@ QuicTlsProcessData(
             TlsContext->Connection,
             "Handshake complete");
         State->HandshakeComplete = TRUE;
+        State->SessionResumed = SSL_session_reused(TlsContext->Ssl) == 1;
         TlsContext->ResultFlags |= QUIC_TLS_RESULT_COMPLETE;
 
+        if (!TlsContext->IsServer &&
+            State->EarlyDataState == QUIC_TLS_EARLY_DATA_UNKNOWN) {
+            if (SSL_get_early_data_status(TlsContext->Ssl) == SSL_EARLY_DATA_ACCEPTED) {
+                State->EarlyDataState = QUIC_TLS_EARLY_DATA_ACCEPTED;
+                TlsContext->ResultFlags |= QUIC_TLS_RESULT_EARLY_DATA_ACCEPT;
+            } else {
+                State->EarlyDataState = QUIC_TLS_EARLY_DATA_REJECTED;
+                TlsContext->ResultFlags |= QUIC_TLS_RESULT_EARLY_DATA_REJECT;
+            }
+        }
+
         if (TlsContext->IsServer) {
             TlsContext->State->ReadKey = QUIC_PACKET_KEY_1_RTT;
             TlsContext->ResultFlags |= QUIC_TLS_RESULT_READ_KEY_UPDATED;
@@ -1113,37 +1397,31 @@ QuicTlsProcessData(
         }
     }
 
-    Ret = SSL_do_handshake(TlsContext->Ssl);
-    if (Ret != 1) {
-        Err = SSL_get_error(TlsContext->Ssl, Ret);
-        switch (Err) {
-        case SSL_ERROR_WANT_READ:
-        case SSL_ERROR_WANT_WRITE:
-            goto Exit;
-
-        case SSL_ERROR_SSL:
-            QuicTraceLogConnError(
-                OpenSslHandshakeErrorStr,
-                TlsContext->Connection,
-                "TLS handshake error: %s",
-                ERR_error_string(ERR_get_error(), NULL));
-            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
-            goto Exit;
-
-        default:
-            QuicTraceLogConnError(
-                OpenSslHandshakeError,
-                TlsContext->Connection,
-                "TLS handshake error: %d",
-                Err);
-            TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
-            goto Exit;
-        }
+    //
+    // Process any post-handshake messages, such as session tickets.
+    //
+    if (SSL_process_quic_post_handshake(TlsContext->Ssl) != 1) {
+        QuicTraceLogConnError(
+            OpenSslPostHandshakeErrorStr,
+            TlsContext->Connection,
+            "TLS post-handshake error: %s",
+            ERR_error_string(ERR_get_error(), NULL));
+        TlsContext->ResultFlags |= QUIC_TLS_RESULT_ERROR;
+        goto Exit;
     }
 
 Exit:
 
     if (!(TlsContext->ResultFlags & QUIC_TLS_RESULT_ERROR)) {
+        if (TlsContext->IsServer &&
+            State->EarlyDataState == QUIC_TLS_EARLY_DATA_UNKNOWN &&
+            State->WriteKeys[QUIC_PACKET_KEY_HANDSHAKE] != NULL) {
+            //
+            // The ClientHello was processed without accepting early data.
+            //
+            State->EarlyDataState = QUIC_TLS_EARLY_DATA_REJECTED;
+            TlsContext->ResultFlags |= QUIC_TLS_RESULT_EARLY_DATA_REJECT;
+        }
         if (State->WriteKeys[QUIC_PACKET_KEY_HANDSHAKE] != NULL &&
             State->BufferOffsetHandshake == 0) {
             State->BufferOffsetHandshake = State->BufferTotalLength;
@@ -74,6 +74,12 @@ struct DataRecvContext {
     QUIC_EVENT ClientCompletion;
 };
 
+struct DataBatchRecvContext {
+    QUIC_EVENT ServerCompletion;
+    volatile long ReceivedCount;
+    long ExpectedCount;
+};
+
 struct DataPathTest : public ::testing::TestWithParam<int32_t>
 {
 protected:
@@ -263,6 +269,32 @@ protected:
 
         QuicDataPathBindingReturnRecvDatagrams(recvBufferChain);
     }
+
+    static void
+    DataBatchRecvCallback(
+        _In_ QUIC_DATAPATH_BINDING* /* Binding */,
+        _In_ void * recvContext,
+        _In_ QUIC_RECV_DATAGRAM* recvBufferChain
+        )
+    {
+        DataBatchRecvContext* RecvContext = (DataBatchRecvContext*)recvContext;
+        ASSERT_NE(nullptr, RecvContext);
+
+        QUIC_RECV_DATAGRAM* recvBuffer = recvBufferChain;
+
+        while (recvBuffer != NULL) {
+            ASSERT_EQ(recvBuffer->BufferLength, ExpectedDataSize);
+            ASSERT_EQ(0, memcmp(recvBuffer->Buffer, ExpectedData, ExpectedDataSize));
+
+            if (InterlockedIncrement(&RecvContext->ReceivedCount) == RecvContext->ExpectedCount) {
+                QuicEventSet(RecvContext->ServerCompletion);
+            }
+
+            recvBuffer = recvBuffer->Next;
+        }
+
+        QuicDataPathBindingReturnRecvDatagrams(recvBufferChain);
+    }
 };
 
 volatile uint16_t DataPathTest::NextPort;
@@ -671,4 +703,385 @@ TEST_P(DataPathTest, DataECT0)
     QuicEventUninitialize(RecvContext.ClientCompletion);
 }
 
+TEST_P(DataPathTest, DataBatch)
+{
+    QUIC_DATAPATH* datapath = nullptr;
+    QUIC_DATAPATH_BINDING* server = nullptr;
+    QUIC_DATAPATH_BINDING* client = nullptr;
+    auto serverAddress = GetNewLocalAddr();
+
+    DataBatchRecvContext RecvContext = {};
+
+    QuicEventInitialize(&RecvContext.ServerCompletion, FALSE, FALSE);
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathInitialize(
+            0,
+            DataBatchRecvCallback,
+            EmptyUnreachableCallback,
+            &datapath));
+    ASSERT_NE(nullptr, datapath);
+
+    QUIC_STATUS Status = QUIC_STATUS_ADDRESS_IN_USE;
+    while (Status == QUIC_STATUS_ADDRESS_IN_USE) {
+        serverAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Status =
+            QuicDataPathBindingCreate(
+                datapath,
+                &serverAddress.SockAddr,
+                nullptr,
+                &RecvContext,
+                &server);
+#ifdef _WIN32
+        if (Status == HRESULT_FROM_WIN32(WSAEACCES)) {
+            Status = QUIC_STATUS_ADDRESS_IN_USE;
+            std::cout << "Replacing EACCESS with ADDRINUSE for port: " <<
+                htons(serverAddress.SockAddr.Ipv4.sin_port) << std::endl;
+        }
+#endif //_WIN32
+    }
+    VERIFY_QUIC_SUCCESS(Status);
+    ASSERT_NE(nullptr, server);
+    QUIC_ADDR ServerAddress;
+    QuicDataPathBindingGetLocalAddress(server, &ServerAddress);
+    ASSERT_NE(ServerAddress.Ipv4.sin_port, (uint16_t)0);
+    serverAddress.SetPort(ServerAddress.Ipv4.sin_port);
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathBindingCreate(
+            datapath,
+            nullptr,
+            &serverAddress.SockAddr,
+            &RecvContext,
+            &client));
+    ASSERT_NE(nullptr, client);
+
+    auto ClientSendContext =
+        QuicDataPathBindingAllocSendContext(client, QUIC_ECN_NON_ECT, ExpectedDataSize);
+    ASSERT_NE(nullptr, ClientSendContext);
+
+    //
+    // Fill the send context with as many datagrams as it will take (up to a
+    // reasonable limit) and send them all at once.
+    //
+    const long MaxDatagrams = 16;
+    while (RecvContext.ExpectedCount < MaxDatagrams &&
+           !QuicDataPathBindingIsSendContextFull(ClientSendContext)) {
+        auto ClientDatagram =
+            QuicDataPathBindingAllocSendDatagram(ClientSendContext, ExpectedDataSize);
+        ASSERT_NE(nullptr, ClientDatagram);
+        memcpy(ClientDatagram->Buffer, ExpectedData, ExpectedDataSize);
+        RecvContext.ExpectedCount++;
+    }
+    ASSERT_NE(0, RecvContext.ExpectedCount);
+
+    QUIC_ADDR ClientAddress;
+    QuicDataPathBindingGetLocalAddress(client, &ClientAddress);
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathBindingSend(
+            client,
+            &ClientAddress,
+            &serverAddress.SockAddr,
+            ClientSendContext));
+
+    ASSERT_TRUE(QuicEventWaitWithTimeout(RecvContext.ServerCompletion, 2000));
+
+    QuicDataPathBindingDelete(client);
+    QuicDataPathBindingDelete(server);
+
+    QuicDataPathUninitialize(
+        datapath);
+
+    QuicEventUninitialize(RecvContext.ServerCompletion);
+}
+
+TEST_P(DataPathTest, DataDepartureTime)
+{
+    QUIC_DATAPATH* datapath = nullptr;
+    QUIC_DATAPATH_BINDING* server = nullptr;
+    QUIC_DATAPATH_BINDING* client = nullptr;
+    auto serverAddress = GetNewLocalAddr();
+
+    DataBatchRecvContext RecvContext = {};
+
+    QuicEventInitialize(&RecvContext.ServerCompletion, FALSE, FALSE);
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathInitialize(
+            0,
+            DataBatchRecvCallback,
+            EmptyUnreachableCallback,
+            &datapath));
+    ASSERT_NE(nullptr, datapath);
+
+    QUIC_STATUS Status = QUIC_STATUS_ADDRESS_IN_USE;
+    while (Status == QUIC_STATUS_ADDRESS_IN_USE) {
+        serverAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Status =
+            QuicDataPathBindingCreate(
+                datapath,
+                &serverAddress.SockAddr,
+                nullptr,
+                &RecvContext,
+                &server);
+#ifdef _WIN32
+        if (Status == HRESULT_FROM_WIN32(WSAEACCES)) {
+            Status = QUIC_STATUS_ADDRESS_IN_USE;
+            std::cout << "Replacing EACCESS with ADDRINUSE for port: " <<
+                htons(serverAddress.SockAddr.Ipv4.sin_port) << std::endl;
+        }
+#endif //_WIN32
+    }
+    VERIFY_QUIC_SUCCESS(Status);
+    ASSERT_NE(nullptr, server);
+    QUIC_ADDR ServerAddress;
+    QuicDataPathBindingGetLocalAddress(server, &ServerAddress);
+    ASSERT_NE(ServerAddress.Ipv4.sin_port, (uint16_t)0);
+    serverAddress.SetPort(ServerAddress.Ipv4.sin_port);
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathBindingCreate(
+            datapath,
+            nullptr,
+            &serverAddress.SockAddr,
+            &RecvContext,
+            &client));
+    ASSERT_NE(nullptr, client);
+
+    auto ClientSendContext =
+        QuicDataPathBindingAllocSendContext(client, QUIC_ECN_NON_ECT, ExpectedDataSize);
+    ASSERT_NE(nullptr, ClientSendContext);
+
+    //
+    // Spread the datagrams out a millisecond apart, far enough that they can't
+    // share a segmented send, if the datapath supports departure times. Either
+    // way, all of them must arrive.
+    //
+    const BOOLEAN DepartureTimeSupported =
+        !!(QuicDataPathGetSupportedFeatures(datapath) & QUIC_DATAPATH_FEATURE_SEND_DEPARTURE_TIME);
+    const long MaxDatagrams = 8;
+    const uint64_t StartTime = QuicTimeUs64();
+    while (RecvContext.ExpectedCount < MaxDatagrams &&
+           !QuicDataPathBindingIsSendContextFull(ClientSendContext)) {
+        auto ClientDatagram =
+            QuicDataPathBindingAllocSendDatagram(ClientSendContext, ExpectedDataSize);
+        ASSERT_NE(nullptr, ClientDatagram);
+        if (DepartureTimeSupported) {
+            QuicDataPathBindingSetSendDepartureTime(
+                ClientSendContext,
+                ClientDatagram,
+                StartTime + 1000 * RecvContext.ExpectedCount);
+        }
+        memcpy(ClientDatagram->Buffer, ExpectedData, ExpectedDataSize);
+        RecvContext.ExpectedCount++;
+    }
+    ASSERT_NE(0, RecvContext.ExpectedCount);
+
+    QUIC_ADDR ClientAddress;
+    QuicDataPathBindingGetLocalAddress(client, &ClientAddress);
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathBindingSend(
+            client,
+            &ClientAddress,
+            &serverAddress.SockAddr,
+            ClientSendContext));
+
+    ASSERT_TRUE(QuicEventWaitWithTimeout(RecvContext.ServerCompletion, 2000));
+
+    QuicDataPathBindingDelete(client);
+    QuicDataPathBindingDelete(server);
+
+    QuicDataPathUninitialize(
+        datapath);
+
+    QuicEventUninitialize(RecvContext.ServerCompletion);
+}
+
+#ifndef _WIN32
+//
+// Returns TRUE if a plain socket with only SO_REUSEPORT set can bind to the
+// address, i.e. if every socket already bound to it is in a reuseport group.
+//
+static
+bool
+CanJoinReusePortGroup(
+    _In_ const QUIC_ADDR* Address
+    )
+{
+    struct sockaddr_storage SockAddr;
+    socklen_t SockAddrLength;
+    QuicZeroMemory(&SockAddr, sizeof(SockAddr));
+    if (QuicAddrGetFamily(Address) == QUIC_ADDRESS_FAMILY_INET) {
+        struct sockaddr_in* Ipv4 = (struct sockaddr_in*)&SockAddr;
+        Ipv4->sin_family = AF_INET;
+        Ipv4->sin_port = Address->Ipv4.sin_port;
+        Ipv4->sin_addr = Address->Ipv4.sin_addr;
+        SockAddrLength = sizeof(*Ipv4);
+    } else {
+        struct sockaddr_in6* Ipv6 = (struct sockaddr_in6*)&SockAddr;
+        Ipv6->sin6_family = AF_INET6;
+        Ipv6->sin6_port = Address->Ipv6.sin6_port;
+        Ipv6->sin6_addr = Address->Ipv6.sin6_addr;
+        SockAddrLength = sizeof(*Ipv6);
+    }
+
+    int Socket = socket(SockAddr.ss_family, SOCK_DGRAM, IPPROTO_UDP);
+    EXPECT_NE(-1, Socket);
+    int Option = 1;
+    EXPECT_EQ(0, setsockopt(Socket, SOL_SOCKET, SO_REUSEPORT, &Option, sizeof(Option)));
+    bool Joined = bind(Socket, (struct sockaddr*)&SockAddr, SockAddrLength) == 0;
+    if (!Joined) {
+        EXPECT_EQ(EADDRINUSE, errno);
+    }
+    close(Socket);
+    return Joined;
+}
+
+TEST_P(DataPathTest, ReusePortGroup)
+{
+    QUIC_DATAPATH* datapath = nullptr;
+    QUIC_DATAPATH_BINDING* server = nullptr;
+    QUIC_DATAPATH_BINDING* client = nullptr;
+    auto serverAddress = GetNewLocalAddr();
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathInitialize(
+            0,
+            EmptyReceiveCallback,
+            EmptyUnreachableCallback,
+            &datapath));
+    ASSERT_NE(nullptr, datapath);
+
+    QUIC_STATUS Status = QUIC_STATUS_ADDRESS_IN_USE;
+    while (Status == QUIC_STATUS_ADDRESS_IN_USE) {
+        serverAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Status =
+            QuicDataPathBindingCreate(
+                datapath,
+                &serverAddress.SockAddr,
+                nullptr,
+                nullptr,
+                &server);
+    }
+    VERIFY_QUIC_SUCCESS(Status);
+    ASSERT_NE(nullptr, server);
+
+    //
+    // The listener's sockets form a reuseport group.
+    //
+    QUIC_ADDR ServerAddress;
+    QuicDataPathBindingGetLocalAddress(server, &ServerAddress);
+    ASSERT_TRUE(CanJoinReusePortGroup(&ServerAddress));
+
+    //
+    // The client's (connected) sockets don't.
+    //
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathBindingCreate(
+            datapath,
+            nullptr,
+            &serverAddress.SockAddr,
+            nullptr,
+            &client));
+    ASSERT_NE(nullptr, client);
+
+    QUIC_ADDR ClientAddress;
+    QuicDataPathBindingGetLocalAddress(client, &ClientAddress);
+    ASSERT_FALSE(CanJoinReusePortGroup(&ClientAddress));
+
+    QuicDataPathBindingDelete(client);
+    QuicDataPathBindingDelete(server);
+
+    QuicDataPathUninitialize(
+        datapath);
+}
+#endif // _WIN32
+
+struct ExecutionContextTest {
+    QUIC_EXECUTION_CONTEXT ExecutionContext;
+    QUIC_EVENT Completion;
+    volatile long RunCount;
+    long StopAfter;
+    bool RunOnThread;
+    ExecutionContextTest(long StopAfter) :
+        RunCount(0), StopAfter(StopAfter), RunOnThread(true) {
+        QuicZeroMemory(&ExecutionContext, sizeof(ExecutionContext));
+        ExecutionContext.Context = this;
+        ExecutionContext.Run = Run;
+        ExecutionContext.NextTimeUs = UINT64_MAX;
+        QuicEventInitialize(&Completion, FALSE, FALSE);
+    }
+    ~ExecutionContextTest() {
+        QuicEventUninitialize(Completion);
+    }
+    static
+    BOOLEAN
+    Run(
+        _Inout_ QUIC_EXECUTION_CONTEXT* ExecutionContext,
+        _In_ uint64_t TimeNow
+        )
+    {
+        auto This = (ExecutionContextTest*)ExecutionContext->Context;
+        if (!QuicDataPathIsExecutionContextThread(ExecutionContext)) {
+            This->RunOnThread = false;
+        }
+        long Count = InterlockedIncrement(&This->RunCount);
+        if (Count == 2) {
+            //
+            // Ask to be run again via the timer.
+            //
+            ExecutionContext->NextTimeUs = TimeNow + MS_TO_US(10);
+        } else {
+            ExecutionContext->NextTimeUs = UINT64_MAX;
+        }
+        QuicEventSet(This->Completion);
+        return Count < This->StopAfter;
+    }
+};
+
+TEST_F(DataPathTest, ExecutionContext)
+{
+    QUIC_DATAPATH* datapath = nullptr;
+
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathInitialize(
+            0,
+            EmptyReceiveCallback,
+            EmptyUnreachableCallback,
+            &datapath));
+    ASSERT_NE(datapath, nullptr);
+
+    if (!(QuicDataPathGetSupportedFeatures(datapath) & QUIC_DATAPATH_FEATURE_EXECUTION_CONTEXTS)) {
+        QuicDataPathUninitialize(datapath);
+        GTEST_SKIP_("Execution contexts not supported by this datapath");
+    }
+
+    ExecutionContextTest Test(3);
+    VERIFY_QUIC_SUCCESS(
+        QuicDataPathAddExecutionContext(datapath, 0, &Test.ExecutionContext));
+
+    //
+    // Added contexts start out ready, so the first run happens right away.
+    //
+    ASSERT_TRUE(QuicEventWaitWithTimeout(Test.Completion, 2000));
+    ASSERT_EQ(1, Test.RunCount);
+    ASSERT_FALSE(QuicDataPathIsExecutionContextThread(&Test.ExecutionContext));
+
+    //
+    // The second run is triggered by an explicit wake and the third (and last)
+    // one by the timer that the second run sets.
+    //
+    QuicDataPathWakeExecutionContext(&Test.ExecutionContext);
+    while (Test.RunCount < 3) {
+        ASSERT_TRUE(QuicEventWaitWithTimeout(Test.Completion, 2000));
+    }
+    ASSERT_EQ(3, Test.RunCount);
+    ASSERT_TRUE(Test.RunOnThread);
+
+    QuicDataPathUninitialize(
+        datapath);
+}
+
 INSTANTIATE_TEST_SUITE_P(DataPathTest, DataPathTest, ::testing::Values(4, 6), testing::PrintToStringParamName());
@@ -0,0 +1,145 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the QUIC_POOL interface.
+
+--*/
+
+#include "main.h"
+#include <atomic>
+#ifdef QUIC_CLOG
+#include "PoolTest.cpp.clog.h"
+#endif
+
+#define POOL_TEST_ENTRY_SIZE        64
+#define POOL_TEST_THREAD_COUNT      8
+#define POOL_TEST_ITERATIONS        5000
+#define POOL_TEST_BATCH_SIZE        32
+#define POOL_TEST_EXCHANGE_SLOTS    16
+
+struct PoolTestContext {
+    QUIC_POOL Pool;
+    std::atomic<void*> Exchange[POOL_TEST_EXCHANGE_SLOTS];
+    std::atomic<uint32_t> Failures;
+    PoolTestContext() : Failures(0) {
+        QuicPoolInitialize(FALSE, POOL_TEST_ENTRY_SIZE, QUIC_POOL_TEST, &Pool);
+        for (uint32_t i = 0; i < POOL_TEST_EXCHANGE_SLOTS; ++i) {
+            Exchange[i] = nullptr;
+        }
+    }
+    ~PoolTestContext() {
+        for (uint32_t i = 0; i < POOL_TEST_EXCHANGE_SLOTS; ++i) {
+            void* Entry = Exchange[i].exchange(nullptr);
+            if (Entry != nullptr) {
+                QuicPoolFree(&Pool, Entry);
+            }
+        }
+        QuicPoolUninitialize(&Pool);
+    }
+};
+
+struct PoolTestThreadContext {
+    PoolTestContext* Context;
+    uint64_t ThreadId;
+};
+
+QUIC_THREAD_CALLBACK(PoolTestThread, Context)
+{
+    PoolTestThreadContext* ThreadContext = (PoolTestThreadContext*)Context;
+    PoolTestContext* TestContext = ThreadContext->Context;
+    uint64_t* Entries[POOL_TEST_BATCH_SIZE];
+
+    for (uint64_t i = 0; i < POOL_TEST_ITERATIONS; ++i) {
+        //
+        // Stamp every entry of the batch so that an entry handed out to two
+        // threads (or twice to this one) is detected.
+        //
+        const uint64_t Stamp = (ThreadContext->ThreadId << 48) | (i << 8);
+        for (uint32_t j = 0; j < POOL_TEST_BATCH_SIZE; ++j) {
+            Entries[j] = (uint64_t*)QuicPoolAlloc(&TestContext->Pool);
+            if (Entries[j] == nullptr) {
+                TestContext->Failures++;
+                QUIC_THREAD_RETURN(0);
+            }
+            for (uint32_t k = 0; k < POOL_TEST_ENTRY_SIZE / sizeof(uint64_t); ++k) {
+                Entries[j][k] = Stamp | j;
+            }
+        }
+        for (uint32_t j = 0; j < POOL_TEST_BATCH_SIZE; ++j) {
+            for (uint32_t k = 0; k < POOL_TEST_ENTRY_SIZE / sizeof(uint64_t); ++k) {
+                if (Entries[j][k] != (Stamp | j)) {
+                    TestContext->Failures++;
+                }
+            }
+        }
+
+        //
+        // Free half the batch locally and trade the other half with other
+        // threads so that entries are also freed on a different thread (and
+        // likely processor) than they were allocated on.
+        //
+        for (uint32_t j = 0; j < POOL_TEST_BATCH_SIZE; ++j) {
+            void* Entry = Entries[j];
+            if (j % 2 == 1) {
+                Entry =
+                    TestContext->Exchange[(i + j) % POOL_TEST_EXCHANGE_SLOTS].exchange(Entry);
+            }
+            if (Entry != nullptr) {
+                QuicPoolFree(&TestContext->Pool, Entry);
+            }
+        }
+    }
+
+    QUIC_THREAD_RETURN(0);
+}
+
+TEST(PoolTest, AllocFree)
+{
+    PoolTestContext Context;
+    uint64_t* Entries[QUIC_POOL_MAXIMUM_DEPTH * 2];
+
+    for (uint32_t Round = 0; Round < 2; ++Round) {
+        for (uint32_t i = 0; i < ARRAYSIZE(Entries); ++i) {
+            Entries[i] = (uint64_t*)QuicPoolAlloc(&Context.Pool);
+            ASSERT_NE(nullptr, Entries[i]);
+            *Entries[i] = i;
+        }
+        for (uint32_t i = 0; i < ARRAYSIZE(Entries); ++i) {
+            ASSERT_EQ(i, *Entries[i]);
+        }
+        for (uint32_t i = 0; i < ARRAYSIZE(Entries); ++i) {
+            QuicPoolFree(&Context.Pool, Entries[i]);
+        }
+    }
+}
+
+TEST(PoolTest, ConcurrentAllocFree)
+{
+    PoolTestContext Context;
+    PoolTestThreadContext ThreadContexts[POOL_TEST_THREAD_COUNT];
+    QUIC_THREAD Threads[POOL_TEST_THREAD_COUNT];
+
+    for (uint32_t i = 0; i < POOL_TEST_THREAD_COUNT; ++i) {
+        ThreadContexts[i].Context = &Context;
+        ThreadContexts[i].ThreadId = i + 1;
+        QUIC_THREAD_CONFIG Config = {
+            0,
+            0,
+            "PoolTest",
+            PoolTestThread,
+            &ThreadContexts[i]
+        };
+        VERIFY_QUIC_SUCCESS(QuicThreadCreate(&Config, &Threads[i]));
+    }
+
+    for (uint32_t i = 0; i < POOL_TEST_THREAD_COUNT; ++i) {
+        QuicThreadWait(&Threads[i]);
+        QuicThreadDelete(&Threads[i]);
+    }
+
+    ASSERT_EQ(0u, Context.Failures.load());
+}
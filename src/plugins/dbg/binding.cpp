@@ -71,8 +71,8 @@ EXT_COMMAND(
             Conn.TypeStr());
     } else {
         for (UCHAR i = 0; i < PartitionCount; i++) {
-            HashTable Hash(Lookup.GetLookupTable(i).GetTablePtr());
-            Dml("\t<link cmd=\"dt msquic!QUIC_HASHTABLE 0x%I64X\">Hash Table %d</link> (%u entries)\n",
+            LookupTable Hash(Lookup.GetLookupTable(i).GetTablePtr());
+            Dml("\t<link cmd=\"dt msquic!QUIC_LOOKUP_TABLE 0x%I64X\">Hash Table %d</link> (%u entries)\n",
                 Hash.Addr,
                 i,
                 Hash.NumEntries());
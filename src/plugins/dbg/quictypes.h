@@ -58,6 +58,8 @@ typedef union QUIC_STREAM_FLAGS {
         BOOLEAN ReceiveFlushQueued      : 1;    // The receive flush operation is queued.
         BOOLEAN ReceiveDataPending      : 1;    // Data (or FIN) is queued and ready for delivery.
         BOOLEAN ReceiveCallPending      : 1;    // There is an uncompleted receive to the app.
+        BOOLEAN ReceiveCallActive       : 1;    // A receive callback is being indicated to the app.
+        BOOLEAN ReceiveCompleteInline   : 1;    // The app completed the receive from the callback.
 
         BOOLEAN HandleSendShutdown      : 1;    // Send shutdown complete callback delivered.
         BOOLEAN HandleShutdown          : 1;    // Shutdown callback delivered.
@@ -917,11 +919,11 @@ struct LossDetection : Struct {
     }
 
     ULONG64 GetSendPackets() {
-        return ReadPointer("SentPackets");
+        return AddrOf("SentPackets"); // QUIC_SENT_PACKET_RING
     }
 
     ULONG64 GetLostPackets() {
-        return ReadPointer("LostPackets");
+        return AddrOf("LostPackets"); // QUIC_SENT_PACKET_RING
     }
 };
 
@@ -1359,12 +1361,70 @@ struct Registration : Struct {
     }
 };
 
+struct LookupTable : Struct {
+
+    ULONG64 Buckets;
+    UCHAR Link;
+    ULONG BucketCount;
+    ULONG HeadsOffset;
+    ULONG NextOffset;
+
+    ULONG Bucket;
+    ULONG64 Entry;
+
+    LookupTable(ULONG64 Addr) : Struct("msquic!QUIC_LOOKUP_TABLE", Addr) {
+        Buckets = ReadPointer("Buckets");
+        Link = 0;
+        BucketCount = 0;
+        HeadsOffset = 0;
+        GetFieldOffset("msquic!QUIC_LOOKUP_ENTRY", "Next", &NextOffset);
+        if (Buckets != 0) {
+            ULONG Mask;
+            ReadTypeFromStructAddr(Buckets, "msquic!QUIC_LOOKUP_BUCKETS", "Link", &Link);
+            ReadTypeFromStructAddr(Buckets, "msquic!QUIC_LOOKUP_BUCKETS", "Mask", &Mask);
+            GetFieldOffset("msquic!QUIC_LOOKUP_BUCKETS", "Heads", &HeadsOffset);
+            BucketCount = Mask + 1;
+        }
+
+        Bucket = 0;
+        Entry = 0;
+    }
+
+    ULONG NumEntries() {
+        return ReadType<ULONG>("NumEntries");
+    }
+
+    bool GetNextEntry(ULONG64* EntryAddress) {
+        while (Entry == 0) {
+            if (Bucket >= BucketCount) {
+                return false;
+            }
+            if (!ReadPointerAtAddr(
+                    Buckets + HeadsOffset + Bucket * g_ExtInstance.m_PtrSize,
+                    &Entry)) {
+                dprintf("Failed to read bucket %u at %p\n", Bucket, Buckets);
+                return false;
+            }
+            Bucket++;
+        }
+
+        *EntryAddress = Entry;
+        if (!ReadPointerAtAddr(
+                Entry + NextOffset + Link * g_ExtInstance.m_PtrSize,
+                &Entry)) {
+            dprintf("Failed to walk entry %p\n", *EntryAddress);
+            Entry = 0;
+        }
+        return true;
+    }
+};
+
 struct LookupHashTable : Struct {
 
     LookupHashTable(ULONG64 Addr) : Struct("msquic!QUIC_PARTITIONED_HASHTABLE", Addr) { }
 
     ULONG64 GetTablePtr() {
-        return AddrOf("Table"); // TODO - Need Hash Table Enumeration.
+        return AddrOf("Table");
     }
 };
 
@@ -1385,13 +1445,15 @@ struct Lookup : Struct {
     }
 
     ULONG64 GetLookupPtr() {
-        return ReadPointer("LookupTable");
+        return ReadPointer("SINGLE.Connection");
     }
 
     LookupHashTable GetLookupTable(UCHAR Index) {
-        ULONG64 ArrayAddr = ReadPointer("LookupTable");
+        ULONG64 PartitionsAddr = ReadPointer("HASH.Partitions");
+        ULONG TablesOffset;
+        GetFieldOffset("msquic!QUIC_LOOKUP_PARTITIONS", "Tables", &TablesOffset);
         ULONG TypeSize = GetTypeSize("msquic!QUIC_PARTITIONED_HASHTABLE");
-        return LookupHashTable(ArrayAddr + Index * TypeSize);
+        return LookupHashTable(PartitionsAddr + TablesOffset + Index * TypeSize);
     }
 };
 
@@ -36,7 +36,8 @@ namespace MsQuicTracing.DataModel
         StreamSend,
         StreamReceiveComplete,
         StreamReceiveSetEnabled,
-        StreamDatagramSend
+        StreamDatagramSend,
+        StreamSendBatch
     }
 
     public enum QuicConnectionState
@@ -79,6 +80,7 @@ namespace MsQuicTracing.DataModel
         ApiSetParam,
         ApiGetParam,
         ApiDatagramSend,
+        ApiStreamSendBatch,
 
         TimerPacing,
         TimerAckDelay,
@@ -32,6 +32,7 @@ void QuicTestValidateConfiguration();
 void QuicTestValidateListener();
 void QuicTestValidateConnection();
 void QuicTestValidateStream(bool Connect);
+void QuicTestValidateInlineStreamCalls();
 void QuicTestGetPerfCounters();
 
 //
@@ -77,6 +78,11 @@ QuicTestVersionNegotiation(
     _In_ int Family
     );
 
+void
+QuicTestAsyncHandshake(
+    _In_ int Family
+    );
+
 //
 // Negative Handshake Tests
 //
@@ -240,6 +246,16 @@ QuicTestAckSendDelay(
     _In_ int Family
     );
 
+void
+QuicTestAckFrequency(
+    _In_ int Family
+    );
+
+void
+QuicTestTxTimePacing(
+    _In_ int Family
+    );
+
 //
 // QuicDrill tests
 //
@@ -590,4 +606,19 @@ typedef struct {
     QUIC_CTL_CODE(46, METHOD_BUFFERED, FILE_WRITE_DATA)
     // int - Family
 
-#define QUIC_MAX_IOCTL_FUNC_CODE 46
+#define IOCTL_QUIC_RUN_ASYNC_HANDSHAKE \
+    QUIC_CTL_CODE(47, METHOD_BUFFERED, FILE_WRITE_DATA)
+    // int - Family
+
+#define IOCTL_QUIC_RUN_ACK_FREQUENCY \
+    QUIC_CTL_CODE(48, METHOD_BUFFERED, FILE_WRITE_DATA)
+    // int - Family
+
+#define IOCTL_QUIC_RUN_TX_TIME_PACING \
+    QUIC_CTL_CODE(49, METHOD_BUFFERED, FILE_WRITE_DATA)
+    // int - Family
+
+#define IOCTL_QUIC_RUN_VALIDATE_INLINE_STREAM_CALLS \
+    QUIC_CTL_CODE(50, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define QUIC_MAX_IOCTL_FUNC_CODE 50
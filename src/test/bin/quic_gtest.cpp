@@ -194,6 +194,15 @@ TEST_P(WithBool, ValidateStream) {
     }
 }
 
+TEST(ParameterValidation, ValidateInlineStreamCalls) {
+    TestLogger Logger("QuicTestValidateInlineStreamCalls");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_VALIDATE_INLINE_STREAM_CALLS));
+    } else {
+        QuicTestValidateInlineStreamCalls();
+    }
+}
+
 TEST(ParameterValidation, ValidateConnectionEvents) {
     TestLogger Logger("QuicTestValidateConnectionEvents");
     if (TestingKernelMode) {
@@ -392,6 +401,15 @@ TEST_P(WithFamilyArgs, VersionNegotiation) {
     }
 }
 
+TEST_P(WithFamilyArgs, AsyncHandshake) {
+    TestLoggerT<ParamType> Logger("QuicTestAsyncHandshake", GetParam());
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_ASYNC_HANDSHAKE, GetParam().Family));
+    } else {
+        QuicTestAsyncHandshake(GetParam().Family);
+    }
+}
+
 #if QUIC_TEST_DATAPATH_HOOKS_ENABLED
 TEST_P(WithHandshakeArgs4, RandomLoss) {
     TestLoggerT<ParamType> Logger("QuicTestConnect-RandomLoss", GetParam());
@@ -821,6 +839,24 @@ TEST_P(WithFamilyArgs, AckSendDelay) {
     }
 }
 
+TEST_P(WithFamilyArgs, AckFrequency) {
+    TestLoggerT<ParamType> Logger("QuicTestAckFrequency", GetParam());
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_ACK_FREQUENCY, GetParam().Family));
+    } else {
+        QuicTestAckFrequency(GetParam().Family);
+    }
+}
+
+TEST_P(WithFamilyArgs, TxTimePacing) {
+    TestLoggerT<ParamType> Logger("QuicTestTxTimePacing", GetParam());
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_TX_TIME_PACING, GetParam().Family));
+    } else {
+        QuicTestTxTimePacing(GetParam().Family);
+    }
+}
+
 TEST(Drill, VarIntEncoder) {
     TestLogger Logger("QuicDrillTestVarIntEncoder");
     if (TestingKernelMode) {
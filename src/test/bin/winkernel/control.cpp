@@ -412,7 +412,11 @@ size_t QUIC_IOCTL_BUFFER_SIZES[] =
     sizeof(INT32),
     sizeof(INT32),
     0,
-    sizeof(INT32)
+    sizeof(INT32),
+    sizeof(INT32),
+    sizeof(INT32),
+    sizeof(INT32),
+    0
 };
 
 static_assert(
@@ -684,6 +688,11 @@ QuicTestCtlEvtIoDeviceControl(
         QuicTestCtlRun(QuicTestVersionNegotiation(Params->Family));
         break;
 
+    case IOCTL_QUIC_RUN_ASYNC_HANDSHAKE:
+        QUIC_FRE_ASSERT(Params != nullptr);
+        QuicTestCtlRun(QuicTestAsyncHandshake(Params->Family));
+        break;
+
     case IOCTL_QUIC_RUN_KEY_UPDATE:
         QUIC_FRE_ASSERT(Params != nullptr);
         QuicTestCtlRun(
@@ -821,6 +830,20 @@ QuicTestCtlEvtIoDeviceControl(
             QuicTestAckSendDelay(Params->Family));
         break;
 
+    case IOCTL_QUIC_RUN_ACK_FREQUENCY:
+        QUIC_FRE_ASSERT(Params != nullptr);
+        QuicTestCtlRun(QuicTestAckFrequency(Params->Family));
+        break;
+
+    case IOCTL_QUIC_RUN_TX_TIME_PACING:
+        QUIC_FRE_ASSERT(Params != nullptr);
+        QuicTestCtlRun(QuicTestTxTimePacing(Params->Family));
+        break;
+
+    case IOCTL_QUIC_RUN_VALIDATE_INLINE_STREAM_CALLS:
+        QuicTestCtlRun(QuicTestValidateInlineStreamCalls());
+        break;
+
     default:
         Status = STATUS_NOT_IMPLEMENTED;
         break;
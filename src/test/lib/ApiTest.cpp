@@ -992,6 +992,19 @@ DummyStreamCallback(
     return QUIC_STATUS_SUCCESS;
 }
 
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+AnyEventStreamCallback(
+    _In_ HQUIC /*Stream*/,
+    _In_opt_ void* /*Context*/,
+    _Inout_ QUIC_STREAM_EVENT* /*Event*/
+    )
+{
+    return QUIC_STATUS_SUCCESS;
+}
+
 void QuicTestValidateStream(bool Connect)
 {
     MsQuicRegistration Registration;
@@ -1342,6 +1355,126 @@ void QuicTestValidateStream(bool Connect)
                         QUIC_TEST_NO_ERROR));
             }
 
+            //
+            // Batch send on null connection.
+            //
+            {
+                QUIC_STREAM_SEND_BATCH_ENTRY Entries[1] = {};
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_INVALID_PARAMETER,
+                    MsQuic->StreamSendBatch(
+                        nullptr,
+                        Entries,
+                        ARRAYSIZE(Entries)));
+            }
+
+            //
+            // Batch send with no entries.
+            //
+            TEST_QUIC_STATUS(
+                QUIC_STATUS_INVALID_PARAMETER,
+                MsQuic->StreamSendBatch(
+                    Client.GetConnection(),
+                    nullptr,
+                    0));
+
+            //
+            // Batch send opening a stream without a handler.
+            //
+            {
+                uint8_t RawBuffer[100] = {};
+                QUIC_BUFFER SendBuffer { sizeof(RawBuffer), RawBuffer };
+                QUIC_STREAM_SEND_BATCH_ENTRY Entries[1] = {};
+                Entries[0].Buffers = &SendBuffer;
+                Entries[0].BufferCount = 1;
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_INVALID_PARAMETER,
+                    MsQuic->StreamSendBatch(
+                        Client.GetConnection(),
+                        Entries,
+                        ARRAYSIZE(Entries)));
+                TEST_QUIC_STATUS(QUIC_STATUS_INVALID_PARAMETER, Entries[0].Status);
+                TEST_EQUAL(nullptr, Entries[0].Stream);
+            }
+
+            //
+            // Batch send with one invalid entry, one existing stream and one
+            // stream opened, sent on and gracefully shutdown by the batch.
+            //
+            {
+                uint8_t RawBuffer[100] = {};
+                QUIC_BUFFER SendBuffer { sizeof(RawBuffer), RawBuffer };
+                StreamScope Existing;
+                TEST_QUIC_SUCCEEDED(
+                    MsQuic->StreamOpen(
+                        Client.GetConnection(),
+                        QUIC_STREAM_OPEN_FLAG_NONE,
+                        AnyEventStreamCallback,
+                        nullptr,
+                        &Existing.Handle));
+
+                QUIC_STREAM_SEND_BATCH_ENTRY Entries[3] = {};
+                Entries[0].Stream = Existing.Handle;
+                Entries[0].Buffers = &SendBuffer;
+                Entries[0].BufferCount = 0;
+                Entries[1].Stream = Existing.Handle;
+                Entries[1].Buffers = &SendBuffer;
+                Entries[1].BufferCount = 1;
+                Entries[1].Flags = QUIC_SEND_FLAG_START;
+                Entries[2].Handler = AnyEventStreamCallback;
+                Entries[2].Buffers = &SendBuffer;
+                Entries[2].BufferCount = 1;
+                Entries[2].Flags = QUIC_SEND_FLAG_START | QUIC_SEND_FLAG_FIN;
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_PENDING,
+                    MsQuic->StreamSendBatch(
+                        Client.GetConnection(),
+                        Entries,
+                        ARRAYSIZE(Entries)));
+
+                StreamScope Opened(Entries[2].Stream);
+                TEST_QUIC_STATUS(QUIC_STATUS_INVALID_PARAMETER, Entries[0].Status);
+                TEST_QUIC_STATUS(QUIC_STATUS_PENDING, Entries[1].Status);
+                TEST_QUIC_STATUS(QUIC_STATUS_PENDING, Entries[2].Status);
+                TEST_NOT_EQUAL(nullptr, Opened.Handle);
+            }
+
+            //
+            // Batch send entries that would open a stream, but fail, don't
+            // return one.
+            //
+            {
+                uint8_t RawBuffer[100] = {};
+                QUIC_BUFFER SendBuffer { sizeof(RawBuffer), RawBuffer };
+                QUIC_BUFFER EmptyBuffer { 0, RawBuffer };
+                QUIC_STREAM_SEND_BATCH_ENTRY Entries[1] = {};
+                Entries[0].Handler = AnyEventStreamCallback;
+                Entries[0].Buffers = &EmptyBuffer;
+                Entries[0].BufferCount = 1;
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_INVALID_PARAMETER,
+                    MsQuic->StreamSendBatch(
+                        Client.GetConnection(),
+                        Entries,
+                        ARRAYSIZE(Entries)));
+                TEST_EQUAL(nullptr, Entries[0].Stream);
+
+                TestConnection Closed(Registration);
+                TEST_TRUE(Closed.IsValid());
+                Closed.Shutdown(QUIC_CONNECTION_SHUTDOWN_FLAG_NONE, 0);
+                TEST_TRUE(Closed.WaitForShutdownComplete());
+
+                Entries[0].Buffers = &SendBuffer;
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_INVALID_STATE,
+                    MsQuic->StreamSendBatch(
+                        Closed.GetConnection(),
+                        Entries,
+                        ARRAYSIZE(Entries)));
+                TEST_QUIC_STATUS(QUIC_STATUS_INVALID_STATE, Entries[0].Status);
+                TEST_EQUAL(nullptr, Entries[0].Stream);
+            }
+
             //
             // Close nullptr.
             //
@@ -1350,6 +1483,213 @@ void QuicTestValidateStream(bool Connect)
     }
 }
 
+#define INLINE_TEST_CHUNK_LENGTH 100
+
+struct InlineStreamCallsContext {
+    uint8_t Data[INLINE_TEST_CHUNK_LENGTH];
+    QUIC_BUFFER Buffer;
+    uint32_t ServerReceiveCount;
+    uint64_t ClientReceiveLength;
+    bool ClientStreamAborted;
+    EventScope ServerReceiveEvent;
+    EventScope ClientPeerSendShutdownEvent;
+    UniquePtr<TestConnection> Server;
+    InlineStreamCallsContext() :
+        ServerReceiveCount(0), ClientReceiveLength(0), ClientStreamAborted(false) {
+        QuicZeroMemory(Data, sizeof(Data));
+        Buffer.Length = sizeof(Data);
+        Buffer.Buffer = Data;
+    }
+};
+
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+InlineServerStreamCallback(
+    _In_ HQUIC Stream,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_STREAM_EVENT* Event
+    )
+{
+    InlineStreamCallsContext* TestContext = (InlineStreamCallsContext*)Context;
+    QUIC_STATUS Status;
+
+    switch (Event->Type) {
+
+    case QUIC_STREAM_EVENT_RECEIVE:
+        //
+        // Completing from the callback only records the completion.
+        //
+        Status = MsQuic->StreamReceiveComplete(Stream, Event->RECEIVE.TotalBufferLength);
+        if (QUIC_FAILED(Status)) {
+            TEST_FAILURE("StreamReceiveComplete failed, 0x%x.", Status);
+        }
+        if (++TestContext->ServerReceiveCount != 2) {
+            //
+            // Returning SUCCESS anyway is tolerated, and the return status
+            // wins.
+            //
+            QuicEventSet(TestContext->ServerReceiveEvent);
+            return QUIC_STATUS_SUCCESS;
+        }
+
+        //
+        // Echo the data back and close the stream, both of which are
+        // processed right after this callback.
+        //
+        Status =
+            MsQuic->StreamSend(
+                Stream, &TestContext->Buffer, 1, QUIC_SEND_FLAG_NONE, nullptr);
+        if (Status != QUIC_STATUS_PENDING) {
+            TEST_FAILURE("StreamSend returned 0x%x instead of pending.", Status);
+        }
+        Status = MsQuic->StreamShutdown(Stream, QUIC_STREAM_SHUTDOWN_FLAG_GRACEFUL, 0);
+        if (Status != QUIC_STATUS_PENDING) {
+            TEST_FAILURE("StreamShutdown returned 0x%x instead of pending.", Status);
+        }
+        return QUIC_STATUS_PENDING;
+
+    case QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE:
+        MsQuic->StreamClose(Stream);
+        break;
+
+    default:
+        break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+InlineClientStreamCallback(
+    _In_ HQUIC /*Stream*/,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_STREAM_EVENT* Event
+    )
+{
+    InlineStreamCallsContext* TestContext = (InlineStreamCallsContext*)Context;
+
+    switch (Event->Type) {
+
+    case QUIC_STREAM_EVENT_RECEIVE:
+        TestContext->ClientReceiveLength += Event->RECEIVE.TotalBufferLength;
+        break;
+
+    case QUIC_STREAM_EVENT_PEER_SEND_ABORTED:
+        TestContext->ClientStreamAborted = true;
+        break;
+
+    case QUIC_STREAM_EVENT_PEER_SEND_SHUTDOWN:
+        QuicEventSet(TestContext->ClientPeerSendShutdownEvent);
+        break;
+
+    default:
+        break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_Function_class_(NEW_STREAM_CALLBACK)
+static
+void
+InlineNewStreamCallback(
+    _In_ TestConnection* Connection,
+    _In_ HQUIC StreamHandle,
+    _In_ QUIC_STREAM_OPEN_FLAGS /*Flags*/
+    )
+{
+    MsQuic->SetCallbackHandler(
+        StreamHandle, (void*)InlineServerStreamCallback, Connection->Context);
+}
+
+_Function_class_(NEW_CONNECTION_CALLBACK)
+static
+bool
+ListenerAcceptInlineCallback(
+    _In_ TestListener*  Listener,
+    _In_ HQUIC ConnectionHandle
+    )
+{
+    InlineStreamCallsContext* TestContext = (InlineStreamCallsContext*)Listener->Context;
+    TestContext->Server.reset(
+        new(std::nothrow) TestConnection(ConnectionHandle, InlineNewStreamCallback));
+    if (TestContext->Server == nullptr || !TestContext->Server->IsValid()) {
+        TEST_FAILURE("Failed to accept new TestConnection.");
+        return false;
+    }
+    TestContext->Server->Context = TestContext;
+    return true;
+}
+
+void QuicTestValidateInlineStreamCalls()
+{
+    MsQuicRegistration Registration;
+    TEST_TRUE(Registration.IsValid());
+
+    MsQuicAlpn Alpn("MsQuicTest");
+
+    MsQuicSettings Settings;
+    Settings.SetPeerBidiStreamCount(1);
+    MsQuicConfiguration ServerConfiguration(Registration, Alpn, Settings, SelfSignedCredConfig);
+    TEST_TRUE(ServerConfiguration.IsValid());
+
+    MsQuicCredentialConfig ClientCredConfig;
+    MsQuicConfiguration ClientConfiguration(Registration, Alpn, ClientCredConfig);
+    TEST_TRUE(ClientConfiguration.IsValid());
+
+    InlineStreamCallsContext TestContext;
+
+    {
+        TestListener MyListener(Registration, ListenerAcceptInlineCallback, ServerConfiguration);
+        TEST_TRUE(MyListener.IsValid());
+        MyListener.Context = &TestContext;
+        TEST_QUIC_SUCCEEDED(MyListener.Start(Alpn, Alpn.Length()));
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(MyListener.GetLocalAddr(ServerLocalAddr));
+
+        TestConnection Client(Registration);
+        TEST_TRUE(Client.IsValid());
+        TEST_QUIC_SUCCEEDED(
+            Client.Start(
+                ClientConfiguration,
+                QuicAddrGetFamily(&ServerLocalAddr.SockAddr),
+                QUIC_LOCALHOST_FOR_AF(
+                    QuicAddrGetFamily(&ServerLocalAddr.SockAddr)),
+                ServerLocalAddr.GetPort()));
+        TEST_TRUE(Client.WaitForConnectionComplete());
+        TEST_TRUE(Client.GetIsConnected());
+
+        StreamScope Stream;
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->StreamOpen(
+                Client.GetConnection(),
+                QUIC_STREAM_OPEN_FLAG_NONE,
+                InlineClientStreamCallback,
+                &TestContext,
+                &Stream.Handle));
+
+        //
+        // Send the data in two parts, so the server sees a separate receive
+        // for each.
+        //
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->StreamSend(
+                Stream.Handle, &TestContext.Buffer, 1, QUIC_SEND_FLAG_START, nullptr));
+        TEST_TRUE(QuicEventWaitWithTimeout(TestContext.ServerReceiveEvent, 2000));
+
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->StreamSend(
+                Stream.Handle, &TestContext.Buffer, 1, QUIC_SEND_FLAG_FIN, nullptr));
+        TEST_TRUE(QuicEventWaitWithTimeout(TestContext.ClientPeerSendShutdownEvent, 2000));
+
+        TEST_FALSE(TestContext.ClientStreamAborted);
+        TEST_EQUAL(INLINE_TEST_CHUNK_LENGTH, TestContext.ClientReceiveLength);
+    }
+}
+
 class SecConfigTestContext {
 public:
     QUIC_EVENT Event;
@@ -2168,3 +2168,152 @@ QuicTestAckSendDelay(
         TEST_EQUAL(TestContext.AckCountStop - TestContext.AckCountStart, 1);
     }
 }
+
+void
+QuicTestAckFrequency(
+    _In_ int Family
+    )
+{
+    //
+    // Large enough for the congestion window to grow to the point the sender
+    // asks for less frequent ACKs.
+    //
+    const uint64_t Length = 4 * 1000 * 1000;
+    const uint32_t TimeoutMs = EstimateTimeoutMs(Length);
+    QUIC_ADDRESS_FAMILY QuicAddrFamily = (Family == 4) ? QUIC_ADDRESS_FAMILY_INET : QUIC_ADDRESS_FAMILY_INET6;
+
+    PingStats ServerStats(Length, 1, 1, true, false, false, false, false, QUIC_STATUS_SUCCESS);
+    PingStats ClientStats(Length, 1, 1, true, false, false, false);
+
+    MsQuicRegistration Registration(true);
+    TEST_TRUE(Registration.IsValid());
+
+    MsQuicAlpn Alpn("MsQuicTest");
+
+    MsQuicSettings Settings;
+    Settings.SetPeerBidiStreamCount(1);
+    Settings.SetAckFrequencyEnabled(true);
+
+    MsQuicConfiguration ServerConfiguration(Registration, Alpn, Settings, SelfSignedCredConfig);
+    TEST_TRUE(ServerConfiguration.IsValid());
+
+    MsQuicCredentialConfig ClientCredConfig;
+    MsQuicConfiguration ClientConfiguration(Registration, Alpn, Settings, ClientCredConfig);
+    TEST_TRUE(ClientConfiguration.IsValid());
+
+    {
+        TestListener Listener(Registration, ListenerAcceptPingConnection, ServerConfiguration);
+        TEST_TRUE(Listener.IsValid());
+        TEST_QUIC_SUCCEEDED(Listener.Start(Alpn));
+
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        Listener.Context = &ServerStats;
+
+        //
+        // Any ACK_FREQUENCY or IMMEDIATE_ACK frame handling error closes the
+        // connection at the transport layer, which fails the test when the
+        // connections are shut down.
+        //
+        TestConnection* Client = NewPingConnection(Registration, &ClientStats, false);
+        if (Client == nullptr) {
+            return;
+        }
+
+        if (!SendPingBurst(Client, 1, Length)) {
+            return;
+        }
+
+        TEST_QUIC_SUCCEEDED(
+            Client->Start(
+                ClientConfiguration,
+                QuicAddrFamily,
+                QUIC_LOCALHOST_FOR_AF(QuicAddrFamily),
+                ServerLocalAddr.GetPort()));
+
+        if (!QuicEventWaitWithTimeout(ClientStats.CompletionEvent, TimeoutMs)) {
+            TEST_FAILURE("Wait for client to complete timed out after %u ms.", TimeoutMs);
+            return;
+        }
+
+        if (!QuicEventWaitWithTimeout(ServerStats.CompletionEvent, TimeoutMs)) {
+            TEST_FAILURE("Wait for server to complete timed out after %u ms.", TimeoutMs);
+            return;
+        }
+    }
+}
+
+void
+QuicTestTxTimePacing(
+    _In_ int Family
+    )
+{
+    //
+    // Large enough for the congestion window to grow past the point where
+    // the sends get paced.
+    //
+    const uint64_t Length = 1000 * 1000;
+    const uint32_t TimeoutMs = EstimateTimeoutMs(Length);
+    QUIC_ADDRESS_FAMILY QuicAddrFamily = (Family == 4) ? QUIC_ADDRESS_FAMILY_INET : QUIC_ADDRESS_FAMILY_INET6;
+
+    PingStats ServerStats(Length, 1, 1, true, false, false, false, false, QUIC_STATUS_SUCCESS);
+    PingStats ClientStats(Length, 1, 1, true, false, false, false);
+
+    MsQuicRegistration Registration(true);
+    TEST_TRUE(Registration.IsValid());
+
+    MsQuicAlpn Alpn("MsQuicTest");
+
+    MsQuicSettings Settings;
+    Settings.SetPeerBidiStreamCount(1);
+    Settings.SetTxTimePacingEnabled(true);
+
+    MsQuicConfiguration ServerConfiguration(Registration, Alpn, Settings, SelfSignedCredConfig);
+    TEST_TRUE(ServerConfiguration.IsValid());
+
+    MsQuicCredentialConfig ClientCredConfig;
+    MsQuicConfiguration ClientConfiguration(Registration, Alpn, Settings, ClientCredConfig);
+    TEST_TRUE(ClientConfiguration.IsValid());
+
+    {
+        TestListener Listener(Registration, ListenerAcceptPingConnection, ServerConfiguration);
+        TEST_TRUE(Listener.IsValid());
+        TEST_QUIC_SUCCEEDED(Listener.Start(Alpn));
+
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        Listener.Context = &ServerStats;
+
+        //
+        // Whether or not the datapath supports departure times (and the OS
+        // honors them), the transfer must complete.
+        //
+        TestConnection* Client = NewPingConnection(Registration, &ClientStats, false);
+        if (Client == nullptr) {
+            return;
+        }
+
+        if (!SendPingBurst(Client, 1, Length)) {
+            return;
+        }
+
+        TEST_QUIC_SUCCEEDED(
+            Client->Start(
+                ClientConfiguration,
+                QuicAddrFamily,
+                QUIC_LOCALHOST_FOR_AF(QuicAddrFamily),
+                ServerLocalAddr.GetPort()));
+
+        if (!QuicEventWaitWithTimeout(ClientStats.CompletionEvent, TimeoutMs)) {
+            TEST_FAILURE("Wait for client to complete timed out after %u ms.", TimeoutMs);
+            return;
+        }
+
+        if (!QuicEventWaitWithTimeout(ServerStats.CompletionEvent, TimeoutMs)) {
+            TEST_FAILURE("Wait for server to complete timed out after %u ms.", TimeoutMs);
+            return;
+        }
+    }
+}